@@ -54,6 +54,139 @@
 #define  MQTTc_CFG_ARG_CHK_EXT_EN               DEF_DISABLED
 
 
+/*
+*********************************************************************************************************
+*                                           ACK QUEUE DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Max nbr of acks (PUBACK, PUBREC and PUBCOMP) that ...*/
+                                                                /* can be q'd on a conn, waiting to be tx'd.            */
+#define  MQTTc_CFG_ACK_Q_SIZE                             8u
+
+
+/*
+*********************************************************************************************************
+*                                       INBOUND QoS 2 TBL DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Max nbr of inbound QoS 2 flows (PUBLISH rx'd and ... */
+                                                                /* PUBREL not yet rx'd) that can be active on a conn.   */
+                                                                /* Should be >= broker's max nbr of in-flight msgs. ... */
+                                                                /* When full, the conn is closed with an err.           */
+#define  MQTTc_CFG_QOS2_RX_TBL_SIZE                       8u
+
+
+/*
+*********************************************************************************************************
+*                                       INBOUND BATCHING DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables delivery of rx'd PUBLISH msgs in batches.    */
+#define  MQTTc_CFG_PUBLISH_RX_BATCH_EN          DEF_DISABLED
+                                                                /* Max nbr of PUBLISH msgs delivered per batch.         */
+#define  MQTTc_CFG_PUBLISH_RX_BATCH_SIZE                 16u
+
+
+/*
+*********************************************************************************************************
+*                                     COMPLETION BATCHING DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables delivery of cmpl'd msgs in batches.          */
+#define  MQTTc_CFG_CMPL_BATCH_EN                DEF_DISABLED
+                                                                /* Max nbr of cmpl'd msgs delivered per batch.          */
+#define  MQTTc_CFG_CMPL_BATCH_SIZE                       32u
+
+
+/*
+*********************************************************************************************************
+*                                         TX SCHEDULING DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enable to serve high, normal and bulk tx lanes in ...*/
+                                                                /* weighted round-robin instead of strict priority.     */
+#define  MQTTc_CFG_TX_SCHED_WEIGHTED_EN         DEF_DISABLED
+                                                                /* Max nbr of msgs tx'd from each lane per round.       */
+#define  MQTTc_CFG_TX_SCHED_WEIGHT_HIGH                   4u
+#define  MQTTc_CFG_TX_SCHED_WEIGHT_NORMAL                 2u
+#define  MQTTc_CFG_TX_SCHED_WEIGHT_BULK                   1u
+
+
+/*
+*********************************************************************************************************
+*                                        TASK SCHEDULING DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Max nbr of bytes rx'd or tx'd on a conn of weight ...*/
+                                                                /* 1 each time the task processes it.                   */
+#define  MQTTc_CFG_TASK_QUANTUM_BYTES                  1460u
+
+
+/*
+*********************************************************************************************************
+*                                      STORE AND FORWARD DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables durable store of outbound PUBLISH msgs.      */
+#define  MQTTc_CFG_STORE_EN                     DEF_DISABLED
+                                                                /* Max nbr of stored msgs in flight per conn.           */
+#define  MQTTc_CFG_STORE_WIN_SIZE                         8u
+                                                                /* Enables write-ahead log of in-flight QoS 1/2 state.  */
+#define  MQTTc_CFG_WAL_EN                       DEF_DISABLED
+
+
+/*
+*********************************************************************************************************
+*                                        RETAINED CACHE DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables cache of last payload rx'd on each topic.    */
+#define  MQTTc_CFG_CACHE_EN                     DEF_DISABLED
+
+
+/*
+*********************************************************************************************************
+*                                          STATISTICS DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables per-conn stat ctrs and MQTTc_ConnStatsGet(). */
+#define  MQTTc_CFG_STAT_EN                      DEF_ENABLED
+
+
+/*
+*********************************************************************************************************
+*                                      LATENCY HISTOGRAM DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables publish-to-ack latency histograms.           */
+#define  MQTTc_CFG_LAT_EN                       DEF_DISABLED
+                                                                /* Nbr of bits of precision of each bucket. See ...     */
+                                                                /* mqtt-c_lat.c Note #1.                                */
+#define  MQTTc_CFG_LAT_HIST_PRECISION_BITS                3u
+                                                                /* Latencies of 2^RANGE_BITS us or more are clamped.    */
+#define  MQTTc_CFG_LAT_HIST_RANGE_BITS                   24u
+
+
+/*
+*********************************************************************************************************
+*                                        TASK PROFILER DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables profiling of the phases of the MQTTc task.   */
+#define  MQTTc_CFG_PROF_EN                      DEF_DISABLED
+                                                                /* Callback calls longer than this, in us, overrun.     */
+#define  MQTTc_CFG_PROF_CALLBACK_OVERRUN_US            1000u
+
+
+/*
+*********************************************************************************************************
+*                                      MEMORY ACCOUNTING DEFINES
+*********************************************************************************************************
+*/
+                                                                /* Enables memory usage and MQTTc_MemStatsGet().        */
+#define  MQTTc_CFG_MEM_STATS_EN                 DEF_DISABLED
+
+
 /*
 *********************************************************************************************************
 *                                              DBG DEFINES
@@ -66,9 +199,21 @@
                                                                 /* Set trace level to higher than OFF, to obtain data.  */
 #define  MQTTc_CFG_DBG_TRACE_LEVEL              TRACE_LEVEL_OFF
 
-                                                                /* -------------- GLOBAL DBG BUF DEFINES -------------- */
-                                                                /* Enables dbg buf where data is copied at checkpoints. */
-#define  MQTTc_CFG_DBG_GLOBAL_BUF_EN            DEF_DISABLED
-                                                                /* Size of dbg buf.                                     */
-#define  MQTTc_CFG_DBG_GLOBAL_BUF_LEN                   512u
+                                                                /* ---------------- TRACE RING DEFINES ---------------- */
+                                                                /* Enables binary trace ring of hot path events.        */
+#define  MQTTc_CFG_DBG_TRACE_RING_EN            DEF_DISABLED
+                                                                /* Nbr of entries of trace ring. MUST be a power of 2.  */
+#define  MQTTc_CFG_DBG_TRACE_RING_SIZE                  256u
+
+                                                                /* ----------------- TIMELINE DEFINES ----------------- */
+                                                                /* Enables export of msg and task timelines to a file.  */
+#define  MQTTc_CFG_DBG_TIMELINE_EN              DEF_DISABLED
+                                                                /* Nbr of records buffered between two flushes.         */
+#define  MQTTc_CFG_DBG_TIMELINE_BUF_SIZE               1024u
+
+                                                                /* ------------------ CAPTURE DEFINES ----------------- */
+                                                                /* Enables capture of MQTT bytes tx'd and rx'd.         */
+#define  MQTTc_CFG_DBG_CAP_EN                   DEF_DISABLED
+                                                                /* Len of capture ring, in bytes. MUST be a power of 2. */
+#define  MQTTc_CFG_DBG_CAP_BUF_LEN                     8192u
 
@@ -93,6 +93,20 @@
 #define  APP_MQTTc_INACTIVITY_TIMEOUT_s           30u
 
 
+/*
+*********************************************************************************************************
+*                                         BENCH BROKER DEFINES
+*********************************************************************************************************
+*/
+
+                                                                /* Addr of the loopback broker stub.                    */
+#define  APP_MQTTc_BENCH_BROKER_ADDR                "127.0.0.1"
+#define  APP_MQTTc_BENCH_BROKER_PORT_NBR         1883u
+
+#define  APP_MQTTc_BENCH_BROKER_TASK_STK_SIZE    2048u
+#define  APP_MQTTc_BENCH_BROKER_TASK_PRIO           7u
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -101,7 +115,14 @@
 *********************************************************************************************************
 */
 
-CPU_BOOLEAN  AppMQTTc_Init (void);
+CPU_BOOLEAN  AppMQTTc_Init             (void);
+
+CPU_BOOLEAN  AppMQTTc_BenchBrokerInit  (void);
+
+CPU_BOOLEAN  AppMQTTc_BenchBrokerFlood (const  CPU_CHAR    *topic_str,
+                                               CPU_INT08U   qos_lvl,
+                                               CPU_INT32U   payload_len,
+                                               CPU_INT32U   msg_nbr);
 
 
 /*
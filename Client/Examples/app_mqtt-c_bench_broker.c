@@ -0,0 +1,1137 @@
+/*
+*********************************************************************************************************
+*                                            EXAMPLE CODE
+*
+*               This file is provided as an example on how to use Micrium products.
+*
+*               Please feel free to use any application code labeled as 'EXAMPLE CODE' in
+*               your application products.  Example code may be used as is, in whole or in
+*               part, or may be used as a reference only. This file can be modified as
+*               required to meet the end-product requirements.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          MQTTc APPLICATION
+*
+* Filename : app_mqtt-c_bench_broker.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) Minimal MQTT v3.1.1 broker stub, listening on the loopback interface, used by the
+*                benchmarks to measure the MQTTc module without a remote broker or a network in the loop.
+*
+*            (2) The stub is NOT a broker:
+*
+*                (a) Only a single topic filter is kept per conn. The filter is matched exactly, or as a
+*                    prefix when it ends with '#'.
+*
+*                (b) Sessions, retained msgs and wills are NOT supported. Msgs are never re-tx'd.
+*
+*                (c) Flow ctrl of outbound QoS 1 and QoS 2 msgs is only done when flooding. See
+*                    AppMQTTc_BenchBrokerFlood() Note #2.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    APP_MQTTc_MODULE
+
+#include  <cpu.h>
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <lib_str.h>
+
+#include  "app_mqtt-c.h"
+
+#include  <Common/mqtt.h>
+
+#include  <Source/net.h>
+#include  <Source/net_sock.h>
+#include  <Source/net_util.h>
+
+#include  <KAL/kal.h>
+
+#include  <stdio.h>
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX        8u
+
+#define  APP_MQTTc_BENCH_BROKER_RX_BUF_LEN       2048u
+#define  APP_MQTTc_BENCH_BROKER_TX_BUF_LEN       2048u
+
+#define  APP_MQTTc_BENCH_BROKER_TOPIC_LEN_MAX      64u
+#define  APP_MQTTc_BENCH_BROKER_PAYLOAD_LEN_MAX  1024u
+
+                                                                /* Max nbr of QoS 1/2 flood msgs not ack'd, per conn.   */
+#define  APP_MQTTc_BENCH_BROKER_FLOOD_WIN_SIZE      4u
+                                                                /* Max nbr of flood msgs tx'd per conn per iteration.   */
+#define  APP_MQTTc_BENCH_BROKER_FLOOD_BURST        16u
+
+#define  APP_MQTTc_BENCH_BROKER_LISTEN_Q_SIZE       4u
+#define  APP_MQTTc_BENCH_BROKER_SEL_TIMEOUT_US  10000u
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  app_mqttc_bench_broker_conn {
+    NET_SOCK_ID  SockId;                                        /* Sock ID, NET_SOCK_ID_NONE if slot is free.           */
+
+    CPU_INT08U   RxBuf[APP_MQTTc_BENCH_BROKER_RX_BUF_LEN];      /* Bytes rx'd, not yet processed.                       */
+    CPU_INT32U   RxLen;
+
+    CPU_CHAR     SubTopicStr[APP_MQTTc_BENCH_BROKER_TOPIC_LEN_MAX];
+    CPU_INT16U   SubTopicLen;                                   /* Len of topic filter, 0 if none. See Note #2a.        */
+    CPU_INT08U   SubQoS;
+
+    CPU_INT16U   MsgID_Next;                                    /* Next msg ID of tx'd QoS 1/2 PUBLISH msgs.            */
+    CPU_INT32U   InFlightNbr;                                   /* Nbr of tx'd QoS 1/2 PUBLISH msgs not ack'd.          */
+    CPU_INT32U   FloodRemNbr;                                   /* Nbr of flood msgs still to tx.                       */
+} APP_MQTTc_BENCH_BROKER_CONN;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U                   AppMQTTc_BenchBrokerTaskStk[APP_MQTTc_BENCH_BROKER_TASK_STK_SIZE];
+
+static  NET_SOCK_ID                  AppMQTTc_BenchBrokerListenSockId = NET_SOCK_ID_NONE;
+static  APP_MQTTc_BENCH_BROKER_CONN  AppMQTTc_BenchBrokerConnTbl[APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX];
+
+static  CPU_INT08U                   AppMQTTc_BenchBrokerTxBuf[APP_MQTTc_BENCH_BROKER_TX_BUF_LEN];
+
+static  NET_SOCK_DESC                AppMQTTc_BenchBrokerSockDescRd;
+
+                                                                /* Flood req'd by AppMQTTc_BenchBrokerFlood().          */
+static  CPU_BOOLEAN                  AppMQTTc_BenchBrokerFloodReq = DEF_NO;
+static  CPU_CHAR                     AppMQTTc_BenchBrokerFloodTopicStr[APP_MQTTc_BENCH_BROKER_TOPIC_LEN_MAX];
+static  CPU_INT16U                   AppMQTTc_BenchBrokerFloodTopicLen;
+static  CPU_INT08U                   AppMQTTc_BenchBrokerFloodQoS;
+static  CPU_INT32U                   AppMQTTc_BenchBrokerFloodPayloadLen;
+static  CPU_INT32U                   AppMQTTc_BenchBrokerFloodMsgNbr;
+static  CPU_CHAR                     AppMQTTc_BenchBrokerFloodPayload[APP_MQTTc_BENCH_BROKER_PAYLOAD_LEN_MAX];
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  void         AppMQTTc_BenchBrokerTask        (void                         *p_arg);
+
+static  void         AppMQTTc_BenchBrokerAccept      (void);
+
+static  void         AppMQTTc_BenchBrokerConnClose   (APP_MQTTc_BENCH_BROKER_CONN  *p_conn);
+
+static  void         AppMQTTc_BenchBrokerRx          (APP_MQTTc_BENCH_BROKER_CONN  *p_conn);
+
+static  void         AppMQTTc_BenchBrokerPktProcess  (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                      CPU_INT08U                    hdr,
+                                                      CPU_INT08U                   *p_buf,
+                                                      CPU_INT32U                    len);
+
+static  void         AppMQTTc_BenchBrokerSubscribe   (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                      CPU_INT08U                   *p_buf,
+                                                      CPU_INT32U                    len);
+
+static  void         AppMQTTc_BenchBrokerRoute       (const  CPU_CHAR              *p_topic,
+                                                             CPU_INT16U             topic_len,
+                                                             CPU_INT08U             qos_lvl,
+                                                      const  CPU_INT08U            *p_payload,
+                                                             CPU_INT32U             payload_len);
+
+static  void         AppMQTTc_BenchBrokerFloodStart  (void);
+
+static  CPU_BOOLEAN  AppMQTTc_BenchBrokerFloodTx     (void);
+
+static  CPU_BOOLEAN  AppMQTTc_BenchBrokerTopicMatch  (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                      const  CPU_CHAR              *p_topic,
+                                                      CPU_INT16U                    topic_len);
+
+static  void         AppMQTTc_BenchBrokerPublishTx   (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                      const  CPU_CHAR              *p_topic,
+                                                      CPU_INT16U                    topic_len,
+                                                      CPU_INT08U                    qos_lvl,
+                                                      const  CPU_INT08U            *p_payload,
+                                                      CPU_INT32U                    payload_len);
+
+static  void         AppMQTTc_BenchBrokerAckTx       (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                      CPU_INT08U                    hdr,
+                                                      CPU_INT16U                    msg_id);
+
+static  void         AppMQTTc_BenchBrokerTx          (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                      CPU_INT08U                   *p_buf,
+                                                      CPU_INT32U                    len);
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchBrokerInit()
+*
+* Description : Open the listen sock of the loopback broker stub and start its task.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The listen sock is open before this function returns : MQTTc conns can be open to
+*                   APP_MQTTc_BENCH_BROKER_ADDR right after, even if the broker task has not run yet.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_BenchBrokerInit (void)
+{
+    NET_SOCK_ADDR_IPv4  addr;
+    KAL_TASK_HANDLE     task_handle;
+    CPU_INT08U          ix;
+    NET_ERR             err_net;
+    KAL_ERR             err_kal;
+
+
+    for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+        AppMQTTc_BenchBrokerConnTbl[ix].SockId = NET_SOCK_ID_NONE;
+    }
+    Mem_Set(AppMQTTc_BenchBrokerFloodPayload, 'f', APP_MQTTc_BENCH_BROKER_PAYLOAD_LEN_MAX);
+
+    AppMQTTc_BenchBrokerListenSockId = NetSock_Open(NET_SOCK_PROTOCOL_FAMILY_IP_V4,
+                                                    NET_SOCK_TYPE_STREAM,
+                                                    NET_SOCK_PROTOCOL_TCP,
+                                                   &err_net);
+    if (err_net != NET_SOCK_ERR_NONE) {
+        printf("ERROR - Failed to open bench broker sock. Err: %i\n\r.", err_net);
+        return (DEF_FAIL);
+    }
+
+    Mem_Clr(&addr, sizeof(addr));
+    addr.AddrFamily = NET_SOCK_ADDR_FAMILY_IP_V4;
+    addr.Port       = NET_UTIL_HOST_TO_NET_16(APP_MQTTc_BENCH_BROKER_PORT_NBR);
+    addr.Addr       = NET_UTIL_HOST_TO_NET_32(NET_IPv4_ADDR_LOCAL_HOST_ADDR);
+
+    (void)NetSock_Bind(                  AppMQTTc_BenchBrokerListenSockId,
+                       (NET_SOCK_ADDR *)&addr,
+                                         NET_SOCK_ADDR_SIZE,
+                                        &err_net);
+    if (err_net != NET_SOCK_ERR_NONE) {
+        printf("ERROR - Failed to bind bench broker sock. Err: %i\n\r.", err_net);
+        goto end_err;
+    }
+
+    (void)NetSock_Listen(AppMQTTc_BenchBrokerListenSockId,
+                         APP_MQTTc_BENCH_BROKER_LISTEN_Q_SIZE,
+                        &err_net);
+    if (err_net != NET_SOCK_ERR_NONE) {
+        printf("ERROR - Failed to listen on bench broker sock. Err: %i\n\r.", err_net);
+        goto end_err;
+    }
+
+    task_handle = KAL_TaskAlloc("App MQTTc Bench Broker Task",
+                       (void *)&AppMQTTc_BenchBrokerTaskStk[0u],
+                                APP_MQTTc_BENCH_BROKER_TASK_STK_SIZE,
+                                DEF_NULL,
+                               &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("ERROR - Failed to alloc bench broker task. Err: %i\n\r.", err_kal);
+        goto end_err;
+    }
+
+    KAL_TaskCreate(task_handle,
+                   AppMQTTc_BenchBrokerTask,
+                   DEF_NULL,
+                   APP_MQTTc_BENCH_BROKER_TASK_PRIO,
+                   DEF_NULL,
+                  &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("ERROR - Failed to create bench broker task. Err: %i\n\r.", err_kal);
+        goto end_err;
+    }
+
+    return (DEF_OK);
+
+end_err:
+    NetSock_Close(AppMQTTc_BenchBrokerListenSockId, &err_net);
+    AppMQTTc_BenchBrokerListenSockId = NET_SOCK_ID_NONE;
+
+    return (DEF_FAIL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchBrokerFlood()
+*
+* Description : Make the broker stub tx a flood of PUBLISH msgs to every conn subscribed to a topic.
+*
+* Arguments   : topic_str       Topic of the PUBLISH msgs.
+*
+*               qos_lvl         QoS level of the PUBLISH msgs. Lowered to the QoS level granted to each conn.
+*
+*               payload_len     Len of the payload of each PUBLISH msg.
+*
+*               msg_nbr         Nbr of PUBLISH msgs to tx to each conn.
+*
+* Return(s)   : DEF_OK,   if flood is req'd,
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The flood is tx'd by the broker task. This function returns right after the flood is
+*                   req'd : the application must count the PUBLISH msgs rx'd to know when the flood ends.
+*
+*               (2) No more than APP_MQTTc_BENCH_BROKER_FLOOD_WIN_SIZE QoS 1/2 msgs are in flight per
+*                   conn, to stay within the QoS 2 rx tbl of the MQTTc module.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_BenchBrokerFlood (const  CPU_CHAR    *topic_str,
+                                               CPU_INT08U   qos_lvl,
+                                               CPU_INT32U   payload_len,
+                                               CPU_INT32U   msg_nbr)
+{
+    CPU_SIZE_T  topic_len;
+    CPU_SR_ALLOC();
+
+
+    topic_len = Str_Len(topic_str);
+    if ((topic_len   >  APP_MQTTc_BENCH_BROKER_TOPIC_LEN_MAX)  ||
+        (payload_len >  APP_MQTTc_BENCH_BROKER_PAYLOAD_LEN_MAX) ||
+        (qos_lvl     >  MQTT_MSG_QOS_LVL_MAX)) {
+        return (DEF_FAIL);
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (AppMQTTc_BenchBrokerFloodReq == DEF_YES) {
+        CPU_CRITICAL_EXIT();
+        return (DEF_FAIL);
+    }
+    Mem_Copy(AppMQTTc_BenchBrokerFloodTopicStr, topic_str, topic_len);
+    AppMQTTc_BenchBrokerFloodTopicLen   = (CPU_INT16U)topic_len;
+    AppMQTTc_BenchBrokerFloodQoS        =  qos_lvl;
+    AppMQTTc_BenchBrokerFloodPayloadLen =  payload_len;
+    AppMQTTc_BenchBrokerFloodMsgNbr     =  msg_nbr;
+    AppMQTTc_BenchBrokerFloodReq        =  DEF_YES;
+    CPU_CRITICAL_EXIT();
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchBrokerTask()
+*
+* Description : Task of the loopback broker stub. Accept conns, process the pkts rx'd and tx floods.
+*
+* Arguments   : p_arg           Unused.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : KAL.
+*
+* Note(s)     : (1) The sock sel does not block while a flood is being tx'd.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerTask (void  *p_arg)
+{
+    APP_MQTTc_BENCH_BROKER_CONN  *p_conn;
+    NET_SOCK_TIMEOUT              timeout;
+    CPU_BOOLEAN                   flood_in_progress;
+    CPU_BOOLEAN                   is_set;
+    CPU_INT08U                    ix;
+    NET_SOCK_RTN_CODE             ret_val;
+    NET_ERR                       err_net;
+
+
+    (void)&p_arg;
+
+    flood_in_progress = DEF_NO;
+    while (DEF_ON) {
+        if (AppMQTTc_BenchBrokerFloodReq == DEF_YES) {
+            AppMQTTc_BenchBrokerFloodStart();
+        }
+        if (flood_in_progress == DEF_YES) {
+            flood_in_progress = AppMQTTc_BenchBrokerFloodTx();
+        }
+
+        NET_SOCK_DESC_INIT(&AppMQTTc_BenchBrokerSockDescRd);
+        NET_SOCK_DESC_SET(AppMQTTc_BenchBrokerListenSockId, &AppMQTTc_BenchBrokerSockDescRd);
+        for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+            p_conn = &AppMQTTc_BenchBrokerConnTbl[ix];
+            if (p_conn->SockId != NET_SOCK_ID_NONE) {
+                NET_SOCK_DESC_SET(p_conn->SockId, &AppMQTTc_BenchBrokerSockDescRd);
+                if (p_conn->FloodRemNbr > 0u) {
+                    flood_in_progress = DEF_YES;
+                }
+            }
+        }
+
+        timeout.timeout_sec = 0;                                /* See Note #1.                                         */
+        timeout.timeout_us  = (flood_in_progress == DEF_YES) ? 0 : APP_MQTTc_BENCH_BROKER_SEL_TIMEOUT_US;
+
+        ret_val = NetSock_Sel(NET_SOCK_NBR_SOCK,
+                             &AppMQTTc_BenchBrokerSockDescRd,
+                              DEF_NULL,
+                              DEF_NULL,
+                             &timeout,
+                             &err_net);
+        if ((err_net != NET_SOCK_ERR_NONE) ||
+            (ret_val <= 0)) {
+            continue;
+        }
+
+        is_set = NET_SOCK_DESC_IS_SET(AppMQTTc_BenchBrokerListenSockId, &AppMQTTc_BenchBrokerSockDescRd);
+        if (is_set == DEF_YES) {
+            AppMQTTc_BenchBrokerAccept();
+        }
+
+        for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+            p_conn = &AppMQTTc_BenchBrokerConnTbl[ix];
+            if (p_conn->SockId == NET_SOCK_ID_NONE) {
+                continue;
+            }
+            is_set = NET_SOCK_DESC_IS_SET(p_conn->SockId, &AppMQTTc_BenchBrokerSockDescRd);
+            if (is_set == DEF_YES) {
+                AppMQTTc_BenchBrokerRx(p_conn);
+            }
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_BenchBrokerAccept()
+*
+* Description : Accept a conn on the listen sock and assign it a free slot.
+*
+* Arguments   : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerTask().
+*
+* Note(s)     : (1) The conn is closed right away if no slot is free.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerAccept (void)
+{
+    APP_MQTTc_BENCH_BROKER_CONN  *p_conn;
+    NET_SOCK_ADDR                 addr;
+    NET_SOCK_ADDR_LEN             addr_len;
+    NET_SOCK_ID                   sock_id;
+    CPU_INT08U                    ix;
+    NET_ERR                       err_net;
+
+
+    addr_len = sizeof(addr);
+    sock_id  = NetSock_Accept(AppMQTTc_BenchBrokerListenSockId,
+                             &addr,
+                             &addr_len,
+                             &err_net);
+    if (err_net != NET_SOCK_ERR_NONE) {
+        return;
+    }
+
+    for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+        p_conn = &AppMQTTc_BenchBrokerConnTbl[ix];
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+            Mem_Clr(p_conn, sizeof(APP_MQTTc_BENCH_BROKER_CONN));
+            p_conn->SockId     = sock_id;
+            p_conn->MsgID_Next = 1u;
+            return;
+        }
+    }
+
+                                                                /* See Note #1.                                         */
+    printf("Bench broker: no free conn slot, closing conn.\n\r");
+    NetSock_Close(sock_id, &err_net);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    AppMQTTc_BenchBrokerConnClose()
+*
+* Description : Close a conn and free its slot.
+*
+* Arguments   : p_conn          Pointer to conn to close.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerConnClose (APP_MQTTc_BENCH_BROKER_CONN  *p_conn)
+{
+    NET_ERR  err_net;
+
+
+    NetSock_Close(p_conn->SockId, &err_net);
+    (void)&err_net;
+
+    p_conn->SockId      = NET_SOCK_ID_NONE;
+    p_conn->FloodRemNbr = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_BenchBrokerRx()
+*
+* Description : Rx on a conn and process every complete pkt rx'd.
+*
+* Arguments   : p_conn          Pointer to conn on which to rx.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerTask().
+*
+* Note(s)     : (1) A pkt larger than the rx buf closes the conn.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerRx (APP_MQTTc_BENCH_BROKER_CONN  *p_conn)
+{
+    NET_SOCK_RTN_CODE  ret_val;
+    CPU_INT32U         rem_len;
+    CPU_INT32U         mult;
+    CPU_INT32U         pkt_len;
+    CPU_INT32U         ix;
+    CPU_INT08U         byte;
+    NET_ERR            err_net;
+
+
+    ret_val = NetSock_RxData(        p_conn->SockId,
+                             (void *)&p_conn->RxBuf[p_conn->RxLen],
+                                     (APP_MQTTc_BENCH_BROKER_RX_BUF_LEN - p_conn->RxLen),
+                                     NET_SOCK_FLAG_NONE,
+                                    &err_net);
+    if ((err_net != NET_SOCK_ERR_NONE) ||
+        (ret_val <= 0)) {                                       /* Conn closed by peer or failed.                       */
+        AppMQTTc_BenchBrokerConnClose(p_conn);
+        return;
+    }
+    p_conn->RxLen += (CPU_INT32U)ret_val;
+
+    while (p_conn->RxLen >= MQTT_MSG_PING_DISCONN_LEN) {
+        rem_len = 0u;                                           /* Decode rem len of fixed hdr.                         */
+        mult    = 1u;
+        ix      = 1u;
+        do {
+            if (ix >= p_conn->RxLen) {
+                return;                                         /* Fixed hdr not rx'd completely.                       */
+            }
+            if (ix > MQTT_MSG_FIXED_HDR_REM_LEN_NBR_BYTES_MAX) {
+                AppMQTTc_BenchBrokerConnClose(p_conn);
+                return;
+            }
+            byte     = p_conn->RxBuf[ix];
+            rem_len += (byte & MQTT_MSG_FIXED_HDR_REM_LEN_MSK) * mult;
+            mult    *= MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN;
+            ix++;
+        } while (DEF_BIT_IS_SET(byte, MQTT_MSG_FIXED_HDR_REM_LEN_CONTINUATION_BIT) == DEF_YES);
+
+        pkt_len = ix + rem_len;
+        if (pkt_len > APP_MQTTc_BENCH_BROKER_RX_BUF_LEN) {      /* See Note #1.                                         */
+            AppMQTTc_BenchBrokerConnClose(p_conn);
+            return;
+        }
+        if (pkt_len > p_conn->RxLen) {
+            return;                                             /* Pkt not rx'd completely.                             */
+        }
+
+        AppMQTTc_BenchBrokerPktProcess(p_conn, p_conn->RxBuf[0u], &p_conn->RxBuf[ix], rem_len);
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+            return;
+        }
+
+        p_conn->RxLen -= pkt_len;
+        Mem_Move(&p_conn->RxBuf[0u], &p_conn->RxBuf[pkt_len], p_conn->RxLen);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                   AppMQTTc_BenchBrokerPktProcess()
+*
+* Description : Process a pkt rx'd on a conn and tx the reply, if any.
+*
+* Arguments   : p_conn          Pointer to conn on which pkt was rx'd.
+*
+*               hdr             First byte of fixed hdr of pkt.
+*
+*               p_buf           Pointer to var hdr of pkt.
+*
+*               len             Len of pkt, after fixed hdr.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerRx().
+*
+* Note(s)     : (1) The CONNECT msg is always accepted, whatever its content.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerPktProcess (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                              CPU_INT08U                    hdr,
+                                              CPU_INT08U                   *p_buf,
+                                              CPU_INT32U                    len)
+{
+    CPU_INT08U   buf[MQTT_MSG_BASE_LEN];
+    CPU_INT08U   qos_lvl;
+    CPU_INT16U   topic_len;
+    CPU_INT16U   msg_id;
+    CPU_INT32U   var_hdr_len;
+
+
+    msg_id = MQTT_MSG_ID_NONE;
+    if (len >= MQTT_MSG_ID_SIZE) {
+        msg_id = (CPU_INT16U)MQTT_MSG_UTF8_LEN_RD(p_buf);
+    }
+
+    switch (hdr & MQTT_MSG_TYPE_MSK) {
+        case MQTT_MSG_TYPE_CONNECT:                             /* See Note #1.                                         */
+             buf[0u] = MQTT_MSG_TYPE_CONNACK;
+             buf[1u] = 2u;
+             buf[2u] = 0u;
+             buf[3u] = MQTT_MSG_VAR_HDR_CONNACK_RET_CODE_ACCEPTED;
+             AppMQTTc_BenchBrokerTx(p_conn, buf, MQTT_MSG_BASE_LEN);
+             break;
+
+
+        case MQTT_MSG_TYPE_PUBLISH:
+             if (len < MQTT_MSG_UTF8_LEN_SIZE) {
+                 AppMQTTc_BenchBrokerConnClose(p_conn);
+                 break;
+             }
+             qos_lvl     = (hdr & MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_MSK) >> MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT;
+             topic_len   = (CPU_INT16U)MQTT_MSG_UTF8_LEN_RD(p_buf);
+             var_hdr_len =  MQTT_MSG_UTF8_LEN_SIZE + topic_len + ((qos_lvl > 0u) ? MQTT_MSG_ID_SIZE : 0u);
+             if (var_hdr_len > len) {
+                 AppMQTTc_BenchBrokerConnClose(p_conn);
+                 break;
+             }
+
+             if (qos_lvl == 1u) {
+                 msg_id = (CPU_INT16U)MQTT_MSG_UTF8_LEN_RD(&p_buf[MQTT_MSG_UTF8_LEN_SIZE + topic_len]);
+                 AppMQTTc_BenchBrokerAckTx(p_conn, MQTT_MSG_TYPE_PUBACK, msg_id);
+             } else if (qos_lvl == 2u) {
+                 msg_id = (CPU_INT16U)MQTT_MSG_UTF8_LEN_RD(&p_buf[MQTT_MSG_UTF8_LEN_SIZE + topic_len]);
+                 AppMQTTc_BenchBrokerAckTx(p_conn, MQTT_MSG_TYPE_PUBREC, msg_id);
+             }
+
+             AppMQTTc_BenchBrokerRoute((CPU_CHAR *)&p_buf[MQTT_MSG_UTF8_LEN_SIZE],
+                                                    topic_len,
+                                                    qos_lvl,
+                                                   &p_buf[var_hdr_len],
+                                                   (len - var_hdr_len));
+             break;
+
+
+        case MQTT_MSG_TYPE_PUBACK:
+        case MQTT_MSG_TYPE_PUBCOMP:
+             if (p_conn->InFlightNbr > 0u) {
+                 p_conn->InFlightNbr--;
+             }
+             break;
+
+
+        case MQTT_MSG_TYPE_PUBREC:                              /* Flags of PUBREL are reserved, set to 0010b.          */
+             AppMQTTc_BenchBrokerAckTx(p_conn, (MQTT_MSG_TYPE_PUBREL | MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_1), msg_id);
+             break;
+
+
+        case MQTT_MSG_TYPE_PUBREL:
+             AppMQTTc_BenchBrokerAckTx(p_conn, MQTT_MSG_TYPE_PUBCOMP, msg_id);
+             break;
+
+
+        case MQTT_MSG_TYPE_SUBSCRIBE:
+             AppMQTTc_BenchBrokerSubscribe(p_conn, p_buf, len);
+             break;
+
+
+        case MQTT_MSG_TYPE_UNSUBSCRIBE:
+             p_conn->SubTopicLen = 0u;
+             AppMQTTc_BenchBrokerAckTx(p_conn, MQTT_MSG_TYPE_UNSUBACK, msg_id);
+             break;
+
+
+        case MQTT_MSG_TYPE_PINGREQ:
+             buf[0u] = MQTT_MSG_TYPE_PINGRESP;
+             buf[1u] = 0u;
+             AppMQTTc_BenchBrokerTx(p_conn, buf, MQTT_MSG_PING_DISCONN_LEN);
+             break;
+
+
+        case MQTT_MSG_TYPE_DISCONNECT:
+        default:
+             AppMQTTc_BenchBrokerConnClose(p_conn);
+             break;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                    AppMQTTc_BenchBrokerSubscribe()
+*
+* Description : Process a SUBSCRIBE pkt and tx the SUBACK.
+*
+* Arguments   : p_conn          Pointer to conn on which pkt was rx'd.
+*
+*               p_buf           Pointer to var hdr of pkt.
+*
+*               len             Len of pkt, after fixed hdr.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerPktProcess().
+*
+* Note(s)     : (1) Every topic filter is granted the QoS level req'd, but only the first one is kept. See
+*                   'app_mqtt-c_bench_broker.c  Note #2a'.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerSubscribe (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                             CPU_INT08U                   *p_buf,
+                                             CPU_INT32U                    len)
+{
+    CPU_INT08U  *p_tx_buf;
+    CPU_INT32U   ix;
+    CPU_INT32U   topic_nbr;
+    CPU_INT16U   topic_len;
+    CPU_INT08U   qos_lvl;
+
+
+    p_tx_buf  = &AppMQTTc_BenchBrokerTxBuf[0u];
+    topic_nbr =  0u;
+    ix        =  MQTT_MSG_ID_SIZE;
+    while ((ix + MQTT_MSG_UTF8_LEN_SIZE) < len) {
+        topic_len = (CPU_INT16U)MQTT_MSG_UTF8_LEN_RD(&p_buf[ix]);
+        if ((ix + MQTT_MSG_UTF8_LEN_SIZE + topic_len) >= len) {
+            break;
+        }
+        qos_lvl = DEF_MIN(p_buf[ix + MQTT_MSG_UTF8_LEN_SIZE + topic_len], MQTT_MSG_QOS_LVL_MAX);
+
+        if ((topic_nbr == 0u) &&                                /* See Note #1.                                         */
+            (topic_len <= APP_MQTTc_BENCH_BROKER_TOPIC_LEN_MAX)) {
+            Mem_Copy(p_conn->SubTopicStr, &p_buf[ix + MQTT_MSG_UTF8_LEN_SIZE], topic_len);
+            p_conn->SubTopicLen = topic_len;
+            p_conn->SubQoS      = qos_lvl;
+        }
+
+        p_tx_buf[MQTT_MSG_BASE_LEN + topic_nbr] = qos_lvl;
+        topic_nbr++;
+        ix += MQTT_MSG_UTF8_LEN_SIZE + topic_len + 1u;
+    }
+
+    p_tx_buf[0u] =  MQTT_MSG_TYPE_SUBACK;
+    p_tx_buf[1u] = (CPU_INT08U)(MQTT_MSG_ID_SIZE + topic_nbr);
+    p_tx_buf[2u] =  p_buf[0u];
+    p_tx_buf[3u] =  p_buf[1u];
+
+    AppMQTTc_BenchBrokerTx(p_conn, p_tx_buf, (MQTT_MSG_BASE_LEN + topic_nbr));
+}
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchBrokerRoute()
+*
+* Description : Tx a PUBLISH msg rx'd to every conn subscribed to its topic.
+*
+* Arguments   : p_topic         Pointer to topic of msg, NOT NULL-terminated.
+*
+*               topic_len       Len of topic.
+*
+*               qos_lvl         QoS level of msg. Lowered to the QoS level granted to each conn.
+*
+*               p_payload       Pointer to payload of msg.
+*
+*               payload_len     Len of payload.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerPktProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerRoute (const  CPU_CHAR    *p_topic,
+                                                CPU_INT16U   topic_len,
+                                                CPU_INT08U   qos_lvl,
+                                         const  CPU_INT08U  *p_payload,
+                                                CPU_INT32U   payload_len)
+{
+    APP_MQTTc_BENCH_BROKER_CONN  *p_conn;
+    CPU_BOOLEAN                   is_match;
+    CPU_INT08U                    ix;
+
+
+    for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+        p_conn = &AppMQTTc_BenchBrokerConnTbl[ix];
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+            continue;
+        }
+        is_match = AppMQTTc_BenchBrokerTopicMatch(p_conn, p_topic, topic_len);
+        if (is_match == DEF_YES) {
+            AppMQTTc_BenchBrokerPublishTx(p_conn,
+                                          p_topic,
+                                          topic_len,
+                                          DEF_MIN(qos_lvl, p_conn->SubQoS),
+                                          p_payload,
+                                          payload_len);
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                   AppMQTTc_BenchBrokerFloodStart()
+*
+* Description : Start the flood req'd by AppMQTTc_BenchBrokerFlood() on every conn subscribed to its topic.
+*
+* Arguments   : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerTask().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerFloodStart (void)
+{
+    APP_MQTTc_BENCH_BROKER_CONN  *p_conn;
+    CPU_BOOLEAN                   is_match;
+    CPU_INT08U                    ix;
+
+
+    for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+        p_conn = &AppMQTTc_BenchBrokerConnTbl[ix];
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+            continue;
+        }
+        is_match = AppMQTTc_BenchBrokerTopicMatch(p_conn,
+                                                  AppMQTTc_BenchBrokerFloodTopicStr,
+                                                  AppMQTTc_BenchBrokerFloodTopicLen);
+        if (is_match == DEF_YES) {
+            p_conn->FloodRemNbr = AppMQTTc_BenchBrokerFloodMsgNbr;
+        }
+    }
+
+    AppMQTTc_BenchBrokerFloodReq = DEF_NO;
+}
+
+
+/*
+*********************************************************************************************************
+*                                    AppMQTTc_BenchBrokerFloodTx()
+*
+* Description : Tx the next burst of flood msgs on every conn that has some left.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_YES, if flood msgs are left to tx,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerTask().
+*
+* Note(s)     : (1) See AppMQTTc_BenchBrokerFlood() Note #2.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_BenchBrokerFloodTx (void)
+{
+    APP_MQTTc_BENCH_BROKER_CONN  *p_conn;
+    CPU_BOOLEAN                   flood_in_progress;
+    CPU_INT08U                    qos_lvl;
+    CPU_INT08U                    ix;
+    CPU_INT32U                    burst_nbr;
+
+
+    flood_in_progress = DEF_NO;
+    for (ix = 0u; ix < APP_MQTTc_BENCH_BROKER_CONN_NBR_MAX; ix++) {
+        p_conn = &AppMQTTc_BenchBrokerConnTbl[ix];
+        if ((p_conn->SockId      == NET_SOCK_ID_NONE) ||
+            (p_conn->FloodRemNbr == 0u)) {
+            continue;
+        }
+
+        qos_lvl   = DEF_MIN(AppMQTTc_BenchBrokerFloodQoS, p_conn->SubQoS);
+        burst_nbr = 0u;
+        while ((p_conn->FloodRemNbr >  0u) &&
+               (burst_nbr           <  APP_MQTTc_BENCH_BROKER_FLOOD_BURST)) {
+            if ((qos_lvl             >  0u) &&                  /* See Note #1.                                         */
+                (p_conn->InFlightNbr >= APP_MQTTc_BENCH_BROKER_FLOOD_WIN_SIZE)) {
+                break;
+            }
+            AppMQTTc_BenchBrokerPublishTx(                p_conn,
+                                                          AppMQTTc_BenchBrokerFloodTopicStr,
+                                                          AppMQTTc_BenchBrokerFloodTopicLen,
+                                                          qos_lvl,
+                                          (CPU_INT08U *)&AppMQTTc_BenchBrokerFloodPayload[0u],
+                                                          AppMQTTc_BenchBrokerFloodPayloadLen);
+            if (p_conn->SockId == NET_SOCK_ID_NONE) {
+                break;
+            }
+            p_conn->FloodRemNbr--;
+            burst_nbr++;
+        }
+
+        if (p_conn->FloodRemNbr > 0u) {
+            flood_in_progress = DEF_YES;
+        }
+    }
+
+    return (flood_in_progress);
+}
+
+
+/*
+*********************************************************************************************************
+*                                   AppMQTTc_BenchBrokerTopicMatch()
+*
+* Description : Check if a topic matches the topic filter of a conn.
+*
+* Arguments   : p_conn          Pointer to conn.
+*
+*               p_topic         Pointer to topic, NOT NULL-terminated.
+*
+*               topic_len       Len of topic.
+*
+* Return(s)   : DEF_YES, if topic matches,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerRoute(),
+*               AppMQTTc_BenchBrokerFloodStart().
+*
+* Note(s)     : (1) See 'app_mqtt-c_bench_broker.c  Note #2a'.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_BenchBrokerTopicMatch (       APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                                     const  CPU_CHAR                     *p_topic,
+                                                            CPU_INT16U                    topic_len)
+{
+    CPU_INT16U  cmp_len;
+
+
+    if (p_conn->SubTopicLen == 0u) {
+        return (DEF_NO);
+    }
+
+    cmp_len = p_conn->SubTopicLen;
+    if (p_conn->SubTopicStr[cmp_len - 1u] == '#') {
+        cmp_len--;
+        if (topic_len < cmp_len) {
+            return (DEF_NO);
+        }
+    } else if (topic_len != cmp_len) {
+        return (DEF_NO);
+    }
+
+    return (Mem_Cmp(p_conn->SubTopicStr, p_topic, cmp_len));
+}
+
+
+/*
+*********************************************************************************************************
+*                                    AppMQTTc_BenchBrokerPublishTx()
+*
+* Description : Encode and tx a PUBLISH msg on a conn.
+*
+* Arguments   : p_conn          Pointer to conn on which to tx.
+*
+*               p_topic         Pointer to topic of msg, NOT NULL-terminated.
+*
+*               topic_len       Len of topic.
+*
+*               qos_lvl         QoS level of msg.
+*
+*               p_payload       Pointer to payload of msg.
+*
+*               payload_len     Len of payload.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerRoute(),
+*               AppMQTTc_BenchBrokerFloodTx().
+*
+* Note(s)     : (1) Msgs that do not fit in the tx buf are dropped.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerPublishTx (       APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                             const  CPU_CHAR                     *p_topic,
+                                                    CPU_INT16U                    topic_len,
+                                                    CPU_INT08U                    qos_lvl,
+                                             const  CPU_INT08U                   *p_payload,
+                                                    CPU_INT32U                    payload_len)
+{
+    CPU_INT08U  *p_buf;
+    CPU_INT32U   rem_len;
+    CPU_INT32U   ix;
+
+
+    rem_len = MQTT_MSG_UTF8_LEN_SIZE + topic_len + ((qos_lvl > 0u) ? MQTT_MSG_ID_SIZE : 0u) + payload_len;
+    if ((rem_len + MQTT_MSG_FIXED_HDR_MAX_LEN_BYTES) > APP_MQTTc_BENCH_BROKER_TX_BUF_LEN) {
+        return;                                                 /* See Note #1.                                         */
+    }
+
+    p_buf    = &AppMQTTc_BenchBrokerTxBuf[0u];
+    p_buf[0] =  MQTT_MSG_TYPE_PUBLISH | (qos_lvl << MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT);
+    ix       =  1u;
+    do {                                                        /* Encode rem len of fixed hdr.                         */
+        p_buf[ix] = (CPU_INT08U)(rem_len % MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN);
+        rem_len  /=  MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN;
+        if (rem_len > 0u) {
+            p_buf[ix] |= MQTT_MSG_FIXED_HDR_REM_LEN_CONTINUATION_BIT;
+        }
+        ix++;
+    } while (rem_len > 0u);
+
+    p_buf[ix++] = (CPU_INT08U)(topic_len >> 8u);
+    p_buf[ix++] = (CPU_INT08U)(topic_len &  DEF_INT_08_MASK);
+    Mem_Copy(&p_buf[ix], p_topic, topic_len);
+    ix += topic_len;
+
+    if (qos_lvl > 0u) {
+        p_buf[ix++] = (CPU_INT08U)(p_conn->MsgID_Next >> 8u);
+        p_buf[ix++] = (CPU_INT08U)(p_conn->MsgID_Next &  DEF_INT_08_MASK);
+        p_conn->MsgID_Next++;
+        if (p_conn->MsgID_Next == MQTT_MSG_ID_NONE) {
+            p_conn->MsgID_Next = 1u;
+        }
+        p_conn->InFlightNbr++;
+    }
+
+    Mem_Copy(&p_buf[ix], p_payload, payload_len);
+    ix += payload_len;
+
+    AppMQTTc_BenchBrokerTx(p_conn, p_buf, ix);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchBrokerAckTx()
+*
+* Description : Tx an ack pkt, made of a fixed hdr and a msg ID, on a conn.
+*
+* Arguments   : p_conn          Pointer to conn on which to tx.
+*
+*               hdr             First byte of fixed hdr of pkt.
+*
+*               msg_id          Msg ID to ack.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchBrokerPktProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerAckTx (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                         CPU_INT08U                    hdr,
+                                         CPU_INT16U                    msg_id)
+{
+    CPU_INT08U  buf[MQTT_MSG_BASE_LEN];
+
+
+    buf[0u] =  hdr;
+    buf[1u] =  MQTT_MSG_ID_SIZE;
+    buf[2u] = (CPU_INT08U)(msg_id >> 8u);
+    buf[3u] = (CPU_INT08U)(msg_id &  DEF_INT_08_MASK);
+
+    AppMQTTc_BenchBrokerTx(p_conn, buf, MQTT_MSG_BASE_LEN);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_BenchBrokerTx()
+*
+* Description : Tx a buf on a conn, blocking until every byte is tx'd.
+*
+* Arguments   : p_conn          Pointer to conn on which to tx.
+*
+*               p_buf           Pointer to buf to tx.
+*
+*               len             Len of buf.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : various.
+*
+* Note(s)     : (1) The conn is closed on a tx err.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchBrokerTx (APP_MQTTc_BENCH_BROKER_CONN  *p_conn,
+                                      CPU_INT08U                   *p_buf,
+                                      CPU_INT32U                    len)
+{
+    NET_SOCK_RTN_CODE  ret_val;
+    CPU_INT32U         tx_len;
+    NET_ERR            err_net;
+
+
+    tx_len = 0u;
+    while (tx_len < len) {
+        ret_val = NetSock_TxData(        p_conn->SockId,
+                                 (void *)&p_buf[tx_len],
+                                         (len - tx_len),
+                                         NET_SOCK_FLAG_NONE,
+                                        &err_net);
+        if ((err_net != NET_SOCK_ERR_NONE) ||                   /* See Note #1.                                         */
+            (ret_val <= 0)) {
+            AppMQTTc_BenchBrokerConnClose(p_conn);
+            return;
+        }
+        tx_len += (CPU_INT32U)ret_val;
+    }
+}
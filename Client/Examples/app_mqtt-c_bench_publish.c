@@ -0,0 +1,445 @@
+/*
+*********************************************************************************************************
+*                                            EXAMPLE CODE
+*
+*               This file is provided as an example on how to use Micrium products.
+*
+*               Please feel free to use any application code labeled as 'EXAMPLE CODE' in
+*               your application products.  Example code may be used as is, in whole or in
+*               part, or may be used as a reference only. This file can be modified as
+*               required to meet the end-product requirements.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          MQTTc APPLICATION
+*
+* Filename : app_mqtt-c_bench_publish.c
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    APP_MQTTc_MODULE
+
+#include  <cpu.h>
+#include  <lib_def.h>
+
+#include  "app_mqtt-c.h"
+
+#include  <Source/dns-c.h>
+
+#include  <Source/net.h>
+#include  <Source/net_sock.h>
+#include  <Source/net_util.h>
+#include  <Source/net_ascii.h>
+
+#include  <Source/os.h>
+
+#include  <dns-c_cfg.h>
+
+#include  <stdio.h>
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  APP_MQTTc_MSG_QTY                         1u
+
+#define  APP_MQTTc_MSG_LEN_MAX                   128u
+
+                                                                /* Domain to which to publish.                          */
+#define  APP_MQTTc_DOMAIN_PUBLISH                   "domain/bench/publish_topic"
+
+#define  APP_MQTTc_PUBLISH_TEST_MSG                 "bench publish"
+#define  APP_MQTTc_PUBLISH_TEST_QoS                1u
+
+                                                                /* Nbr of publish per bench phase.                      */
+#define  APP_MQTTc_BENCH_PUBLISH_NBR             1000u
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  enum  app_mqttc_bench_phase {
+    APP_MQTTc_BENCH_PHASE_PUBLISH,                              /* Publish using MQTTc_Publish().                       */
+    APP_MQTTc_BENCH_PHASE_TEMPLATE,                             /* Publish using MQTTc_PublishByTemplate().             */
+    APP_MQTTc_BENCH_PHASE_DONE
+} APP_MQTTc_BENCH_PHASE;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U              AppMQTTc_TaskStk[APP_MQTTc_TASK_STK_SIZE];
+
+static  MQTTc_CONN              AppMQTTc_Conn;
+
+static  MQTTc_MSG               AppMQTTc_Msg;
+static  CPU_INT08U              AppMQTTc_MsgBuf[APP_MQTTc_MSG_LEN_MAX];
+
+static  MQTTc_PUBLISH_TEMPLATE  AppMQTTc_PublishTemplate;
+
+static  APP_MQTTc_BENCH_PHASE   AppMQTTc_BenchPhase;
+static  CPU_INT32U              AppMQTTc_BenchCnt;
+static  CPU_TS32                AppMQTTc_BenchTimeTot;          /* Tot time spent in publish calls for cur phase.       */
+
+const  NET_TASK_CFG  AppMQTTc_TaskCfg = {                       /* Cfg for MQTTc internal task.                         */
+    APP_MQTTc_TASK_PRIO,                                        /* MQTTc internal task prio.                            */
+    APP_MQTTc_TASK_STK_SIZE,                                    /* MQTTc internal task stack size.                      */
+    AppMQTTc_TaskStk                                            /* Ptr to start of MQTTc internal stack.                */
+};
+
+
+const  MQTTc_CFG     AppMQTTc_Cfg = {
+    APP_MQTTc_MSG_QTY,
+    APP_MQTTc_INACTIVITY_TIMEOUT_s,
+    APP_MQTTc_INTERNAL_TASK_DLY
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchPublish             (MQTTc_CONN  *p_conn,
+                                                 MQTTc_MSG   *p_msg);
+
+static  void  AppMQTTc_OnConnectCmplCallbackFnct(MQTTc_CONN  *p_conn,
+                                                 MQTTc_MSG   *p_msg,
+                                                 void        *p_arg,
+                                                 MQTTc_ERR    err);
+
+static  void  AppMQTTc_OnPublishCmplCallbackFnct(MQTTc_CONN  *p_conn,
+                                                 MQTTc_MSG   *p_msg,
+                                                 void        *p_arg,
+                                                 MQTTc_ERR    err);
+
+static  void  AppMQTTc_OnErrCallbackFnct        (MQTTc_CONN  *p_conn,
+                                                 void        *p_arg,
+                                                 MQTTc_ERR    err);
+
+
+/*
+*********************************************************************************************************
+*                                            AppMQTTc_Init()
+*
+* Description : Initialize the application MQTT-client module and start the publish benchmark.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The benchmark compares the time spent in MQTTc_Publish() with the time spent in
+*                   MQTTc_PublishByTemplate() for the same topic and payload. Only the time spent in the
+*                   call itself (validation, encoding and posting) is measured, not the round-trip to the
+*                   server.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_Init (void)
+{
+    MQTTc_ERR  err_mqttc;
+
+
+    MQTTc_Init(&AppMQTTc_Cfg,
+               &AppMQTTc_TaskCfg,
+                DEF_NULL,
+               &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to init MQTTc module. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_PublishTemplateCreate(&AppMQTTc_PublishTemplate,      /* Tmpl only needs to be created once.                  */
+                                 APP_MQTTc_DOMAIN_PUBLISH,
+                                 APP_MQTTc_PUBLISH_TEST_QoS,
+                                 DEF_NO,
+                                &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to create publish template. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgClr(&AppMQTTc_Msg, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to clr msg object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgSetParam(&AppMQTTc_Msg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_MsgBuf[0u], &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to set buf ptr param. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgSetParam(&AppMQTTc_Msg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *)APP_MQTTc_MSG_LEN_MAX, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to set buf len param. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_ConnClr(&AppMQTTc_Conn,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to clr MQTTc connection object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+                                                                /* Err handling should be done in your application.     */
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_BROKER_NAME,              (void *) APP_MQTTc_BROKER_NAME,              &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CLIENT_ID_STR,            (void *) APP_MQTTc_CLIENT_ID_NAME,           &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_USERNAME_STR,             (void *) APP_MQTTc_USERNAME,                 &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_KEEP_ALIVE_TMR_SEC,       (void *) 1000u,                              &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_CONNECT_CMPL, (void *) AppMQTTc_OnConnectCmplCallbackFnct, &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_CMPL, (void *) AppMQTTc_OnPublishCmplCallbackFnct, &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_ERR_CALLBACK, (void *) AppMQTTc_OnErrCallbackFnct,         &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_TIMEOUT_MS,               (void *) 30000u,                             &err_mqttc);
+
+    MQTTc_ConnOpen(&AppMQTTc_Conn,                              /* Open conn to MQTT server with parameters set in Conn.*/
+                    MQTTc_FLAGS_NONE,
+                   &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to open TCP connection to MQTT server. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);                                      /* Failed to open TCP connection to MQTT server.        */
+    }
+
+    MQTTc_Connect(&AppMQTTc_Conn,                               /* Send CONNECT msg to MQTT server.                     */
+                  &AppMQTTc_Msg,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to process Connect msg req. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);                                      /* Failed to process MQTT CONNECT msg.                  */
+    }
+
+    printf("Initialization and CONNECT to server successful.\r\n");
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        AppMQTTc_BenchPublish()
+*
+* Description : Publish the benchmark message, using the API of the current phase, and accumulate the
+*               time spent in the call.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_OnConnectCmplCallbackFnct(),
+*               AppMQTTc_OnPublishCmplCallbackFnct().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchPublish (MQTTc_CONN  *p_conn,
+                                     MQTTc_MSG   *p_msg)
+{
+    CPU_TS32   ts_start;
+    CPU_TS32   ts_end;
+    MQTTc_ERR  err_mqttc;
+
+
+    if (AppMQTTc_BenchCnt >= APP_MQTTc_BENCH_PUBLISH_NBR) {     /* End of cur phase: display results.                   */
+        printf("%s: %u publish in %u us (%u ns/publish).\n\r",
+               (AppMQTTc_BenchPhase == APP_MQTTc_BENCH_PHASE_PUBLISH) ? "MQTTc_Publish()" : "MQTTc_PublishByTemplate()",
+               (unsigned int)AppMQTTc_BenchCnt,
+               (unsigned int)CPU_TS32_to_uSec(AppMQTTc_BenchTimeTot),
+               (unsigned int)((CPU_TS32_to_uSec(AppMQTTc_BenchTimeTot) * 1000u) / AppMQTTc_BenchCnt));
+
+        AppMQTTc_BenchCnt     = 0u;
+        AppMQTTc_BenchTimeTot = 0u;
+        AppMQTTc_BenchPhase++;
+    }
+
+    ts_start = CPU_TS_Get32();
+    switch (AppMQTTc_BenchPhase) {
+        case APP_MQTTc_BENCH_PHASE_PUBLISH:
+             MQTTc_Publish(p_conn,
+                           p_msg,
+                           APP_MQTTc_DOMAIN_PUBLISH,
+                           APP_MQTTc_PUBLISH_TEST_QoS,
+                           DEF_NO,
+                           APP_MQTTc_PUBLISH_TEST_MSG,
+                           sizeof(APP_MQTTc_PUBLISH_TEST_MSG) - 1u,
+                          &err_mqttc);
+             break;
+
+
+        case APP_MQTTc_BENCH_PHASE_TEMPLATE:
+             MQTTc_PublishByTemplate(p_conn,
+                                     p_msg,
+                                    &AppMQTTc_PublishTemplate,
+                                     APP_MQTTc_PUBLISH_TEST_MSG,
+                                     sizeof(APP_MQTTc_PUBLISH_TEST_MSG) - 1u,
+                                    &err_mqttc);
+             break;
+
+
+        case APP_MQTTc_BENCH_PHASE_DONE:
+        default:
+             printf("Publish benchmark completed.\n\r");
+             return;
+    }
+    ts_end = CPU_TS_Get32();
+
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to Publish bench msg. Err: %i\n\r.", err_mqttc);
+        return;
+    }
+
+    AppMQTTc_BenchTimeTot += (ts_end - ts_start);
+    AppMQTTc_BenchCnt++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                 AppMQTTc_OnConnectCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a CONNECT operation has completed.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing CONNECT message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnConnectCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                                  MQTTc_MSG   *p_msg,
+                                                  void        *p_arg,
+                                                  MQTTc_ERR    err)
+{
+    (void)&p_arg;
+
+    if (err != MQTTc_ERR_NONE) {
+        printf("ConnectCmpl callback called with err (%i). NOT starting benchmark.\n\r", err);
+    } else {
+        printf("ConnectCmpl callback called. Starting publish benchmark.\n\r");
+
+        AppMQTTc_BenchPhase   = APP_MQTTc_BENCH_PHASE_PUBLISH;
+        AppMQTTc_BenchCnt     = 0u;
+        AppMQTTc_BenchTimeTot = 0u;
+
+        AppMQTTc_BenchPublish(p_conn, p_msg);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                 AppMQTTc_OnPublishCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a PUBLISH operation has completed.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing PUBLISH message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnPublishCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                                  MQTTc_MSG   *p_msg,
+                                                  void        *p_arg,
+                                                  MQTTc_ERR    err)
+{
+    (void)&p_arg;
+
+    if (err != MQTTc_ERR_NONE) {
+        printf("PublishCmpl callback called with error (%i). Stopping benchmark.\n\r", err);
+    } else {
+        AppMQTTc_BenchPublish(p_conn, p_msg);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_OnErrCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when an error occurs.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object on which error occurred.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnErrCallbackFnct (MQTTc_CONN  *p_conn,
+                                          void        *p_arg,
+                                          MQTTc_ERR    err)
+{
+    (void)&p_conn;
+    (void)&p_arg;
+
+    printf("!!! APP ERROR !!! Err detected via OnErr callback. Err = %i.\n\r", err);
+}
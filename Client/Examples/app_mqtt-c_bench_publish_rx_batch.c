@@ -0,0 +1,559 @@
+/*
+*********************************************************************************************************
+*                                            EXAMPLE CODE
+*
+*               This file is provided as an example on how to use Micrium products.
+*
+*               Please feel free to use any application code labeled as 'EXAMPLE CODE' in
+*               your application products.  Example code may be used as is, in whole or in
+*               part, or may be used as a reference only. This file can be modified as
+*               required to meet the end-product requirements.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          MQTTc APPLICATION
+*
+* Filename : app_mqtt-c_bench_publish_rx_batch.c
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    APP_MQTTc_MODULE
+
+#include  <cpu.h>
+#include  <lib_def.h>
+#include  <lib_mem.h>
+
+#include  "app_mqtt-c.h"
+
+#include  <stdio.h>
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  APP_MQTTc_MSG_QTY                         2u
+
+#define  APP_MQTTc_MSG_LEN_MAX                   128u
+                                                                /* Holds a full batch of bench msgs. See Note #2.       */
+#define  APP_MQTTc_PUBLISH_RX_MSG_LEN_MAX       1024u
+
+                                                                /* Domain to which to subscribe and publish.            */
+#define  APP_MQTTc_DOMAIN_BENCH                     "domain/bench/rx_batch_topic"
+
+#define  APP_MQTTc_BENCH_QoS                        0u
+
+                                                                /* Len of each bench msg payload, in bytes.             */
+#define  APP_MQTTc_BENCH_PAYLOAD_LEN              32u
+
+                                                                /* Nbr of msgs published and rx'd.                      */
+#define  APP_MQTTc_BENCH_MSG_NBR                10000u
+
+                                                                /* Rx msgs by batch (DEF_ENABLED) or one at a time.     */
+#define  APP_MQTTc_BENCH_BATCH_EN                DEF_ENABLED
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U   AppMQTTc_TaskStk[APP_MQTTc_TASK_STK_SIZE];
+
+static  MQTTc_CONN   AppMQTTc_Conn;
+
+static  MQTTc_MSG    AppMQTTc_Msg;
+static  CPU_INT08U   AppMQTTc_MsgBuf[APP_MQTTc_MSG_LEN_MAX];
+
+static  MQTTc_MSG    AppMQTTc_MsgPublishRx;
+static  CPU_INT08U   AppMQTTc_MsgPublishRxBuf[APP_MQTTc_PUBLISH_RX_MSG_LEN_MAX];
+
+static  CPU_CHAR     AppMQTTc_BenchPayload[APP_MQTTc_BENCH_PAYLOAD_LEN];
+
+static  CPU_INT32U   AppMQTTc_BenchTxCnt;                       /* Nbr of bench msgs published.                         */
+static  CPU_INT32U   AppMQTTc_BenchRxCnt;                       /* Nbr of bench msgs rx'd.                              */
+static  CPU_INT32U   AppMQTTc_BenchRxCallbackCnt;               /* Nbr of rx callbacks called.                          */
+static  CPU_TS32     AppMQTTc_BenchTS_Start;                    /* TS of first publish.                                 */
+
+
+const  NET_TASK_CFG  AppMQTTc_TaskCfg = {                       /* Cfg for MQTTc internal task.                         */
+    APP_MQTTc_TASK_PRIO,                                        /* MQTTc internal task prio.                            */
+    APP_MQTTc_TASK_STK_SIZE,                                    /* MQTTc internal task stack size.                      */
+    AppMQTTc_TaskStk                                            /* Ptr to start of MQTTc internal stack.                */
+};
+
+
+const  MQTTc_CFG     AppMQTTc_Cfg = {
+    APP_MQTTc_MSG_QTY,
+    APP_MQTTc_INACTIVITY_TIMEOUT_s,
+    APP_MQTTc_INTERNAL_TASK_DLY
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchPublish                 (       MQTTc_CONN             *p_conn,
+                                                            MQTTc_MSG              *p_msg);
+
+static  void  AppMQTTc_BenchRx                      (       CPU_INT32U              msg_nbr);
+
+static  void  AppMQTTc_OnCmplCallbackFnct           (       MQTTc_CONN             *p_conn,
+                                                            MQTTc_MSG              *p_msg,
+                                                            void                   *p_arg,
+                                                            MQTTc_ERR               err);
+
+#if (APP_MQTTc_BENCH_BATCH_EN == DEF_ENABLED)
+static  void  AppMQTTc_OnPublishRxBatchCallbackFnct (       MQTTc_CONN             *p_conn,
+                                                     const  MQTTc_PUBLISH_RX_VIEW  *p_views,
+                                                            CPU_INT32U              view_nbr,
+                                                            void                   *p_arg);
+#else
+static  void  AppMQTTc_OnPublishRxCallbackFnct      (       MQTTc_CONN             *p_conn,
+                                                     const  CPU_CHAR               *topic_name_str,
+                                                            CPU_INT32U              topic_len,
+                                                     const  CPU_CHAR               *p_payload,
+                                                            CPU_INT32U              payload_len,
+                                                            void                   *p_arg,
+                                                            MQTTc_ERR               err);
+#endif
+
+static  void  AppMQTTc_OnErrCallbackFnct            (       MQTTc_CONN             *p_conn,
+                                                            void                   *p_arg,
+                                                            MQTTc_ERR               err);
+
+
+/*
+*********************************************************************************************************
+*                                            AppMQTTc_Init()
+*
+* Description : Initialize the application MQTT-client module and start the publish rx benchmark.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The benchmark subscribes to a topic and then publishes APP_MQTTc_BENCH_MSG_NBR QoS 0
+*                   messages with a payload of APP_MQTTc_BENCH_PAYLOAD_LEN bytes to that same topic. The
+*                   server sends each message back, and the time from the first publish to the reception
+*                   of the last message is measured. Run it once with APP_MQTTc_BENCH_BATCH_EN enabled and
+*                   once with it disabled to compare batched and per-message delivery.
+*
+*               (2) With batched delivery, the views of a batch all point in the buffer of the publish rx
+*                   message. The larger the buffer, the more messages a batch can hold, up to
+*                   MQTTc_CFG_PUBLISH_RX_BATCH_SIZE.
+*
+*               (3) MQTTc_CFG_PUBLISH_RX_BATCH_EN MUST be enabled if APP_MQTTc_BENCH_BATCH_EN is.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_Init (void)
+{
+    MQTTc_ERR  err_mqttc;
+
+
+    MQTTc_Init(&AppMQTTc_Cfg,
+               &AppMQTTc_TaskCfg,
+                DEF_NULL,
+               &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to init MQTTc module. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    Mem_Set(&AppMQTTc_BenchPayload[0u], 'b', sizeof(AppMQTTc_BenchPayload));
+
+    MQTTc_MsgClr(&AppMQTTc_Msg, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to clr msg object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgSetParam(&AppMQTTc_Msg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_MsgBuf[0u], &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to set buf ptr param. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgSetParam(&AppMQTTc_Msg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *)APP_MQTTc_MSG_LEN_MAX, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to set buf len param. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgClr(&AppMQTTc_MsgPublishRx, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to clr publish rx msg object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgSetParam(&AppMQTTc_MsgPublishRx, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_MsgPublishRxBuf[0u], &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to set publish rx buf ptr param. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_MsgSetParam(&AppMQTTc_MsgPublishRx, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *)APP_MQTTc_PUBLISH_RX_MSG_LEN_MAX, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to set publish rx buf len param. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_ConnClr(&AppMQTTc_Conn,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to clr MQTTc connection object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+                                                                /* Err handling should be done in your application.     */
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_BROKER_NAME,                  (void *) APP_MQTTc_BROKER_NAME,                 &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CLIENT_ID_STR,                (void *) APP_MQTTc_CLIENT_ID_NAME,              &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_USERNAME_STR,                 (void *) APP_MQTTc_USERNAME,                    &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_KEEP_ALIVE_TMR_SEC,           (void *) 1000u,                                 &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_COMPL,            (void *) AppMQTTc_OnCmplCallbackFnct,           &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_PUBLISH_RX_MSG_PTR,           (void *)&AppMQTTc_MsgPublishRx,                 &err_mqttc);
+#if (APP_MQTTc_BENCH_BATCH_EN == DEF_ENABLED)
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_BATCH, (void *) AppMQTTc_OnPublishRxBatchCallbackFnct, &err_mqttc);
+#else
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX,       (void *) AppMQTTc_OnPublishRxCallbackFnct,      &err_mqttc);
+#endif
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_ERR_CALLBACK,     (void *) AppMQTTc_OnErrCallbackFnct,            &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_TIMEOUT_MS,                   (void *) 30000u,                                &err_mqttc);
+
+    MQTTc_ConnOpen(&AppMQTTc_Conn,                              /* Open conn to MQTT server with parameters set in Conn.*/
+                    MQTTc_FLAGS_NONE,
+                   &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to open TCP connection to MQTT server. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);                                      /* Failed to open TCP connection to MQTT server.        */
+    }
+
+    MQTTc_Connect(&AppMQTTc_Conn,                               /* Send CONNECT msg to MQTT server.                     */
+                  &AppMQTTc_Msg,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to process Connect msg req. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);                                      /* Failed to process MQTT CONNECT msg.                  */
+    }
+
+    printf("Initialization and CONNECT to server successful.\r\n");
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        AppMQTTc_BenchPublish()
+*
+* Description : Publish the next benchmark message, if any is left.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_OnCmplCallbackFnct().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchPublish (MQTTc_CONN  *p_conn,
+                                     MQTTc_MSG   *p_msg)
+{
+    MQTTc_ERR  err_mqttc;
+
+
+    if (AppMQTTc_BenchTxCnt >= APP_MQTTc_BENCH_MSG_NBR) {
+        return;
+    }
+
+    if (AppMQTTc_BenchTxCnt == 0u) {
+        AppMQTTc_BenchTS_Start = CPU_TS_Get32();
+    }
+
+    MQTTc_Publish(p_conn,
+                  p_msg,
+                  APP_MQTTc_DOMAIN_BENCH,
+                  APP_MQTTc_BENCH_QoS,
+                  DEF_NO,
+                  AppMQTTc_BenchPayload,
+                  APP_MQTTc_BENCH_PAYLOAD_LEN,
+                 &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to Publish bench msg. Err: %i\n\r.", err_mqttc);
+        return;
+    }
+
+    AppMQTTc_BenchTxCnt++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          AppMQTTc_BenchRx()
+*
+* Description : Account for benchmark messages rx'd by one callback and display the results once all
+*               messages have been rx'd.
+*
+* Arguments   : msg_nbr         Number of messages rx'd by the callback.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_OnPublishRxBatchCallbackFnct(),
+*               AppMQTTc_OnPublishRxCallbackFnct().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchRx (CPU_INT32U  msg_nbr)
+{
+    CPU_INT32U  time_us;
+
+
+    AppMQTTc_BenchRxCnt += msg_nbr;
+    AppMQTTc_BenchRxCallbackCnt++;
+
+    if (AppMQTTc_BenchRxCnt < APP_MQTTc_BENCH_MSG_NBR) {
+        return;
+    }
+
+    time_us = CPU_TS32_to_uSec(CPU_TS_Get32() - AppMQTTc_BenchTS_Start);
+    if (time_us == 0u) {
+        time_us = 1u;
+    }
+
+    printf("%s: %u msgs of %u bytes rx'd in %u us (%u msgs/s, %u.%02u msgs/callback).\n\r",
+           (APP_MQTTc_BENCH_BATCH_EN == DEF_ENABLED) ? "OnPublishRxBatch" : "OnPublishRx",
+           (unsigned int) AppMQTTc_BenchRxCnt,
+           (unsigned int) APP_MQTTc_BENCH_PAYLOAD_LEN,
+           (unsigned int) time_us,
+           (unsigned int)(((CPU_INT64U)AppMQTTc_BenchRxCnt * 1000000u) / time_us),
+           (unsigned int) (AppMQTTc_BenchRxCnt / AppMQTTc_BenchRxCallbackCnt),
+           (unsigned int)(((AppMQTTc_BenchRxCnt * 100u) / AppMQTTc_BenchRxCallbackCnt) % 100u));
+    printf("Publish rx benchmark completed.\n\r");
+}
+
+
+/*
+*********************************************************************************************************
+*                                    AppMQTTc_OnCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a CONNECT, SUBSCRIBE or PUBLISH operation
+*               has completed.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                           MQTTc_MSG   *p_msg,
+                                           void        *p_arg,
+                                           MQTTc_ERR    err)
+{
+    MQTTc_ERR  err_mqttc;
+
+
+    (void)&p_arg;
+
+    if (err != MQTTc_ERR_NONE) {
+        printf("Cmpl callback called with err (%i) for msg type %i. Stopping benchmark.\n\r", err, p_msg->Type);
+        return;
+    }
+
+    switch (p_msg->Type) {
+        case MQTTc_MSG_TYPE_CONNECT:                            /* Subscribe to the topic to which the bench publishes. */
+             MQTTc_Subscribe(p_conn,
+                             p_msg,
+                             APP_MQTTc_DOMAIN_BENCH,
+                             APP_MQTTc_BENCH_QoS,
+                            &err_mqttc);
+             if (err_mqttc != MQTTc_ERR_NONE) {
+                 printf("!!! APP ERROR !!! Subscribe failed. Err: %i\n\r.", err_mqttc);
+             }
+             break;
+
+
+        case MQTTc_MSG_TYPE_SUBSCRIBE:
+             printf("Subscribed. Starting publish rx benchmark.\n\r");
+
+             AppMQTTc_BenchTxCnt         = 0u;
+             AppMQTTc_BenchRxCnt         = 0u;
+             AppMQTTc_BenchRxCallbackCnt = 0u;
+
+             AppMQTTc_BenchPublish(p_conn, p_msg);
+             break;
+
+
+        case MQTTc_MSG_TYPE_PUBLISH:
+             AppMQTTc_BenchPublish(p_conn, p_msg);
+             break;
+
+
+        default:
+             break;
+    }
+}
+
+
+#if (APP_MQTTc_BENCH_BATCH_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                AppMQTTc_OnPublishRxBatchCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a batch of PUBLISH messages has been rx'd.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object on which the messages were rx'd.
+*
+*               p_views         Pointer to table of views of the rx'd messages.
+*
+*               view_nbr        Number of views in table.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnPublishRxBatchCallbackFnct (       MQTTc_CONN             *p_conn,
+                                                     const  MQTTc_PUBLISH_RX_VIEW  *p_views,
+                                                            CPU_INT32U              view_nbr,
+                                                            void                   *p_arg)
+{
+    (void)&p_conn;
+    (void)&p_views;
+    (void)&p_arg;
+
+    AppMQTTc_BenchRx(view_nbr);
+}
+#else
+/*
+*********************************************************************************************************
+*                                  AppMQTTc_OnPublishRxCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a PUBLISH message has been rx'd.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object on which the message was rx'd.
+*
+*               topic_name_str  String containing the topic of the message rx'd. NOT NULL-terminated.
+*
+*               topic_len       Length of the topic.
+*
+*               p_payload       Pointer to the payload of the message rx'd. NOT NULL-terminated.
+*
+*               payload_len     Length of the payload.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing the rx'd message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnPublishRxCallbackFnct (       MQTTc_CONN  *p_conn,
+                                                const  CPU_CHAR    *topic_name_str,
+                                                       CPU_INT32U   topic_len,
+                                                const  CPU_CHAR    *p_payload,
+                                                       CPU_INT32U   payload_len,
+                                                       void        *p_arg,
+                                                       MQTTc_ERR    err)
+{
+    (void)&p_conn;
+    (void)&topic_name_str;
+    (void)&topic_len;
+    (void)&p_payload;
+    (void)&payload_len;
+    (void)&p_arg;
+    (void)&err;
+
+    AppMQTTc_BenchRx(1u);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_OnErrCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when an error occurs.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object on which error occurred.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnErrCallbackFnct (MQTTc_CONN  *p_conn,
+                                          void        *p_arg,
+                                          MQTTc_ERR    err)
+{
+    (void)&p_conn;
+    (void)&p_arg;
+
+    printf("!!! APP ERROR !!! Err detected via OnErr callback. Err = %i.\n\r", err);
+}
@@ -0,0 +1,1283 @@
+/*
+*********************************************************************************************************
+*                                            EXAMPLE CODE
+*
+*               This file is provided as an example on how to use Micrium products.
+*
+*               Please feel free to use any application code labeled as 'EXAMPLE CODE' in
+*               your application products.  Example code may be used as is, in whole or in
+*               part, or may be used as a reference only. This file can be modified as
+*               required to meet the end-product requirements.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          MQTTc APPLICATION
+*
+* Filename : app_mqtt-c_bench_suite.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) Benchmark suite of the MQTTc module, run against the loopback broker stub of
+*                'app_mqtt-c_bench_broker.c'. Each scenario of AppMQTTc_BenchScenarioTbl measures one of :
+*
+*                (a) CONNECT     Time from MQTTc_ConnOpen() to the CONNECT cmpl callback.
+*                (b) PUBLISH     Outbound throughput, with APP_MQTTc_BENCH_WIN_SIZE msgs in flight per conn.
+*                (c) PUBLISH_RX  Inbound  throughput, of a flood tx'd by the broker stub.
+*                (d) RTT         Round-trip latency of a msg published on a topic the conn is subscribed to.
+*
+*            (2) The results are printed as a single JSON object, one entry per scenario. When the task
+*                profiler is enabled (MQTTc_CFG_PROF_EN), the CPU time spent by the MQTTc task per msg is
+*                also reported : it is the time of the task's iterations minus the time waiting on the sock
+*                sel, and includes the time spent in the callbacks of this file.
+*
+*            (3) The key value of each scenario is compared to the baseline stored in its entry of
+*                AppMQTTc_BenchScenarioTbl. A scenario regresses if its value is worse than the baseline by
+*                more than APP_MQTTc_BENCH_BASELINE_TOL_PCT. A baseline of 0 is not compared : to record a
+*                baseline, copy the "value" fields of a reference run on the target into the tbl.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    APP_MQTTc_MODULE
+
+#include  <cpu.h>
+#include  <cpu_core.h>
+#include  <lib_def.h>
+#include  <lib_mem.h>
+
+#include  "app_mqtt-c.h"
+
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+#include  <Client/Source/mqtt-c_prof.h>
+#endif
+
+#include  <Source/net.h>
+#include  <Source/net_sock.h>
+#include  <Source/net_util.h>
+
+#include  <KAL/kal.h>
+
+#include  <stdio.h>
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  APP_MQTTc_BENCH_CONN_NBR_MAX               4u
+                                                                /* Nbr of msgs in flight per conn for PUBLISH.          */
+#define  APP_MQTTc_BENCH_WIN_SIZE                   4u
+#define  APP_MQTTc_MSG_QTY                         (APP_MQTTc_BENCH_CONN_NBR_MAX * APP_MQTTc_BENCH_WIN_SIZE)
+
+#define  APP_MQTTc_BENCH_PAYLOAD_LEN_MAX         1024u
+#define  APP_MQTTc_BENCH_MSG_LEN_MAX             (APP_MQTTc_BENCH_PAYLOAD_LEN_MAX + 64u)
+
+                                                                /* Max nbr of latency samples kept per scenario.        */
+#define  APP_MQTTc_BENCH_SAMPLE_NBR_MAX          2048u
+
+#define  APP_MQTTc_BENCH_TIMEOUT_MS             60000u
+#define  APP_MQTTc_BENCH_BASELINE_TOL_PCT          10u
+
+#define  APP_MQTTc_BENCH_TASK_STK_SIZE           4096u
+#define  APP_MQTTc_BENCH_TASK_PRIO                  9u
+
+#define  APP_MQTTc_BENCH_TOPIC_PUBLISH_RX           "bench/rx"
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  enum  app_mqttc_bench_type {
+    APP_MQTTc_BENCH_TYPE_CONNECT,                               /* See Note #1a.                                        */
+    APP_MQTTc_BENCH_TYPE_PUBLISH,                               /* See Note #1b.                                        */
+    APP_MQTTc_BENCH_TYPE_PUBLISH_RX,                            /* See Note #1c.                                        */
+    APP_MQTTc_BENCH_TYPE_RTT                                    /* See Note #1d.                                        */
+} APP_MQTTc_BENCH_TYPE;
+
+
+typedef  struct  app_mqttc_bench_scenario {
+    APP_MQTTc_BENCH_TYPE  Type;
+    CPU_INT08U            QoS;
+    CPU_INT16U            PayloadLen;
+    CPU_INT08U            ConnNbr;
+    CPU_INT32U            MsgNbr;                               /* Nbr of msgs (or of connects) per conn.               */
+    CPU_INT32U            Baseline;                             /* Baseline of key value. See Note #3.                  */
+} APP_MQTTc_BENCH_SCENARIO;
+
+
+typedef  struct  app_mqttc_bench_result {
+    CPU_BOOLEAN  IsOK;                                          /* DEF_NO if scenario failed or timed out.              */
+    CPU_INT32U   MsgNbr;                                        /* Nbr of msgs (or of connects) measured.               */
+    CPU_INT32U   Dur_ms;
+    CPU_INT32U   MsgPerSec;
+    CPU_INT32U   BytePerSec;
+    CPU_INT32U   LatP50_us;
+    CPU_INT32U   LatP90_us;
+    CPU_INT32U   LatP99_us;
+    CPU_INT32U   LatMax_us;
+    CPU_INT32U   CPU_PerMsg_ns;                                 /* 0 if the task profiler is disabled.                  */
+    CPU_INT32U   ErrNbr;
+    CPU_INT32U   Val;                                           /* Key value compared to the baseline.                  */
+    CPU_BOOLEAN  IsRegressed;
+} APP_MQTTc_BENCH_RESULT;
+
+
+typedef  struct  app_mqttc_bench_conn {
+    MQTTc_CONN   Conn;
+
+    MQTTc_MSG    MsgTbl[APP_MQTTc_BENCH_WIN_SIZE];
+    CPU_INT08U   MsgBufTbl[APP_MQTTc_BENCH_WIN_SIZE][APP_MQTTc_BENCH_MSG_LEN_MAX];
+
+    MQTTc_MSG    RxMsg;
+    CPU_INT08U   RxMsgBuf[APP_MQTTc_BENCH_MSG_LEN_MAX];
+
+    CPU_CHAR     PayloadBuf[APP_MQTTc_BENCH_PAYLOAD_LEN_MAX];
+
+    CPU_INT32U   TxCnt;                                         /* Nbr of msgs published.                               */
+    CPU_INT32U   CmplCnt;                                       /* Nbr of publish cmpl'd.                               */
+    CPU_INT32U   RxCnt;                                         /* Nbr of msgs rx'd.                                    */
+    CPU_INT32U   ErrCnt;
+    CPU_TS32     ConnectTS;                                     /* TS of MQTTc_ConnOpen() call.                         */
+    CPU_BOOLEAN  IsOpen;
+} APP_MQTTc_BENCH_CONN;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U                       AppMQTTc_TaskStk[APP_MQTTc_TASK_STK_SIZE];
+static  CPU_INT08U                       AppMQTTc_BenchTaskStk[APP_MQTTc_BENCH_TASK_STK_SIZE];
+
+static  KAL_SEM_HANDLE                   AppMQTTc_BenchSem;
+
+static  APP_MQTTc_BENCH_CONN             AppMQTTc_BenchConnTbl[APP_MQTTc_BENCH_CONN_NBR_MAX];
+static  const  APP_MQTTc_BENCH_SCENARIO *AppMQTTc_BenchScenarioCurPtr;
+static  CPU_INT32U                       AppMQTTc_BenchRxCnt;   /* Nbr of msgs rx'd on all conns.                       */
+
+static  CPU_TS32                         AppMQTTc_BenchSampleTbl[APP_MQTTc_BENCH_SAMPLE_NBR_MAX];
+static  CPU_INT32U                       AppMQTTc_BenchSampleNbr;
+
+static  const  CPU_CHAR  *AppMQTTc_BenchClientID_Tbl[APP_MQTTc_BENCH_CONN_NBR_MAX] = {
+    "bench_0", "bench_1", "bench_2", "bench_3"
+};
+
+static  const  CPU_CHAR  *AppMQTTc_BenchTopicTbl[APP_MQTTc_BENCH_CONN_NBR_MAX] = {
+    "bench/0", "bench/1", "bench/2", "bench/3"
+};
+
+static  const  CPU_CHAR  *AppMQTTc_BenchTypeStrTbl[] = {
+    "connect", "publish", "publish_rx", "rtt"
+};
+
+                                                                /* See Note #1 and #3.                                  */
+static  const  APP_MQTTc_BENCH_SCENARIO  AppMQTTc_BenchScenarioTbl[] = {
+                                                                /* Type, QoS, payload len, conn nbr, msg nbr, baseline. */
+    { APP_MQTTc_BENCH_TYPE_CONNECT,      0u,     0u,   1u,   100u,   0u },
+    { APP_MQTTc_BENCH_TYPE_CONNECT,      0u,     0u,   4u,    25u,   0u },
+
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      0u,    16u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      1u,    16u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      2u,    16u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      0u,   256u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      1u,   256u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      2u,   256u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      0u,  1024u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      1u,  1024u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      2u,  1024u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH,      1u,   256u,   4u,   500u,   0u },
+
+    { APP_MQTTc_BENCH_TYPE_PUBLISH_RX,   0u,   256u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH_RX,   1u,   256u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH_RX,   2u,   256u,   1u,  2000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_PUBLISH_RX,   1u,   256u,   4u,   500u,   0u },
+
+    { APP_MQTTc_BENCH_TYPE_RTT,          0u,    16u,   1u,  1000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_RTT,          1u,    16u,   1u,  1000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_RTT,          2u,    16u,   1u,  1000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_RTT,          1u,  1024u,   1u,  1000u,   0u },
+    { APP_MQTTc_BENCH_TYPE_RTT,          1u,    16u,   4u,   250u,   0u }
+};
+
+#define  APP_MQTTc_BENCH_SCENARIO_NBR            (sizeof(AppMQTTc_BenchScenarioTbl) / sizeof(APP_MQTTc_BENCH_SCENARIO))
+
+
+const  NET_TASK_CFG  AppMQTTc_TaskCfg = {                       /* Cfg for MQTTc internal task.                         */
+    APP_MQTTc_TASK_PRIO,                                        /* MQTTc internal task prio.                            */
+    APP_MQTTc_TASK_STK_SIZE,                                    /* MQTTc internal task stack size.                      */
+    AppMQTTc_TaskStk                                            /* Ptr to start of MQTTc internal stack.                */
+};
+
+
+const  MQTTc_CFG     AppMQTTc_Cfg = {
+    APP_MQTTc_MSG_QTY,
+    APP_MQTTc_INACTIVITY_TIMEOUT_s,
+    APP_MQTTc_INTERNAL_TASK_DLY
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  void         AppMQTTc_BenchTask                   (void                            *p_arg);
+
+static  void         AppMQTTc_BenchRun                    (const  APP_MQTTc_BENCH_SCENARIO *p_scenario,
+                                                                  APP_MQTTc_BENCH_RESULT   *p_result);
+
+static  CPU_BOOLEAN  AppMQTTc_BenchConnOpen               (APP_MQTTc_BENCH_CONN            *p_bench_conn,
+                                                           CPU_INT08U                       ix);
+
+static  void         AppMQTTc_BenchConnClose              (APP_MQTTc_BENCH_CONN            *p_bench_conn);
+
+static  CPU_BOOLEAN  AppMQTTc_BenchPend                   (CPU_INT32U                       nbr);
+
+static  void         AppMQTTc_BenchPost                   (void);
+
+static  void         AppMQTTc_BenchPublishNext            (APP_MQTTc_BENCH_CONN            *p_bench_conn,
+                                                           MQTTc_MSG                       *p_msg);
+
+static  void         AppMQTTc_BenchRttNext                (APP_MQTTc_BENCH_CONN            *p_bench_conn);
+
+static  void         AppMQTTc_BenchSampleAdd              (CPU_TS32                         ts_start);
+
+static  void         AppMQTTc_BenchResultCompute          (const  APP_MQTTc_BENCH_SCENARIO *p_scenario,
+                                                                  APP_MQTTc_BENCH_RESULT   *p_result);
+
+static  void         AppMQTTc_BenchResultPrint            (const  APP_MQTTc_BENCH_SCENARIO *p_scenario,
+                                                           const  APP_MQTTc_BENCH_RESULT   *p_result,
+                                                                  CPU_BOOLEAN               is_first);
+
+static  void         AppMQTTc_OnConnectCmplCallbackFnct   (MQTTc_CONN                      *p_conn,
+                                                           MQTTc_MSG                       *p_msg,
+                                                           void                            *p_arg,
+                                                           MQTTc_ERR                        err);
+
+static  void         AppMQTTc_OnSubscribeCmplCallbackFnct (MQTTc_CONN                      *p_conn,
+                                                           MQTTc_MSG                       *p_msg,
+                                                           void                            *p_arg,
+                                                           MQTTc_ERR                        err);
+
+static  void         AppMQTTc_OnPublishCmplCallbackFnct   (MQTTc_CONN                      *p_conn,
+                                                           MQTTc_MSG                       *p_msg,
+                                                           void                            *p_arg,
+                                                           MQTTc_ERR                        err);
+
+static  void         AppMQTTc_OnPublishRxCallbackFnct     (       MQTTc_CONN               *p_conn,
+                                                           const  CPU_CHAR                 *topic_name_str,
+                                                                  CPU_INT32U                topic_len,
+                                                           const  CPU_CHAR                 *p_payload,
+                                                                  CPU_INT32U                payload_len,
+                                                                  void                     *p_arg,
+                                                                  MQTTc_ERR                 err);
+
+static  void         AppMQTTc_OnErrCallbackFnct           (MQTTc_CONN                      *p_conn,
+                                                           void                            *p_arg,
+                                                           MQTTc_ERR                        err);
+
+
+/*
+*********************************************************************************************************
+*                                            AppMQTTc_Init()
+*
+* Description : Initialize the application MQTT-client module, the loopback broker stub and start the
+*               benchmark suite.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The scenarios are run one after the other by the bench task. See
+*                   'app_mqtt-c_bench_suite.c  Note #1'.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_Init (void)
+{
+    KAL_TASK_HANDLE  task_handle;
+    CPU_BOOLEAN      is_ok;
+    MQTTc_ERR        err_mqttc;
+    KAL_ERR          err_kal;
+
+
+    is_ok = AppMQTTc_BenchBrokerInit();
+    if (is_ok != DEF_OK) {
+        printf("ERROR - Failed to init bench broker.\n\r.");
+        return (DEF_FAIL);
+    }
+
+    MQTTc_Init(&AppMQTTc_Cfg,
+               &AppMQTTc_TaskCfg,
+                DEF_NULL,
+               &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to init MQTTc module. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    AppMQTTc_BenchSem = KAL_SemCreate("App MQTTc Bench Sem",
+                                       DEF_NULL,
+                                      &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("ERROR - Failed to create bench sem. Err: %i\n\r.", err_kal);
+        return (DEF_FAIL);
+    }
+
+    task_handle = KAL_TaskAlloc("App MQTTc Bench Task",
+                       (void *)&AppMQTTc_BenchTaskStk[0u],
+                                APP_MQTTc_BENCH_TASK_STK_SIZE,
+                                DEF_NULL,
+                               &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("ERROR - Failed to alloc bench task. Err: %i\n\r.", err_kal);
+        return (DEF_FAIL);
+    }
+
+    KAL_TaskCreate(task_handle,                                 /* See Note #1.                                         */
+                   AppMQTTc_BenchTask,
+                   DEF_NULL,
+                   APP_MQTTc_BENCH_TASK_PRIO,
+                   DEF_NULL,
+                  &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("ERROR - Failed to create bench task. Err: %i\n\r.", err_kal);
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         AppMQTTc_BenchTask()
+*
+* Description : Run every scenario of the suite, print the results and compare them to the baseline.
+*
+* Arguments   : p_arg           Unused.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : KAL.
+*
+* Note(s)     : (1) See 'app_mqtt-c_bench_suite.c  Note #2 & #3'.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchTask (void  *p_arg)
+{
+    APP_MQTTc_BENCH_RESULT  result;
+    CPU_INT32U              ix;
+    CPU_INT32U              regressed_nbr;
+
+
+    (void)&p_arg;
+
+    regressed_nbr = 0u;
+    printf("{\"suite\":\"mqttc\",\"results\":[\n\r");
+    for (ix = 0u; ix < APP_MQTTc_BENCH_SCENARIO_NBR; ix++) {
+        AppMQTTc_BenchRun(&AppMQTTc_BenchScenarioTbl[ix], &result);
+        if (result.IsRegressed == DEF_YES) {
+            regressed_nbr++;
+        }
+        AppMQTTc_BenchResultPrint(&AppMQTTc_BenchScenarioTbl[ix], &result, (ix == 0u) ? DEF_YES : DEF_NO);
+    }
+    printf("\n\r],\"regressed_nbr\":%u}\n\r", (unsigned int)regressed_nbr);
+
+    if (regressed_nbr > 0u) {
+        printf("!!! APP ERROR !!! %u bench scenario(s) regressed.\n\r", (unsigned int)regressed_nbr);
+    } else {
+        printf("Bench suite completed with no regression.\n\r");
+    }
+
+    while (DEF_ON) {
+        KAL_Dly(1000u);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          AppMQTTc_BenchRun()
+*
+* Description : Run a scenario of the suite.
+*
+* Arguments   : p_scenario      Pointer to scenario to run.
+*
+*               p_result        Pointer to variable that will receive the result of the scenario.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchTask().
+*
+* Note(s)     : (1) The conns are open and, for PUBLISH_RX and RTT, subscribed before the measure starts,
+*                   except for CONNECT scenarios that measure the opening of conns.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchRun (const  APP_MQTTc_BENCH_SCENARIO  *p_scenario,
+                                        APP_MQTTc_BENCH_RESULT    *p_result)
+{
+    APP_MQTTc_BENCH_CONN    *p_bench_conn;
+    const  CPU_CHAR         *p_topic;
+    CPU_INT32U               iter_nbr;
+    CPU_INT32U               iter;
+    CPU_INT32U               ts_start_ms;
+    CPU_INT08U               ix;
+    CPU_INT08U               win;
+    CPU_BOOLEAN              is_ok;
+    MQTTc_ERR                err_mqttc;
+    KAL_ERR                  err_kal;
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+    MQTTc_PROF_PHASE_STATS   stats_iter;
+    MQTTc_PROF_PHASE_STATS   stats_sel;
+    CPU_TS_TMR_FREQ          freq;
+    CPU_ERR                  err_cpu;
+#endif
+
+
+    Mem_Clr(p_result, sizeof(APP_MQTTc_BENCH_RESULT));
+    AppMQTTc_BenchScenarioCurPtr = p_scenario;
+    AppMQTTc_BenchSampleNbr      = 0u;
+    AppMQTTc_BenchRxCnt          = 0u;
+    is_ok                        = DEF_OK;
+                                                                /* Drop events left by a previous scenario that failed. */
+    KAL_SemSet(AppMQTTc_BenchSem, 0u, &err_kal);
+    (void)&err_kal;
+
+    iter_nbr = (p_scenario->Type == APP_MQTTc_BENCH_TYPE_CONNECT) ? p_scenario->MsgNbr : 1u;
+    for (iter = 0u; (iter < iter_nbr) && (is_ok == DEF_OK); iter++) {
+                                                                /* ------------------- OPEN CONNS --------------------- */
+        ts_start_ms = NetUtil_TS_Get_ms();
+        for (ix = 0u; (ix < p_scenario->ConnNbr) && (is_ok == DEF_OK); ix++) {
+            is_ok = AppMQTTc_BenchConnOpen(&AppMQTTc_BenchConnTbl[ix], ix);
+        }
+        if (is_ok == DEF_OK) {
+            is_ok = AppMQTTc_BenchPend(p_scenario->ConnNbr);
+        }
+        p_result->Dur_ms += NetUtil_TS_Get_ms() - ts_start_ms;
+
+                                                                /* ------------------ SUBSCRIBE CONNS ----------------- */
+        if ((is_ok               == DEF_OK) &&
+           ((p_scenario->Type == APP_MQTTc_BENCH_TYPE_PUBLISH_RX) ||
+            (p_scenario->Type == APP_MQTTc_BENCH_TYPE_RTT))) {
+            for (ix = 0u; ix < p_scenario->ConnNbr; ix++) {
+                p_bench_conn = &AppMQTTc_BenchConnTbl[ix];
+                p_topic      = (p_scenario->Type == APP_MQTTc_BENCH_TYPE_RTT) ? AppMQTTc_BenchTopicTbl[ix]
+                                                                              : APP_MQTTc_BENCH_TOPIC_PUBLISH_RX;
+                MQTTc_Subscribe(&p_bench_conn->Conn,
+                                &p_bench_conn->MsgTbl[0u],
+                                 p_topic,
+                                 p_scenario->QoS,
+                                &err_mqttc);
+                if (err_mqttc != MQTTc_ERR_NONE) {
+                    printf("!!! APP ERROR !!! Failed to subscribe. Err: %i\n\r.", err_mqttc);
+                    is_ok = DEF_FAIL;
+                    break;
+                }
+            }
+            if (is_ok == DEF_OK) {
+                is_ok = AppMQTTc_BenchPend(p_scenario->ConnNbr);
+            }
+        }
+
+                                                                /* ---------------------- MEASURE --------------------- */
+        if ((is_ok            == DEF_OK) &&
+            (p_scenario->Type != APP_MQTTc_BENCH_TYPE_CONNECT)) {
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+            MQTTc_ProfClr(&err_mqttc);
+#endif
+            ts_start_ms = NetUtil_TS_Get_ms();
+            switch (p_scenario->Type) {
+                case APP_MQTTc_BENCH_TYPE_PUBLISH:
+                     for (ix = 0u; ix < p_scenario->ConnNbr; ix++) {
+                         p_bench_conn = &AppMQTTc_BenchConnTbl[ix];
+                         for (win = 0u; win < APP_MQTTc_BENCH_WIN_SIZE; win++) {
+                             AppMQTTc_BenchPublishNext(p_bench_conn, &p_bench_conn->MsgTbl[win]);
+                         }
+                     }
+                     is_ok = AppMQTTc_BenchPend(p_scenario->ConnNbr);
+                     break;
+
+
+                case APP_MQTTc_BENCH_TYPE_PUBLISH_RX:
+                     is_ok = AppMQTTc_BenchBrokerFlood(APP_MQTTc_BENCH_TOPIC_PUBLISH_RX,
+                                                       p_scenario->QoS,
+                                                       p_scenario->PayloadLen,
+                                                       p_scenario->MsgNbr);
+                     if (is_ok == DEF_OK) {
+                         is_ok = AppMQTTc_BenchPend(1u);
+                     }
+                     break;
+
+
+                case APP_MQTTc_BENCH_TYPE_RTT:
+                     for (ix = 0u; ix < p_scenario->ConnNbr; ix++) {
+                         p_bench_conn = &AppMQTTc_BenchConnTbl[ix];
+                         AppMQTTc_BenchPublishNext(p_bench_conn, &p_bench_conn->MsgTbl[0u]);
+                     }
+                     is_ok = AppMQTTc_BenchPend(p_scenario->ConnNbr);
+                     break;
+
+
+                case APP_MQTTc_BENCH_TYPE_CONNECT:
+                default:
+                     break;
+            }
+            p_result->Dur_ms = NetUtil_TS_Get_ms() - ts_start_ms;
+
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+            MQTTc_ProfPhaseGet(MQTTc_PROF_PHASE_ITER, &stats_iter, &err_mqttc);
+            MQTTc_ProfPhaseGet(MQTTc_PROF_PHASE_SEL,  &stats_sel,  &err_mqttc);
+            freq = CPU_TS_TmrFreqGet(&err_cpu);
+            if ((err_cpu                 == CPU_ERR_NONE) &&
+                (freq                    >= DEF_TIME_NBR_mS_PER_SEC) &&
+                (stats_iter.TotalTicks   >= stats_sel.TotalTicks)) {
+                p_result->CPU_PerMsg_ns = (CPU_INT32U)((((stats_iter.TotalTicks - stats_sel.TotalTicks) * DEF_TIME_NBR_uS_PER_SEC)
+                                                      / (freq / DEF_TIME_NBR_mS_PER_SEC))
+                                                      / (p_scenario->MsgNbr * p_scenario->ConnNbr));
+            }
+#endif
+        }
+
+                                                                /* ------------------- CLOSE CONNS -------------------- */
+        for (ix = 0u; ix < p_scenario->ConnNbr; ix++) {
+            AppMQTTc_BenchConnClose(&AppMQTTc_BenchConnTbl[ix]);
+        }
+    }
+
+    for (ix = 0u; ix < p_scenario->ConnNbr; ix++) {
+        p_result->ErrNbr += AppMQTTc_BenchConnTbl[ix].ErrCnt;
+    }
+    p_result->IsOK = is_ok;
+
+    AppMQTTc_BenchResultCompute(p_scenario, p_result);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_BenchConnOpen()
+*
+* Description : Set up a conn to the loopback broker stub, open it and send its CONNECT msg.
+*
+* Arguments   : p_bench_conn    Pointer to bench conn to open.
+*
+*               ix              Index of bench conn.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : AppMQTTc_BenchRun().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_BenchConnOpen (APP_MQTTc_BENCH_CONN  *p_bench_conn,
+                                             CPU_INT08U             ix)
+{
+    CPU_INT08U  win;
+    MQTTc_ERR   err_mqttc;
+
+
+    p_bench_conn->TxCnt   = 0u;
+    p_bench_conn->CmplCnt = 0u;
+    p_bench_conn->RxCnt   = 0u;
+    p_bench_conn->ErrCnt  = 0u;
+    Mem_Set(p_bench_conn->PayloadBuf, 'b', APP_MQTTc_BENCH_PAYLOAD_LEN_MAX);
+
+    for (win = 0u; win < APP_MQTTc_BENCH_WIN_SIZE; win++) {
+        MQTTc_MsgClr(&p_bench_conn->MsgTbl[win], &err_mqttc);
+        MQTTc_MsgSetParam(&p_bench_conn->MsgTbl[win], MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&p_bench_conn->MsgBufTbl[win][0u], &err_mqttc);
+        MQTTc_MsgSetParam(&p_bench_conn->MsgTbl[win], MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_BENCH_MSG_LEN_MAX,      &err_mqttc);
+    }
+    MQTTc_MsgClr(&p_bench_conn->RxMsg, &err_mqttc);
+    MQTTc_MsgSetParam(&p_bench_conn->RxMsg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&p_bench_conn->RxMsgBuf[0u],      &err_mqttc);
+    MQTTc_MsgSetParam(&p_bench_conn->RxMsg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_BENCH_MSG_LEN_MAX,    &err_mqttc);
+
+    MQTTc_ConnClr(&p_bench_conn->Conn, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("ERROR - Failed to clr MQTTc connection object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+                                                                /* Err handling should be done in your application.     */
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_BROKER_NAME,                (void *) APP_MQTTc_BENCH_BROKER_ADDR,           &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_BROKER_PORT_NBR,            (void *) APP_MQTTc_BENCH_BROKER_PORT_NBR,       &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CLIENT_ID_STR,              (void *) AppMQTTc_BenchClientID_Tbl[ix],        &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_KEEP_ALIVE_TMR_SEC,         (void *) 1000u,                                 &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_CONNECT_CMPL,   (void *) AppMQTTc_OnConnectCmplCallbackFnct,    &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_SUBSCRIBE_CMPL, (void *) AppMQTTc_OnSubscribeCmplCallbackFnct,  &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_CMPL,   (void *) AppMQTTc_OnPublishCmplCallbackFnct,    &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX,     (void *) AppMQTTc_OnPublishRxCallbackFnct,      &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_ERR_CALLBACK,   (void *) AppMQTTc_OnErrCallbackFnct,            &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR,           (void *) p_bench_conn,                          &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_PUBLISH_RX_MSG_PTR,         (void *)&p_bench_conn->RxMsg,                   &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_TIMEOUT_MS,                 (void *) 30000u,                                &err_mqttc);
+
+    p_bench_conn->ConnectTS = CPU_TS_Get32();
+    MQTTc_ConnOpen(&p_bench_conn->Conn,                         /* Open conn to broker stub with parameters set in Conn.*/
+                    MQTTc_FLAGS_NONE,
+                   &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to open TCP connection to bench broker. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+    p_bench_conn->IsOpen = DEF_YES;
+
+    MQTTc_Connect(&p_bench_conn->Conn,                          /* Send CONNECT msg to broker stub.                     */
+                  &p_bench_conn->MsgTbl[0u],
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to process Connect msg req. Err: %i\n\r.", err_mqttc);
+        AppMQTTc_BenchConnClose(p_bench_conn);
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_BenchConnClose()
+*
+* Description : Close a bench conn, if open.
+*
+* Arguments   : p_bench_conn    Pointer to bench conn to close.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchRun(),
+*               AppMQTTc_BenchConnOpen().
+*
+* Note(s)     : (1) No DISCONNECT msg is sent : the broker stub closes its side when the TCP conn closes.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchConnClose (APP_MQTTc_BENCH_CONN  *p_bench_conn)
+{
+    MQTTc_ERR  err_mqttc;
+
+
+    if (p_bench_conn->IsOpen == DEF_NO) {
+        return;
+    }
+    p_bench_conn->IsOpen = DEF_NO;
+
+    MQTTc_ConnClose(&p_bench_conn->Conn,                        /* See Note #1.                                         */
+                     MQTTc_FLAGS_NONE,
+                    &err_mqttc);
+    (void)&err_mqttc;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         AppMQTTc_BenchPend()
+*
+* Description : Wait for the callbacks to signal a nbr of events.
+*
+* Arguments   : nbr             Nbr of events to wait for.
+*
+* Return(s)   : DEF_OK,   if every event was signaled,
+*               DEF_FAIL, if timed out.
+*
+* Caller(s)   : AppMQTTc_BenchRun().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_BenchPend (CPU_INT32U  nbr)
+{
+    CPU_INT32U  ix;
+    KAL_ERR     err_kal;
+
+
+    for (ix = 0u; ix < nbr; ix++) {
+        KAL_SemPend(AppMQTTc_BenchSem,
+                    KAL_OPT_PEND_NONE,
+                    APP_MQTTc_BENCH_TIMEOUT_MS,
+                   &err_kal);
+        if (err_kal != KAL_ERR_NONE) {
+            printf("!!! APP ERROR !!! Bench scenario timed out. Err: %i\n\r.", err_kal);
+            return (DEF_FAIL);
+        }
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         AppMQTTc_BenchPost()
+*
+* Description : Signal an event to the bench task.
+*
+* Arguments   : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchPost (void)
+{
+    KAL_ERR  err_kal;
+
+
+    KAL_SemPost(AppMQTTc_BenchSem, KAL_OPT_POST_NONE, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchPublishNext()
+*
+* Description : Publish the next msg of a conn, if any are left.
+*
+* Arguments   : p_bench_conn    Pointer to bench conn on which to publish.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchRun(),
+*               AppMQTTc_BenchRttNext(),
+*               AppMQTTc_OnPublishCmplCallbackFnct().
+*
+* Note(s)     : (1) Called from both the bench task and the MQTTc task : the msg is counted in a critical
+*                   section before being published.
+*
+*               (2) The payload of RTT msgs starts with the TS at which they are published.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchPublishNext (APP_MQTTc_BENCH_CONN  *p_bench_conn,
+                                         MQTTc_MSG             *p_msg)
+{
+    const  APP_MQTTc_BENCH_SCENARIO  *p_scenario;
+    CPU_INT32U                        payload_len;
+    CPU_TS32                          ts;
+    MQTTc_ERR                         err_mqttc;
+    CPU_SR_ALLOC();
+
+
+    p_scenario = AppMQTTc_BenchScenarioCurPtr;
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    if (p_bench_conn->TxCnt >= p_scenario->MsgNbr) {
+        CPU_CRITICAL_EXIT();
+        return;
+    }
+    p_bench_conn->TxCnt++;
+    CPU_CRITICAL_EXIT();
+
+    payload_len = p_scenario->PayloadLen;
+    if (p_scenario->Type == APP_MQTTc_BENCH_TYPE_RTT) {         /* See Note #2.                                         */
+        payload_len = DEF_MAX(payload_len, sizeof(CPU_TS32));
+        ts          = CPU_TS_Get32();
+        Mem_Copy(p_bench_conn->PayloadBuf, &ts, sizeof(CPU_TS32));
+    }
+
+    MQTTc_Publish(&p_bench_conn->Conn,
+                   p_msg,
+                   AppMQTTc_BenchTopicTbl[p_bench_conn - &AppMQTTc_BenchConnTbl[0u]],
+                   p_scenario->QoS,
+                   DEF_NO,
+                   p_bench_conn->PayloadBuf,
+                   payload_len,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to Publish bench msg. Err: %i\n\r.", err_mqttc);
+        p_bench_conn->ErrCnt++;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        AppMQTTc_BenchRttNext()
+*
+* Description : Publish the next RTT msg of a conn once the previous one is both cmpl'd and rx'd back, or
+*               signal the end of the conn's RTT msgs.
+*
+* Arguments   : p_bench_conn    Pointer to bench conn.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_OnPublishCmplCallbackFnct(),
+*               AppMQTTc_OnPublishRxCallbackFnct().
+*
+* Note(s)     : (1) With QoS 2, the msg can be rx'd back before its PUBLISH cmpl's.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchRttNext (APP_MQTTc_BENCH_CONN  *p_bench_conn)
+{
+    if ((p_bench_conn->CmplCnt != p_bench_conn->TxCnt) ||       /* See Note #1.                                         */
+        (p_bench_conn->RxCnt   != p_bench_conn->TxCnt)) {
+        return;
+    }
+
+    if (p_bench_conn->RxCnt >= AppMQTTc_BenchScenarioCurPtr->MsgNbr) {
+        AppMQTTc_BenchPost();
+    } else {
+        AppMQTTc_BenchPublishNext(p_bench_conn, &p_bench_conn->MsgTbl[0u]);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_BenchSampleAdd()
+*
+* Description : Add a latency sample.
+*
+* Arguments   : ts_start        TS at which the measured operation started.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_OnConnectCmplCallbackFnct(),
+*               AppMQTTc_OnPublishRxCallbackFnct().
+*
+* Note(s)     : (1) Samples past APP_MQTTc_BENCH_SAMPLE_NBR_MAX are dropped.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchSampleAdd (CPU_TS32  ts_start)
+{
+    CPU_TS32  ts_end;
+
+
+    ts_end = CPU_TS_Get32();
+    if (AppMQTTc_BenchSampleNbr < APP_MQTTc_BENCH_SAMPLE_NBR_MAX) {
+        AppMQTTc_BenchSampleTbl[AppMQTTc_BenchSampleNbr] = ts_end - ts_start;
+        AppMQTTc_BenchSampleNbr++;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_BenchResultCompute()
+*
+* Description : Compute the rates and latency percentiles of a scenario, and compare its key value to the
+*               baseline.
+*
+* Arguments   : p_scenario      Pointer to scenario that was run.
+*
+*               p_result        Pointer to result of scenario.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchRun().
+*
+* Note(s)     : (1) The key value is the msg rate for throughput scenarios (higher is better), the median
+*                   connect time for CONNECT and the 99th percentile latency for RTT (lower is better).
+*
+*               (2) A scenario that failed always counts as regressed.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchResultCompute (const  APP_MQTTc_BENCH_SCENARIO  *p_scenario,
+                                                  APP_MQTTc_BENCH_RESULT    *p_result)
+{
+    CPU_INT32U  ix;
+    CPU_INT32U  ix_ins;
+    CPU_TS32    sample;
+    CPU_INT32U  sample_nbr;
+    CPU_INT32U  payload_len;
+
+
+    p_result->MsgNbr = p_scenario->MsgNbr * p_scenario->ConnNbr;
+    if (p_result->Dur_ms > 0u) {
+        payload_len          = p_scenario->PayloadLen;
+        p_result->MsgPerSec  = (CPU_INT32U)(((CPU_INT64U)p_result->MsgNbr * DEF_TIME_NBR_mS_PER_SEC) / p_result->Dur_ms);
+        p_result->BytePerSec = (CPU_INT32U)(((CPU_INT64U)p_result->MsgNbr * payload_len * DEF_TIME_NBR_mS_PER_SEC) / p_result->Dur_ms);
+    }
+
+    sample_nbr = AppMQTTc_BenchSampleNbr;                       /* Sort samples, by insertion.                          */
+    for (ix = 1u; ix < sample_nbr; ix++) {
+        sample = AppMQTTc_BenchSampleTbl[ix];
+        ix_ins = ix;
+        while ((ix_ins > 0u) &&
+               (AppMQTTc_BenchSampleTbl[ix_ins - 1u] > sample)) {
+            AppMQTTc_BenchSampleTbl[ix_ins] = AppMQTTc_BenchSampleTbl[ix_ins - 1u];
+            ix_ins--;
+        }
+        AppMQTTc_BenchSampleTbl[ix_ins] = sample;
+    }
+    if (sample_nbr > 0u) {
+        p_result->LatP50_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_BenchSampleTbl[(sample_nbr * 50u) / 100u]);
+        p_result->LatP90_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_BenchSampleTbl[(sample_nbr * 90u) / 100u]);
+        p_result->LatP99_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_BenchSampleTbl[(sample_nbr * 99u) / 100u]);
+        p_result->LatMax_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_BenchSampleTbl[sample_nbr - 1u]);
+    }
+
+    switch (p_scenario->Type) {                                 /* See Note #1.                                         */
+        case APP_MQTTc_BENCH_TYPE_CONNECT:
+             p_result->Val = p_result->LatP50_us;
+             break;
+
+        case APP_MQTTc_BENCH_TYPE_RTT:
+             p_result->Val = p_result->LatP99_us;
+             break;
+
+        case APP_MQTTc_BENCH_TYPE_PUBLISH:
+        case APP_MQTTc_BENCH_TYPE_PUBLISH_RX:
+        default:
+             p_result->Val = p_result->MsgPerSec;
+             break;
+    }
+
+    p_result->IsRegressed = DEF_NO;
+    if (p_result->IsOK != DEF_OK) {                             /* See Note #2.                                         */
+        p_result->IsRegressed = DEF_YES;
+    } else if (p_scenario->Baseline > 0u) {
+        if ((p_scenario->Type == APP_MQTTc_BENCH_TYPE_PUBLISH) ||
+            (p_scenario->Type == APP_MQTTc_BENCH_TYPE_PUBLISH_RX)) {
+            if (((CPU_INT64U)p_result->Val * 100u) < ((CPU_INT64U)p_scenario->Baseline * (100u - APP_MQTTc_BENCH_BASELINE_TOL_PCT))) {
+                p_result->IsRegressed = DEF_YES;
+            }
+        } else {
+            if (((CPU_INT64U)p_result->Val * 100u) > ((CPU_INT64U)p_scenario->Baseline * (100u + APP_MQTTc_BENCH_BASELINE_TOL_PCT))) {
+                p_result->IsRegressed = DEF_YES;
+            }
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                      AppMQTTc_BenchResultPrint()
+*
+* Description : Print the result of a scenario as an entry of the JSON results array.
+*
+* Arguments   : p_scenario      Pointer to scenario that was run.
+*
+*               p_result        Pointer to result of scenario.
+*
+*               is_first        DEF_YES, if first entry of the array.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_BenchTask().
+*
+* Note(s)     : (1) A baseline of 0 is printed as null. See 'app_mqtt-c_bench_suite.c  Note #3'.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchResultPrint (const  APP_MQTTc_BENCH_SCENARIO  *p_scenario,
+                                         const  APP_MQTTc_BENCH_RESULT    *p_result,
+                                                CPU_BOOLEAN                is_first)
+{
+    printf("%s{\"name\":\"%s_qos%u_%ub_%uc\",\"type\":\"%s\",\"qos\":%u,\"payload_len\":%u,\"conn_nbr\":%u,",
+           (is_first == DEF_YES) ? "" : ",\n\r",
+           AppMQTTc_BenchTypeStrTbl[p_scenario->Type],
+           (unsigned int)p_scenario->QoS,
+           (unsigned int)p_scenario->PayloadLen,
+           (unsigned int)p_scenario->ConnNbr,
+           AppMQTTc_BenchTypeStrTbl[p_scenario->Type],
+           (unsigned int)p_scenario->QoS,
+           (unsigned int)p_scenario->PayloadLen,
+           (unsigned int)p_scenario->ConnNbr);
+
+    printf("\"ok\":%s,\"msg_nbr\":%u,\"dur_ms\":%u,\"msg_per_sec\":%u,\"byte_per_sec\":%u,",
+           (p_result->IsOK == DEF_OK) ? "true" : "false",
+           (unsigned int)p_result->MsgNbr,
+           (unsigned int)p_result->Dur_ms,
+           (unsigned int)p_result->MsgPerSec,
+           (unsigned int)p_result->BytePerSec);
+
+    printf("\"lat_p50_us\":%u,\"lat_p90_us\":%u,\"lat_p99_us\":%u,\"lat_max_us\":%u,\"cpu_ns_per_msg\":%u,\"err_nbr\":%u,",
+           (unsigned int)p_result->LatP50_us,
+           (unsigned int)p_result->LatP90_us,
+           (unsigned int)p_result->LatP99_us,
+           (unsigned int)p_result->LatMax_us,
+           (unsigned int)p_result->CPU_PerMsg_ns,
+           (unsigned int)p_result->ErrNbr);
+
+    if (p_scenario->Baseline > 0u) {                            /* See Note #1.                                         */
+        printf("\"value\":%u,\"baseline\":%u,", (unsigned int)p_result->Val, (unsigned int)p_scenario->Baseline);
+    } else {
+        printf("\"value\":%u,\"baseline\":null,", (unsigned int)p_result->Val);
+    }
+    printf("\"regressed\":%s}", (p_result->IsRegressed == DEF_YES) ? "true" : "false");
+}
+
+
+/*
+*********************************************************************************************************
+*                                 AppMQTTc_OnConnectCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a CONNECT operation has completed.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing CONNECT message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnConnectCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                                  MQTTc_MSG   *p_msg,
+                                                  void        *p_arg,
+                                                  MQTTc_ERR    err)
+{
+    APP_MQTTc_BENCH_CONN  *p_bench_conn;
+
+
+    (void)&p_conn;
+    (void)&p_msg;
+
+    p_bench_conn = (APP_MQTTc_BENCH_CONN *)p_arg;
+    if (err != MQTTc_ERR_NONE) {
+        printf("ConnectCmpl callback called with err (%i).\n\r", err);
+        p_bench_conn->ErrCnt++;
+    } else if (AppMQTTc_BenchScenarioCurPtr->Type == APP_MQTTc_BENCH_TYPE_CONNECT) {
+        AppMQTTc_BenchSampleAdd(p_bench_conn->ConnectTS);
+    }
+
+    AppMQTTc_BenchPost();
+}
+
+
+/*
+*********************************************************************************************************
+*                                AppMQTTc_OnSubscribeCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a SUBSCRIBE operation has completed.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing SUBSCRIBE message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnSubscribeCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                                    MQTTc_MSG   *p_msg,
+                                                    void        *p_arg,
+                                                    MQTTc_ERR    err)
+{
+    APP_MQTTc_BENCH_CONN  *p_bench_conn;
+
+
+    (void)&p_conn;
+    (void)&p_msg;
+
+    p_bench_conn = (APP_MQTTc_BENCH_CONN *)p_arg;
+    if (err != MQTTc_ERR_NONE) {
+        printf("SubscribeCmpl callback called with err (%i).\n\r", err);
+        p_bench_conn->ErrCnt++;
+    }
+
+    AppMQTTc_BenchPost();
+}
+
+
+/*
+*********************************************************************************************************
+*                                 AppMQTTc_OnPublishCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a PUBLISH operation has completed.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing PUBLISH message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : (1) A PUBLISH that cmpl's with an err is still counted, so that the scenario ends.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnPublishCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                                  MQTTc_MSG   *p_msg,
+                                                  void        *p_arg,
+                                                  MQTTc_ERR    err)
+{
+    APP_MQTTc_BENCH_CONN  *p_bench_conn;
+
+
+    (void)&p_conn;
+
+    p_bench_conn = (APP_MQTTc_BENCH_CONN *)p_arg;
+    if (err != MQTTc_ERR_NONE) {                                /* See Note #1.                                         */
+        p_bench_conn->ErrCnt++;
+    }
+    p_bench_conn->CmplCnt++;
+
+    if (AppMQTTc_BenchScenarioCurPtr->Type == APP_MQTTc_BENCH_TYPE_RTT) {
+        AppMQTTc_BenchRttNext(p_bench_conn);
+    } else if (p_bench_conn->CmplCnt == AppMQTTc_BenchScenarioCurPtr->MsgNbr) {
+        AppMQTTc_BenchPost();
+    } else {
+        AppMQTTc_BenchPublishNext(p_bench_conn, p_msg);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                  AppMQTTc_OnPublishRxCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a PUBLISH message has been received.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               topic_name_str  String containing the topic of the message received. NOT NULL-terminated.
+*
+*               topic_len       Length of the topic.
+*
+*               p_payload       Pointer to payload of the message received.
+*
+*               payload_len     Length of the payload.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code from processing PUBLISH message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : (1) See AppMQTTc_BenchPublishNext() Note #2.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnPublishRxCallbackFnct (       MQTTc_CONN  *p_conn,
+                                                const  CPU_CHAR    *topic_name_str,
+                                                       CPU_INT32U   topic_len,
+                                                const  CPU_CHAR    *p_payload,
+                                                       CPU_INT32U   payload_len,
+                                                       void        *p_arg,
+                                                       MQTTc_ERR    err)
+{
+    APP_MQTTc_BENCH_CONN  *p_bench_conn;
+    CPU_TS32               ts;
+
+
+    (void)&p_conn;
+    (void)&topic_name_str;
+    (void)&topic_len;
+
+    p_bench_conn = (APP_MQTTc_BENCH_CONN *)p_arg;
+    if (err != MQTTc_ERR_NONE) {
+        p_bench_conn->ErrCnt++;
+    }
+    p_bench_conn->RxCnt++;
+
+    if (AppMQTTc_BenchScenarioCurPtr->Type == APP_MQTTc_BENCH_TYPE_RTT) {
+        if (payload_len >= sizeof(CPU_TS32)) {                  /* See Note #1.                                         */
+            Mem_Copy(&ts, p_payload, sizeof(CPU_TS32));
+            AppMQTTc_BenchSampleAdd(ts);
+        }
+        AppMQTTc_BenchRttNext(p_bench_conn);
+    } else {
+        AppMQTTc_BenchRxCnt++;
+        if (AppMQTTc_BenchRxCnt == (AppMQTTc_BenchScenarioCurPtr->MsgNbr * AppMQTTc_BenchScenarioCurPtr->ConnNbr)) {
+            AppMQTTc_BenchPost();
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_OnErrCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when an error occurs.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object on which error occurred.
+*
+*               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
+*                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
+*
+*               err             Error code.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_OnErrCallbackFnct (MQTTc_CONN  *p_conn,
+                                          void        *p_arg,
+                                          MQTTc_ERR    err)
+{
+    (void)&p_conn;
+
+    ((APP_MQTTc_BENCH_CONN *)p_arg)->ErrCnt++;
+
+    printf("!!! APP ERROR !!! Err detected via OnErr callback. Err = %i.\n\r", err);
+}
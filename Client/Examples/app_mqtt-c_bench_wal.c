@@ -0,0 +1,313 @@
+/*
+*********************************************************************************************************
+*                                            EXAMPLE CODE
+*
+*               This file is provided as an example on how to use Micrium products.
+*
+*               Please feel free to use any application code labeled as 'EXAMPLE CODE' in
+*               your application products.  Example code may be used as is, in whole or in
+*               part, or may be used as a reference only. This file can be modified as
+*               required to meet the end-product requirements.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          MQTTc APPLICATION
+*
+* Filename : app_mqtt-c_bench_wal.c
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    APP_MQTTc_MODULE
+
+#include  <cpu.h>
+#include  <lib_def.h>
+
+#include  "app_mqtt-c.h"
+
+#include  <Client/Source/mqtt-c_wal.h>
+
+#include  <stdio.h>
+
+
+#if ((MQTTc_CFG_STORE_EN == DEF_ENABLED) && \
+     (MQTTc_CFG_WAL_EN   == DEF_ENABLED))
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+                                                                /* Len of mem region holding the WAL, in bytes.         */
+#define  APP_MQTTc_BENCH_WAL_MEM_LEN             4096u
+
+                                                                /* Nbr of msgs logged per policy.                       */
+#define  APP_MQTTc_BENCH_MSG_NBR                10000u
+
+                                                                /* Nbr of msgs logged between two tx, for GROUP policy. */
+#define  APP_MQTTc_BENCH_GROUP_MSG_NBR             8u
+
+                                                                /* Simulated cost of a sync, in microseconds.           */
+#define  APP_MQTTc_BENCH_SYNC_COST_US             50u
+
+                                                                /* Len of each msg rec in the store, in bytes.          */
+#define  APP_MQTTc_BENCH_REC_LEN                  64u
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U   AppMQTTc_WalMem[APP_MQTTc_BENCH_WAL_MEM_LEN / sizeof(CPU_INT32U)];
+
+static  MQTTc_WAL    AppMQTTc_Wal;
+
+static  CPU_INT32U   AppMQTTc_BenchSyncCnt;                     /* Nbr of syncs for cur policy.                         */
+static  CPU_INT32U   AppMQTTc_BenchSyncLen;                     /* Nbr of bytes synced for cur policy.                  */
+static  CPU_TS32     AppMQTTc_BenchSyncTime;                    /* Time spent in simulated syncs, in CPU_TS ticks.      */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_BenchWal     (MQTTc_WAL_SYNC_POLICY   sync_policy);
+
+static  void         AppMQTTc_BenchSyncFnct(void                   *p_addr,
+                                            CPU_INT32U              len,
+                                            void                   *p_arg);
+
+
+/*
+*********************************************************************************************************
+*                                            AppMQTTc_Init()
+*
+* Description : Run the WAL benchmark.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The benchmark measures the time spent logging the lifecycle of QoS 1 messages in a WAL,
+*                   for each sync policy. No connection is opened : the WAL is held in RAM and each sync
+*                   busy-waits APP_MQTTc_BENCH_SYNC_COST_US, to simulate the cost of the non-volatile
+*                   storage. Set it to the cost of the actual storage, e.g. of an fsync() or of a FRAM write.
+*                   The time spent in the simulated syncs is excluded from the time per message, so that it
+*                   only holds the overhead of the WAL itself. The cost of the storage for a policy is given
+*                   by its nbr of syncs and of bytes synced per message.
+*
+*               (2) The lifecycle of a stored QoS 1 message is logged as two records : one when it is tx'd,
+*                   one when its record is released from the store. See MQTTc_ConnStoreFeed() and
+*                   MQTTc_ConnStoreMsgCmpl().
+*
+*               (3) MQTTc_CFG_STORE_EN and MQTTc_CFG_WAL_EN MUST be enabled. Otherwise, the benchmark
+*                   only displays an error.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_Init (void)
+{
+    CPU_BOOLEAN  is_ok;
+
+
+    is_ok = AppMQTTc_BenchWal(MQTTc_WAL_SYNC_POLICY_NONE);
+    if (is_ok == DEF_OK) {
+        is_ok = AppMQTTc_BenchWal(MQTTc_WAL_SYNC_POLICY_GROUP);
+    }
+    if (is_ok == DEF_OK) {
+        is_ok = AppMQTTc_BenchWal(MQTTc_WAL_SYNC_POLICY_EACH);
+    }
+    if (is_ok == DEF_OK) {
+        printf("WAL benchmark completed.\n\r");
+    }
+
+    return (is_ok);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          AppMQTTc_BenchWal()
+*
+* Description : Log the lifecycle of APP_MQTTc_BENCH_MSG_NBR messages with given sync policy and display
+*               the time spent per message, as well as the nbr of syncs and of bytes synced.
+*
+* Arguments   : sync_policy     Sync policy of the WAL.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : AppMQTTc_Init().
+*
+* Note(s)     : (1) With the GROUP policy, the task syncs the WAL once before each tx. This is simulated by
+*                   syncing it every APP_MQTTc_BENCH_GROUP_MSG_NBR messages, as if that many messages were
+*                   tx'd at once. See MQTTc_Task() Note #5.
+*
+*               (2) The time spent in the sync function is subtracted from the time measured, so that the
+*                   time per message does not depend on APP_MQTTc_BENCH_SYNC_COST_US. See AppMQTTc_Init()
+*                   Note #1.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_BenchWal (MQTTc_WAL_SYNC_POLICY  sync_policy)
+{
+    MQTTc_STORE_POS  pos;
+    CPU_TS32         ts_start;
+    CPU_TS32         ts_end;
+    CPU_INT32U       time_us;
+    CPU_INT32U       sync_time_us;
+    CPU_INT32U       msg_ix;
+    CPU_INT16U       msg_id;
+    MQTTc_ERR        err_mqttc;
+
+
+    AppMQTTc_BenchSyncCnt = 0u;
+
+    MQTTc_WalOpen(&AppMQTTc_Wal,
+                  &AppMQTTc_WalMem[0u],
+                   sizeof(AppMQTTc_WalMem),
+                   sync_policy,
+                   AppMQTTc_BenchSyncFnct,
+                   DEF_NULL,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to open WAL. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+    AppMQTTc_BenchSyncCnt  = 0u;                                /* Do not count syncs done when opening the WAL.        */
+    AppMQTTc_BenchSyncLen  = 0u;
+    AppMQTTc_BenchSyncTime = 0u;
+
+    pos.SegSeq = 0u;
+    pos.Offset = 0u;
+
+    ts_start = CPU_TS_Get32();
+    for (msg_ix = 0u; msg_ix < APP_MQTTc_BENCH_MSG_NBR; msg_ix++) {
+        msg_id = (CPU_INT16U)((msg_ix % MQTTc_CFG_STORE_WIN_SIZE) + 1u);
+
+        MQTTc_WalLog(&AppMQTTc_Wal, MQTTc_WAL_STATE_OUT_TX, msg_id, &pos);
+        if ((msg_ix % APP_MQTTc_BENCH_GROUP_MSG_NBR) == 0u) {   /* See Note #1.                                         */
+            MQTTc_WalSync(&AppMQTTc_Wal);
+        }
+        MQTTc_WalLog(&AppMQTTc_Wal, MQTTc_WAL_STATE_OUT_FREE, msg_id, &pos);
+
+        pos.Offset += APP_MQTTc_BENCH_REC_LEN;                  /* Pos of next rec in the store.                        */
+    }
+    MQTTc_WalSync(&AppMQTTc_Wal);
+    ts_end = CPU_TS_Get32();
+
+                                                                /* Exclude time spent in syncs. See Note #2.            */
+    time_us      = CPU_TS32_to_uSec((ts_end - ts_start) - AppMQTTc_BenchSyncTime);
+    sync_time_us = CPU_TS32_to_uSec(AppMQTTc_BenchSyncTime);
+    printf("%s: %u msgs in %u us excl. %u us of sync (%u ns/msg, %u syncs per 1000 msgs, %u bytes synced per msg).\n\r",
+           (sync_policy == MQTTc_WAL_SYNC_POLICY_NONE)  ? "MQTTc_WAL_SYNC_POLICY_NONE " :
+           (sync_policy == MQTTc_WAL_SYNC_POLICY_GROUP) ? "MQTTc_WAL_SYNC_POLICY_GROUP" :
+                                                          "MQTTc_WAL_SYNC_POLICY_EACH ",
+           (unsigned int) APP_MQTTc_BENCH_MSG_NBR,
+           (unsigned int) time_us,
+           (unsigned int) sync_time_us,
+           (unsigned int)((time_us * 1000u) / APP_MQTTc_BENCH_MSG_NBR),
+           (unsigned int)((AppMQTTc_BenchSyncCnt * 1000u) / APP_MQTTc_BENCH_MSG_NBR),
+           (unsigned int) (AppMQTTc_BenchSyncLen / APP_MQTTc_BENCH_MSG_NBR));
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        AppMQTTc_BenchSyncFnct()
+*
+* Description : Sync function of the WAL. Simulates the cost of a sync to non-volatile storage.
+*
+* Arguments   : p_addr          Pointer to the start of the range to sync.
+*
+*               len             Length of the range to sync, in bytes.
+*
+*               p_arg           Pointer to argument set when the WAL was opened.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc WAL module.
+*
+* Note(s)     : (1) The time spent in the function is accumulated, so that it can be excluded from the time
+*                   measured. See AppMQTTc_BenchWal() Note #2.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_BenchSyncFnct (void        *p_addr,
+                                      CPU_INT32U   len,
+                                      void        *p_arg)
+{
+    CPU_TS32  ts_start;
+    CPU_TS32  ts_end;
+
+
+    (void)&p_addr;
+    (void)&p_arg;
+
+    ts_start = CPU_TS_Get32();
+
+    AppMQTTc_BenchSyncCnt++;
+    AppMQTTc_BenchSyncLen += len;
+
+    do {
+        ts_end = CPU_TS_Get32();
+    } while (CPU_TS32_to_uSec(ts_end - ts_start) < APP_MQTTc_BENCH_SYNC_COST_US);
+
+    AppMQTTc_BenchSyncTime += ts_end - ts_start;                /* See Note #1.                                         */
+}
+
+#else
+
+
+/*
+*********************************************************************************************************
+*                                            AppMQTTc_Init()
+*
+* Description : Display an error, since the WAL benchmark requires the store and the WAL.
+*
+* Arguments   : none.
+*
+* Return(s)   : DEF_FAIL.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppMQTTc_Init (void)
+{
+    printf("!!! APP ERROR !!! WAL benchmark requires MQTTc_CFG_STORE_EN and MQTTc_CFG_WAL_EN.\n\r");
+
+    return (DEF_FAIL);
+}
+#endif
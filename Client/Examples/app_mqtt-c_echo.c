@@ -20,6 +20,27 @@
 * Filename : app_mqtt-c_echo.c
 * Version  : V1.02.00
 *********************************************************************************************************
+* Note(s)  : (1) The application echoes every msg rx'd on APP_MQTTc_DOMAIN_SUBSCRIBE_LISTEN to
+*                APP_MQTTc_DOMAIN_PUBLISH_ECHO.
+*
+*            (2) When APP_MQTTc_ECHO_BENCH_EN is enabled, the application also measures the round-trip
+*                latency through its echo :
+*
+*                (a) APP_MQTTc_ECHO_BENCH_CONN_NBR bench conns publish msgs to the listen topic and rx
+*                    their echo on the echo topic. The payload of each msg starts with the index of its
+*                    conn, a seq nbr and the TS at which it was published.
+*
+*                (b) The bench sweeps the steps of AppMQTTc_EchoBenchStepTbl, each with its own rate and
+*                    payload len. Every conn publishes at the rate of the step.
+*
+*                (c) For each step, the latency percentiles, the jitter and the nbr of msgs lost or rx'd
+*                    out of order are printed as a JSON object. The jitter is the mean of the absolute
+*                    differences between the latencies of consecutive msgs of a conn.
+*
+*                (d) By default, the conns are open to the loopback broker stub of
+*                    'app_mqtt-c_bench_broker.c'. To measure against another local broker, disable
+*                    APP_MQTTc_ECHO_BENCH_BROKER_STUB_EN and set the broker's addr.
+*********************************************************************************************************
 */
 
 /*
@@ -34,6 +55,8 @@
 
 #include  <cpu.h>
 #include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <lib_str.h>
 
 #include  "app_mqtt-c.h"
 
@@ -46,6 +69,8 @@
 
 #include  <Source/os.h>
 
+#include  <KAL/kal.h>
+
 #include  <dns-c_cfg.h>
 
 #include  <stdio.h>
@@ -59,7 +84,40 @@
 *********************************************************************************************************
 */
 
-#define  APP_MQTTc_MSG_QTY                         3u
+                                                                /* See Note #2.                                         */
+#define  APP_MQTTc_ECHO_BENCH_EN                DEF_DISABLED
+#define  APP_MQTTc_ECHO_BENCH_BROKER_STUB_EN    DEF_ENABLED
+
+#define  APP_MQTTc_ECHO_BENCH_CONN_NBR              2u
+#define  APP_MQTTc_ECHO_BENCH_QoS                   0u
+                                                                /* Nbr of msgs in flight per bench conn.                */
+#define  APP_MQTTc_ECHO_BENCH_WIN_SIZE              8u
+#define  APP_MQTTc_ECHO_BENCH_PAYLOAD_LEN_MAX     512u
+                                                                /* Max nbr of latency samples kept per step.            */
+#define  APP_MQTTc_ECHO_BENCH_SAMPLE_NBR_MAX     4096u
+                                                                /* Time to wait for the last echoes of a step.          */
+#define  APP_MQTTc_ECHO_BENCH_DRAIN_MS           1000u
+#define  APP_MQTTc_ECHO_BENCH_TIMEOUT_MS        30000u
+
+#if (APP_MQTTc_ECHO_BENCH_CONN_NBR > 4u)                        /* See AppMQTTc_EchoBenchClientID_Tbl.                  */
+#error  "APP_MQTTc_ECHO_BENCH_CONN_NBR illegally #define'd in 'app_mqtt-c_echo.c'. MUST be [1u; 4u]."
+#endif
+
+#define  APP_MQTTc_ECHO_BENCH_TASK_STK_SIZE      2048u
+#define  APP_MQTTc_ECHO_BENCH_TASK_PRIO             9u
+
+                                                                /* Nbr of msgs that can echo at once.                   */
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)                    /* Echo every msg in flight of the bench conns.         */
+#define  APP_MQTTc_ECHO_MSG_NBR                    (APP_MQTTc_ECHO_BENCH_CONN_NBR * APP_MQTTc_ECHO_BENCH_WIN_SIZE)
+#else
+#define  APP_MQTTc_ECHO_MSG_NBR                     4u
+#endif
+
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+#define  APP_MQTTc_MSG_QTY                         (2u + APP_MQTTc_ECHO_MSG_NBR + (APP_MQTTc_ECHO_BENCH_CONN_NBR * APP_MQTTc_ECHO_BENCH_WIN_SIZE))
+#else
+#define  APP_MQTTc_MSG_QTY                         (2u + APP_MQTTc_ECHO_MSG_NBR)
+#endif
 #define  APP_MQTTc_MSG_LEN_MAX                  1024u
 #define  APP_MQTTc_PAYLOAD_LEN_MAX                64u
 
@@ -72,6 +130,66 @@
 #define  APP_MQTTc_DOMAIN_SUBSCRIBE_LISTEN          "domain/listen"
 #define  APP_MQTTc_DOMAIN_SUBSCRIBE_LISTEN_QoS     1u
 
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+#if (APP_MQTTc_ECHO_BENCH_BROKER_STUB_EN == DEF_ENABLED)
+#define  APP_MQTTc_ECHO_BROKER_NAME                 APP_MQTTc_BENCH_BROKER_ADDR
+#define  APP_MQTTc_ECHO_BROKER_PORT_NBR             APP_MQTTc_BENCH_BROKER_PORT_NBR
+#else
+#define  APP_MQTTc_ECHO_BROKER_NAME                 "127.0.0.1" /* TODO : Specify addr of the local broker.             */
+#define  APP_MQTTc_ECHO_BROKER_PORT_NBR          1883u
+#endif
+#else
+#define  APP_MQTTc_ECHO_BROKER_NAME                 APP_MQTTc_BROKER_NAME
+#define  APP_MQTTc_ECHO_BROKER_PORT_NBR          1883u
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+typedef  struct  app_mqttc_echo_bench_step {
+    CPU_INT32U  Rate;                                           /* Nbr of msgs published per sec, per conn.             */
+    CPU_INT16U  PayloadLen;
+    CPU_INT32U  MsgNbr;                                         /* Nbr of msgs published per conn.                      */
+} APP_MQTTc_ECHO_BENCH_STEP;
+
+
+typedef  struct  app_mqttc_echo_bench_hdr {                     /* Hdr at start of payload. See Note #2a.               */
+    CPU_INT32U  ConnIx;
+    CPU_INT32U  Seq;
+    CPU_TS32    TS;
+} APP_MQTTc_ECHO_BENCH_HDR;
+
+
+typedef  struct  app_mqttc_echo_bench_conn {
+    MQTTc_CONN   Conn;
+    CPU_INT32U   Ix;
+
+    MQTTc_MSG    MsgTbl[APP_MQTTc_ECHO_BENCH_WIN_SIZE];
+    CPU_BOOLEAN  MsgIsAvailTbl[APP_MQTTc_ECHO_BENCH_WIN_SIZE];
+    CPU_INT08U   MsgBufTbl[APP_MQTTc_ECHO_BENCH_WIN_SIZE][APP_MQTTc_MSG_LEN_MAX];
+
+    MQTTc_MSG    RxMsg;
+    CPU_INT08U   RxMsgBuf[APP_MQTTc_MSG_LEN_MAX];
+
+    CPU_CHAR     PayloadBuf[APP_MQTTc_ECHO_BENCH_PAYLOAD_LEN_MAX];
+
+    CPU_INT32U   TxNbr;                                         /* Nbr of msgs published. Also seq nbr of next msg.     */
+    CPU_INT32U   TxSkipNbr;                                     /* Nbr of msgs not published, no msg was avail.         */
+    CPU_INT32U   RxNbr;                                         /* Nbr of echoes rx'd.                                  */
+    CPU_INT32U   ReorderNbr;                                    /* Nbr of echoes rx'd after an echo of a later msg.     */
+    CPU_INT32U   SeqMax;                                        /* Highest seq nbr rx'd.                                */
+    CPU_TS32     LatPrev;                                       /* Latency of last echo rx'd, in TS units.              */
+    CPU_INT64U   JitterSum;                                     /* Sum of latency diffs, in TS units. See Note #2c.     */
+    CPU_INT32U   ErrNbr;
+} APP_MQTTc_ECHO_BENCH_CONN;
+#endif
 
 /*
 *********************************************************************************************************
@@ -85,13 +203,42 @@ static  CPU_INT08U   AppMQTTc_TaskStk[APP_MQTTc_TASK_STK_SIZE];
 
 static  MQTTc_CONN   AppMQTTc_Conn;
 static  MQTTc_MSG    AppMQTTc_StatusMsg;
-static  MQTTc_MSG    AppMQTTc_EchoMsg;
+static  MQTTc_MSG    AppMQTTc_EchoMsgTbl[APP_MQTTc_ECHO_MSG_NBR];
 static  MQTTc_MSG    AppMQTTc_ListenRxMsg;
-static  CPU_INT08U   AppMQTTc_BufTbl[APP_MQTTc_MSG_QTY][APP_MQTTc_MSG_LEN_MAX];
+static  CPU_INT08U   AppMQTTc_BufTbl[2u + APP_MQTTc_ECHO_MSG_NBR][APP_MQTTc_MSG_LEN_MAX];
 static  CPU_CHAR     AppMQTTc_Payload[APP_MQTTc_PAYLOAD_LEN_MAX];
 
 static  CPU_BOOLEAN  App_MQTTc_StatusMsgIsAvail;
-static  CPU_BOOLEAN  App_MQTTc_EchoMsgIsAvail;
+static  CPU_BOOLEAN  App_MQTTc_EchoMsgIsAvailTbl[APP_MQTTc_ECHO_MSG_NBR];
+
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+static  CPU_INT08U                 AppMQTTc_EchoBenchTaskStk[APP_MQTTc_ECHO_BENCH_TASK_STK_SIZE];
+static  KAL_SEM_HANDLE             AppMQTTc_EchoBenchSem;
+
+static  APP_MQTTc_ECHO_BENCH_CONN  AppMQTTc_EchoBenchConnTbl[APP_MQTTc_ECHO_BENCH_CONN_NBR];
+static  CPU_BOOLEAN                AppMQTTc_EchoBenchStepIsActive;
+
+static  CPU_TS32                   AppMQTTc_EchoBenchSampleTbl[APP_MQTTc_ECHO_BENCH_SAMPLE_NBR_MAX];
+static  CPU_INT32U                 AppMQTTc_EchoBenchSampleNbr;
+
+static  const  CPU_CHAR  *AppMQTTc_EchoBenchClientID_Tbl[] = {
+    "App_MQTT_EchoBench0", "App_MQTT_EchoBench1", "App_MQTT_EchoBench2", "App_MQTT_EchoBench3"
+};
+
+                                                                /* See Note #2b.                                        */
+static  const  APP_MQTTc_ECHO_BENCH_STEP  AppMQTTc_EchoBenchStepTbl[] = {
+                                                                /* Rate, payload len, msg nbr.                          */
+    {   10u,    16u,   100u },
+    {  100u,    16u,  1000u },
+    {  500u,    16u,  2000u },
+    { 1000u,    16u,  2000u },
+    {  100u,   128u,  1000u },
+    {  100u,   512u,  1000u },
+    {  500u,   512u,  2000u }
+};
+
+#define  APP_MQTTc_ECHO_BENCH_STEP_NBR             (sizeof(AppMQTTc_EchoBenchStepTbl) / sizeof(APP_MQTTc_ECHO_BENCH_STEP))
+#endif
 
 
 const  NET_TASK_CFG  AppMQTTc_TaskCfg = {                       /* Cfg for MQTTc internal task.                         */
@@ -148,6 +295,39 @@ static  void  AppMQTTc_OnErrCallbackFnct          (       MQTTc_CONN  *p_conn,
                                                           void        *p_arg,
                                                           MQTTc_ERR    err);
 
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+static  void         AppMQTTc_EchoBenchTask                   (       void                       *p_arg);
+
+static  CPU_BOOLEAN  AppMQTTc_EchoBenchConnOpen               (       APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn);
+
+static  CPU_BOOLEAN  AppMQTTc_EchoBenchPend                   (       CPU_INT32U                  nbr);
+
+static  void         AppMQTTc_EchoBenchStepRun                (const  APP_MQTTc_ECHO_BENCH_STEP  *p_step);
+
+static  void         AppMQTTc_EchoBenchPublish                (       APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn,
+                                                               const  APP_MQTTc_ECHO_BENCH_STEP  *p_step);
+
+static  void         AppMQTTc_EchoBenchStepPrint              (const  APP_MQTTc_ECHO_BENCH_STEP  *p_step,
+                                                                      CPU_BOOLEAN                 is_first);
+
+static  void         AppMQTTc_EchoBenchOnCmplCallbackFnct     (       MQTTc_CONN                 *p_conn,
+                                                                      MQTTc_MSG                  *p_msg,
+                                                                      void                       *p_arg,
+                                                                      MQTTc_ERR                   err);
+
+static  void         AppMQTTc_EchoBenchOnPublishRxCallbackFnct(       MQTTc_CONN                 *p_conn,
+                                                               const  CPU_CHAR                   *topic_name_str,
+                                                                      CPU_INT32U                  topic_len,
+                                                               const  CPU_CHAR                   *p_payload,
+                                                                      CPU_INT32U                  payload_len,
+                                                                      void                       *p_arg,
+                                                                      MQTTc_ERR                   err);
+
+static  void         AppMQTTc_EchoBenchOnErrCallbackFnct      (       MQTTc_CONN                 *p_conn,
+                                                                      void                       *p_arg,
+                                                                      MQTTc_ERR                   err);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -162,17 +342,37 @@ static  void  AppMQTTc_OnErrCallbackFnct          (       MQTTc_CONN  *p_conn,
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The bench task waits for the echo conn to be subscribed before it starts. See
+*                   'app_mqtt-c_echo.c  Note #2'.
 *********************************************************************************************************
 */
 
 CPU_BOOLEAN  AppMQTTc_Init (void)
 {
-    MQTTc_ERR  err_mqttc;
+    CPU_INT08U       ix;
+    MQTTc_ERR        err_mqttc;
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+    KAL_TASK_HANDLE  task_handle;
+    KAL_ERR          err_kal;
+#if (APP_MQTTc_ECHO_BENCH_BROKER_STUB_EN == DEF_ENABLED)
+    CPU_BOOLEAN      is_ok;
+#endif
+#endif
 
 
     App_MQTTc_StatusMsgIsAvail = DEF_YES;
-    App_MQTTc_EchoMsgIsAvail   = DEF_YES;
+    for (ix = 0u; ix < APP_MQTTc_ECHO_MSG_NBR; ix++) {
+        App_MQTTc_EchoMsgIsAvailTbl[ix] = DEF_YES;
+    }
+
+#if ((APP_MQTTc_ECHO_BENCH_EN            == DEF_ENABLED) && \
+     (APP_MQTTc_ECHO_BENCH_BROKER_STUB_EN == DEF_ENABLED))
+    is_ok = AppMQTTc_BenchBrokerInit();
+    if (is_ok != DEF_OK) {
+        printf("!!! APP ERROR !!! Failed to init bench broker.\n\r.");
+        return (DEF_FAIL);
+    }
+#endif
 
     MQTTc_Init(&AppMQTTc_Cfg,
                &AppMQTTc_TaskCfg,
@@ -187,14 +387,15 @@ CPU_BOOLEAN  AppMQTTc_Init (void)
     MQTTc_MsgSetParam(&AppMQTTc_StatusMsg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_BufTbl[0u],   &err_mqttc);
     MQTTc_MsgSetParam(&AppMQTTc_StatusMsg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_MSG_LEN_MAX, &err_mqttc);
 
-    MQTTc_MsgClr(&AppMQTTc_EchoMsg, &err_mqttc);
-    MQTTc_MsgSetParam(&AppMQTTc_EchoMsg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_BufTbl[1u],   &err_mqttc);
-    MQTTc_MsgSetParam(&AppMQTTc_EchoMsg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_MSG_LEN_MAX, &err_mqttc);
-
     MQTTc_MsgClr(&AppMQTTc_ListenRxMsg, &err_mqttc);
-    MQTTc_MsgSetParam(&AppMQTTc_ListenRxMsg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_BufTbl[2u],   &err_mqttc);
+    MQTTc_MsgSetParam(&AppMQTTc_ListenRxMsg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_BufTbl[1u],   &err_mqttc);
     MQTTc_MsgSetParam(&AppMQTTc_ListenRxMsg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_MSG_LEN_MAX, &err_mqttc);
 
+    for (ix = 0u; ix < APP_MQTTc_ECHO_MSG_NBR; ix++) {
+        MQTTc_MsgClr(&AppMQTTc_EchoMsgTbl[ix], &err_mqttc);
+        MQTTc_MsgSetParam(&AppMQTTc_EchoMsgTbl[ix], MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&AppMQTTc_BufTbl[2u + ix], &err_mqttc);
+        MQTTc_MsgSetParam(&AppMQTTc_EchoMsgTbl[ix], MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_MSG_LEN_MAX,    &err_mqttc);
+    }
 
     MQTTc_ConnClr(&AppMQTTc_Conn,
                   &err_mqttc);
@@ -204,12 +405,15 @@ CPU_BOOLEAN  AppMQTTc_Init (void)
     }
 
                                                                 /* Err handling should be done, in your application.    */
-    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_BROKER_NAME,                  (void *) APP_MQTTc_BROKER_NAME,                  &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_BROKER_NAME,                  (void *) APP_MQTTc_ECHO_BROKER_NAME,             &err_mqttc);
+    MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_BROKER_PORT_NBR,              (void *) APP_MQTTc_ECHO_BROKER_PORT_NBR,         &err_mqttc);
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CLIENT_ID_STR,                (void *)"App_MQTT_TestClientID",                 &err_mqttc);
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_USERNAME_STR,                 (void *) APP_MQTTc_USERNAME,                     &err_mqttc);
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_PASSWORD_STR,                 (void *) APP_MQTTc_PASSWORD,                     &err_mqttc);
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_KEEP_ALIVE_TMR_SEC,           (void *) 1000u,                                  &err_mqttc);
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_DISABLED)                   /* Gen callback prints every cmpl, not when benching.   */
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_COMPL,            (void *) AppMQTTc_OnCmplCallbackFnct,            &err_mqttc);
+#endif
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_CONNECT_CMPL,     (void *) AppMQTTc_OnConnectCmplCallbackFnct,     &err_mqttc);
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_CMPL,     (void *) AppMQTTc_OnPublishCmplCallbackFnct,     &err_mqttc);
     MQTTc_ConnSetParam(&AppMQTTc_Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_SUBSCRIBE_CMPL,   (void *) AppMQTTc_OnSubscribeCmplCallbackFnct,   &err_mqttc);
@@ -220,6 +424,37 @@ CPU_BOOLEAN  AppMQTTc_Init (void)
 
     printf("Done setting params.\r\n");
 
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+    AppMQTTc_EchoBenchSem = KAL_SemCreate("App MQTTc Echo Bench Sem",
+                                           DEF_NULL,
+                                          &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to create echo bench sem. Err: %i\n\r.", err_kal);
+        return (DEF_FAIL);
+    }
+
+    task_handle = KAL_TaskAlloc("App MQTTc Echo Bench Task",
+                       (void *)&AppMQTTc_EchoBenchTaskStk[0u],
+                                APP_MQTTc_ECHO_BENCH_TASK_STK_SIZE,
+                                DEF_NULL,
+                               &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to alloc echo bench task. Err: %i\n\r.", err_kal);
+        return (DEF_FAIL);
+    }
+
+    KAL_TaskCreate(task_handle,                                 /* See Note #1.                                         */
+                   AppMQTTc_EchoBenchTask,
+                   DEF_NULL,
+                   APP_MQTTc_ECHO_BENCH_TASK_PRIO,
+                   DEF_NULL,
+                  &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to create echo bench task. Err: %i\n\r.", err_kal);
+        return (DEF_FAIL);
+    }
+#endif
+
     MQTTc_ConnOpen(&AppMQTTc_Conn,                              /* Open conn to MQTT server with parameters set in Conn.*/
                     MQTTc_FLAGS_NONE,
                    &err_mqttc);
@@ -391,6 +626,9 @@ static  void  AppMQTTc_OnPublishCmplCallbackFnct (MQTTc_CONN  *p_conn,
                                                   void        *p_arg,
                                                   MQTTc_ERR    err)
 {
+    CPU_INT08U  ix;
+
+
     (void)&p_conn;
     (void)&p_arg;
 
@@ -400,9 +638,14 @@ static  void  AppMQTTc_OnPublishCmplCallbackFnct (MQTTc_CONN  *p_conn,
         if (p_msg == &AppMQTTc_StatusMsg) {
             printf("PublishCmpl callback called for status. Marking message as available.\n\r");
             App_MQTTc_StatusMsgIsAvail = DEF_YES;               /* Mark msg as re-available.                            */
-        } else {
-            printf("PublishCmpl callback called for status. Marking message as available.\n\r");
-            App_MQTTc_EchoMsgIsAvail = DEF_YES;                 /* Mark msg as re-available.                            */
+            return;
+        }
+    }
+
+    for (ix = 0u; ix < APP_MQTTc_ECHO_MSG_NBR; ix++) {          /* Mark echo msg as re-available, even on err.          */
+        if (p_msg == &AppMQTTc_EchoMsgTbl[ix]) {
+            App_MQTTc_EchoMsgIsAvailTbl[ix] = DEF_YES;
+            break;
         }
     }
 }
@@ -438,6 +681,9 @@ static  void  AppMQTTc_OnSubscribeCmplCallbackFnct (MQTTc_CONN  *p_conn,
 {
     CPU_INT16U   payload_len;
     CPU_CHAR    *p_payload = &AppMQTTc_Payload[0];
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+    KAL_ERR      err_kal;
+#endif
 
 
     (void)&p_arg;
@@ -462,6 +708,10 @@ static  void  AppMQTTc_OnSubscribeCmplCallbackFnct (MQTTc_CONN  *p_conn,
         if (err != MQTTc_ERR_NONE) {
             printf("!!! APP ERROR !!! Failed to Publish Status. Err: %i\n\r.", err);
         }
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+        KAL_SemPost(AppMQTTc_EchoBenchSem, KAL_OPT_POST_NONE, &err_kal);
+        (void)&err_kal;                                         /* Echo conn is ready, start bench.                     */
+#endif
     }
 }
 
@@ -478,18 +728,21 @@ static  void  AppMQTTc_OnSubscribeCmplCallbackFnct (MQTTc_CONN  *p_conn,
 *
 *               topic_len       Length of the topic.
 *
-*               p_payload       NULL-terminated buffer containing the payload received.
+*               p_payload       Buffer containing the payload received. NOT NULL-terminated.
 *
 *               payload_len     Length of the received payload
 *
 *               p_arg           Pointer to argument set in MQTTc Connection using the parameter type
 *                               MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR.
 *
+*               err             Error code.
+*
 * Return(s)   : none.
 *
 * Caller(s)   : MQTTc module.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The payload is echoed byte for byte, so that the bench hdr comes back as it was sent.
+*                   See 'app_mqtt-c_echo.c  Note #2a'.
 *********************************************************************************************************
 */
 
@@ -501,8 +754,8 @@ static  void  AppMQTTc_OnPublishRxCallbackFnct (       MQTTc_CONN  *p_conn,
                                                        void        *p_arg,
                                                        MQTTc_ERR    err)
 {
-    CPU_INT16U   payload_len;
-    CPU_CHAR    *p_payload = &AppMQTTc_Payload[0];
+    CPU_INT08U   ix;
+    CPU_CHAR    *p_status_payload = &AppMQTTc_Payload[0];
 
 
     (void)&p_arg;
@@ -512,36 +765,47 @@ static  void  AppMQTTc_OnPublishRxCallbackFnct (       MQTTc_CONN  *p_conn,
         return;
     }
 
-    printf("Received PUBLISH message from server. Topic is %.*s.", topic_len, topic_name_str);
-    printf(" Message is %s.\n\r", p_payload);
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_DISABLED)                   /* Printing would skew the latency of the bench.        */
+    printf("Received PUBLISH message from server. Topic is %.*s.", (int)topic_len, topic_name_str);
+    printf(" Message is %.*s.\n\r", (int)payload_len, p_payload);
+#else
+    (void)&topic_name_str;
+    (void)&topic_len;
+#endif
+
+    for (ix = 0u; ix < APP_MQTTc_ECHO_MSG_NBR; ix++) {          /* Find an echo msg that is avail.                      */
+        if (App_MQTTc_EchoMsgIsAvailTbl[ix] == DEF_YES) {
+            break;
+        }
+    }
 
-    if (App_MQTTc_EchoMsgIsAvail == DEF_YES) {
-        App_MQTTc_EchoMsgIsAvail = DEF_NO;
-        MQTTc_Publish(p_conn,
-                     &AppMQTTc_EchoMsg,
-                      APP_MQTTc_DOMAIN_PUBLISH_STATUS,
-                      APP_MQTTc_DOMAIN_PUBLISH_STATUS_QoS,
+    if (ix < APP_MQTTc_ECHO_MSG_NBR) {
+        App_MQTTc_EchoMsgIsAvailTbl[ix] = DEF_NO;
+        MQTTc_Publish(p_conn,                                   /* Echo payload as rx'd. See Note #1.                   */
+                     &AppMQTTc_EchoMsgTbl[ix],
+                      APP_MQTTc_DOMAIN_PUBLISH_ECHO,
+                      APP_MQTTc_DOMAIN_PUBLISH_ECHO_QoS,
                       DEF_NO,
                       p_payload,
-                      Str_Len(p_payload),
+                      payload_len,
                      &err);
         if (err != MQTTc_ERR_NONE) {
+            App_MQTTc_EchoMsgIsAvailTbl[ix] = DEF_YES;
             printf("!!! APP ERROR !!! Failed to Echo received message. Err: %i\n\r.", err);
         }
     } else if (App_MQTTc_StatusMsgIsAvail == DEF_YES) {
         App_MQTTc_StatusMsgIsAvail = DEF_NO;
 
-        Str_Copy(p_payload,                                      /* Copy the string to publish to the payload buffer     */
+        Str_Copy(p_status_payload,                              /* Copy the string to publish to the payload buffer     */
                 "Unable to send echo msg: msg unavailable.");
-        payload_len = Str_Len(p_payload);                        /* Determine the length of the string we're publishing  */
 
         MQTTc_Publish(p_conn,
                      &AppMQTTc_StatusMsg,
                       APP_MQTTc_DOMAIN_PUBLISH_STATUS,
                       APP_MQTTc_DOMAIN_PUBLISH_STATUS_QoS,
                       DEF_NO,
-                      p_payload,
-                      payload_len,
+                      p_status_payload,
+                      Str_Len(p_status_payload),
                      &err);
         if (err != MQTTc_ERR_NONE) {
             printf("!!! APP ERROR !!! Failed to Publish Status. Err: %i\n\r.", err);
@@ -609,3 +873,624 @@ static  void  AppMQTTc_OnErrCallbackFnct (MQTTc_CONN  *p_conn,
         printf("Unable to send status, message is not available.\r\n");
     }
 }
+
+
+#if (APP_MQTTc_ECHO_BENCH_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_EchoBenchTask()
+*
+* Description : Open the bench conns, run every step of the bench and print the results.
+*
+* Arguments   : p_arg           Unused.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : KAL, via AppMQTTc_Init().
+*
+* Note(s)     : (1) Every bench conn subscribes to the echo topic, so each one rx's the echoes of every
+*                   conn. Echoes of other conns are ignored by AppMQTTc_EchoBenchOnPublishRxCallbackFnct().
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchTask (void  *p_arg)
+{
+    APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn;
+    CPU_INT32U                  ix;
+    CPU_BOOLEAN                 is_ok;
+    MQTTc_ERR                   err_mqttc;
+
+
+    (void)&p_arg;
+
+    is_ok = AppMQTTc_EchoBenchPend(1u);                         /* Wait for echo conn to be subscribed.                 */
+    if (is_ok != DEF_OK) {
+        printf("!!! APP ERROR !!! Echo conn not ready. Bench NOT run.\n\r");
+        return;
+    }
+
+    AppMQTTc_EchoBenchStepIsActive = DEF_NO;
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {
+        p_bench_conn     = &AppMQTTc_EchoBenchConnTbl[ix];
+        p_bench_conn->Ix =  ix;
+        is_ok            =  AppMQTTc_EchoBenchConnOpen(p_bench_conn);
+        if (is_ok != DEF_OK) {
+            return;
+        }
+    }
+    is_ok = AppMQTTc_EchoBenchPend(APP_MQTTc_ECHO_BENCH_CONN_NBR);
+    if (is_ok != DEF_OK) {
+        return;
+    }
+
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {   /* See Note #1.                                         */
+        p_bench_conn = &AppMQTTc_EchoBenchConnTbl[ix];
+        MQTTc_Subscribe(&p_bench_conn->Conn,
+                        &p_bench_conn->MsgTbl[0u],
+                         APP_MQTTc_DOMAIN_PUBLISH_ECHO,
+                         APP_MQTTc_ECHO_BENCH_QoS,
+                        &err_mqttc);
+        if (err_mqttc != MQTTc_ERR_NONE) {
+            printf("!!! APP ERROR !!! Failed to subscribe bench conn to echo topic. Err: %i\n\r.", err_mqttc);
+            return;
+        }
+    }
+    is_ok = AppMQTTc_EchoBenchPend(APP_MQTTc_ECHO_BENCH_CONN_NBR);
+    if (is_ok != DEF_OK) {
+        return;
+    }
+
+    printf("{\"suite\":\"mqttc_echo\",\"conn_nbr\":%u,\"steps\":[\n\r", (unsigned int)APP_MQTTc_ECHO_BENCH_CONN_NBR);
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_STEP_NBR; ix++) {
+        AppMQTTc_EchoBenchStepRun(&AppMQTTc_EchoBenchStepTbl[ix]);
+        AppMQTTc_EchoBenchStepPrint(&AppMQTTc_EchoBenchStepTbl[ix], (ix == 0u) ? DEF_YES : DEF_NO);
+    }
+    printf("\n\r]}\n\r");
+
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {
+        MQTTc_ConnClose(&AppMQTTc_EchoBenchConnTbl[ix].Conn,
+                         MQTTc_FLAGS_NONE,
+                        &err_mqttc);
+    }
+    printf("Echo bench completed.\n\r");
+
+    while (DEF_ON) {
+        KAL_Dly(1000u);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_EchoBenchConnOpen()
+*
+* Description : Open a bench conn and send its CONNECT msg.
+*
+* Arguments   : p_bench_conn    Pointer to bench conn to open.
+*
+* Return(s)   : DEF_OK,   if NO error(s),
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : AppMQTTc_EchoBenchTask().
+*
+* Note(s)     : (1) The generic callback handles the cmpl of every msg type of the bench conns.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_EchoBenchConnOpen (APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn)
+{
+    CPU_INT08U  win;
+    MQTTc_ERR   err_mqttc;
+
+
+    p_bench_conn->ErrNbr = 0u;
+    Mem_Set(p_bench_conn->PayloadBuf, 'e', APP_MQTTc_ECHO_BENCH_PAYLOAD_LEN_MAX);
+
+    for (win = 0u; win < APP_MQTTc_ECHO_BENCH_WIN_SIZE; win++) {
+        p_bench_conn->MsgIsAvailTbl[win] = DEF_YES;
+        MQTTc_MsgClr(&p_bench_conn->MsgTbl[win], &err_mqttc);
+        MQTTc_MsgSetParam(&p_bench_conn->MsgTbl[win], MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&p_bench_conn->MsgBufTbl[win][0u], &err_mqttc);
+        MQTTc_MsgSetParam(&p_bench_conn->MsgTbl[win], MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_MSG_LEN_MAX,            &err_mqttc);
+    }
+    MQTTc_MsgClr(&p_bench_conn->RxMsg, &err_mqttc);
+    MQTTc_MsgSetParam(&p_bench_conn->RxMsg, MQTTc_PARAM_TYPE_MSG_BUF_PTR, (void *)&p_bench_conn->RxMsgBuf[0u], &err_mqttc);
+    MQTTc_MsgSetParam(&p_bench_conn->RxMsg, MQTTc_PARAM_TYPE_MSG_BUF_LEN, (void *) APP_MQTTc_MSG_LEN_MAX,      &err_mqttc);
+
+    MQTTc_ConnClr(&p_bench_conn->Conn, &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to clr MQTTc connection object. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+                                                                /* Err handling should be done, in your application.    */
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_BROKER_NAME,              (void *) APP_MQTTc_ECHO_BROKER_NAME,                   &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_BROKER_PORT_NBR,          (void *) APP_MQTTc_ECHO_BROKER_PORT_NBR,               &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CLIENT_ID_STR,            (void *) AppMQTTc_EchoBenchClientID_Tbl[p_bench_conn->Ix], &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_KEEP_ALIVE_TMR_SEC,       (void *) 1000u,                                        &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_COMPL,        (void *) AppMQTTc_EchoBenchOnCmplCallbackFnct,         &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX,   (void *) AppMQTTc_EchoBenchOnPublishRxCallbackFnct,    &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ON_ERR_CALLBACK, (void *) AppMQTTc_EchoBenchOnErrCallbackFnct,          &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR,         (void *) p_bench_conn,                                 &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_PUBLISH_RX_MSG_PTR,       (void *)&p_bench_conn->RxMsg,                          &err_mqttc);
+    MQTTc_ConnSetParam(&p_bench_conn->Conn, MQTTc_PARAM_TYPE_TIMEOUT_MS,               (void *) 30000u,                                       &err_mqttc);
+
+    MQTTc_ConnOpen(&p_bench_conn->Conn,
+                    MQTTc_FLAGS_NONE,
+                   &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to open TCP connection to broker. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    MQTTc_Connect(&p_bench_conn->Conn,                          /* See Note #1.                                         */
+                  &p_bench_conn->MsgTbl[0u],
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        printf("!!! APP ERROR !!! Failed to process Connect msg req. Err: %i\n\r.", err_mqttc);
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       AppMQTTc_EchoBenchPend()
+*
+* Description : Wait for the callbacks to signal a nbr of events.
+*
+* Arguments   : nbr             Nbr of events to wait for.
+*
+* Return(s)   : DEF_OK,   if every event was signaled without error,
+*               DEF_FAIL, otherwise.
+*
+* Caller(s)   : AppMQTTc_EchoBenchTask().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppMQTTc_EchoBenchPend (CPU_INT32U  nbr)
+{
+    CPU_INT32U  ix;
+    KAL_ERR     err_kal;
+
+
+    for (ix = 0u; ix < nbr; ix++) {
+        KAL_SemPend(AppMQTTc_EchoBenchSem,
+                    KAL_OPT_PEND_NONE,
+                    APP_MQTTc_ECHO_BENCH_TIMEOUT_MS,
+                   &err_kal);
+        if (err_kal != KAL_ERR_NONE) {
+            printf("!!! APP ERROR !!! Echo bench timed out. Err: %i\n\r.", err_kal);
+            return (DEF_FAIL);
+        }
+    }
+
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {
+        if (AppMQTTc_EchoBenchConnTbl[ix].ErrNbr > 0u) {
+            printf("!!! APP ERROR !!! Echo bench conn %u failed.\n\r", (unsigned int)ix);
+            return (DEF_FAIL);
+        }
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_EchoBenchStepRun()
+*
+* Description : Run a step of the bench.
+*
+* Arguments   : p_step          Pointer to step to run.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_EchoBenchTask().
+*
+* Note(s)     : (1) The msgs are paced against the time elapsed since the start of the step, so that a late
+*                   wake-up is caught up by the next ones. A msg that finds no free msg in the window of its
+*                   conn is skipped and counted, rather than delayed.
+*
+*               (2) The samples of every conn are sorted together, by insertion, for the percentiles.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchStepRun (const  APP_MQTTc_ECHO_BENCH_STEP  *p_step)
+{
+    APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn;
+    CPU_INT32U                  ix;
+    CPU_INT32U                  ix_ins;
+    CPU_INT32U                  msg_nbr;
+    CPU_INT32U                  due_nbr;
+    CPU_INT32U                  ts_start_ms;
+    CPU_INT32U                  elapsed_ms;
+    CPU_TS32                    sample;
+
+
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {
+        p_bench_conn               = &AppMQTTc_EchoBenchConnTbl[ix];
+        p_bench_conn->TxNbr        =  0u;
+        p_bench_conn->TxSkipNbr    =  0u;
+        p_bench_conn->RxNbr        =  0u;
+        p_bench_conn->ReorderNbr   =  0u;
+        p_bench_conn->SeqMax       =  0u;
+        p_bench_conn->LatPrev      =  0u;
+        p_bench_conn->JitterSum    =  0u;
+        p_bench_conn->ErrNbr       =  0u;
+    }
+    AppMQTTc_EchoBenchSampleNbr    = 0u;
+    AppMQTTc_EchoBenchStepIsActive = DEF_YES;
+
+    msg_nbr     = 0u;
+    ts_start_ms = NetUtil_TS_Get_ms();
+    while (msg_nbr < p_step->MsgNbr) {                          /* See Note #1.                                         */
+        elapsed_ms = NetUtil_TS_Get_ms() - ts_start_ms;
+        due_nbr    = (CPU_INT32U)(((CPU_INT64U)elapsed_ms * p_step->Rate) / DEF_TIME_NBR_mS_PER_SEC) + 1u;
+        due_nbr    =  DEF_MIN(due_nbr, p_step->MsgNbr);
+        while (msg_nbr < due_nbr) {
+            for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {
+                AppMQTTc_EchoBenchPublish(&AppMQTTc_EchoBenchConnTbl[ix], p_step);
+            }
+            msg_nbr++;
+        }
+        KAL_Dly(1u);
+    }
+
+    KAL_Dly(APP_MQTTc_ECHO_BENCH_DRAIN_MS);                     /* Wait for the last echoes.                            */
+    AppMQTTc_EchoBenchStepIsActive = DEF_NO;
+
+    for (ix = 1u; ix < AppMQTTc_EchoBenchSampleNbr; ix++) {     /* See Note #2.                                         */
+        sample = AppMQTTc_EchoBenchSampleTbl[ix];
+        ix_ins = ix;
+        while ((ix_ins > 0u) &&
+               (AppMQTTc_EchoBenchSampleTbl[ix_ins - 1u] > sample)) {
+            AppMQTTc_EchoBenchSampleTbl[ix_ins] = AppMQTTc_EchoBenchSampleTbl[ix_ins - 1u];
+            ix_ins--;
+        }
+        AppMQTTc_EchoBenchSampleTbl[ix_ins] = sample;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     AppMQTTc_EchoBenchPublish()
+*
+* Description : Publish the next msg of a bench conn, if a msg of its window is avail.
+*
+* Arguments   : p_bench_conn    Pointer to bench conn on which to publish.
+*
+*               p_step          Pointer to step being run.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_EchoBenchStepRun().
+*
+* Note(s)     : (1) The hdr is copied to the payload buf, since the start of the payload is not aligned
+*                   once rx'd. See 'app_mqtt-c_echo.c  Note #2a'.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchPublish (       APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn,
+                                         const  APP_MQTTc_ECHO_BENCH_STEP  *p_step)
+{
+    APP_MQTTc_ECHO_BENCH_HDR  hdr;
+    CPU_INT08U                win;
+    CPU_INT32U                payload_len;
+    MQTTc_ERR                 err_mqttc;
+
+
+    for (win = 0u; win < APP_MQTTc_ECHO_BENCH_WIN_SIZE; win++) {
+        if (p_bench_conn->MsgIsAvailTbl[win] == DEF_YES) {
+            break;
+        }
+    }
+    if (win >= APP_MQTTc_ECHO_BENCH_WIN_SIZE) {
+        p_bench_conn->TxSkipNbr++;
+        return;
+    }
+
+    payload_len = DEF_MIN(p_step->PayloadLen, APP_MQTTc_ECHO_BENCH_PAYLOAD_LEN_MAX);
+    payload_len = DEF_MAX(payload_len,        sizeof(hdr));
+
+    hdr.ConnIx = p_bench_conn->Ix;
+    hdr.Seq    = p_bench_conn->TxNbr;
+    hdr.TS     = CPU_TS_Get32();
+    Mem_Copy(p_bench_conn->PayloadBuf, &hdr, sizeof(hdr));      /* See Note #1.                                         */
+
+    p_bench_conn->MsgIsAvailTbl[win] = DEF_NO;
+    MQTTc_Publish(&p_bench_conn->Conn,
+                  &p_bench_conn->MsgTbl[win],
+                   APP_MQTTc_DOMAIN_SUBSCRIBE_LISTEN,
+                   APP_MQTTc_ECHO_BENCH_QoS,
+                   DEF_NO,
+                   p_bench_conn->PayloadBuf,
+                   payload_len,
+                  &err_mqttc);
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        p_bench_conn->MsgIsAvailTbl[win] = DEF_YES;
+        p_bench_conn->ErrNbr++;
+        return;
+    }
+
+    p_bench_conn->TxNbr++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                    AppMQTTc_EchoBenchStepPrint()
+*
+* Description : Print the results of a step as an entry of the JSON steps array.
+*
+* Arguments   : p_step          Pointer to step that was run.
+*
+*               is_first        DEF_YES, if first entry of the array.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : AppMQTTc_EchoBenchTask().
+*
+* Note(s)     : (1) The msgs published but never echoed are counted as lost. The msgs skipped, since no msg
+*                   was avail in the window of their conn, are counted apart.
+*
+*               (2) The jitter is the mean over every conn. See 'app_mqtt-c_echo.c  Note #2c'.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchStepPrint (const  APP_MQTTc_ECHO_BENCH_STEP  *p_step,
+                                                  CPU_BOOLEAN                 is_first)
+{
+    APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn;
+    CPU_INT32U                  ix;
+    CPU_INT32U                  tx_nbr;
+    CPU_INT32U                  tx_skip_nbr;
+    CPU_INT32U                  rx_nbr;
+    CPU_INT32U                  reorder_nbr;
+    CPU_INT32U                  err_nbr;
+    CPU_INT32U                  diff_nbr;
+    CPU_INT64U                  jitter_sum;
+    CPU_INT32U                  sample_nbr;
+    CPU_INT32U                  lat_p50_us;
+    CPU_INT32U                  lat_p90_us;
+    CPU_INT32U                  lat_p99_us;
+    CPU_INT32U                  lat_max_us;
+    CPU_INT32U                  jitter_us;
+
+
+    tx_nbr      = 0u;
+    tx_skip_nbr = 0u;
+    rx_nbr      = 0u;
+    reorder_nbr = 0u;
+    err_nbr     = 0u;
+    diff_nbr    = 0u;
+    jitter_sum  = 0u;
+    for (ix = 0u; ix < APP_MQTTc_ECHO_BENCH_CONN_NBR; ix++) {
+        p_bench_conn  = &AppMQTTc_EchoBenchConnTbl[ix];
+        tx_nbr       +=  p_bench_conn->TxNbr;
+        tx_skip_nbr  +=  p_bench_conn->TxSkipNbr;
+        rx_nbr       +=  p_bench_conn->RxNbr;
+        reorder_nbr  +=  p_bench_conn->ReorderNbr;
+        err_nbr      +=  p_bench_conn->ErrNbr;
+        jitter_sum   +=  p_bench_conn->JitterSum;
+        if (p_bench_conn->RxNbr > 1u) {
+            diff_nbr += p_bench_conn->RxNbr - 1u;
+        }
+    }
+
+    lat_p50_us = 0u;
+    lat_p90_us = 0u;
+    lat_p99_us = 0u;
+    lat_max_us = 0u;
+    sample_nbr = AppMQTTc_EchoBenchSampleNbr;
+    if (sample_nbr > 0u) {
+        lat_p50_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_EchoBenchSampleTbl[(sample_nbr * 50u) / 100u]);
+        lat_p90_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_EchoBenchSampleTbl[(sample_nbr * 90u) / 100u]);
+        lat_p99_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_EchoBenchSampleTbl[(sample_nbr * 99u) / 100u]);
+        lat_max_us = (CPU_INT32U)CPU_TS32_to_uSec(AppMQTTc_EchoBenchSampleTbl[sample_nbr - 1u]);
+    }
+
+    jitter_us = 0u;
+    if (diff_nbr > 0u) {                                        /* See Note #2.                                         */
+        jitter_us = (CPU_INT32U)CPU_TS32_to_uSec((CPU_TS32)(jitter_sum / diff_nbr));
+    }
+
+    printf("%s{\"rate\":%u,\"payload_len\":%u,\"msg_nbr\":%u,\"tx_nbr\":%u,\"tx_skip_nbr\":%u,\"rx_nbr\":%u,",
+           (is_first == DEF_YES) ? "" : ",\n\r",
+           (unsigned int)p_step->Rate,
+           (unsigned int)p_step->PayloadLen,
+           (unsigned int)p_step->MsgNbr,
+           (unsigned int)tx_nbr,
+           (unsigned int)tx_skip_nbr,
+           (unsigned int)rx_nbr);
+                                                                /* See Note #1.                                         */
+    printf("\"lost_nbr\":%u,\"reorder_nbr\":%u,\"err_nbr\":%u,",
+           (unsigned int)((tx_nbr > rx_nbr) ? (tx_nbr - rx_nbr) : 0u),
+           (unsigned int)reorder_nbr,
+           (unsigned int)err_nbr);
+    printf("\"lat_p50_us\":%u,\"lat_p90_us\":%u,\"lat_p99_us\":%u,\"lat_max_us\":%u,\"jitter_us\":%u}",
+           (unsigned int)lat_p50_us,
+           (unsigned int)lat_p90_us,
+           (unsigned int)lat_p99_us,
+           (unsigned int)lat_max_us,
+           (unsigned int)jitter_us);
+}
+
+
+/*
+*********************************************************************************************************
+*                                AppMQTTc_EchoBenchOnCmplCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when an operation of a bench conn completes.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object for which operation has completed.
+*
+*               p_msg           Pointer to MQTTc Message object used for operation.
+*
+*               p_arg           Pointer to bench conn.
+*
+*               err             Error code from processing message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : (1) The bench task pends on the cmpl of CONNECT and SUBSCRIBE msgs. PUBLISH msgs release their
+*                   slot of the window.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchOnCmplCallbackFnct (MQTTc_CONN  *p_conn,
+                                                    MQTTc_MSG   *p_msg,
+                                                    void        *p_arg,
+                                                    MQTTc_ERR    err)
+{
+    APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn = (APP_MQTTc_ECHO_BENCH_CONN *)p_arg;
+    CPU_INT08U                  win;
+    KAL_ERR                     err_kal;
+
+
+    (void)&p_conn;
+
+    if (err != MQTTc_ERR_NONE) {
+        p_bench_conn->ErrNbr++;
+    }
+
+    switch (p_msg->Type) {                                      /* See Note #1.                                         */
+        case MQTTc_MSG_TYPE_CONNECT:
+        case MQTTc_MSG_TYPE_SUBSCRIBE:
+             KAL_SemPost(AppMQTTc_EchoBenchSem, KAL_OPT_POST_NONE, &err_kal);
+             (void)&err_kal;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBLISH:
+             for (win = 0u; win < APP_MQTTc_ECHO_BENCH_WIN_SIZE; win++) {
+                 if (p_msg == &p_bench_conn->MsgTbl[win]) {
+                     p_bench_conn->MsgIsAvailTbl[win] = DEF_YES;
+                     break;
+                 }
+             }
+             break;
+
+        default:
+             break;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                             AppMQTTc_EchoBenchOnPublishRxCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when a bench conn rx's an echo.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object that rx'd the echo.
+*
+*               topic_name_str  String containing the topic of the message received. NOT NULL-terminated.
+*
+*               topic_len       Length of the topic.
+*
+*               p_payload       Buffer containing the payload received. NOT NULL-terminated.
+*
+*               payload_len     Length of the received payload
+*
+*               p_arg           Pointer to bench conn.
+*
+*               err             Error code.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : (1) Every bench conn rx's the echoes of every conn. See AppMQTTc_EchoBenchTask() Note #1.
+*
+*               (2) An echo is reordered when a later msg of the same conn was echoed before it.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchOnPublishRxCallbackFnct (       MQTTc_CONN  *p_conn,
+                                                         const  CPU_CHAR    *topic_name_str,
+                                                                CPU_INT32U   topic_len,
+                                                         const  CPU_CHAR    *p_payload,
+                                                                CPU_INT32U   payload_len,
+                                                                void        *p_arg,
+                                                                MQTTc_ERR    err)
+{
+    APP_MQTTc_ECHO_BENCH_CONN  *p_bench_conn = (APP_MQTTc_ECHO_BENCH_CONN *)p_arg;
+    APP_MQTTc_ECHO_BENCH_HDR    hdr;
+    CPU_TS32                    lat;
+
+
+    (void)&p_conn;
+    (void)&topic_name_str;
+    (void)&topic_len;
+
+    if ((err                            != MQTTc_ERR_NONE) ||
+        (AppMQTTc_EchoBenchStepIsActive != DEF_YES)        ||
+        (payload_len                    <  sizeof(hdr))) {
+        return;
+    }
+
+    Mem_Copy(&hdr, p_payload, sizeof(hdr));                     /* See AppMQTTc_EchoBenchPublish() Note #1.             */
+    if (hdr.ConnIx != p_bench_conn->Ix) {                       /* See Note #1.                                         */
+        return;
+    }
+
+    lat = CPU_TS_Get32() - hdr.TS;
+
+    if ((p_bench_conn->RxNbr > 0u) &&                           /* See Note #2.                                         */
+        (hdr.Seq < p_bench_conn->SeqMax)) {
+        p_bench_conn->ReorderNbr++;
+    } else {
+        p_bench_conn->SeqMax = hdr.Seq;
+    }
+
+    if (p_bench_conn->RxNbr > 0u) {
+        p_bench_conn->JitterSum += (lat > p_bench_conn->LatPrev) ? (lat - p_bench_conn->LatPrev)
+                                                                 : (p_bench_conn->LatPrev - lat);
+    }
+    p_bench_conn->LatPrev = lat;
+    p_bench_conn->RxNbr++;
+
+    if (AppMQTTc_EchoBenchSampleNbr < APP_MQTTc_ECHO_BENCH_SAMPLE_NBR_MAX) {
+        AppMQTTc_EchoBenchSampleTbl[AppMQTTc_EchoBenchSampleNbr] = lat;
+        AppMQTTc_EchoBenchSampleNbr++;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                AppMQTTc_EchoBenchOnErrCallbackFnct()
+*
+* Description : Callback function for MQTTc module called when an error occurs on a bench conn.
+*
+* Arguments   : p_conn          Pointer to MQTTc Connection object on which error occurred.
+*
+*               p_arg           Pointer to bench conn.
+*
+*               err             Error code.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc module.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppMQTTc_EchoBenchOnErrCallbackFnct (MQTTc_CONN  *p_conn,
+                                                   void        *p_arg,
+                                                   MQTTc_ERR    err)
+{
+    (void)&p_conn;
+
+    ((APP_MQTTc_ECHO_BENCH_CONN *)p_arg)->ErrNbr++;
+
+    printf("!!! APP ERROR !!! Err detected via OnErr callback of echo bench conn. Err = %i.\n\r", err);
+}
+#endif
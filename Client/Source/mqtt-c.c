@@ -38,6 +38,7 @@
 #include  <lib_def.h>
 #include  <lib_str.h>
 #include  <cpu.h>
+#include  <cpu_core.h>
 
 #include  <mqtt-c_cfg.h>
 #include  <KAL/kal.h>
@@ -47,6 +48,15 @@
 
 #include  "mqtt-c.h"
 #include  "mqtt-c_sock.h"
+#include  "mqtt-c_store.h"
+#include  "mqtt-c_wal.h"
+#include  "mqtt-c_cache.h"
+#include  "mqtt-c_lat.h"
+#include  "mqtt-c_trace.h"
+#include  "mqtt-c_timeline.h"
+#include  "mqtt-c_cap.h"
+#include  "mqtt-c_prof.h"
+#include  "mqtt-c_mem.h"
 #include  "../../Common/mqtt.h"
 
 
@@ -58,11 +68,6 @@
 *********************************************************************************************************
 */
 
-                                                                /* Offset in Rx publish buf to provide room to send ... */
-                                                                /* a potential ACK without copying the whole buf.       */
-#define MQTTc_PUBLISH_RX_MSG_BUF_OFFSET                             4u
-
-
 /*
 *********************************************************************************************************
 *                                          DFLT VALUES DEFINES
@@ -72,23 +77,64 @@
 #define  MQTTc_TIMEOUT_MS_DFLT_VAL                             10000u
 #define  MQTTc_BROKER_PORT_NBR_DFLT_VAL                         1883u
 #define  MQTTc_KEEP_ALIVE_TIMER_SEC_DFLT_VAL                       0u
+#define  MQTTc_CACHE_SYNC_SETTLE_MS_DFLT_VAL                     100u
+
+
+/*
+*********************************************************************************************************
+*                                           TX RATE DEFINES
+*
+* Note(s) : (1) The buckets of the tx rate limiter hold tokens in thousandths of a message or of a byte, so
+*               that they can be refilled every millisecond without losing precision. Rates and bursts are
+*               bounded so that the content of a bucket always fits in 32 bits.
+*********************************************************************************************************
+*/
+
+#define  MQTTc_TX_RATE_TOKEN_SCALE                              1000u
+#define  MQTTc_TX_RATE_MAX_VAL                               1000000u
+
+
+/*
+*********************************************************************************************************
+*                                          MSG DEADLINE MACRO
+*
+* Note(s) : (1) Only PUBLISH messages have a deadline. See MQTTc_MsgSetParam() Note #3.
+*********************************************************************************************************
+*/
+
+#define  MQTTc_MSG_DEADLINE_IS_SET(p_msg)                  ((((p_msg)->Type   == MQTTc_MSG_TYPE_PUBLISH) && \
+                                                             ((p_msg)->TTL_ms != 0u)) ? DEF_YES : DEF_NO)
 
 
 /*
 *********************************************************************************************************
-*                                                  DBG
+*                                            STORE DEFINES
+*
+* Note(s) : (1) A fixed hdr is made of the msg type and flags byte, followed by at most 4 rem len bytes.
 *********************************************************************************************************
 */
 
-#if (MQTTc_CFG_DBG_GLOBAL_BUF_EN == DEF_ENABLED)
-#define  MQTTc_DBG_GLOBAL_BUF_COPY(p_buf, len)       Mem_Copy(MQTTc_Dbg_GlobalBuf,  \
-                                                             (p_buf),               \
-                                                              DEF_MIN((len), MQTTc_CFG_DBG_GLOBAL_BUF_LEN))
+#define  MQTTc_STORE_FIXED_HDR_MAX_LEN                             5u
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+#define  MQTTc_CONN_WAL_IS_SET(p_conn)                          (((p_conn)->WalPtr != DEF_NULL) ? DEF_YES : DEF_NO)
 #else
-#define  MQTTc_DBG_GLOBAL_BUF_COPY(p_buf, len)
+#define  MQTTc_CONN_WAL_IS_SET(p_conn)                            DEF_NO
 #endif
 
 
+/*
+*********************************************************************************************************
+*                                            RX SINK DEFINES
+*
+* Note(s) : (1) The payload of a PUBLISH that is discarded is rx'd in a scratch sink, by chunks of that
+*               size, instead of the connection's rx msg. See MQTTc_RdSockProcess() Note #7.
+*********************************************************************************************************
+*/
+
+#define  MQTTc_RX_SINK_BUF_LEN                                   128u
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -117,8 +163,16 @@ typedef  struct  mqttc_data {
 */
 
 static  MQTTc_DATA  *MQTTc_Ptr = DEF_NULL;
-#if (MQTTc_CFG_DBG_GLOBAL_BUF_EN == DEF_ENABLED)
-        CPU_CHAR     MQTTc_Dbg_GlobalBuf[MQTTc_CFG_DBG_GLOBAL_BUF_LEN];
+
+static  CPU_INT08U   MQTTc_RxSinkBuf[MQTTc_RX_SINK_BUF_LEN];    /* Sink of discarded payloads. Only used by the task.   */
+
+#if (MQTTc_CFG_TX_SCHED_WEIGHTED_EN == DEF_ENABLED)
+static  const  CPU_INT08U  MQTTc_TxLaneWeightTbl[MQTTc_MSG_PRIO_NBR] = {
+    0u,                                                         /* Ctrl lane is not weighted, it always has precedence. */
+    MQTTc_CFG_TX_SCHED_WEIGHT_HIGH,
+    MQTTc_CFG_TX_SCHED_WEIGHT_NORMAL,
+    MQTTc_CFG_TX_SCHED_WEIGHT_BULK
+};
 #endif
 
 
@@ -140,7 +194,13 @@ static  void         MQTTc_Task                      (void            *p_arg);
 
 static  void         MQTTc_WrSockProcess             (MQTTc_MSG       *p_msg);
 
-static  void         MQTTc_RdSockProcess             (MQTTc_CONN      *p_conn);
+static  CPU_BOOLEAN  MQTTc_WrSockCoalesceProcess     (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_WrSockAckProcess          (MQTTc_CONN      *p_conn);
+
+static  CPU_BOOLEAN  MQTTc_RdSockProcess             (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_RdSockPublishFilter       (MQTTc_CONN      *p_conn);
 
 static  void         MQTTc_MsgProcess                (void);
 
@@ -165,6 +225,89 @@ static  void         MQTTc_MsgPost                   (MQTTc_CONN      *p_conn,
 
 static  void         MQTTc_MsgListClosedCallbackExec (MQTTc_MSG       *p_head_msg);
 
+static  void         MQTTc_AckQ_Add                  (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG_TYPE   type,
+                                                      CPU_INT16U       msg_id);
+
+static  CPU_INT08U   MQTTc_QoS2_RxTblFind            (MQTTc_CONN      *p_conn,
+                                                      CPU_INT16U       msg_id);
+
+static  CPU_INT08U   MQTTc_QoS2_RxTblAdd             (MQTTc_CONN      *p_conn,
+                                                      CPU_INT16U       msg_id);
+
+static  void         MQTTc_QoS2_RxTblClr             (MQTTc_CONN      *p_conn);
+
+
+/*
+*********************************************************************************************************
+*                                           TX LANE FUNCTIONS
+*********************************************************************************************************
+*/
+
+static  void         MQTTc_TxLaneAdd                 (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg,
+                                                      MQTTc_MSG_PRIO   lane);
+
+static  MQTTc_MSG   *MQTTc_TxLaneConflate            (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg,
+                                                      MQTTc_MSG_PRIO   lane);
+
+static  void         MQTTc_TxLaneExpire              (MQTTc_CONN      *p_conn);
+
+static  CPU_INT08U   MQTTc_TxLaneSel                 (MQTTc_CONN      *p_conn);
+
+static  MQTTc_MSG   *MQTTc_TxMsgGet                  (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_WaitRxMsgAdd              (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  MQTTc_MSG   *MQTTc_WaitRxMsgFind             (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG_TYPE   type,
+                                                      CPU_INT16U       msg_id);
+
+static  void         MQTTc_ConnMsgRemove             (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  void         MQTTc_ConnMsgListsFlush         (MQTTc_CONN      *p_conn);
+
+
+/*
+*********************************************************************************************************
+*                                           TX Q FUNCTIONS
+*********************************************************************************************************
+*/
+
+static  void         MQTTc_TxQ_Release               (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  CPU_BOOLEAN  MQTTc_TxQ_IsLow                 (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_TxQ_HighCallbackExec      (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_TxQ_Wait                  (MQTTc_CONN      *p_conn,
+                                                      CPU_INT32U       timeout_ms,
+                                                      MQTTc_ERR       *p_err);
+
+
+/*
+*********************************************************************************************************
+*                                         TX RATE FUNCTIONS
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U   MQTTc_TxRateWaitGet             (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  CPU_INT32U   MQTTc_TxRateDlyGet              (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_TxRateConsume             (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  CPU_INT32S   MQTTc_TxRateTokensCalc          (CPU_INT32S       tokens,
+                                                      CPU_INT32U       rate,
+                                                      CPU_INT32U       burst,
+                                                      CPU_INT32U       elapsed_ms);
+
 
 /*
 *********************************************************************************************************
@@ -180,6 +323,12 @@ static  CPU_INT08U  *MQTTc_FixedHdrBufCfg            (CPU_INT08U      *p_buf,
                                                       CPU_INT32U       rem_len,
                                                       MQTTc_ERR       *p_err);
 
+static  CPU_INT08U  *MQTTc_RemLenBufCfg              (CPU_INT08U      *p_buf,
+                                                      CPU_INT32U       rem_len);
+
+static  CPU_INT08U  *MQTTc_PublishTopicGet           (MQTTc_MSG       *p_msg,
+                                                      CPU_INT16U      *p_topic_len);
+
 
 /*
 *********************************************************************************************************
@@ -191,6 +340,94 @@ static  CPU_INT16U   MQTTc_MsgID_Get                 (void);
 
 static  void         MQTTc_MsgID_Free                (CPU_INT16U       msg_id);
 
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  MQTTc_MsgID_Reserve             (CPU_INT16U       msg_id);
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            STORE FUNCTIONS
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+static  void         MQTTc_ConnStoreFeed             (MQTTc_CONN      *p_conn);
+
+static  CPU_BOOLEAN  MQTTc_ConnStoreMsgCmpl          (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  void         MQTTc_ConnStorePubRecRx         (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  MQTTc_STORE_SLOT  *MQTTc_ConnStoreSlotGet    (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  void         MQTTc_ConnStoreReset            (MQTTc_CONN      *p_conn);
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+static  void         MQTTc_ConnWalRestore            (MQTTc_CONN      *p_conn);
+#endif
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       PUBLISH RX BATCH FUNCTIONS
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+static  void         MQTTc_PublishRxBatchBufGet      (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_PublishRxBatchAdd         (MQTTc_CONN      *p_conn,
+                                                      CPU_INT08U      *p_topic,
+                                                      CPU_INT32U       topic_len,
+                                                      CPU_INT08U      *p_payload,
+                                                      CPU_INT32U       payload_len,
+                                                      MQTTc_ERR        err);
+
+static  void         MQTTc_PublishRxBatchFlush       (MQTTc_CONN      *p_conn);
+
+static  void         MQTTc_PublishRxBatchRelease     (MQTTc_CONN      *p_conn);
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         STATISTICS FUNCTIONS
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+static  void         MQTTc_ConnStatsSnap             (MQTTc_CONN      *p_conn);
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         CMPL BATCH FUNCTIONS
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+static  void         MQTTc_CmplBatchAdd              (MQTTc_CONN      *p_conn,
+                                                      MQTTc_MSG       *p_msg);
+
+static  void         MQTTc_CmplBatchFlush            (MQTTc_CONN      *p_conn);
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            CACHE FUNCTIONS
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+static  CPU_INT32U   MQTTc_ConnCacheSyncProc         (MQTTc_CONN      *p_conn);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -238,7 +475,10 @@ static  void         MQTTc_ConnRemove                (MQTTc_CONN      *p_conn);
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When the memory usage is accounted, the task's stk is painted before the task is created,
+*                   so that its high-water mark can be probed. A stk that is not provided in 'p_task_cfg' is
+*                   then allocated from 'p_mem_seg', instead of by the KAL, so that it can be painted. See
+*                   mqtt-c_mem.c Note #2.
 *********************************************************************************************************
 */
 
@@ -248,6 +488,7 @@ void  MQTTc_Init (const  MQTTc_CFG     *p_cfg,
                          MQTTc_ERR     *p_err)
 {
     MQTTc_DATA      *p_temp_mqttc_data;
+    void            *p_stk;
     KAL_TASK_HANDLE  task_handle;
     CPU_BOOLEAN      kal_feat_is_ok;
     KAL_ERR          err_kal;
@@ -327,9 +568,39 @@ void  MQTTc_Init (const  MQTTc_CFG     *p_cfg,
     p_temp_mqttc_data->MsgListHeadPtr = DEF_NULL;               /* Init head of msg list.                               */
     p_temp_mqttc_data->MsgListTailPtr = DEF_NULL;               /* Init tail of msg list.                               */
 
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+    MQTTc_MemInit();
+    MQTTc_MemAdd(MQTTc_MEM_TYPE_DATA,          sizeof(MQTTc_DATA) + sizeof(MQTTc_RxSinkBuf));
+    MQTTc_MemAdd(MQTTc_MEM_TYPE_MSG_ID_BITMAP, sizeof(CPU_INT32U) * p_temp_mqttc_data->MsgID_BitmapTblMax);
+#endif
+
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+    MQTTc_TimelineInit(p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        return;
+    }
+#endif
+
+    p_stk = p_task_cfg->StkPtr;
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+    if (p_stk == DEF_NULL) {                                    /* See Note #1.                                         */
+        p_stk = Mem_SegAllocExt("MQTTc - Task Stk",
+                                 p_mem_seg,
+                                 p_task_cfg->StkSizeBytes,
+                                 CPU_CFG_STK_ALIGN_BYTES,
+                                 DEF_NULL,
+                                &err_lib);
+        if (err_lib != LIB_MEM_ERR_NONE) {
+           *p_err = MQTTc_ERR_ALLOC;
+            return;
+        }
+    }
+    MQTTc_MemTaskStkSet(p_stk, p_task_cfg->StkSizeBytes);
+#endif
+
                                                                 /* Create task.                                         */
     task_handle = KAL_TaskAlloc("MQTTc Task",
-                                 p_task_cfg->StkPtr,
+                                 p_stk,
                                  p_task_cfg->StkSizeBytes,
                                  DEF_NULL,
                                 &err_kal);
@@ -349,6 +620,14 @@ void  MQTTc_Init (const  MQTTc_CFG     *p_cfg,
         return;
     }
 
+#if (MQTTc_CFG_DBG_TRACE_RING_EN == DEF_ENABLED)
+    MQTTc_TraceInit();
+#endif
+
+#if (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+    MQTTc_CapInit();
+#endif
+
     CPU_CRITICAL_ENTER();
     MQTTc_Ptr = p_temp_mqttc_data;
     CPU_CRITICAL_EXIT();
@@ -384,6 +663,9 @@ void  MQTTc_Init (const  MQTTc_CFG     *p_cfg,
 void  MQTTc_ConnClr (MQTTc_CONN  *p_conn,
                      MQTTc_ERR   *p_err)
 {
+    CPU_INT08U  lane;
+
+
                                                                 /* --------------- ARGUMENTS VALIDATION --------------- */
     #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
     {
@@ -426,6 +708,7 @@ void  MQTTc_ConnClr (MQTTc_CONN  *p_conn,
     p_conn->PasswordStr         = DEF_NULL;
 
     p_conn->KeepAliveTimerSec   = MQTTc_KEEP_ALIVE_TIMER_SEC_DFLT_VAL;
+    p_conn->CleanSession        = DEF_YES;
     p_conn->WillCfgPtr          = DEF_NULL;
 
     p_conn->SecureCfgPtr        = DEF_NULL;
@@ -439,15 +722,105 @@ void  MQTTc_ConnClr (MQTTc_CONN  *p_conn,
     p_conn->OnDisconnectCmpl    = DEF_NULL;
     p_conn->OnErrCallback       = DEF_NULL;
     p_conn->OnPublishRx         = DEF_NULL;
+    p_conn->OnPublishRxFilter   = DEF_NULL;
+    p_conn->OnTxQ_High          = DEF_NULL;
+    p_conn->OnTxQ_Low           = DEF_NULL;
     p_conn->ArgPtr              = DEF_NULL;
 
     p_conn->TimeoutMs           = MQTTc_TIMEOUT_MS_DFLT_VAL;
 
     p_conn->PublishRxMsgPtr     = DEF_NULL;
 
-    p_conn->TxMsgHeadPtr        = DEF_NULL;
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {
+        p_conn->TxLaneHeadPtr[lane] = DEF_NULL;
+        p_conn->TxLaneTailPtr[lane] = DEF_NULL;
+#if (MQTTc_CFG_TX_SCHED_WEIGHTED_EN == DEF_ENABLED)
+        p_conn->TxLaneCredit[lane]  = MQTTc_TxLaneWeightTbl[lane];
+#endif
+    }
+    p_conn->TxWaitConnAck       = DEF_NO;
+    p_conn->TxMsgCurPtr         = DEF_NULL;
     p_conn->NextTxMsgTxLen      = 0u;
 
+    p_conn->WaitRxMsgHeadPtr    = DEF_NULL;
+    p_conn->WaitRxMsgTailPtr    = DEF_NULL;
+
+    p_conn->TxBufPtr            = DEF_NULL;
+    p_conn->TxBufLen            = 0u;
+    p_conn->TxBufDataLen        = 0u;
+    p_conn->TxBufTxLen          = 0u;
+    p_conn->TxBufAckLen         = 0u;
+    p_conn->TxBufMsgHeadPtr     = DEF_NULL;
+
+    p_conn->AckQ_Len            = 0u;
+    p_conn->AckQ_TxLen          = 0u;
+
+    p_conn->QoS2_RxTblBitmap    = DEF_BIT_NONE;
+
+    p_conn->SchedWeight         = 1u;
+    p_conn->SchedDeficit        = 0u;
+
+    p_conn->TxQ_MsgNbr           = 0u;
+    p_conn->TxQ_Len              = 0u;
+    p_conn->TxQ_MaxMsgNbr        = 0u;
+    p_conn->TxQ_MaxLen           = 0u;
+    p_conn->TxQ_LowMsgNbr        = 0u;
+    p_conn->TxQ_LowLen           = 0u;
+    p_conn->TxQ_IsHigh           = DEF_NO;
+    p_conn->TxQ_HighCallbackPend = DEF_NO;
+    p_conn->TxQ_WaitNbr          = 0u;
+    p_conn->TxQ_SemHandle        = KAL_SemHandleNull;
+
+    p_conn->TxRateMsgPerSec      = 0u;
+    p_conn->TxRateMsgBurst       = 1u;
+    p_conn->TxRateBytesPerSec    = 0u;
+    p_conn->TxRateBytesBurst     = 0u;
+    p_conn->TxRateMsgTokens      = 0;
+    p_conn->TxRateBytesTokens    = 0;
+    p_conn->TxRateTS_ms          = 0u;
+
+    p_conn->TxDeadlineMsgNbr     = 0u;
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+    p_conn->StorePtr             = DEF_NULL;
+    p_conn->StoreTxEn            = DEF_NO;
+    p_conn->StoreWinHeadIx       = 0u;
+    p_conn->StoreWinNbr          = 0u;
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    p_conn->WalPtr               = DEF_NULL;
+#endif
+#endif
+
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+    p_conn->OnPublishRxBatch     = DEF_NULL;
+    p_conn->PublishRxBatchBufPtr = DEF_NULL;
+    p_conn->PublishRxBatchBufLen = 0u;
+    p_conn->PublishRxBatchLen    = 0u;
+    p_conn->PublishRxBatchNbr    = 0u;
+#endif
+
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+    p_conn->OnCmplBatch          = DEF_NULL;
+    p_conn->CmplBatchNbr         = 0u;
+#endif
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+    Mem_Clr(&p_conn->Stats,     sizeof(MQTTc_CONN_STATS));
+    Mem_Clr(&p_conn->StatsSnap, sizeof(MQTTc_CONN_STATS));
+#endif
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+    p_conn->CachePtr             = DEF_NULL;
+    p_conn->CacheSyncSettle_ms   = MQTTc_CACHE_SYNC_SETTLE_MS_DFLT_VAL;
+    p_conn->CacheSyncTS_ms       = 0u;
+    p_conn->CacheSyncPend        = DEF_NO;
+    p_conn->OnCacheSync          = DEF_NULL;
+#endif
+
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+    p_conn->LatPtr               = DEF_NULL;
+#endif
+
     p_conn->NextPtr             = DEF_NULL;
 
     MQTTc_ConnNextMsgClr(p_conn);                               /* Clr all the NextMsg fields.                          */
@@ -483,10 +856,33 @@ void  MQTTc_ConnClr (MQTTc_CONN  *p_conn,
 *                                   MQTTc_PARAM_TYPE_CALLBACK_ON_UNSUBSCRIBE_CMPL   On unsubscribe cmpl callback.
 *                                   MQTTc_PARAM_TYPE_CALLBACK_ON_PINGREQ_CMPL       On pingreq     cmpl callback.
 *                                   MQTTc_PARAM_TYPE_CALLBACK_ON_DISCONNECT_CMPL    On disconnect  cmpl callback.
+*                                   MQTTc_PARAM_TYPE_CALLBACK_ON_COMPL_BATCH        On cmpl batch       callback.
 *                                   MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX         On publish rx'd callback.
+*                                   MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_FILTER  On publish rx'd filter callback.
+*                                   MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_BATCH   On publish rx'd batch callback.
+*                                   MQTTc_PARAM_TYPE_CALLBACK_ON_TX_Q_HIGH          On tx q high watermark callback.
+*                                   MQTTc_PARAM_TYPE_CALLBACK_ON_TX_Q_LOW           On tx q low  watermark callback.
 *                                   MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR               Ptr on arg passed to callback.
 *                                   MQTTc_PARAM_TYPE_TIMEOUT_MS                     'Open' timeout, in milliseconds.
 *                                   MQTTc_PARAM_TYPE_PUBLISH_RX_MSG_PTR             Ptr on msg that is used to rx publish.
+*                                   MQTTc_PARAM_TYPE_TX_BUF_PTR                     Ptr on buf used to coalesce tx'd msgs.
+*                                   MQTTc_PARAM_TYPE_TX_BUF_LEN                     Len of buf used to coalesce tx'd msgs.
+*                                   MQTTc_PARAM_TYPE_SCHED_WEIGHT                   Weight when sharing the task.
+*                                   MQTTc_PARAM_TYPE_TX_Q_MAX_MSG_NBR               Max nbr of PUBLISH msgs q'd.
+*                                   MQTTc_PARAM_TYPE_TX_Q_MAX_LEN                   Max nbr of bytes of PUBLISH msgs q'd.
+*                                   MQTTc_PARAM_TYPE_TX_Q_LOW_MSG_NBR               Tx q low watermark, in nbr of msgs.
+*                                   MQTTc_PARAM_TYPE_TX_Q_LOW_LEN                   Tx q low watermark, in bytes.
+*                                   MQTTc_PARAM_TYPE_TX_RATE_MSG_PER_SEC            Max nbr of PUBLISH msgs tx'd per sec.
+*                                   MQTTc_PARAM_TYPE_TX_RATE_MSG_BURST              Nbr of PUBLISH msgs tx'd back to back.
+*                                   MQTTc_PARAM_TYPE_TX_RATE_BYTES_PER_SEC          Max nbr of PUBLISH bytes tx'd per sec.
+*                                   MQTTc_PARAM_TYPE_TX_RATE_BYTES_BURST            Nbr of PUBLISH bytes tx'd back to back.
+*                                   MQTTc_PARAM_TYPE_STORE_PTR                      Ptr on store of outbound PUBLISH msgs.
+*                                   MQTTc_PARAM_TYPE_CLEAN_SESSION                  Flag to start a clean session.
+*                                   MQTTc_PARAM_TYPE_WAL_PTR                        Ptr on WAL of in-flight QoS 1/2 state.
+*                                   MQTTc_PARAM_TYPE_CACHE_PTR                      Ptr on cache of last payload per topic.
+*                                   MQTTc_PARAM_TYPE_CACHE_SYNC_SETTLE_MS           Quiet time ending initial sync, in ms.
+*                                   MQTTc_PARAM_TYPE_CALLBACK_ON_CACHE_SYNC         On cache initial sync cmpl callback.
+*                                   MQTTc_PARAM_TYPE_LAT_PTR                        Ptr on publish-to-ack latency histograms.
 *
 *               p_param         Parameter's value.
 *
@@ -499,7 +895,134 @@ void  MQTTc_ConnClr (MQTTc_CONN  *p_conn,
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When a tx buf is set (MQTTc_PARAM_TYPE_TX_BUF_PTR and MQTTc_PARAM_TYPE_TX_BUF_LEN), the
+*                   messages ready to be transmitted on the connection are copied in that buffer and sent
+*                   using a single socket transmit call. The length of the buffer is the maximum number of
+*                   bytes sent per call. See MQTTc_WrSockCoalesceProcess() for more details.
+*
+*               (2) The tx buf MUST NOT be changed while the connection is open.
+*
+*               (3) Each time the task processes the connection, it can rx or tx up to its weight times
+*                   MQTTc_CFG_TASK_QUANTUM_BYTES bytes. The weight must be [1; 255]. It is 1 by default.
+*                   See MQTTc_Task() Note #1.
+*
+*               (4) The tx q limits bound the PUBLISH messages posted on the connection that have not yet
+*                   completed, in number of messages and in bytes. They are unlimited by default.
+*
+*                   (a) Once a limit is reached, the tx q is 'high': OnTxQ_High is called and MQTTc_Publish()
+*                       returns MQTTc_ERR_TX_Q_FULL until the tx q drains down to its low watermarks. At that
+*                       point, OnTxQ_Low is called and tasks pending in MQTTc_PublishBlocking() are woken up.
+*
+*                   (b) A low watermark that is not set, or that is not below its limit, defaults to half
+*                       of that limit.
+*
+*                   (c) The tx q limits MUST be set before the connection is opened and MUST NOT be changed
+*                       while it is open.
+*
+*               (5) The tx rate limiter delays the PUBLISH messages of the connection so that no more than
+*                   MQTTc_PARAM_TYPE_TX_RATE_MSG_PER_SEC messages and MQTTc_PARAM_TYPE_TX_RATE_BYTES_PER_SEC
+*                   bytes are tx'd per second. Both rates are unlimited by default. Messages are never
+*                   dropped : they wait in their tx lane until they can be tx'd.
+*
+*                   (a) Each rate is enforced by a token bucket. Its burst is the number of messages (1 by
+*                       default) or of bytes (0 by default) that can be tx'd back to back once the connection
+*                       has been idle long enough.
+*
+*                   (b) A message larger than the byte burst is tx'd as soon as the byte bucket is full. The
+*                       bucket then goes in debt, so that the average rate is still respected.
+*
+*                   (c) Rates and bursts MUST be at most 1000000. They MUST be set before the connection is
+*                       opened and MUST NOT be changed while it is open.
+*
+*               (6) When a store is set (MQTTc_CFG_STORE_EN), the messages appended to it with
+*                   MQTTc_PublishStore() are durable : they are kept in the store until the MQTT server
+*                   acknowledges them, even if the connection is closed or the application restarts.
+*
+*                   (a) Stored messages are tx'd once the CONNECT of the connection has cmpl'd, at QoS 1,
+*                       with up to MQTTc_CFG_STORE_WIN_SIZE messages in flight.
+*
+*                   (b) A stored message is released from the store once it and every message stored
+*                       before it have been acknowledged. Messages can thus be tx'd more than once, but
+*                       are never lost.
+*
+*                   (c) When the connection is closed, the messages that have not been released are tx'd
+*                       again on the next connection.
+*
+*                   (d) The store MUST be opened with MQTTc_StoreOpen() and set before the connection is
+*                       opened. It MUST NOT be changed while the connection is open, nor be shared by two
+*                       connections.
+*
+*               (7) The clean session flag of the CONNECT is set by default. When it is cleared, the MQTT
+*                   server keeps the session of the client between connections, and the QoS 2 flows rx'd
+*                   that were not released are kept in the QoS 2 rx tbl when the connection is closed.
+*
+*               (8) When a WAL is set (MQTTc_CFG_WAL_EN), the state of the QoS 1 and 2 flows in flight is
+*                   logged, so that they can be resumed after the application restarts.
+*
+*                   (a) A stored message is resumed with the msg ID it was tx'd with. It is tx'd again with
+*                       the DUP flag set, unless its PUBREC was rx'd, in which case its PUBREL is tx'd again.
+*                       A message that was acknowledged is not tx'd again.
+*
+*                   (b) A QoS 2 PUBLISH rx'd whose PUBREL was not rx'd is not delivered again.
+*
+*                   (c) The MQTT server only resumes the flows of a persistent session. The clean session
+*                       flag MUST thus be cleared. See Note #7.
+*
+*                   (d) Only the messages of the store are logged. Messages posted with MQTTc_Publish() are
+*                       lost on a restart, as without a WAL.
+*
+*                   (e) The WAL MUST be opened with MQTTc_WalOpen() and set after the store and the clean
+*                       session flag, once, before the connection is opened. It MUST NOT be shared by two
+*                       connections.
+*
+*               (9) When a cache is set (MQTTc_CFG_CACHE_EN), the last payload rx'd on each topic is kept in
+*                   it, and can be read at any time with MQTTc_CacheGet(). The PUBLISH messages rx'd are
+*                   cached before OnPublishRx is called.
+*
+*                   (a) Once a SUBSCRIBE cmpl's, the MQTT server sends the retained messages of the topics
+*                       subscribed to. The initial sync of the cache is considered cmpl once no retained
+*                       message has been rx'd for MQTTc_PARAM_TYPE_CACHE_SYNC_SETTLE_MS milliseconds (100 by
+*                       default). OnCacheSync is then called, from the MQTTc task.
+*
+*                   (b) The cache MUST be opened with MQTTc_CacheOpen() and set before the connection is
+*                       opened. It is kept when the connection is closed, and can be shared by connections.
+*
+*              (10) OnPublishRxFilter is called from the task for each PUBLISH rx'd, once its topic is rx'd
+*                   and before its payload is. The payload of a PUBLISH it rejects is skipped without
+*                   being copied in the rx msg. See MQTTc_RdSockProcess() Note #7.
+*
+*              (11) When OnPublishRxBatch is set (MQTTc_CFG_PUBLISH_RX_BATCH_EN), it is called instead of
+*                   OnPublishRx, with the views of up to MQTTc_CFG_PUBLISH_RX_BATCH_SIZE PUBLISH msgs rx'd.
+*
+*                   (a) The PUBLISH msgs rx'd are kept in the buf of the rx msg, one after the other. A batch
+*                       is delivered once the task has rx'd all it could from the connection, or once the
+*                       batch is full, or the buf has no room for the next PUBLISH.
+*
+*                   (b) A batch is also delivered before any other callback of the connection is called,
+*                       so that the application sees the events in the order they were rx'd.
+*
+*                   (c) OnPublishRxBatch MUST be set before the connection is opened and MUST NOT be changed
+*                       while it is open.
+*
+*              (12) When OnCmplBatch is set (MQTTc_CFG_CMPL_BATCH_EN), it is called instead of OnCmpl and of
+*                   the operation-specific cmpl callbacks, with an entry (msg, type, err) for each of up to
+*                   MQTTc_CFG_CMPL_BATCH_SIZE msgs that cmpl'd.
+*
+*                   (a) The msgs that cmpl during an iteration of the task are delivered at the end of that
+*                       iteration, or once the batch is full, or when the connection closes. A msg can be
+*                       re-used as soon as its entry has been delivered.
+*
+*                   (b) OnCmplBatch MUST be set before the connection is opened and MUST NOT be changed
+*                       while it is open.
+*
+*              (13) When latency histograms are set (MQTTc_CFG_LAT_EN), each PUBLISH msg of QoS 1 or 2 that
+*                   is acked records its queueing, tx, ack and end-to-end latencies. See mqtt-c_lat.h.
+*
+*                   (a) The histograms MUST be cleared with MQTTc_LatClr() and set before the connection is
+*                       opened. They are kept when the connection is closed, and can be shared by connections.
+*
+*                   (b) CPU_TS_Get32() is used to timestamp the msgs. Its resolution bounds the resolution
+*                       of the latencies.
 *********************************************************************************************************
 */
 
@@ -519,7 +1042,8 @@ void  MQTTc_ConnSetParam (MQTTc_CONN        *p_conn,
             return;
         }
 
-        if (p_param == DEF_NULL) {
+        if ((p_param == DEF_NULL) &&                            /* Flag can be cleared.                                 */
+            (type    != MQTTc_PARAM_TYPE_CLEAN_SESSION)) {
            *p_err = MQTTc_ERR_NULL_PTR;
             return;
         }
@@ -606,6 +1130,12 @@ void  MQTTc_ConnSetParam (MQTTc_CONN        *p_conn,
             p_conn->OnDisconnectCmpl = (MQTTc_CMPL_CALLBACK)p_param;
             break;
 
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+        case MQTTc_PARAM_TYPE_CALLBACK_ON_COMPL_BATCH:          /* See Note #12.                                        */
+            p_conn->OnCmplBatch = (MQTTc_CMPL_BATCH_CALLBACK)p_param;
+            break;
+#endif
+
         case MQTTc_PARAM_TYPE_CALLBACK_ON_ERR_CALLBACK:
             p_conn->OnErrCallback = (MQTTc_ERR_CALLBACK)p_param;
             break;
@@ -616,6 +1146,28 @@ void  MQTTc_ConnSetParam (MQTTc_CONN        *p_conn,
             break;
 
 
+        case MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_FILTER:    /* See Note #10.                                        */
+            p_conn->OnPublishRxFilter = (MQTTc_PUBLISH_RX_FILTER_CALLBACK)p_param;
+            break;
+
+
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+        case MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_BATCH:     /* See Note #11.                                        */
+            p_conn->OnPublishRxBatch = (MQTTc_PUBLISH_RX_BATCH_CALLBACK)p_param;
+            break;
+#endif
+
+
+        case MQTTc_PARAM_TYPE_CALLBACK_ON_TX_Q_HIGH:
+            p_conn->OnTxQ_High = (MQTTc_TX_Q_CALLBACK)p_param;
+            break;
+
+
+        case MQTTc_PARAM_TYPE_CALLBACK_ON_TX_Q_LOW:
+            p_conn->OnTxQ_Low = (MQTTc_TX_Q_CALLBACK)p_param;
+            break;
+
+
         case MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR:
              p_conn->ArgPtr = p_param;
              break;
@@ -636,43 +1188,177 @@ void  MQTTc_ConnSetParam (MQTTc_CONN        *p_conn,
              break;
 
 
-        default:
-            *p_err = MQTTc_ERR_INVALID_ARG;
-             return;
-    }
+        case MQTTc_PARAM_TYPE_TX_BUF_PTR:                       /* See Note #1.                                         */
+             p_conn->TxBufPtr = (CPU_INT08U *)p_param;
+             break;
 
-   *p_err = MQTTc_ERR_NONE;
 
-    return;
-}
+        case MQTTc_PARAM_TYPE_TX_BUF_LEN:
+             p_conn->TxBufLen = (CPU_INT32U)p_param;
+             break;
 
 
-/*
-*********************************************************************************************************
-*                                            MQTTc_ConnOpen()
-*
-* Description : Open a new MQTT Client connection.
-*
-* Argument(s) : p_conn          Pointer to MQTTc Connection object to open.
-*
-*               flags           Configuration flags, reserved for future usage.
-*
-*               p_err           Pointer to variable that will receive the return error code from this function :
-*                                   MQTTc_ERR_NONE              Operation successful.
-*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
-*
-* Return(s)   : none.
-*
-* Caller(s)   : Application.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
+        case MQTTc_PARAM_TYPE_SCHED_WEIGHT:                     /* See Note #3.                                         */
+             if (((CPU_INT32U)p_param == 0u) ||
+                 ((CPU_INT32U)p_param >  DEF_INT_08U_MAX_VAL)) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->SchedWeight = (CPU_INT08U)(CPU_INT32U)p_param;
+             break;
 
-void  MQTTc_ConnOpen (MQTTc_CONN     *p_conn,
-                      MQTTc_FLAGS     flags,
+
+        case MQTTc_PARAM_TYPE_TX_Q_MAX_MSG_NBR:                 /* See Note #4.                                         */
+             if ((CPU_INT32U)p_param > DEF_INT_16U_MAX_VAL) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->TxQ_MaxMsgNbr = (CPU_INT16U)(CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_Q_MAX_LEN:
+             p_conn->TxQ_MaxLen = (CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_Q_LOW_MSG_NBR:
+             if ((CPU_INT32U)p_param > DEF_INT_16U_MAX_VAL) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->TxQ_LowMsgNbr = (CPU_INT16U)(CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_Q_LOW_LEN:
+             p_conn->TxQ_LowLen = (CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_RATE_MSG_PER_SEC:              /* See Note #5.                                         */
+             if ((CPU_INT32U)p_param > MQTTc_TX_RATE_MAX_VAL) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->TxRateMsgPerSec = (CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_RATE_MSG_BURST:
+             if (((CPU_INT32U)p_param == 0u) ||
+                 ((CPU_INT32U)p_param >  MQTTc_TX_RATE_MAX_VAL)) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->TxRateMsgBurst = (CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_RATE_BYTES_PER_SEC:
+             if ((CPU_INT32U)p_param > MQTTc_TX_RATE_MAX_VAL) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->TxRateBytesPerSec = (CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_TX_RATE_BYTES_BURST:
+             if ((CPU_INT32U)p_param > MQTTc_TX_RATE_MAX_VAL) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_conn->TxRateBytesBurst = (CPU_INT32U)p_param;
+             break;
+
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+        case MQTTc_PARAM_TYPE_STORE_PTR:                        /* See Note #6.                                         */
+             p_conn->StorePtr = (MQTTc_STORE *)p_param;
+             break;
+
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+        case MQTTc_PARAM_TYPE_WAL_PTR:                          /* See Note #8.                                         */
+             p_conn->WalPtr = (MQTTc_WAL *)p_param;
+             MQTTc_ConnWalRestore(p_conn);
+             break;
+#endif
+#endif
+
+
+        case MQTTc_PARAM_TYPE_CLEAN_SESSION:                    /* See Note #7.                                         */
+             p_conn->CleanSession = ((CPU_INT32U)p_param != 0u) ? DEF_YES : DEF_NO;
+             break;
+
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+        case MQTTc_PARAM_TYPE_CACHE_PTR:                        /* See Note #9.                                         */
+             p_conn->CachePtr = (MQTTc_CACHE *)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_CACHE_SYNC_SETTLE_MS:             /* See Note #9a.                                        */
+             p_conn->CacheSyncSettle_ms = (CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_CALLBACK_ON_CACHE_SYNC:
+             p_conn->OnCacheSync = (MQTTc_CACHE_SYNC_CALLBACK)p_param;
+             break;
+#endif
+
+
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+        case MQTTc_PARAM_TYPE_LAT_PTR:                          /* See Note #13.                                        */
+             p_conn->LatPtr = (MQTTc_LAT *)p_param;
+             break;
+#endif
+
+
+        default:
+            *p_err = MQTTc_ERR_INVALID_ARG;
+             return;
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+
+    return;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_ConnOpen()
+*
+* Description : Open a new MQTT Client connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to open.
+*
+*               flags           Configuration flags, reserved for future usage.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_ALLOC             Could not allocate tx q sem.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The sem on which MQTTc_PublishBlocking() pends is only needed when the tx q is bounded.
+*                   It is created the first time such a connection is opened and kept afterwards.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ConnOpen (MQTTc_CONN     *p_conn,
+                      MQTTc_FLAGS     flags,
                       MQTTc_ERR      *p_err)
 {
+    CPU_INT08U  lane;
+
+
     (void)&flags;
 
                                                                 /* --------------- ARGUMENTS VALIDATION --------------- */
@@ -687,11 +1373,45 @@ void  MQTTc_ConnOpen (MQTTc_CONN     *p_conn,
         }
     #endif
 
+    if (((p_conn->TxQ_MaxMsgNbr != 0u)  ||                      /* Create tx q sem, if needed. See Note #1.             */
+         (p_conn->TxQ_MaxLen    != 0u)) &&
+        (KAL_SEM_HANDLE_IS_NULL(p_conn->TxQ_SemHandle) == DEF_YES)) {
+        KAL_ERR  err_kal;
+
+
+        p_conn->TxQ_SemHandle = KAL_SemCreate("MQTTc Tx Q Sem",
+                                               DEF_NULL,
+                                              &err_kal);
+        if (err_kal != KAL_ERR_NONE) {
+           *p_err = MQTTc_ERR_ALLOC;
+            return;
+        }
+    }
+
     MQTTc_SockConnOpen(p_conn,
                        p_err);
 
-    p_conn->TxMsgHeadPtr = DEF_NULL;
-    p_conn->NextPtr      = DEF_NULL;
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {
+        p_conn->TxLaneHeadPtr[lane] = DEF_NULL;
+    }
+    p_conn->TxWaitConnAck    = DEF_NO;
+    p_conn->TxMsgCurPtr      = DEF_NULL;
+    p_conn->WaitRxMsgHeadPtr = DEF_NULL;
+    p_conn->TxBufMsgHeadPtr  = DEF_NULL;
+    p_conn->TxQ_IsHigh       = DEF_NO;
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+    p_conn->Stats.InFlightNbr = 0u;
+#endif
+    p_conn->TxDeadlineMsgNbr = 0u;
+    p_conn->NextPtr          = DEF_NULL;
+                                                                /* Start with full tx rate buckets.                     */
+    p_conn->TxRateMsgTokens   = (CPU_INT32S)(p_conn->TxRateMsgBurst   * MQTTc_TX_RATE_TOKEN_SCALE);
+    p_conn->TxRateBytesTokens = (CPU_INT32S)(p_conn->TxRateBytesBurst * MQTTc_TX_RATE_TOKEN_SCALE);
+    p_conn->TxRateTS_ms       =  NetUtil_TS_Get_ms();
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+    MQTTc_ConnStoreReset(p_conn);                               /* Stored msgs are tx'd once CONNECT has cmpl'd.        */
+#endif
 
     return;
 }
@@ -791,6 +1511,63 @@ end_err:
 }
 
 
+/*
+*********************************************************************************************************
+*                                        MQTTc_ConnStatsGet()
+*
+* Description : Get a snapshot of the statistics counters of a MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection.
+*
+*               p_stats         Pointer to variable that will receive the snapshot.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The snapshot is taken by the MQTTc task at the end of each of its passes on the
+*                   connection, and when the connection closes. Its counters are consistent with each
+*                   other, and this function never waits for the task.
+*
+*               (2) The counters are kept when the connection is closed and re-opened. They are only reset
+*                   by MQTTc_ConnClr().
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+void  MQTTc_ConnStatsGet (MQTTc_CONN        *p_conn,
+                          MQTTc_CONN_STATS  *p_stats,
+                          MQTTc_ERR         *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+                                                                /* --------------- ARGUMENTS VALIDATION --------------- */
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if ((p_conn  == DEF_NULL) ||
+            (p_stats == DEF_NULL)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    Mem_Copy(p_stats, &p_conn->StatsSnap, sizeof(MQTTc_CONN_STATS));
+    CPU_CRITICAL_EXIT();
+
+   *p_err = MQTTc_ERR_NONE;
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                            MQTTc_MsgClr()
@@ -832,15 +1609,29 @@ void  MQTTc_MsgClr (MQTTc_MSG  *p_msg,
     p_msg->State   = MQTTc_MSG_STATE_NONE;
 
     p_msg->QoS     = 0u;
+    p_msg->Prio    = MQTTc_MSG_PRIO_NORMAL;
+
+    p_msg->ConflateEn    = DEF_NO;
+    p_msg->TTL_ms        = 0u;
+    p_msg->DeadlineTS_ms = 0u;
 
     p_msg->MsgID   = MQTT_MSG_ID_NONE;
 
     p_msg->ArgPtr  = DEF_NULL;
     p_msg->BufLen  = 0u;
     p_msg->XferLen = 0u;
+    p_msg->TxQ_Len = 0u;
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+    p_msg->MemLen  = 0u;
+#endif
 
     p_msg->Err     = MQTTc_ERR_NONE;
 
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+    p_msg->TimelineID    = 0u;
+    p_msg->TimelinePhase = MQTTc_TIMELINE_MSG_PHASE_NONE;
+#endif
+
     p_msg->NextPtr = DEF_NULL;
 
    *p_err = MQTTc_ERR_NONE;
@@ -860,6 +1651,9 @@ void  MQTTc_MsgClr (MQTTc_MSG  *p_msg,
 *               type            Parameter type :
 *                                   MQTTc_PARAM_TYPE_MSG_BUF_PTR        Msg's buf ptr.
 *                                   MQTTc_PARAM_TYPE_MSG_BUF_LEN        Msg's buf len.
+*                                   MQTTc_PARAM_TYPE_MSG_PRIO           Msg's tx prio.
+*                                   MQTTc_PARAM_TYPE_MSG_CONFLATE_EN    Msg can replace q'd msg on same topic.
+*                                   MQTTc_PARAM_TYPE_MSG_TTL_MS         Msg's time to live, in ms.
 *
 *               p_param         Parameter's value.
 *
@@ -872,7 +1666,21 @@ void  MQTTc_MsgClr (MQTTc_MSG  *p_msg,
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The tx prio is either MQTTc_MSG_PRIO_HIGH, MQTTc_MSG_PRIO_NORMAL (default) or
+*                   MQTTc_MSG_PRIO_BULK. It only applies to PUBLISH, SUBSCRIBE, UNSUBSCRIBE and DISCONNECT
+*                   messages and MUST NOT be changed while the message is in use.
+*
+*               (2) A PUBLISH message with conflation enabled replaces a PUBLISH message that was q'd with
+*                   conflation enabled on the same topic, in the same tx lane, and that has not started
+*                   to be tx'd yet. The replaced message cmpl's with MQTTc_ERR_SUPERSEDED. This is meant for
+*                   state-like topics, where only the newest value matters. Conflation is disabled by
+*                   default and MUST NOT be changed while the message is in use.
+*
+*               (3) A PUBLISH message with a time to live gets a deadline when it is posted. If it is still
+*                   waiting in its tx lane once the deadline is reached, it is removed from the lane and
+*                   cmpl's with MQTTc_ERR_EXPIRED, so that fresher data is tx'd first. A message that has
+*                   started to be tx'd is never dropped. The TTL is unlimited (0) by default, MUST be at
+*                   most DEF_INT_32S_MAX_VAL and MUST NOT be changed while the message is in use.
 *********************************************************************************************************
 */
 
@@ -909,6 +1717,31 @@ void  MQTTc_MsgSetParam (MQTTc_MSG         *p_msg,
              break;
 
 
+        case MQTTc_PARAM_TYPE_MSG_PRIO:                         /* See Note #1.                                         */
+             if (((CPU_INT32U)p_param != MQTTc_MSG_PRIO_HIGH)   &&
+                 ((CPU_INT32U)p_param != MQTTc_MSG_PRIO_NORMAL) &&
+                 ((CPU_INT32U)p_param != MQTTc_MSG_PRIO_BULK)) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_msg->Prio = (MQTTc_MSG_PRIO)(CPU_INT32U)p_param;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_MSG_CONFLATE_EN:                  /* See Note #2.                                         */
+             p_msg->ConflateEn = ((CPU_INT32U)p_param != 0u) ? DEF_YES : DEF_NO;
+             break;
+
+
+        case MQTTc_PARAM_TYPE_MSG_TTL_MS:                       /* See Note #3.                                         */
+             if ((CPU_INT32U)p_param > DEF_INT_32S_MAX_VAL) {
+                *p_err = MQTTc_ERR_INVALID_ARG;
+                 return;
+             }
+             p_msg->TTL_ms = (CPU_INT32U)p_param;
+             break;
+
+
         default:
             *p_err = MQTTc_ERR_INVALID_ARG;
              return;
@@ -1090,7 +1923,9 @@ void  MQTTc_Connect (MQTTc_CONN  *p_conn,
         }
     }
 
-    DEF_BIT_SET(conn_flags, MQTT_MSG_VAR_HDR_CONNECT_FLAG_CLEAN_SESSION);
+    if (p_conn->CleanSession == DEF_YES) {                      /* See MQTTc_ConnSetParam() Note #7.                    */
+        DEF_BIT_SET(conn_flags, MQTT_MSG_VAR_HDR_CONNECT_FLAG_CLEAN_SESSION);
+    }
 
    *p_buf = conn_flags;
     p_buf++;
@@ -1146,8 +1981,6 @@ void  MQTTc_Connect (MQTTc_CONN  *p_conn,
         p_buf += str_len;
     }
 
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf_start, 150u);
-
     xfer_len = p_buf - p_buf_start;
 
     MQTTc_MsgPost(p_conn,                                       /* Add msg to Q for task to process.                    */
@@ -1190,11 +2023,13 @@ void  MQTTc_Connect (MQTTc_CONN  *p_conn,
 *                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
 *                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
 *                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
+*                                   MQTTc_ERR_TX_Q_FULL         Conn's tx q is full. See MQTTc_ConnSetParam() Note #4.
 *                                   MQTTc_ERR_FAIL              Operation failed.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : Application.
+* Caller(s)   : Application,
+*               MQTTc_PublishBlocking().
 *
 * Note(s)     : none.
 *********************************************************************************************************
@@ -1332,8 +2167,6 @@ void  MQTTc_Publish (       MQTTc_CONN    *p_conn,
 
     xfer_len = p_buf - p_buf_start;
 
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf, 150u);
-
     MQTTc_MsgPost(p_conn,                                       /* Post msg to Q for task to process.                   */
                   p_msg,
                   MQTTc_MSG_TYPE_PUBLISH,
@@ -1351,114 +2184,246 @@ void  MQTTc_Publish (       MQTTc_CONN    *p_conn,
 
 /*
 *********************************************************************************************************
-*                                           MQTTc_Subscribe()
+*                                        MQTTc_PublishBlocking()
 *
-* Description : Send a 'Subscribe' message to MQTT server.
+* Description : Send a 'Publish' message to MQTT server, waiting for room in the connection's tx q if it is
+*               full.
 *
 * Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
 *
 *               p_msg           Pointer to MQTTc Message object to use.
 *
-*               topic_str       String containing the topic at which to subscribe. Must stay valid until
+*               topic_str       String containing the topic on which to publish.  Must stay valid until
 *                               the message has been completely sent.
 *
-*               req_qos         Requested level of QoS for this subscription.
+*               qos_lvl         Level of QoS at which to publish.
+*
+*               retain_flag     Flag indicating if the retain flag in the PUBLISH header needs to be set.
+*
+*               p_payload       Pointer to the payload to publish.  Must stay valid until the message has
+*                               been completely sent.
+*
+*               payload_len     The length of the payload to publish.
+*
+*               timeout_ms      Max time to wait each time the tx q is full, in milliseconds.
+*                               KAL_TIMEOUT_INFINITE to wait until the tx q drains.
 *
 *               p_err           Pointer to variable that will receive the return error code from this function :
 *                                   MQTTc_ERR_NONE              Operation successful.
-*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
-*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
-*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
-*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
-*                                   MQTTc_ERR_FAIL              Operation failed.
+*                                   MQTTc_ERR_TIMEOUT           Tx q did not drain before timeout expired.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+*                               ---------------- See MQTTc_Publish() for more error codes. ----------------
 *
 * Return(s)   : none.
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When the tx q is full, the calling task pends until the task signals that the tx q has
+*                   drained down to its low watermarks. See MQTTc_ConnSetParam() Note #4.
+*
+*               (2) Another producer may fill the tx q again before the calling task gets to post its
+*                   message. In that case, the calling task simply pends again.
+*
+*               (3) MUST NOT be called from a callback, since the task would then wait on itself.
 *********************************************************************************************************
 */
 
-void  MQTTc_Subscribe (       MQTTc_CONN  *p_conn,
-                              MQTTc_MSG   *p_msg,
-                       const  CPU_CHAR    *topic_str,
-                              CPU_INT08U   req_qos,
-                              MQTTc_ERR   *p_err)
+void  MQTTc_PublishBlocking (       MQTTc_CONN    *p_conn,
+                                    MQTTc_MSG     *p_msg,
+                             const  CPU_CHAR      *topic_str,
+                                    CPU_INT08U     qos_lvl,
+                                    CPU_BOOLEAN    retain_flag,
+                             const  CPU_CHAR      *p_payload,
+                                    CPU_INT32U     payload_len,
+                                    CPU_INT32U     timeout_ms,
+                                    MQTTc_ERR     *p_err)
 {
-    MQTTc_SubscribeMult(p_conn,
-                        p_msg,
-                       &topic_str,
-                       &req_qos,
-                        1u,
-                        p_err);
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+    #endif
+
+    while (DEF_TRUE) {
+        MQTTc_Publish(p_conn,
+                      p_msg,
+                      topic_str,
+                      qos_lvl,
+                      retain_flag,
+                      p_payload,
+                      payload_len,
+                      p_err);
+        if (*p_err != MQTTc_ERR_TX_Q_FULL) {
+            break;
+        }
+
+        MQTTc_TxQ_Wait(p_conn,                                  /* Wait for tx q to drain. See Note #1.                 */
+                       timeout_ms,
+                       p_err);
+        if (*p_err != MQTTc_ERR_NONE) {
+            break;
+        }
+    }                                                           /* Retry to publish. See Note #2.                       */
+
+    return;
 }
 
 
 /*
 *********************************************************************************************************
-*                                         MQTTc_SubscribeMult()
-*
-* Description : Send a 'Subscribe' message containing multiple topics to MQTT server.
+*                                     MQTTc_PublishTemplateCreate()
 *
-* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+* Description : Validate and pre-encode everything needed to publish repeatedly on a given topic.
 *
-*               p_msg           Pointer to MQTTc Message object to use.
+* Argument(s) : p_template      Pointer to MQTTc Publish Template object to fill.
 *
-*               topic_str_tbl   Table containing string of all the topic(s) at which to subscribe. Must
-*                               all stay valid until the message has been completely sent.
+*               topic_str       String containing the topic on which to publish. Must stay valid as long
+*                               as the template is used.
 *
-*               req_qos_tbl     Table of the requested level of QoS for each subscription.
+*               qos_lvl         Level of QoS at which to publish.
 *
-*               topic_nbr       Number of topic and QoS contained in tables.
+*               retain_flag     Flag indicating if the retain flag in the PUBLISH header needs to be set.
 *
 *               p_err           Pointer to variable that will receive the return error code from this function :
 *                                   MQTTc_ERR_NONE              Operation successful.
-*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
 *                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
 *                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
-*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
-*                                   MQTTc_ERR_FAIL              Operation failed.
 *
 * Return(s)   : none.
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : (1) To compare with the granted QoS returned by the server with the SUBACK message, the
-*                   number of topics and their QoSes are kept before the actual content to send to the
-*                   server. For 3 topics, the buffer would look like this:
-*
-*                   Original p_msg->BufPtr           Modified p_msg->BufPtr
-*                                   |               |   Start of msg sent to server.
-*                                   |               |  |
-*                                   V               V  V
-*                                   ------------------------------
-*                                   | 2 | 0 | 1 | 3 | 0x82 | ... |
-*                                   ------------------------------
-*                                    ^    ^   ^   ^
-*                                    |    |   |   |
-*                          QoS Topic 3    |   |   |
-*                               QoS Topic 2   |   |
-*                                   QoS Topic 1   |
-*                                          Topic Nbr
+* Note(s)     : (1) Contrary to MQTTc_Publish(), the topic is always validated, since it is only done once
+*                   per template.
 *********************************************************************************************************
 */
 
-void  MQTTc_SubscribeMult (       MQTTc_CONN   *p_conn,
-                                  MQTTc_MSG    *p_msg,
-                           const  CPU_CHAR    **topic_str_tbl,
-                                  CPU_INT08U   *req_qos_tbl,
-                                  CPU_INT08U    topic_nbr,
-                                  MQTTc_ERR    *p_err)
+void  MQTTc_PublishTemplateCreate (       MQTTc_PUBLISH_TEMPLATE  *p_template,
+                                   const  CPU_CHAR                *topic_str,
+                                          CPU_INT08U               qos_lvl,
+                                          CPU_BOOLEAN              retain_flag,
+                                          MQTTc_ERR               *p_err)
 {
-    CPU_INT08U  *p_buf_base;
+    CPU_CHAR    *p_char;
+    CPU_SIZE_T   str_len;
+    CPU_INT08U   fixed_hdr_byte;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+    #endif
+
+    if ((p_template == DEF_NULL) ||
+        (topic_str  == DEF_NULL)) {
+       *p_err = MQTTc_ERR_NULL_PTR;
+        return;
+    }
+
+    if (qos_lvl > MQTT_MSG_QOS_LVL_MAX) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    str_len = Str_Len(topic_str);                               /* See Note #1.                                         */
+    if ((str_len == 0u) ||
+        (str_len >  DEF_INT_16U_MAX_VAL)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_char = Str_Char_N(topic_str,                              /* # sign not allowed in topic.                         */
+                        str_len,
+                        ASCII_CHAR_NUMBER_SIGN);
+    if (p_char != DEF_NULL) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_char = Str_Char_N(topic_str,                              /* + sign not allowed in topic.                         */
+                        str_len,
+                        ASCII_CHAR_PLUS_SIGN);
+    if (p_char != DEF_NULL) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    fixed_hdr_byte = MQTT_MSG_TYPE_PUBLISH | (qos_lvl << MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT);
+    if (retain_flag == DEF_YES) {
+        DEF_BIT_SET(fixed_hdr_byte, MQTT_MSG_FIXED_HDR_FLAGS_RETAIN_MSK);
+    }
+
+    p_template->TopicStr           =  topic_str;
+    p_template->TopicLen           = (CPU_INT16U)str_len;
+    p_template->TopicLenEncoded[0] = (CPU_INT08U)(str_len >> 8u);
+    p_template->TopicLenEncoded[1] = (CPU_INT08U)(str_len & 0xFFu);
+    p_template->QoS                =  qos_lvl;
+    p_template->FixedHdrByte       =  fixed_hdr_byte;
+    p_template->VarHdrLen          =  str_len + MQTT_MSG_UTF8_LEN_SIZE;
+    if (qos_lvl > 0u) {
+        p_template->VarHdrLen += MQTT_MSG_ID_SIZE;
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+
+    return;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_PublishByTemplate()
+*
+* Description : Send a 'Publish' message to MQTT server, using a pre-encoded publish template.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+*               p_template      Pointer to publish template, filled by MQTTc_PublishTemplateCreate().
+*
+*               p_payload       Pointer to the payload to publish.
+*
+*               payload_len     The length of the payload to publish.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
+*                                   MQTTc_ERR_TX_Q_FULL         Conn's tx q is full. See MQTTc_ConnSetParam() Note #4.
+*                                   MQTTc_ERR_FAIL              Operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The topic has already been validated and its length computed when the template was
+*                   created. Only the fixed header, message ID and payload are encoded here.
+*
+*               (2) The payload len is checked before the rem len is computed, so that the sum cannot wrap.
+*                   The fixed hdr is encoded in a local buf and the whole msg len is checked against the msg
+*                   buf before anything is written to it.
+*********************************************************************************************************
+*/
+
+void  MQTTc_PublishByTemplate (       MQTTc_CONN              *p_conn,
+                                      MQTTc_MSG               *p_msg,
+                               const  MQTTc_PUBLISH_TEMPLATE  *p_template,
+                               const  CPU_CHAR                *p_payload,
+                                      CPU_INT32U               payload_len,
+                                      MQTTc_ERR               *p_err)
+{
+    CPU_INT08U   hdr_buf[1u + MQTT_MSG_FIXED_HDR_REM_LEN_NBR_BYTES_MAX];
     CPU_INT08U  *p_buf_start;
     CPU_INT08U  *p_buf;
     CPU_INT32U   xfer_len;
-    CPU_INT16U   str_len;
-    CPU_INT16U   rem_len;
-    CPU_INT16U   msg_id;
-    CPU_INT08U   topic_ix;
+    CPU_INT32U   hdr_len;
+    CPU_INT32U   rem_len;
+    CPU_INT16U   msg_id      = MQTT_MSG_ID_NONE;
 
 
     #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
@@ -1491,147 +2456,74 @@ void  MQTTc_SubscribeMult (       MQTTc_CONN   *p_conn,
             return;
         }
 
-                                                                /* Make sure buf can hold topics of 1 byte and its QoS. */
-        if (p_msg->BufLen < (MQTT_MSG_BASE_LEN + 1u + (topic_nbr * (MQTT_MSG_UTF8_LEN_SIZE + 1u)))) {
-           *p_err = MQTTc_ERR_INVALID_ARG;
+        if (p_template == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
             return;
         }
 
-        if (topic_str_tbl == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
+        if (p_template->TopicStr == DEF_NULL) {                 /* Make sure tmpl has been created.                     */
+           *p_err = MQTTc_ERR_INVALID_ARG;
             return;
         }
 
-        if (req_qos_tbl == DEF_NULL) {
-           *p_err = MQTTc_ERR_INVALID_ARG;
+        if ((p_template->QoS != 0u) &&                          /* Make sure buf can at least hold reply from server.   */
+            (p_msg->BufLen   <  MQTT_MSG_BASE_LEN)) {
+           *p_err = MQTTc_ERR_INVALID_BUF_SIZE;
             return;
         }
     #endif
 
-    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
-    p_buf_base  = (CPU_INT08U *)p_msg->ArgPtr;
-    rem_len     =  MQTT_MSG_ID_SIZE;
-
-    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {     /* Calculate len of all topics and their QoS.           */
-        #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
-                                                                /* Make sure each ix contains a valid str and QoS.      */
-            if (topic_str_tbl[topic_ix] == DEF_NULL) {
-               *p_err = MQTTc_ERR_NULL_PTR;
-                return;
-            }
-
-            if (req_qos_tbl[topic_ix] > MQTT_MSG_QOS_LVL_MAX) {
-               *p_err = MQTTc_ERR_INVALID_ARG;
-                return;
-            }
-        #endif
-
-        str_len = Str_Len(topic_str_tbl[topic_ix]);
-
-        #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
-            p_buf = (CPU_INT08U *)Str_Char_N(topic_str_tbl[topic_ix],
-                                             str_len,
-                                             ASCII_CHAR_NUMBER_SIGN);
-            if (p_buf != DEF_NULL) {
-                if (str_len != 1u) {                            /* If topic is '#' by itself, no err.                   */
-                    if (*(p_buf - 1u) != ASCII_CHAR_SOLIDUS) {  /* '#' must be preceded by a '/'.                       */
-                       *p_err = MQTTc_ERR_INVALID_ARG;
-                        return;
-                    }
-                                                                /* '#' must be the last character in topic.             */
-                    if (p_buf != (CPU_INT08U *)&topic_str_tbl[topic_ix][str_len - 1u]) {
-                       *p_err = MQTTc_ERR_INVALID_ARG;
-                        return;
-                    }
-                }
-            }
-
-            p_buf = (CPU_INT08U *)Str_Char_N(topic_str_tbl[topic_ix],
-                                             str_len,
-                                             ASCII_CHAR_PLUS_SIGN);
-            if (p_buf != DEF_NULL) {
-                if (str_len != 1u) {                            /* If topic is '+' by itself, no err.                   */
-                    if (*(p_buf - 1u) != ASCII_CHAR_SOLIDUS) {  /* '+' must be preceded by a '/'.                       */
-                       *p_err = MQTTc_ERR_INVALID_ARG;
-                        return;
-                    }
-                                                                /* If '+' is not last char, it must be followed by '/'. */
-                    if ((  p_buf       != (CPU_INT08U *)&topic_str_tbl[topic_ix][str_len - 1u]) &&
-                        (*(p_buf + 1u) !=  ASCII_CHAR_SOLIDUS)) {
-                       *p_err = MQTTc_ERR_INVALID_ARG;
-                        return;
-                    }
-                }
-            }
-        #endif
-
-        rem_len += str_len + MQTT_MSG_UTF8_LEN_SIZE;
-        rem_len += 1u;
-    }
-
-                                                                /* Write topics QoS and nbr of topics before ...        */
-                                                                /* content. See Note #1.                                */
-    for (topic_ix = topic_nbr; topic_ix > 0u; topic_ix--) {
-       *p_buf_start = req_qos_tbl[topic_ix - 1u];
-        p_buf_start++;
-    }
-   *p_buf_start = topic_nbr;
-    p_buf_start++;
-
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf_base, 10u);
-
-    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
-                                 MQTTc_MSG_TYPE_SUBSCRIBE,
-                                 DEF_NO,
-                                 1u,
-                                 DEF_NO,
-                                 rem_len,
-                                 p_err);
-    if (*p_err != MQTTc_ERR_NONE) {
+                                                                /* See Note #2.                                         */
+    if (payload_len > (MQTT_MSG_FIXED_HDR_REM_LEN_MAX - p_template->VarHdrLen)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
         return;
     }
+    rem_len = p_template->VarHdrLen + payload_len;              /* See Note #1.                                         */
 
-    if ((rem_len + ((CPU_INT16U)(p_buf - p_buf_base))) > p_msg->BufLen) {
-                                                                /* Confirm msg fits in provided buf.                    */
+    hdr_buf[0u] = p_template->FixedHdrByte;                     /* Copy pre-encoded fixed hdr byte and encode rem len.  */
+    p_buf       = MQTTc_RemLenBufCfg(&hdr_buf[1u], rem_len);
+    hdr_len     = (CPU_INT32U)(p_buf - &hdr_buf[0u]);
+
+    if ((hdr_len + rem_len) > p_msg->BufLen) {                  /* Confirm msg fits in provided buf.                    */
        *p_err = MQTTc_ERR_INVALID_BUF_SIZE;
         return;
     }
 
-    msg_id = MQTTc_MsgID_Get();
-   *p_buf = (CPU_INT08U)(msg_id >> 8u);
+    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
+    Mem_Copy(p_buf_start, hdr_buf, hdr_len);
+    p_buf       = &p_buf_start[hdr_len];
+
+   *p_buf = p_template->TopicLenEncoded[0u];                    /* Copy topic, without re-computing its len.            */
     p_buf++;
-   *p_buf = (CPU_INT08U)(msg_id & 0xFFu);
+   *p_buf = p_template->TopicLenEncoded[1u];
     p_buf++;
+    Mem_Copy(p_buf,
+             p_template->TopicStr,
+             p_template->TopicLen);
+    p_buf += p_template->TopicLen;
 
-    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {     /* Calculate len of all topics and their QoS.           */
-
-        str_len = Str_Len(topic_str_tbl[topic_ix]);
+    if (p_template->QoS > 0u) {                                 /* Obtain msg ID if QoS > 0.                            */
+        msg_id = MQTTc_MsgID_Get();
 
-       *p_buf = (CPU_INT08U)(str_len >> 8u);
-        p_buf++;
-       *p_buf = (CPU_INT08U)(str_len & 0xFFu);
+       *p_buf = (CPU_INT08U)(msg_id >> 8u);
         p_buf++;
-
-        Str_Copy((CPU_CHAR *)p_buf, topic_str_tbl[topic_ix]);
-
-        p_buf += str_len;
-
-       *p_buf = req_qos_tbl[topic_ix];
+       *p_buf = (CPU_INT08U)(msg_id & 0xFFu);
         p_buf++;
     }
 
-    xfer_len = p_buf - p_buf_start;
+    Mem_Copy(p_buf,                                             /* Copy payload.                                        */
+             p_payload,
+             payload_len);
 
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf_start, 150u);
+    p_buf += payload_len;
 
-    p_msg->ArgPtr  = (void *)p_buf_start;                       /* Adjust BufPtr to start of content to send.           */
-    p_msg->BufLen -= (topic_nbr + 1u);                          /* Adjust BufLen to account for topics Qos.             */
+    xfer_len = p_buf - p_buf_start;
 
     MQTTc_MsgPost(p_conn,                                       /* Post msg to Q for task to process.                   */
                   p_msg,
-                  MQTTc_MSG_TYPE_SUBSCRIBE,
+                  MQTTc_MSG_TYPE_PUBLISH,
                   xfer_len,
-                  1u,
+                  p_template->QoS,
                   msg_id,
                   p_err);
     if (*p_err != MQTTc_ERR_NONE) {
@@ -1642,92 +2534,65 @@ void  MQTTc_SubscribeMult (       MQTTc_CONN   *p_conn,
 }
 
 
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
 /*
 *********************************************************************************************************
-*                                          MQTTc_Unsubscribe()
+*                                         MQTTc_PublishStore()
 *
-* Description : Send a 'Unsubscribe' message to MQTT server.
+* Description : Append a 'Publish' message to the store of given MQTTc Connection, for it to be tx'd to
+*               the MQTT server once the connection is open.
 *
 * Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
 *
-*               p_msg           Pointer to MQTTc Message object to use.
-*
-*               topic_str       String containing the topic at which to unsubscribe. Must stay valid
-*                               until the message has been completely sent.
-*
-*               p_err           Pointer to variable that will receive the return error code from this function :
-*                                   MQTTc_ERR_NONE              Operation successful.
-*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
-*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
-*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
-*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
-*                                   MQTTc_ERR_FAIL              Operation failed.
-*
-* Return(s)   : none.
-*
-* Caller(s)   : Application.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void  MQTTc_Unsubscribe (       MQTTc_CONN  *p_conn,
-                                MQTTc_MSG   *p_msg,
-                         const  CPU_CHAR    *topic_str,
-                                MQTTc_ERR   *p_err)
-{
-    MQTTc_UnsubscribeMult(p_conn,
-                          p_msg,
-                         &topic_str,
-                          1u,
-                          p_err);
-}
-
-
-/*
-*********************************************************************************************************
-*                                        MQTTc_UnsubscribeMult()
-*
-* Description : Send a 'Unsubscribe' message for multiple topics to MQTT server.
+*               topic_str       String containing the topic on which to publish.
 *
-* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+*               qos_lvl         Level of QoS at which to publish. MUST be 1 or 2.
 *
-*               p_msg           Pointer to MQTTc Message object to use.
+*               retain_flag     Flag indicating if the retain flag in the PUBLISH header needs to be set.
 *
-*               topic_str_tbl   Table containing string of all the topic(s) at which to unsubscribe. Must
-*                               all stay valid until the message has been completely sent.
+*               p_payload       Pointer to the payload to publish.
 *
-*               topic_nbr       Number of topic contained in tables.
+*               payload_len     The length of the payload to publish.
 *
 *               p_err           Pointer to variable that will receive the return error code from this function :
 *                                   MQTTc_ERR_NONE              Operation successful.
 *                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
 *                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
 *                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
-*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
-*                                   MQTTc_ERR_FAIL              Operation failed.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Msg does not fit in a seg of the store.
+*                                   MQTTc_ERR_STORE_FULL        Store is full.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
 *
 * Return(s)   : none.
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The message is encoded and copied in the store before this function returns. Neither
+*                   the topic nor the payload need to stay valid afterwards.
+*
+*               (2) This function can be called whether the connection is open or not. See
+*                   MQTTc_ConnSetParam() Note #6.
+*
+*               (3) The message is acknowledged by the MQTT server, and thus published at QoS 1 or 2. Its
+*                   msg ID is assigned each time it is tx'd.
 *********************************************************************************************************
 */
 
-void  MQTTc_UnsubscribeMult (       MQTTc_CONN   *p_conn,
-                                    MQTTc_MSG    *p_msg,
-                             const  CPU_CHAR    **topic_str_tbl,
-                                    CPU_INT08U    topic_nbr,
-                                    MQTTc_ERR    *p_err)
+void  MQTTc_PublishStore (       MQTTc_CONN    *p_conn,
+                          const  CPU_CHAR      *topic_str,
+                                 CPU_INT08U     qos_lvl,
+                                 CPU_BOOLEAN    retain_flag,
+                          const  CPU_CHAR      *p_payload,
+                                 CPU_INT32U     payload_len,
+                                 MQTTc_ERR     *p_err)
 {
+    CPU_INT08U   hdr_buf[MQTTc_STORE_FIXED_HDR_MAX_LEN];
     CPU_INT08U  *p_buf_start;
     CPU_INT08U  *p_buf;
-    CPU_INT32U   xfer_len;
+    CPU_INT32U   hdr_len;
+    CPU_INT32U   rem_len;
     CPU_INT16U   str_len;
-    CPU_INT16U   rem_len;
-    CPU_INT16U   msg_id;
-    CPU_INT08U   topic_ix;
+    CPU_INT16U   msg_id_ix;
 
 
     #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
@@ -1740,122 +2605,115 @@ void  MQTTc_UnsubscribeMult (       MQTTc_CONN   *p_conn,
             return;
         }
 
-        if (p_conn == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
-            return;
-        }
-
-        if (p_conn->SockId == NET_SOCK_ID_NONE) {
-           *p_err = MQTTc_ERR_INVALID_ARG;
-            return;
-        }
-
-        if (p_msg == DEF_NULL) {
+        if ((p_conn    == DEF_NULL) ||
+            (topic_str == DEF_NULL)) {
            *p_err = MQTTc_ERR_NULL_PTR;
             return;
         }
 
-        if (p_msg->ArgPtr == DEF_NULL) {
+        if ((p_payload   == DEF_NULL) &&
+            (payload_len != 0u)) {
            *p_err = MQTTc_ERR_NULL_PTR;
             return;
         }
 
-        if (p_msg->BufLen < MQTT_MSG_BASE_LEN) {
+        str_len =  Str_Len(topic_str);
+        p_buf   = (CPU_INT08U *)Str_Char_N(topic_str,           /* # sign not allowed in topic.                         */
+                                           str_len,
+                                           ASCII_CHAR_NUMBER_SIGN);
+        if (p_buf != DEF_NULL) {
            *p_err = MQTTc_ERR_INVALID_ARG;
             return;
         }
 
-        if (topic_str_tbl == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
+        p_buf = (CPU_INT08U *)Str_Char_N(topic_str,             /* + sign not allowed in topic.                         */
+                                         str_len,
+                                         ASCII_CHAR_PLUS_SIGN);
+        if (p_buf != DEF_NULL) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
             return;
         }
     #endif
 
-    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
-    rem_len     =  MQTT_MSG_ID_SIZE;
-
-    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {     /* Calculate len of all topics.                         */
-        #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
-            if (topic_str_tbl[topic_ix] == DEF_NULL) {          /* Make sure each ix contains a valid str.              */
-               *p_err = MQTTc_ERR_NULL_PTR;
-                return;
-            }
-        #endif
-
-        str_len  = Str_Len(topic_str_tbl[topic_ix]);
-        rem_len += str_len + MQTT_MSG_UTF8_LEN_SIZE;
+    if ((p_conn->StorePtr == DEF_NULL) ||
+        (qos_lvl          == 0u)       ||                       /* See Note #3.                                         */
+        (qos_lvl          >  MQTT_MSG_QOS_LVL_MAX)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
     }
 
-    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
-                                 MQTTc_MSG_TYPE_UNSUBSCRIBE,
-                                 DEF_NO,
-                                 1u,
+    str_len = Str_Len(topic_str);
+    rem_len = str_len + MQTT_MSG_UTF8_LEN_SIZE + MQTT_MSG_ID_SIZE + payload_len;
+
+    p_buf = MQTTc_FixedHdrBufCfg(hdr_buf,                       /* Cfg fixed section of hdr. See Note #3.               */
+                                 MQTTc_MSG_TYPE_PUBLISH,
                                  DEF_NO,
+                                 qos_lvl,
+                                 retain_flag,
                                  rem_len,
                                  p_err);
     if (*p_err != MQTTc_ERR_NONE) {
         return;
     }
+    hdr_len = (CPU_INT32U)(p_buf - hdr_buf);
 
-    if ((rem_len + ((CPU_INT16U)(p_buf - p_buf_start))) > p_msg->BufLen) {
-                                                                /* Confirm msg fits in provided buf.                    */
-       *p_err = MQTTc_ERR_INVALID_BUF_SIZE;
+    p_buf_start = MQTTc_StoreRecAlloc(p_conn->StorePtr,         /* See Note #1.                                         */
+                                      hdr_len + rem_len,
+                                      p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
         return;
     }
 
-    msg_id = MQTTc_MsgID_Get();                                 /* Obtain msg ID.                                       */
-   *p_buf = (CPU_INT08U)(msg_id >> 8u);
+    Mem_Copy(p_buf_start, hdr_buf, hdr_len);
+    p_buf = &p_buf_start[hdr_len];
+
+   *p_buf = (CPU_INT08U)(str_len >> 8u);                        /* Copy topic str.                                      */
     p_buf++;
-   *p_buf = (CPU_INT08U)(msg_id & 0xFFu);
+   *p_buf = (CPU_INT08U)(str_len & 0xFFu);
     p_buf++;
+    Mem_Copy(p_buf, topic_str, str_len);
+    p_buf += str_len;
 
-    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {
-        str_len = Str_Len(topic_str_tbl[topic_ix]);
-
-       *p_buf = (CPU_INT08U)(str_len >> 8u);
-        p_buf++;
-       *p_buf = (CPU_INT08U)(str_len & 0xFFu);
-        p_buf++;
-
-        Str_Copy((CPU_CHAR *)p_buf, topic_str_tbl[topic_ix]);
-
-        p_buf += str_len;
-    }
+    msg_id_ix = (CPU_INT16U)(p_buf - p_buf_start);              /* Msg ID is set when msg is tx'd.                      */
+   *p_buf     =  0u;
+    p_buf++;
+   *p_buf     =  0u;
+    p_buf++;
 
-    xfer_len = p_buf - p_buf_start;
+    Mem_Copy(p_buf,                                             /* Copy payload.                                        */
+             p_payload,
+             payload_len);
 
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf_start, 150u);
+    MQTTc_StoreRecCommit(p_conn->StorePtr, msg_id_ix);
 
-    MQTTc_MsgPost(p_conn,                                       /* Post msg in Q for task to process.                   */
-                  p_msg,
-                  MQTTc_MSG_TYPE_UNSUBSCRIBE,
-                  xfer_len,
-                  1u,
-                  msg_id,
-                  p_err);
-    if (*p_err != MQTTc_ERR_NONE) {
-        MQTTc_MsgID_Free(msg_id);
-    }
+   *p_err = MQTTc_ERR_NONE;
 
     return;
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                            MQTTc_PingReq()
+*                                           MQTTc_Subscribe()
 *
-* Description : Send a 'PingReq' message to MQTT server.
+* Description : Send a 'Subscribe' message to MQTT server.
 *
 * Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
 *
 *               p_msg           Pointer to MQTTc Message object to use.
 *
+*               topic_str       String containing the topic at which to subscribe. Must stay valid until
+*                               the message has been completely sent.
+*
+*               req_qos         Requested level of QoS for this subscription.
+*
 *               p_err           Pointer to variable that will receive the return error code from this function :
 *                                   MQTTc_ERR_NONE              Operation successful.
 *                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
 *                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
 *                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
 *                                   MQTTc_ERR_FAIL              Operation failed.
 *
 * Return(s)   : none.
@@ -1866,112 +2724,85 @@ void  MQTTc_UnsubscribeMult (       MQTTc_CONN   *p_conn,
 *********************************************************************************************************
 */
 
-void  MQTTc_PingReq (MQTTc_CONN  *p_conn,
-                     MQTTc_MSG   *p_msg,
-                     MQTTc_ERR   *p_err)
+void  MQTTc_Subscribe (       MQTTc_CONN  *p_conn,
+                              MQTTc_MSG   *p_msg,
+                       const  CPU_CHAR    *topic_str,
+                              CPU_INT08U   req_qos,
+                              MQTTc_ERR   *p_err)
 {
-    CPU_INT08U  *p_buf_start;
-    CPU_INT08U  *p_buf;
-    CPU_INT32U   xfer_len;
-
-
-    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
-        if (p_err == DEF_NULL) {
-            CPU_SW_EXCEPTION(;);
-        }
-
-        if (MQTTc_Ptr == DEF_NULL) {                            /* Make sure MQTTc module is init.                      */
-           *p_err = MQTTc_ERR_NOT_INIT;
-            return;
-        }
-
-        if (p_conn == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
-            return;
-        }
-
-        if (p_conn->SockId == NET_SOCK_ID_NONE) {
-           *p_err = MQTTc_ERR_INVALID_ARG;
-            return;
-        }
-
-        if (p_msg == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
-            return;
-        }
-
-        if (p_msg->ArgPtr == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
-            return;
-        }
-
-        if (p_msg->BufLen < MQTT_MSG_PING_DISCONN_LEN) {
-           *p_err = MQTTc_ERR_INVALID_ARG;
-            return;
-        }
-    #endif
-
-    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
-
-    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
-                                 MQTTc_MSG_TYPE_PINGREQ,
-                                 DEF_NO,
-                                 0u,
-                                 DEF_NO,
-                                 0u,
-                                 p_err);
-    if (*p_err != MQTTc_ERR_NONE) {
-        return;
-    }
-
-    xfer_len = p_buf - p_buf_start;
-
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf, 150u);
-
-    MQTTc_MsgPost(p_conn,                                       /* Post msg in Q for task to process.                   */
-                  p_msg,
-                  MQTTc_MSG_TYPE_PINGREQ,
-                  xfer_len,
-                  0u,
-                  MQTT_MSG_ID_NONE,
-                  p_err);
-
-    return;
+    MQTTc_SubscribeMult(p_conn,
+                        p_msg,
+                       &topic_str,
+                       &req_qos,
+                        1u,
+                        p_err);
 }
 
 
 /*
 *********************************************************************************************************
-*                                          MQTTc_Disconnect()
+*                                         MQTTc_SubscribeMult()
 *
-* Description : Send a 'Disconnect' message to MQTT server.
+* Description : Send a 'Subscribe' message containing multiple topics to MQTT server.
 *
 * Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
 *
 *               p_msg           Pointer to MQTTc Message object to use.
 *
+*               topic_str_tbl   Table containing string of all the topic(s) at which to subscribe. Must
+*                               all stay valid until the message has been completely sent.
+*
+*               req_qos_tbl     Table of the requested level of QoS for each subscription.
+*
+*               topic_nbr       Number of topic and QoS contained in tables.
+*
 *               p_err           Pointer to variable that will receive the return error code from this function :
 *                                   MQTTc_ERR_NONE              Operation successful.
 *                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
 *                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
 *                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
 *                                   MQTTc_ERR_FAIL              Operation failed.
 *
 * Return(s)   : none.
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) To compare with the granted QoS returned by the server with the SUBACK message, the
+*                   number of topics and their QoSes are kept before the actual content to send to the
+*                   server. For 3 topics, the buffer would look like this:
+*
+*                   Original p_msg->BufPtr           Modified p_msg->BufPtr
+*                                   |               |   Start of msg sent to server.
+*                                   |               |  |
+*                                   V               V  V
+*                                   ------------------------------
+*                                   | 2 | 0 | 1 | 3 | 0x82 | ... |
+*                                   ------------------------------
+*                                    ^    ^   ^   ^
+*                                    |    |   |   |
+*                          QoS Topic 3    |   |   |
+*                               QoS Topic 2   |   |
+*                                   QoS Topic 1   |
+*                                          Topic Nbr
 *********************************************************************************************************
 */
 
-void  MQTTc_Disconnect (MQTTc_CONN  *p_conn,
-                        MQTTc_MSG   *p_msg,
-                        MQTTc_ERR   *p_err)
+void  MQTTc_SubscribeMult (       MQTTc_CONN   *p_conn,
+                                  MQTTc_MSG    *p_msg,
+                           const  CPU_CHAR    **topic_str_tbl,
+                                  CPU_INT08U   *req_qos_tbl,
+                                  CPU_INT08U    topic_nbr,
+                                  MQTTc_ERR    *p_err)
 {
-    CPU_INT08U  *p_buf;
+    CPU_INT08U  *p_buf_base;
     CPU_INT08U  *p_buf_start;
+    CPU_INT08U  *p_buf;
     CPU_INT32U   xfer_len;
+    CPU_INT16U   str_len;
+    CPU_INT16U   rem_len;
+    CPU_INT16U   msg_id;
+    CPU_INT08U   topic_ix;
 
 
     #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
@@ -1999,36 +2830,153 @@ void  MQTTc_Disconnect (MQTTc_CONN  *p_conn,
             return;
         }
 
-        if (p_msg->BufLen < MQTT_MSG_PING_DISCONN_LEN) {
+        if (p_msg->ArgPtr == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+
+                                                                /* Make sure buf can hold topics of 1 byte and its QoS. */
+        if (p_msg->BufLen < (MQTT_MSG_BASE_LEN + 1u + (topic_nbr * (MQTT_MSG_UTF8_LEN_SIZE + 1u)))) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
+
+        if (topic_str_tbl == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+
+        if (req_qos_tbl == DEF_NULL) {
            *p_err = MQTTc_ERR_INVALID_ARG;
             return;
         }
     #endif
 
     p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
+    p_buf_base  = (CPU_INT08U *)p_msg->ArgPtr;
+    rem_len     =  MQTT_MSG_ID_SIZE;
 
-    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
-                                 MQTTc_MSG_TYPE_DISCONNECT,
-                                 DEF_NO,
-                                 0u,
-                                 DEF_NO,
-                                 0u,
-                                 p_err);
-    if (*p_err != MQTTc_ERR_NONE) {
-        return;
+    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {     /* Calculate len of all topics and their QoS.           */
+        #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+                                                                /* Make sure each ix contains a valid str and QoS.      */
+            if (topic_str_tbl[topic_ix] == DEF_NULL) {
+               *p_err = MQTTc_ERR_NULL_PTR;
+                return;
+            }
+
+            if (req_qos_tbl[topic_ix] > MQTT_MSG_QOS_LVL_MAX) {
+               *p_err = MQTTc_ERR_INVALID_ARG;
+                return;
+            }
+        #endif
+
+        str_len = Str_Len(topic_str_tbl[topic_ix]);
+
+        #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+            p_buf = (CPU_INT08U *)Str_Char_N(topic_str_tbl[topic_ix],
+                                             str_len,
+                                             ASCII_CHAR_NUMBER_SIGN);
+            if (p_buf != DEF_NULL) {
+                if (str_len != 1u) {                            /* If topic is '#' by itself, no err.                   */
+                    if (*(p_buf - 1u) != ASCII_CHAR_SOLIDUS) {  /* '#' must be preceded by a '/'.                       */
+                       *p_err = MQTTc_ERR_INVALID_ARG;
+                        return;
+                    }
+                                                                /* '#' must be the last character in topic.             */
+                    if (p_buf != (CPU_INT08U *)&topic_str_tbl[topic_ix][str_len - 1u]) {
+                       *p_err = MQTTc_ERR_INVALID_ARG;
+                        return;
+                    }
+                }
+            }
+
+            p_buf = (CPU_INT08U *)Str_Char_N(topic_str_tbl[topic_ix],
+                                             str_len,
+                                             ASCII_CHAR_PLUS_SIGN);
+            if (p_buf != DEF_NULL) {
+                if (str_len != 1u) {                            /* If topic is '+' by itself, no err.                   */
+                    if (*(p_buf - 1u) != ASCII_CHAR_SOLIDUS) {  /* '+' must be preceded by a '/'.                       */
+                       *p_err = MQTTc_ERR_INVALID_ARG;
+                        return;
+                    }
+                                                                /* If '+' is not last char, it must be followed by '/'. */
+                    if ((  p_buf       != (CPU_INT08U *)&topic_str_tbl[topic_ix][str_len - 1u]) &&
+                        (*(p_buf + 1u) !=  ASCII_CHAR_SOLIDUS)) {
+                       *p_err = MQTTc_ERR_INVALID_ARG;
+                        return;
+                    }
+                }
+            }
+        #endif
+
+        rem_len += str_len + MQTT_MSG_UTF8_LEN_SIZE;
+        rem_len += 1u;
+    }
+
+                                                                /* Write topics QoS and nbr of topics before ...        */
+                                                                /* content. See Note #1.                                */
+    for (topic_ix = topic_nbr; topic_ix > 0u; topic_ix--) {
+       *p_buf_start = req_qos_tbl[topic_ix - 1u];
+        p_buf_start++;
+    }
+   *p_buf_start = topic_nbr;
+    p_buf_start++;
+
+    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
+                                 MQTTc_MSG_TYPE_SUBSCRIBE,
+                                 DEF_NO,
+                                 1u,
+                                 DEF_NO,
+                                 rem_len,
+                                 p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        return;
+    }
+
+    if ((rem_len + ((CPU_INT16U)(p_buf - p_buf_base))) > p_msg->BufLen) {
+                                                                /* Confirm msg fits in provided buf.                    */
+       *p_err = MQTTc_ERR_INVALID_BUF_SIZE;
+        return;
+    }
+
+    msg_id = MQTTc_MsgID_Get();
+   *p_buf = (CPU_INT08U)(msg_id >> 8u);
+    p_buf++;
+   *p_buf = (CPU_INT08U)(msg_id & 0xFFu);
+    p_buf++;
+
+    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {     /* Calculate len of all topics and their QoS.           */
+
+        str_len = Str_Len(topic_str_tbl[topic_ix]);
+
+       *p_buf = (CPU_INT08U)(str_len >> 8u);
+        p_buf++;
+       *p_buf = (CPU_INT08U)(str_len & 0xFFu);
+        p_buf++;
+
+        Str_Copy((CPU_CHAR *)p_buf, topic_str_tbl[topic_ix]);
+
+        p_buf += str_len;
+
+       *p_buf = req_qos_tbl[topic_ix];
+        p_buf++;
     }
 
     xfer_len = p_buf - p_buf_start;
 
-    MQTTc_DBG_GLOBAL_BUF_COPY(p_buf, 150u);
+    p_msg->ArgPtr  = (void *)p_buf_start;                       /* Adjust BufPtr to start of content to send.           */
+    p_msg->BufLen -= (topic_nbr + 1u);                          /* Adjust BufLen to account for topics Qos.             */
 
-    MQTTc_MsgPost(p_conn,                                       /* Post msg in Q for task to process.                   */
+    MQTTc_MsgPost(p_conn,                                       /* Post msg to Q for task to process.                   */
                   p_msg,
-                  MQTTc_MSG_TYPE_DISCONNECT,
+                  MQTTc_MSG_TYPE_SUBSCRIBE,
                   xfer_len,
-                  0u,
-                  MQTT_MSG_ID_NONE,
+                  1u,
+                  msg_id,
                   p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        MQTTc_MsgID_Free(msg_id);
+    }
 
     return;
 }
@@ -2036,1452 +2984,4703 @@ void  MQTTc_Disconnect (MQTTc_CONN  *p_conn,
 
 /*
 *********************************************************************************************************
-*********************************************************************************************************
-*                                           LOCAL FUNCTIONS
-*********************************************************************************************************
+*                                          MQTTc_Unsubscribe()
+*
+* Description : Send a 'Unsubscribe' message to MQTT server.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+*               topic_str       String containing the topic at which to unsubscribe. Must stay valid
+*                               until the message has been completely sent.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
+*                                   MQTTc_ERR_FAIL              Operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : none.
 *********************************************************************************************************
 */
 
+void  MQTTc_Unsubscribe (       MQTTc_CONN  *p_conn,
+                                MQTTc_MSG   *p_msg,
+                         const  CPU_CHAR    *topic_str,
+                                MQTTc_ERR   *p_err)
+{
+    MQTTc_UnsubscribeMult(p_conn,
+                          p_msg,
+                         &topic_str,
+                          1u,
+                          p_err);
+}
+
+
 /*
 *********************************************************************************************************
-*                                             MQTTc_Task()
+*                                        MQTTc_UnsubscribeMult()
 *
-* Description : Task for MQTTc. Process select, read, write and msg Q.
+* Description : Send a 'Unsubscribe' message for multiple topics to MQTT server.
 *
-* Argument(s) : p_arg           Unused argument.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+*               topic_str_tbl   Table containing string of all the topic(s) at which to unsubscribe. Must
+*                               all stay valid until the message has been completely sent.
+*
+*               topic_nbr       Number of topic contained in tables.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Invalid buf size passed to function.
+*                                   MQTTc_ERR_FAIL              Operation failed.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : This is a task.
+* Caller(s)   : Application.
 *
 * Note(s)     : none.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_Task (void  *p_arg)
+void  MQTTc_UnsubscribeMult (       MQTTc_CONN   *p_conn,
+                                    MQTTc_MSG    *p_msg,
+                             const  CPU_CHAR    **topic_str_tbl,
+                                    CPU_INT08U    topic_nbr,
+                                    MQTTc_ERR    *p_err)
 {
-    MQTTc_CONN    *p_conn;
-    CPU_BOOLEAN    proc_rd;
-    CPU_BOOLEAN    proc_wr;
-    CPU_BOOLEAN    proc_err;
-    CPU_BOOLEAN    is_init   = DEF_NO;
-    CPU_INT32U     dly;
-    MQTTc_ERR      err_mqttc;
-
-
-    (void)&p_arg;
+    CPU_INT08U  *p_buf_start;
+    CPU_INT08U  *p_buf;
+    CPU_INT32U   xfer_len;
+    CPU_INT16U   str_len;
+    CPU_INT16U   rem_len;
+    CPU_INT16U   msg_id;
+    CPU_INT08U   topic_ix;
 
-    while (is_init != DEF_YES) {                                /* Wait for MQTTc module to be init.                    */
-        CPU_SR_ALLOC();
 
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
 
-        KAL_Dly(1u);
-        CPU_CRITICAL_ENTER();
-        is_init = (MQTTc_Ptr != DEF_NULL) ? DEF_YES : DEF_NO;
-        CPU_CRITICAL_EXIT();
-    }
+        if (MQTTc_Ptr == DEF_NULL) {                            /* Make sure MQTTc module is init.                      */
+           *p_err = MQTTc_ERR_NOT_INIT;
+            return;
+        }
 
-    while (DEF_TRUE) {
+        if (p_conn == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
-        if (MQTTc_Ptr->ConnHeadPtr != DEF_NULL) {
-            dly = MQTTc_Ptr->CfgPtr->TaskDly;
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
 
-            MQTTc_SockSel(MQTTc_Ptr->ConnHeadPtr,
-                         &err_mqttc);
+        if (p_msg == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
-            if (err_mqttc == MQTTc_ERR_NONE) {
+        if (p_msg->ArgPtr == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
-                p_conn = MQTTc_Ptr->ConnHeadPtr;
+        if (p_msg->BufLen < MQTT_MSG_BASE_LEN) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
 
-                while (p_conn != DEF_NULL) {
-                    MQTTc_CONN  *p_conn_next = p_conn->NextPtr;
+        if (topic_str_tbl == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
 
+    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
+    rem_len     =  MQTT_MSG_ID_SIZE;
 
-                    proc_rd  = MQTTc_SockSelDescProc(p_conn, MQTTc_SEL_DESC_TYPE_RD);
-                    proc_wr  = MQTTc_SockSelDescProc(p_conn, MQTTc_SEL_DESC_TYPE_WR);
-                    proc_err = MQTTc_SockSelDescProc(p_conn, MQTTc_SEL_DESC_TYPE_ERR);
-
-
-                    if (proc_err == DEF_YES) {
-                        MQTTc_ERR_CALLBACK   on_err_callback;
-                        void                *p_callback_arg;
+    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {     /* Calculate len of all topics.                         */
+        #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+            if (topic_str_tbl[topic_ix] == DEF_NULL) {          /* Make sure each ix contains a valid str.              */
+               *p_err = MQTTc_ERR_NULL_PTR;
+                return;
+            }
+        #endif
 
+        str_len  = Str_Len(topic_str_tbl[topic_ix]);
+        rem_len += str_len + MQTT_MSG_UTF8_LEN_SIZE;
+    }
 
-                        on_err_callback = p_conn->OnErrCallback;
-                        p_callback_arg  = p_conn->ArgPtr;
+    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
+                                 MQTTc_MSG_TYPE_UNSUBSCRIBE,
+                                 DEF_NO,
+                                 1u,
+                                 DEF_NO,
+                                 rem_len,
+                                 p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        return;
+    }
 
-                        MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Sock sel error for sock ID %i. Closing it.\r\n", p_conn->SockId));
+    if ((rem_len + ((CPU_INT16U)(p_buf - p_buf_start))) > p_msg->BufLen) {
+                                                                /* Confirm msg fits in provided buf.                    */
+       *p_err = MQTTc_ERR_INVALID_BUF_SIZE;
+        return;
+    }
 
-                        MQTTc_ConnCloseProc(p_conn,
-                                           &err_mqttc);
+    msg_id = MQTTc_MsgID_Get();                                 /* Obtain msg ID.                                       */
+   *p_buf = (CPU_INT08U)(msg_id >> 8u);
+    p_buf++;
+   *p_buf = (CPU_INT08U)(msg_id & 0xFFu);
+    p_buf++;
 
-                        if (on_err_callback != DEF_NULL) {
-                            on_err_callback(p_conn,
-                                            p_callback_arg,
-                                            MQTTc_ERR_SOCK_FAIL);
-                        }
+    for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {
+        str_len = Str_Len(topic_str_tbl[topic_ix]);
 
-                    } else if (proc_wr == DEF_YES) {
-                        MQTTc_MSG  *p_msg = DEF_NULL;
-
-
-                        if (p_conn->PublishRxMsgPtr->State == MQTTc_MSG_STATE_WAIT_TX_CMPL) {
-                            p_msg = p_conn->PublishRxMsgPtr;
-                        } else if ((p_conn->TxMsgHeadPtr        != DEF_NULL) &&
-                                   (p_conn->TxMsgHeadPtr->State == MQTTc_MSG_STATE_WAIT_TX_CMPL)) {
-                            p_msg = p_conn->TxMsgHeadPtr;
-                        } else if (p_conn->PublishRxMsgPtr->State == MQTTc_MSG_STATE_MUST_TX) {
-                            p_msg = p_conn->PublishRxMsgPtr;
-                        } else if ((p_conn->TxMsgHeadPtr        != DEF_NULL) &&
-                                   (p_conn->TxMsgHeadPtr->State == MQTTc_MSG_STATE_MUST_TX)) {
-                            p_msg = p_conn->TxMsgHeadPtr;
-                        } else {
-                            MQTTc_SockSelDescClr(p_conn, MQTTc_SEL_DESC_TYPE_WR);
-                        }
+       *p_buf = (CPU_INT08U)(str_len >> 8u);
+        p_buf++;
+       *p_buf = (CPU_INT08U)(str_len & 0xFFu);
+        p_buf++;
 
-                        if (p_msg != DEF_NULL) {
-                            MQTTc_WrSockProcess(p_msg);
-                        }
-                    } else if (proc_rd == DEF_YES) {
-                        MQTTc_RdSockProcess(p_conn);
-                    }
+        Str_Copy((CPU_CHAR *)p_buf, topic_str_tbl[topic_ix]);
 
-                    if ((p_conn->TxMsgHeadPtr        != DEF_NULL) &&
-                        (p_conn->TxMsgHeadPtr->State == MQTTc_MSG_STATE_MUST_TX)) {
-                        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
-                    }
-                    p_conn = p_conn_next;
-                }
-            }
-        } else {
-            dly = DEF_MAX(1u, MQTTc_Ptr->CfgPtr->TaskDly);      /* In this case the task must absolutely dly.           */
-        }
+        p_buf += str_len;
+    }
 
-        MQTTc_MsgProcess();
+    xfer_len = p_buf - p_buf_start;
 
-        KAL_Dly(dly);
+    MQTTc_MsgPost(p_conn,                                       /* Post msg in Q for task to process.                   */
+                  p_msg,
+                  MQTTc_MSG_TYPE_UNSUBSCRIBE,
+                  xfer_len,
+                  1u,
+                  msg_id,
+                  p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        MQTTc_MsgID_Free(msg_id);
     }
+
+    return;
 }
 
 
 /*
 *********************************************************************************************************
-*                                         MQTTc_WrSockProcess()
+*                                            MQTTc_PingReq()
 *
-* Description : Process write operations required for given MQTTc message.
+* Description : Send a 'PingReq' message to MQTT server.
 *
-* Argument(s) : p_msg           Pointer to MQTTc Message object for which to process write operation.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_FAIL              Operation failed.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : MQTTc_Task().
+* Caller(s)   : Application.
 *
 * Note(s)     : none.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_WrSockProcess (MQTTc_MSG  *p_msg)
+void  MQTTc_PingReq (MQTTc_CONN  *p_conn,
+                     MQTTc_MSG   *p_msg,
+                     MQTTc_ERR   *p_err)
 {
-    MQTTc_CONN  *p_conn = p_msg->ConnPtr;
-    CPU_INT32U   buf_len;
-
+    CPU_INT08U  *p_buf_start;
+    CPU_INT08U  *p_buf;
+    CPU_INT32U   xfer_len;
 
-    if (p_msg->State == MQTTc_MSG_STATE_MUST_TX) {              /* If msg needs to be tx'd, tx it.                      */
 
-        switch (p_msg->Type) {
-            case MQTTc_MSG_TYPE_CONNECT:
-                                                                /* Set Rd and Err sel desc, to be able to rx CONNACK.   */
-                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_RD);
-                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_ERR);
-                                                                /* break intentionally omitted.                         */
-            case MQTTc_MSG_TYPE_PUBLISH:
-            case MQTTc_MSG_TYPE_PUBACK:
-            case MQTTc_MSG_TYPE_PUBREC:
-            case MQTTc_MSG_TYPE_PUBREL:
-            case MQTTc_MSG_TYPE_PUBCOMP:
-            case MQTTc_MSG_TYPE_SUBSCRIBE:
-            case MQTTc_MSG_TYPE_UNSUBSCRIBE:
-            case MQTTc_MSG_TYPE_PINGREQ:
-            case MQTTc_MSG_TYPE_DISCONNECT:
-                 buf_len = DEF_MIN((p_msg->XferLen - p_conn->NextTxMsgTxLen), DEF_INT_16U_MAX_VAL);
-                 MQTTc_DBG_TRACE_DBG(("Transmitting %i bytes on sock ID %i. Msg Type: %i\r\n",
-                                       p_msg->XferLen,
-                                       p_conn->SockId,
-                                       p_msg->Type));
-                 p_conn->NextTxMsgTxLen += MQTTc_SockTx(   p_conn,
-                                                       &(((CPU_INT08U *)p_msg->ArgPtr)[p_conn->NextTxMsgTxLen]),
-													       buf_len,
-                                                          &p_msg->Err);
-                 if (p_msg->Err != MQTTc_ERR_NONE) {            /* If err, exec callback and return.                    */
-                     MQTTc_MsgCallbackExec(p_msg);
-                 }
-                 if (p_conn->NextTxMsgTxLen == p_msg->XferLen) {
-                     p_msg->State           = MQTTc_MSG_STATE_WAIT_TX_CMPL;
-                     p_conn->NextTxMsgTxLen = 0u;
-                 }
-                 break;
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
 
+        if (MQTTc_Ptr == DEF_NULL) {                            /* Make sure MQTTc module is init.                      */
+           *p_err = MQTTc_ERR_NOT_INIT;
+            return;
+        }
 
-            case MQTTc_MSG_TYPE_CONNACK:                        /* These cases should never happen.                     */
-            case MQTTc_MSG_TYPE_SUBACK:
-            case MQTTc_MSG_TYPE_UNSUBACK:
-            case MQTTc_MSG_TYPE_PINGRESP:
-            default:
-                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In must Tx switch default case.\n\r"));
-                 break;
+        if (p_conn == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
         }
-    } else if (p_msg->State == MQTTc_MSG_STATE_WAIT_TX_CMPL) {
-        CPU_INT08U  *p_buf_topic_nbr;
-        CPU_INT08U   topic_nbr;
 
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
 
-                                                                /* Tx operation has finished. Go to next step of msg.   */
-        switch (p_msg->Type) {
-            case MQTTc_MSG_TYPE_CONNECT:                        /* Finished sending a CONNECT, wait to rx CONNACK reply.*/
-                 MQTTc_DBG_TRACE_LOG(("Finished sending Connect. Waiting to Rx Connack.\r\n"));
+        if (p_msg == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
-                 p_msg->Type    = MQTTc_MSG_TYPE_CONNACK;
-                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->XferLen = 2u;
-                 break;
+        if (p_msg->ArgPtr == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
+        if (p_msg->BufLen < MQTT_MSG_PING_DISCONN_LEN) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
+    #endif
 
-            case MQTTc_MSG_TYPE_PUBLISH:
-                 if (p_msg->QoS == 0u) {                        /* If QoS is 0, xfer is cmpl.                           */
-                     MQTTc_DBG_TRACE_LOG(("Finished sending Publish QoS 0. Executing callback.\r\n"));
-                     p_msg->Err = MQTTc_ERR_NONE;
-                     MQTTc_MsgCallbackExec(p_msg);
-                 } else if (p_msg->QoS == 1u) {                 /* If QoS is 1, send PUBACK reply.                      */
-                     MQTTc_DBG_TRACE_LOG(("Finished sending Publish QoS 1. Waiting to Rx Puback.\r\n"));
-                     p_msg->Type    = MQTTc_MSG_TYPE_PUBACK;
-                     p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                     p_msg->XferLen = 0u;
-                 } else {                                       /* If QoS is 2, send PUBREC reply.                      */
-                     MQTTc_DBG_TRACE_LOG(("Finished sending Publish QoS 2. Waiting to Rx Pubrec.\r\n"));
-                     p_msg->Type    = MQTTc_MSG_TYPE_PUBREC;
-                     p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                     p_msg->XferLen = 0u;
-                 }
-                 break;
+    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
 
+    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
+                                 MQTTc_MSG_TYPE_PINGREQ,
+                                 DEF_NO,
+                                 0u,
+                                 DEF_NO,
+                                 0u,
+                                 p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        return;
+    }
 
-            case MQTTc_MSG_TYPE_PUBACK:                         /* Finished sending a PUBACK, xfer is cmpl.             */
-                 MQTTc_DBG_TRACE_LOG(("Finished sending a Puback. Removing msg from list.\r\n"));
-                 p_msg->Type  = MQTTc_MSG_TYPE_PUBLISH;
-                 p_msg->State = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->Err   = MQTTc_ERR_NONE;
-                 break;
+    xfer_len = p_buf - p_buf_start;
 
+    MQTTc_MsgPost(p_conn,                                       /* Post msg in Q for task to process.                   */
+                  p_msg,
+                  MQTTc_MSG_TYPE_PINGREQ,
+                  xfer_len,
+                  0u,
+                  MQTT_MSG_ID_NONE,
+                  p_err);
 
-            case MQTTc_MSG_TYPE_PUBREC:                         /* Finished sending a PUBREC, wait to rx PUBREL.        */
-                 MQTTc_DBG_TRACE_LOG(("Finished sending a Pubrec. Waiting to Rx a Pubrel.\r\n"));
-                 p_msg->Type    = MQTTc_MSG_TYPE_PUBREL;
-                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->XferLen = 0u;
-                 break;
+    return;
+}
 
 
-            case MQTTc_MSG_TYPE_PUBREL:                         /* Finished sending a PUBREL, wait to rx PUBCOMP.       */
-                 MQTTc_DBG_TRACE_LOG(("Finished sending Pubrel. Waiting to Rx Pubcomp.\r\n"));
-                 p_msg->Type    = MQTTc_MSG_TYPE_PUBCOMP;
-                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->XferLen = 0u;
-                 break;
+/*
+*********************************************************************************************************
+*                                          MQTTc_Disconnect()
+*
+* Description : Send a 'Disconnect' message to MQTT server.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to use.
+*
+*               p_msg           Pointer to MQTTc Message object to use.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NOT_INIT          MQTTc module has not yet been initialized.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*                                   MQTTc_ERR_FAIL              Operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
 
+void  MQTTc_Disconnect (MQTTc_CONN  *p_conn,
+                        MQTTc_MSG   *p_msg,
+                        MQTTc_ERR   *p_err)
+{
+    CPU_INT08U  *p_buf;
+    CPU_INT08U  *p_buf_start;
+    CPU_INT32U   xfer_len;
 
-            case MQTTc_MSG_TYPE_PUBCOMP:                        /* Finished sending a PUBCOMP, xfer is cmpl.            */
-                 MQTTc_DBG_TRACE_LOG(("Finished sending a Pubcomp. Removing msg from list.\r\n"));
-                 p_msg->Type  = MQTTc_MSG_TYPE_PUBLISH;
-                 p_msg->State = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->Err   = MQTTc_ERR_NONE;
-                 break;
 
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
 
-            case MQTTc_MSG_TYPE_SUBSCRIBE:                      /* Finished sending a SUBSCRIBE, wait to rx SUBACK.     */
-                                                                /* Re-obtain nbr of topics in Subscribe msg. See ...    */
-                                                                /* Note #1 in MQTTc_SubscribeMult().                    */
-                 MQTTc_DBG_TRACE_LOG(("Finished sending Subscribe. Waiting to Rx Suback.\r\n"));
-
-
-                 p_buf_topic_nbr = ((CPU_INT08U *)p_msg->ArgPtr) - 1u;
-                 topic_nbr       =  p_buf_topic_nbr[0u];
-
-                 p_msg->Type    = MQTTc_MSG_TYPE_SUBACK;
-                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->XferLen = topic_nbr;
-                 break;
-
+        if (MQTTc_Ptr == DEF_NULL) {                            /* Make sure MQTTc module is init.                      */
+           *p_err = MQTTc_ERR_NOT_INIT;
+            return;
+        }
 
-            case MQTTc_MSG_TYPE_UNSUBSCRIBE:                    /* Finished sending a UNSUBSCRIBE, wait to rx UNSUBACK. */
-                 MQTTc_DBG_TRACE_LOG(("Finished sending Unsubscribe. Waiting to Rx Unsuback.\r\n"));
+        if (p_conn == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
-                 p_msg->Type    = MQTTc_MSG_TYPE_UNSUBACK;
-                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->XferLen = 0u;
-                 break;
+        if (p_conn->SockId == NET_SOCK_ID_NONE) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
 
+        if (p_msg == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
 
-            case MQTTc_MSG_TYPE_PINGREQ:                        /* Finished sending a PINGREQ, wait to rx PINGRESP.     */
-                 p_msg->Type    = MQTTc_MSG_TYPE_PINGRESP;
-                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
-                 p_msg->XferLen = 0u;
-                 break;
+        if (p_msg->BufLen < MQTT_MSG_PING_DISCONN_LEN) {
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return;
+        }
+    #endif
 
+    p_buf_start = (CPU_INT08U *)p_msg->ArgPtr;
 
-            case MQTTc_MSG_TYPE_DISCONNECT:                     /* Finished sending a DISCONNECT, clear sel descs.      */
-                 MQTTc_MsgCallbackExec(p_msg);
+    p_buf = MQTTc_FixedHdrBufCfg(p_buf_start,                   /* Cfg fixed hdr section of msg.                        */
+                                 MQTTc_MSG_TYPE_DISCONNECT,
+                                 DEF_NO,
+                                 0u,
+                                 DEF_NO,
+                                 0u,
+                                 p_err);
+    if (*p_err != MQTTc_ERR_NONE) {
+        return;
+    }
 
-                 MQTTc_ConnRemove(p_conn);
-                                                                /* Exec callbacks for msgs q'd under this conn.         */
-                 MQTTc_MsgListClosedCallbackExec(p_conn->TxMsgHeadPtr);
-                 p_conn->TxMsgHeadPtr = DEF_NULL;               /* Mark list as empty.                                  */
-                 break;
+    xfer_len = p_buf - p_buf_start;
 
+    MQTTc_MsgPost(p_conn,                                       /* Post msg in Q for task to process.                   */
+                  p_msg,
+                  MQTTc_MSG_TYPE_DISCONNECT,
+                  xfer_len,
+                  0u,
+                  MQTT_MSG_ID_NONE,
+                  p_err);
 
-            default:
-                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Wait Tx Cmpl switch, in default case.\n\r"));
-                 break;
-        }
-    }
+    return;
 }
 
 
 /*
 *********************************************************************************************************
-*                                         MQTTc_RdSockProcess()
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                             MQTTc_Task()
 *
-* Description : Process read operations required for given MQTTc Connection.
+* Description : Task for MQTTc. Process select, read, write and msg Q.
 *
-* Argument(s) : p_conn          Pointer to MQTTc Connection object for which to process read operations.
+* Argument(s) : p_arg           Unused argument.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : MQTTc_Task().
+* Caller(s)   : This is a task.
 *
-* Note(s)     : none.
+* Note(s)     : (1) Connections are served in deficit round-robin. Each time a connection is processed, its
+*                   read and its write operations are each credited with a deficit of its weight times
+*                   MQTTc_CFG_TASK_QUANTUM_BYTES, and can only rx or tx that many bytes. The rest is processed
+*                   on the next iteration, so that a connection moving a lot of data does not delay the others.
+*
+*                   (a) An operation that did not use all its deficit has nothing more to process at the
+*                       moment. Its deficit is reset, so that it cannot accumulate credit while idle.
+*
+*                   (b) If an operation used all its deficit, the task only dly for a single tick before its
+*                       next iteration. This keeps the throughput of a single busy connection, while lower
+*                       priority tasks still get to run.
+*
+*                   (c) A connection that is both readable and writable is read first, then written to, in
+*                       the same iteration. A bulk transfer that keeps the socket writable can therefore not
+*                       delay the rx of control msgs, such as PINGRESP, PUBACK or PUBREC.
+*
+*               (2) A connection whose next messages are held back by its tx rate limiter is not selected
+*                   for writing. Instead, the task dly is shortened, if needed, so that the task runs again
+*                   by the time the first of these messages can be tx'd. See MQTTc_ConnSetParam() Note #5.
+*
+*               (3) Expired messages are removed from the tx lanes before a connection is written to, so
+*                   that they are never tx'd, and after each iteration, so that they cmpl even if the
+*                   connection is stalled. See MQTTc_MsgSetParam() Note #3.
+*
+*               (4) The tx lanes are refilled from the connection's store after each iteration, as stored
+*                   messages are acknowledged. See MQTTc_ConnSetParam() Note #6.
+*
+*               (5) The records logged in the connection's WAL are synced before anything is tx'd, so that
+*                   the MQTT server never sees a state that the WAL does not cover. See
+*                   MQTTc_ConnSetParam() Note #8.
+*
+*               (6) While the initial sync of the connection's cache is in progress, the task dly is
+*                   shortened, if needed, so that its completion is detected on time. See
+*                   MQTTc_ConnSetParam() Note #9a.
+*
+*               (7) Msgs are rx'd one after the other, as long as the connection has deficit left and data
+*                   to rx. Each msg is charged for its fixed hdr, so that a flow of msgs without payload
+*                   cannot hold the task. The PUBLISH msgs rx'd are then delivered in a single batch, if
+*                   enabled. See MQTTc_ConnSetParam() Note #11a.
+*
+*               (8) The msgs that cmpl'd while a connection was processed are delivered in a single batch,
+*                   if enabled. See MQTTc_ConnSetParam() Note #12a.
+*
+*               (9) The statistics counters of a connection are copied to its snapshot once it has been
+*                   processed. See MQTTc_ConnStatsGet() Note #1.
+*
+*               (10) The phases recorded for the timelines during the iteration are written to the timeline
+*                    file, if one is open, outside of any recorded phase. See mqtt-c_timeline.c Note #2.
+*
+*               (11) The time of each iteration is split between its phases by the profiler, if enabled. The
+*                    task dly is accounted separately. See mqtt-c_prof.c Note #1.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_RdSockProcess (MQTTc_CONN  *p_conn)
+static  void  MQTTc_Task (void  *p_arg)
 {
-    MQTTc_MSG   *p_next_msg;
-    CPU_INT08U  *p_buf;
-    CPU_INT32U   rx_len;
-    MQTTc_ERR    err_mqttc;
+    MQTTc_CONN    *p_conn;
+    CPU_BOOLEAN    proc_rd;
+    CPU_BOOLEAN    proc_wr;
+    CPU_BOOLEAN    proc_err;
+    CPU_BOOLEAN    is_init   = DEF_NO;
+    CPU_BOOLEAN    is_throttled;
+    CPU_BOOLEAN    is_rx_cmpl;
+    CPU_INT32U     dly;
+    CPU_INT32U     rate_dly;
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+    CPU_INT32U     cache_dly;
+#endif
+    MQTTc_ERR      err_mqttc;
 
 
-    if (p_conn->NextMsgPtr == DEF_NULL) {                       /* If next msg is already known, skip this step.        */
-        if (p_conn->NextMsgHeader == DEF_BIT_NONE) {
+    (void)&p_arg;
 
-            (void)MQTTc_SockRx(p_conn,                          /* Read header (type, DUP, QoS and retain) of rx'd msg. */
-                              &p_conn->NextMsgHeader,
-                               1u,
-                              &err_mqttc);
-            if (err_mqttc == MQTTc_ERR_FATAL) {
-                goto err_remove_conn_close_sock;
-            } else if (err_mqttc != MQTTc_ERR_NONE) {           /* Wait for more data to be avail to continue.          */
-                return;
-            }
+    while (is_init != DEF_YES) {                                /* Wait for MQTTc module to be init.                    */
+        CPU_SR_ALLOC();
 
-            MQTTc_DBG_TRACE_DBG(("Rx'd msg type %i.\r\n", ((CPU_INT08U)(p_conn->NextMsgHeader & MQTT_MSG_TYPE_MSK) >> 4u)));
-                                                                /* Convert msg type to enum type.                       */
-            switch (p_conn->NextMsgHeader & MQTT_MSG_TYPE_MSK) {
-                case MQTT_MSG_TYPE_CONNACK:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_CONNACK;
-                     MQTTc_DBG_TRACE_LOG(("Connack event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
 
-                case MQTT_MSG_TYPE_PUBLISH:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBLISH;
-                     MQTTc_DBG_TRACE_LOG(("Publish event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+        KAL_Dly(1u);
+        CPU_CRITICAL_ENTER();
+        is_init = (MQTTc_Ptr != DEF_NULL) ? DEF_YES : DEF_NO;
+        CPU_CRITICAL_EXIT();
+    }
 
-                case MQTT_MSG_TYPE_PUBACK:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBACK;
-                     MQTTc_DBG_TRACE_LOG(("Puback event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+    while (DEF_TRUE) {
+        MQTTc_PROF_ITER_START();                                /* See Note #11.                                        */
 
-                case MQTT_MSG_TYPE_PUBREC:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBREC;
-                     MQTTc_DBG_TRACE_LOG(("Pubrec event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+        if (MQTTc_Ptr->ConnHeadPtr != DEF_NULL) {
+            dly          = MQTTc_Ptr->CfgPtr->TaskDly;
+            is_throttled = DEF_NO;
 
-                case MQTT_MSG_TYPE_PUBREL:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBREL;
-                     MQTTc_DBG_TRACE_LOG(("Pubrel event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+            MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_SEL, NET_SOCK_ID_NONE);
+            MQTTc_PROF_PHASE_START(MQTTc_PROF_PHASE_SEL);
+            MQTTc_SockSel(MQTTc_Ptr->ConnHeadPtr,
+                         &err_mqttc);
+            MQTTc_PROF_PHASE_END(MQTTc_PROF_PHASE_SEL);
+            MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_SEL);
 
-                case MQTT_MSG_TYPE_PUBCOMP:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBCOMP;
-                     MQTTc_DBG_TRACE_LOG(("Pubcomp event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+            if (err_mqttc == MQTTc_ERR_NONE) {
 
-                case MQTT_MSG_TYPE_SUBACK:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_SUBACK;
-                     MQTTc_DBG_TRACE_LOG(("Suback event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+                p_conn = MQTTc_Ptr->ConnHeadPtr;
 
-                case MQTT_MSG_TYPE_UNSUBACK:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_UNSUBACK;
-                     MQTTc_DBG_TRACE_LOG(("Unsuback event rx'd on sock ID %i.\n\r", p_conn->SockId));
-                     break;
+                while (p_conn != DEF_NULL) {
+                    MQTTc_CONN  *p_conn_next = p_conn->NextPtr;
 
-                case MQTT_MSG_TYPE_PINGRESP:
-                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PINGRESP;
-                     break;
 
+                    proc_rd  = MQTTc_SockSelDescProc(p_conn, MQTTc_SEL_DESC_TYPE_RD);
+                    proc_wr  = MQTTc_SockSelDescProc(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+                    proc_err = MQTTc_SockSelDescProc(p_conn, MQTTc_SEL_DESC_TYPE_ERR);
 
-                case MQTT_MSG_TYPE_CONNECT:
-                case MQTT_MSG_TYPE_SUBSCRIBE:
-                case MQTT_MSG_TYPE_UNSUBSCRIBE:
-                case MQTT_MSG_TYPE_PINGREQ:
-                case MQTT_MSG_TYPE_DISCONNECT:
-                default:
-                     MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Received wrong message type: %i\r\n", p_conn->NextMsgHeader));
-                     p_conn->NextMsgHeader = 0u;
-                     goto err_restart;                          /* These msg types cannot be rx'd. Flush rx buf.        */
-            }
-            p_conn->NextMsgRxLen = 0u;
-        }
-                                                                /* Make sure msg being rx'd is expected.                */
-        if (p_conn->NextMsgType != p_conn->PublishRxMsgPtr->Type) {
-            if (p_conn->TxMsgHeadPtr != DEF_NULL) {
-                if (p_conn->NextMsgType != p_conn->TxMsgHeadPtr->Type) {
-                    goto err_restart;
-                }
-            } else {
-                goto err_restart;
-            }
-        }
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+                    if ((proc_rd  == DEF_YES) ||
+                        (proc_wr  == DEF_YES) ||
+                        (proc_err == DEF_YES)) {
+                        MQTTc_STAT_INC(p_conn, SelWakeupCtr);
+                    }
+#endif
 
-        if (p_conn->NextMsgLenIsCmpl == DEF_NO) {
-            CPU_INT08U  rem_len;
-            CPU_INT32U  rx_len;
-            CPU_INT32U  multiplier;
+                    if (proc_err == DEF_YES) {
+                        MQTTc_ERR_CALLBACK   on_err_callback;
+                        void                *p_callback_arg;
 
 
-            do {                                                /* Read rem len of msg. This can be a multi-byte field. */
-                rx_len = MQTTc_SockRx(p_conn,
-                                     &rem_len,
-                                      1u,
-                                     &err_mqttc);
-                if (err_mqttc == MQTTc_ERR_FATAL) {
-                    goto err_remove_conn_close_sock;
-                } else if (err_mqttc != MQTTc_ERR_NONE) {       /* Wait for more data to be avail to continue.          */
-                    return;
-                }
-                                                                /* Calculate the multiplier which is a power of 128.    */
-                multiplier            = 1 << (7 * p_conn->NextMsgRxLen);
-                p_conn->NextMsgRxLen += rx_len;
-                                                                /* Use the multiplier to determine msg length           */
-                p_conn->NextMsgLen += (rem_len & MQTT_MSG_FIXED_HDR_REM_LEN_MSK) * multiplier;
+                        on_err_callback = p_conn->OnErrCallback;
+                        p_callback_arg  = p_conn->ArgPtr;
 
-                                                                /* Read msg as long as continuation bit is set, max 4x. */
-            }  while ((DEF_BIT_IS_SET(rem_len, MQTT_MSG_FIXED_HDR_REM_LEN_CONTINUATION_BIT) == DEF_YES) &&
-                      (p_conn->NextMsgRxLen                                                 <  MQTT_MSG_FIXED_HDR_REM_LEN_NBR_BYTES_MAX));
+                        MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Sock sel error for sock ID %i. Closing it.\r\n", p_conn->SockId));
+                        MQTTc_STAT_ERR_INC(p_conn, MQTTc_ERR_SOCK_FAIL);
 
-            p_conn->NextMsgLenIsCmpl = DEF_YES;
-            p_conn->NextMsgRxLen     = 0u;
+                        MQTTc_ConnCloseProc(p_conn,
+                                           &err_mqttc);
 
-            MQTTc_DBG_TRACE_DBG(("Finished reading msg len: %i on sock ID %i.\n\r", p_conn->NextMsgLen, p_conn->SockId));
-        }
+                        if (on_err_callback != DEF_NULL) {
+                            MQTTc_PROF_CALLBACK_START();
+                            on_err_callback(p_conn,
+                                            p_callback_arg,
+                                            MQTTc_ERR_SOCK_FAIL);
+                            MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_ERR);
+                        }
 
-        if ( (p_conn->NextMsgMsgID_IsCmpl == DEF_NO) &&
-            ((p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBACK)  ||
-             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBREC)  ||
-             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBREL)  ||
-             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBCOMP) ||
-             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_SUBACK)  ||
-             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_UNSUBACK))) {
-            CPU_INT08U  msg_id_rx[MQTT_MSG_ID_SIZE];
+                    } else {
+                        if (proc_rd == DEF_YES) {               /* Rd before wr. See Note #1c.                          */
+                            MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_RD, p_conn->SockId);
+                            MQTTc_PROF_PHASE_START(MQTTc_PROF_PHASE_RD);
+                                                                /* Credit rd deficit. See Note #1.                      */
+                            p_conn->SchedDeficit = (CPU_INT32U)MQTTc_CFG_TASK_QUANTUM_BYTES * p_conn->SchedWeight;
+
+                            do {                                /* See Note #7.                                         */
+                                is_rx_cmpl = MQTTc_RdSockProcess(p_conn);
+                                if (is_rx_cmpl == DEF_YES) {
+                                    p_conn->SchedDeficit -= DEF_MIN(p_conn->SchedDeficit, MQTT_MSG_BASE_LEN);
+                                }
+                            } while ((is_rx_cmpl           == DEF_YES) &&
+                                     (p_conn->SchedDeficit != 0u));
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+                            MQTTc_PublishRxBatchFlush(p_conn);
+#endif
+                            MQTTc_PROF_PHASE_END(MQTTc_PROF_PHASE_RD);
+                            MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_RD);
+                            if (p_conn->SchedDeficit == 0u) {
+                                is_throttled = DEF_YES;         /* See Note #1b.                                        */
+                            }
+                            p_conn->SchedDeficit = 0u;          /* See Note #1a.                                        */
+                        }
 
+                        if ((proc_wr        == DEF_YES) &&      /* Conn may have been closed by rd.                     */
+                            (p_conn->SockId != NET_SOCK_ID_NONE)) {
+                            CPU_BOOLEAN  is_coalesced;
 
-            if (p_conn->NextMsgRxLen == 1u) {                   /* If already rx'd 1 byte of MsgID, re-put in msg_id_rx.*/
-                msg_id_rx[0u] = (p_conn->NextMsgMsgID & 0xFF00u) >> 8u;
-            }
 
-            rx_len = MQTTc_SockRx(p_conn,                       /* Rx msg ID if msg has one.                            */
-                                 &msg_id_rx[p_conn->NextMsgRxLen],
-                                 (MQTT_MSG_ID_SIZE - p_conn->NextMsgRxLen),
-                                &err_mqttc);
-            if (err_mqttc == MQTTc_ERR_NONE) {
-                p_conn->NextMsgRxLen += rx_len;
-            } else if (err_mqttc == MQTTc_ERR_FATAL) {
-                goto err_remove_conn_close_sock;
-            } else {                                            /* Wait to be able to rx data to continue.              */
-                if ((err_mqttc == MQTTc_ERR_RX_BUF_EMPTY) &&
-                    (rx_len    == 1u)) {                        /* Keep first part of msg ID rx'd.                      */
-                    p_conn->NextMsgMsgID = (msg_id_rx[0u] << 8u);
-                    p_conn->NextMsgRxLen += 1u;
-                }
-                return;
-            }
+                            MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_WR, p_conn->SockId);
+                            MQTTc_PROF_PHASE_START(MQTTc_PROF_PHASE_WR);
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+                            if (p_conn->WalPtr != DEF_NULL) {   /* See Note #5.                                         */
+                                MQTTc_WalSync(p_conn->WalPtr);
+                            }
+#endif
+                            MQTTc_TxLaneExpire(p_conn);         /* Drop expired msgs before tx. See Note #3.            */
+                                                                /* Credit wr deficit. See Note #1.                      */
+                            p_conn->SchedDeficit = (CPU_INT32U)MQTTc_CFG_TASK_QUANTUM_BYTES * p_conn->SchedWeight;
+
+                            is_coalesced = MQTTc_WrSockCoalesceProcess(p_conn);
+                            if (is_coalesced == DEF_YES) {
+                                ;                               /* Msgs have been tx'd from conn's tx buf.              */
+                            } else if ((p_conn->AckQ_Len       != 0u) &&
+                                       (p_conn->NextTxMsgTxLen == 0u)) {
+                                MQTTc_WrSockAckProcess(p_conn); /* Tx q'd acks, unless a msg is partially tx'd.         */
+                            } else {
+                                if (p_conn->TxMsgCurPtr == DEF_NULL) {
+                                                                /* Sel next msg to tx from conn's tx lanes.             */
+                                    p_conn->TxMsgCurPtr = MQTTc_TxMsgGet(p_conn);
+                                }
+
+                                if (p_conn->TxMsgCurPtr != DEF_NULL) {
+                                    MQTTc_WrSockProcess(p_conn->TxMsgCurPtr);
+                                } else {
+                                    MQTTc_SockSelDescClr(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+                                }
+                            }
+                            MQTTc_PROF_PHASE_END(MQTTc_PROF_PHASE_WR);
+                            MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_WR);
+                            if (p_conn->SchedDeficit == 0u) {
+                                is_throttled = DEF_YES;         /* See Note #1b.                                        */
+                            }
+                            p_conn->SchedDeficit = 0u;          /* See Note #1a.                                        */
+                        }
+                    }
 
-            p_conn->NextMsgMsgID         = ((msg_id_rx[0u] << 8u) | msg_id_rx[1u]);
-            p_conn->NextMsgLen          -=   MQTT_MSG_ID_SIZE;
-            p_conn->NextMsgMsgID_IsCmpl  =   DEF_YES;
-            p_conn->NextMsgRxLen         =   0u;
+                    MQTTc_TxLaneExpire(p_conn);                 /* See Note #3.                                         */
 
-            MQTTc_DBG_TRACE_LOG(("Finished reading next msg msg ID.\n\r"));
-        }
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+                    MQTTc_ConnStoreFeed(p_conn);                /* See Note #4.                                         */
+#endif
 
-        if (p_conn->NextMsgType == p_conn->PublishRxMsgPtr->Type) {
-            p_conn->NextMsgPtr   = p_conn->PublishRxMsgPtr;
-                                                                /* Account for header that may need to be sent.         */
-                                                                /* Start rx'ing useful data at offset, to leave room.   */
-            p_conn->NextMsgRxLen = MQTTc_PUBLISH_RX_MSG_BUF_OFFSET;
-            if ((p_conn->NextMsgLen + MQTTc_PUBLISH_RX_MSG_BUF_OFFSET) > p_conn->NextMsgPtr->BufLen) {
-                MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Next msg len of Publish Msg (%i (+4 from header)) too big for msg buf (%i).\n\r",
-                                       p_conn->NextMsgLen,
-                                       p_conn->NextMsgPtr->BufLen));
-                p_conn->NextMsgPtr->Err = MQTTc_ERR_BUF_OVERFLOW;
-                goto err_callback_restart;
-            }
-        } else {
-            p_conn->NextMsgPtr = p_conn->TxMsgHeadPtr;
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+                    cache_dly = MQTTc_ConnCacheSyncProc(p_conn);
+                    if (cache_dly != 0u) {                      /* See Note #6.                                         */
+                        dly = DEF_MIN(dly, cache_dly);
+                    }
+#endif
 
-            if (p_conn->NextMsgLen != p_conn->NextMsgPtr->XferLen) {
-                MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Next msg len (%i) not equal to expected xfer len (%i).\n\r",
-                                       p_conn->NextMsgLen,
-                                       p_conn->NextMsgPtr->XferLen));
-                p_conn->NextMsgPtr->Err = MQTTc_ERR_BUF_OVERFLOW;
-                goto err_callback_restart;
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+                    MQTTc_CmplBatchFlush(p_conn);               /* See Note #8.                                         */
+#endif
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+                    MQTTc_ConnStatsSnap(p_conn);                /* See Note #9.                                         */
+#endif
+
+                    if (MQTTc_TxLaneSel(p_conn) != MQTTc_TX_LANE_NONE) {
+                        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+                    } else {
+                        rate_dly = MQTTc_TxRateDlyGet(p_conn);  /* See Note #2.                                         */
+                        if (rate_dly != 0u) {
+                            dly = DEF_MIN(dly, rate_dly);
+                        }
+                    }
+                    p_conn = p_conn_next;
+                }
             }
-            if (p_conn->NextMsgLen > p_conn->NextMsgPtr->BufLen) {
-                MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Next msg len (%i) too big for msg buf (%i).\n\r",
-                                       p_conn->NextMsgLen,
-                                       p_conn->NextMsgPtr->BufLen));
-                p_conn->NextMsgPtr->Err = MQTTc_ERR_BUF_OVERFLOW;
-                goto err_callback_restart;
+
+            if (is_throttled == DEF_YES) {                      /* See Note #1b.                                        */
+                dly = 1u;
             }
+        } else {
+            dly = DEF_MAX(1u, MQTTc_Ptr->CfgPtr->TaskDly);      /* In this case the task must absolutely dly.           */
         }
-    }
 
-                                                                /* At this point, p_conn->NextMsgPtr contains the ...   */
-                                                                /* next msg to process and all its infos have been ...  */
-                                                                /* rx'd. Only the payload still needs to be rx'd.       */
-    p_next_msg = p_conn->NextMsgPtr;
+        MQTTc_MsgProcess();
 
-    if (p_conn->NextMsgLen != 0u) {                             /* If there is more than the hdr to rx, rx it.          */
-        MQTTc_DBG_TRACE_DBG(("Rx'ing payload. Trying to read %i bytes. Already rx'd %i bytes.\n\r", p_conn->NextMsgLen, p_conn->NextMsgRxLen));
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+        MQTTc_TimelineFlush();                                  /* See Note #10.                                        */
+#endif
 
-        rx_len = MQTTc_SockRx(    p_conn,
-                              &(((CPU_INT08U *)p_next_msg->ArgPtr)[p_conn->NextMsgRxLen]),
-                                  p_conn->NextMsgLen,
-                                 &err_mqttc);
-        p_conn->NextMsgLen   -= rx_len;
-        p_conn->NextMsgRxLen += rx_len;
-        if (err_mqttc == MQTTc_ERR_FATAL) {
-            goto err_remove_conn_close_sock;
-        } else if (err_mqttc != MQTTc_ERR_NONE) {               /* Wait for more data to be avail to continue.          */
-            return;
-        }
+        MQTTc_PROF_ITER_END();
+        KAL_Dly(dly);
     }
+}
 
-    MQTTc_DBG_TRACE_DBG(("Finished rx'ing msg payload. Rx'd %i bytes.\n\r", p_conn->NextMsgRxLen));
 
-                                                                /* At this point, the payload has been completely rx'd. */
-    MQTTc_DBG_GLOBAL_BUF_COPY((CPU_INT08U *)p_next_msg->ArgPtr, p_conn->NextMsgRxLen);
+/*
+*********************************************************************************************************
+*                                         MQTTc_WrSockProcess()
+*
+* Description : Process write operations required for given MQTTc message.
+*
+* Argument(s) : p_msg           Pointer to MQTTc Message object for which to process write operation.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_WrSockCoalesceProcess().
+*
+* Note(s)     : (1) Once tx'd, a message that expects a reply is moved to the connection's list of messages
+*                   waiting for a reply. The reply is matched by its type and message ID, so any number of
+*                   messages can wait for their reply while other messages are tx'd.
+*********************************************************************************************************
+*/
 
+static  void  MQTTc_WrSockProcess (MQTTc_MSG  *p_msg)
+{
+    MQTTc_CONN  *p_conn = p_msg->ConnPtr;
+    CPU_INT32U   buf_len;
+    CPU_INT32U   tx_len;
 
-    if (p_next_msg->Type == MQTTc_MSG_TYPE_PUBLISH) {           /* Rx'd a Publish msg from broker.                      */
-                                                                /* 'p_next_msg' points to p_conn->PublishRxMsgPtr.      */
-        p_next_msg->QoS = (p_conn->NextMsgHeader & MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_MSK) >> MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT;
 
+    if (p_msg->State == MQTTc_MSG_STATE_MUST_TX) {              /* If msg needs to be tx'd, tx it.                      */
 
-                                                                /* Null-terminate rx'd msg payload.                     */
-        ((CPU_INT08U*)(p_next_msg->ArgPtr))[p_conn->NextMsgRxLen] = '\0';
+        switch (p_msg->Type) {
+            case MQTTc_MSG_TYPE_CONNECT:
+                                                                /* Set Rd and Err sel desc, to be able to rx CONNACK.   */
+                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_RD);
+                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_ERR);
+                                                                /* break intentionally omitted.                         */
+            case MQTTc_MSG_TYPE_PUBLISH:
+            case MQTTc_MSG_TYPE_PUBREL:
+            case MQTTc_MSG_TYPE_SUBSCRIBE:
+            case MQTTc_MSG_TYPE_UNSUBSCRIBE:
+            case MQTTc_MSG_TYPE_PINGREQ:
+            case MQTTc_MSG_TYPE_DISCONNECT:
+                 buf_len = DEF_MIN((p_msg->XferLen - p_conn->NextTxMsgTxLen), DEF_INT_16U_MAX_VAL);
+                 buf_len = DEF_MIN(buf_len, p_conn->SchedDeficit);
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+                 if ((p_msg->Type            == MQTTc_MSG_TYPE_PUBLISH) &&
+                     (p_conn->NextTxMsgTxLen == 0u)) {
+                     p_msg->LatTxStartTS = CPU_TS_Get32();
+                 }
+#endif
+                 MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_TX);
+                 tx_len = MQTTc_SockTx(   p_conn,
+                                      &(((CPU_INT08U *)p_msg->ArgPtr)[p_conn->NextTxMsgTxLen]),
+                                          buf_len,
+                                         &p_msg->Err);
+                 p_conn->NextTxMsgTxLen += tx_len;
+                 p_conn->SchedDeficit   -= tx_len;              /* See MQTTc_Task() Note #1.                            */
+                 MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_TX, p_msg->Type, buf_len, tx_len, 0u);
+                 if (p_msg->Err != MQTTc_ERR_NONE) {            /* If err, exec callback and return.                    */
+                     p_conn->NextTxMsgTxLen = 0u;
+                     MQTTc_MsgCallbackExec(p_msg);
+                     break;
+                 }
+                 if (p_conn->NextTxMsgTxLen == p_msg->XferLen) {
+                     p_msg->State           = MQTTc_MSG_STATE_WAIT_TX_CMPL;
+                     p_conn->NextTxMsgTxLen = 0u;
+                 }
+                 break;
 
-        if (p_next_msg->QoS == 0u) {                            /* If QoS is 0, msg is cmpl'd. Exec callback.           */
-            MQTTc_DBG_TRACE_LOG(("MQTTc - Read a Publish (QoS=0) successfully. Executing callback.\n\r"));
-            p_next_msg->Err = MQTTc_ERR_NONE;
-            MQTTc_MsgCallbackExec(p_next_msg);
-        } else {
-            MQTTc_MSG_TYPE  type   = MQTTc_MSG_TYPE_PUBREC;
-            CPU_INT16U      msg_id;
-            CPU_INT16U      len;
 
+            case MQTTc_MSG_TYPE_CONNACK:                        /* These cases should never happen.                     */
+            case MQTTc_MSG_TYPE_PUBACK:                         /* Acks are tx'd from conn's ack Q.                     */
+            case MQTTc_MSG_TYPE_PUBREC:
+            case MQTTc_MSG_TYPE_PUBCOMP:
+            case MQTTc_MSG_TYPE_SUBACK:
+            case MQTTc_MSG_TYPE_UNSUBACK:
+            case MQTTc_MSG_TYPE_PINGRESP:
+            default:
+                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In must Tx switch default case.\n\r"));
+                 break;
+        }
+    } else if (p_msg->State == MQTTc_MSG_STATE_WAIT_TX_CMPL) {
+        CPU_INT08U  *p_buf_topic_nbr;
+        CPU_INT08U   topic_nbr;
 
-            len    = MQTT_MSG_UTF8_LEN_RD(&(((CPU_INT08U *)p_next_msg->ArgPtr)[MQTTc_PUBLISH_RX_MSG_BUF_OFFSET])) + MQTT_MSG_UTF8_LEN_SIZE;
-            msg_id = MQTT_MSG_UTF8_LEN_RD(&(((CPU_INT08U *)p_next_msg->ArgPtr)[len + MQTTc_PUBLISH_RX_MSG_BUF_OFFSET]));
 
-            if (p_next_msg->QoS == 1u) {                        /* Callback must be called now only for QoS 1.          */
-                p_next_msg->Err = MQTTc_ERR_NONE;
-                MQTTc_MsgCallbackExec(p_next_msg);
+                                                                /* Tx operation has finished. Go to next step of msg.   */
+        MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_TX_CMPL, p_msg->Type, p_msg->MsgID, p_msg->QoS, 0u);
+        MQTTc_STAT_INC(p_conn, TxPktCtrTbl[p_msg->Type]);
+        MQTTc_STAT_ADD(p_conn, TxPktByteCtrTbl[p_msg->Type], p_msg->XferLen);
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+        if ((p_msg->Type == MQTTc_MSG_TYPE_PUBLISH) &&
+            (DEF_BIT_IS_SET(((CPU_INT08U *)p_msg->ArgPtr)[0u], MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK) == DEF_YES)) {
+            MQTTc_STAT_INC(p_conn, RetxCtr);
+        }
+#endif
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+        if (p_msg->Type == MQTTc_MSG_TYPE_PUBLISH) {
+            p_msg->LatTxEndTS = CPU_TS_Get32();
+        }
+#endif
 
-                type = MQTTc_MSG_TYPE_PUBACK;
-            }
+        switch (p_msg->Type) {
+            case MQTTc_MSG_TYPE_CONNECT:                        /* Finished sending a CONNECT, wait to rx CONNACK reply.*/
+                 p_msg->Type    = MQTTc_MSG_TYPE_CONNACK;
+                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                 p_msg->XferLen = 2u;
+                 break;
 
-                                                                /* Cfg fixed hdr section of msg for reply.              */
-            p_buf = MQTTc_FixedHdrBufCfg((CPU_INT08U *)p_next_msg->ArgPtr,
-                                                       type,
-                                                       DEF_NO,
-                                                       0u,
-                                                       DEF_NO,
-                                                       MQTT_MSG_ID_SIZE,
-                                                      &p_next_msg->Err);
 
-            p_buf[0u] = (msg_id >>    8u);
-            p_buf[1u] = (msg_id &  0xFFu);
+            case MQTTc_MSG_TYPE_PUBLISH:
+                 if (p_msg->QoS == 0u) {                        /* If QoS is 0, xfer is cmpl.                           */
+                     p_msg->Err = MQTTc_ERR_NONE;
+                     MQTTc_MsgCallbackExec(p_msg);
+                 } else if (p_msg->QoS == 1u) {                 /* If QoS is 1, send PUBACK reply.                      */
+                     p_msg->Type    = MQTTc_MSG_TYPE_PUBACK;
+                     p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                     p_msg->XferLen = 0u;
+                 } else {                                       /* If QoS is 2, send PUBREC reply.                      */
+                     p_msg->Type    = MQTTc_MSG_TYPE_PUBREC;
+                     p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                     p_msg->XferLen = 0u;
+                 }
+                 break;
 
-            MQTTc_DBG_TRACE_LOG(("MQTTc - Read a Publish (QoS=%i) successfully. Sending a Puback/Pubrec with Msg ID: %i.\n\r", p_next_msg->QoS, msg_id));
 
-            MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+            case MQTTc_MSG_TYPE_PUBREL:                         /* Finished sending a PUBREL, wait to rx PUBCOMP.       */
+                 p_msg->Type    = MQTTc_MSG_TYPE_PUBCOMP;
+                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                 p_msg->XferLen = 0u;
+                 break;
 
-            p_next_msg->Type    = type;
-            p_next_msg->State   = MQTTc_MSG_STATE_MUST_TX;
-            p_next_msg->XferLen = MQTT_MSG_BASE_LEN;
-            p_next_msg->MsgID   = msg_id;
-            p_next_msg->Err     = MQTTc_ERR_NONE;
-        }
 
-        MQTTc_ConnNextMsgClr(p_conn);                           /* Clr NextMsg fields.                                  */
+            case MQTTc_MSG_TYPE_SUBSCRIBE:                      /* Finished sending a SUBSCRIBE, wait to rx SUBACK.     */
+                                                                /* Re-obtain nbr of topics in Subscribe msg. See ...    */
+                                                                /* Note #1 in MQTTc_SubscribeMult().                    */
+                 p_buf_topic_nbr = ((CPU_INT08U *)p_msg->ArgPtr) - 1u;
+                 topic_nbr       =  p_buf_topic_nbr[0u];
 
-        return;
-    } else {
-        CPU_INT08U  *p_buf_topic_nbr;
-        CPU_INT08U   topic_nbr;
-        CPU_INT08U   topic_ix;
+                 p_msg->Type    = MQTTc_MSG_TYPE_SUBACK;
+                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                 p_msg->XferLen = topic_nbr;
+                 break;
 
 
-        switch (p_next_msg->Type) {
-            case MQTTc_MSG_TYPE_CONNACK:
-                 if ((p_conn->NextMsgRxLen                   != 2u) ||
-                     (((CPU_INT08U *)p_next_msg->ArgPtr)[1u] != MQTT_MSG_VAR_HDR_CONNACK_RET_CODE_ACCEPTED)) {
-                     MQTTc_DBG_TRACE_DBG(("MQTTc - Connack code not OK.\n\r"));
-                     p_next_msg->Err = MQTTc_ERR_CONNACK_FAIL;
-                 } else {
-                     MQTTc_DBG_TRACE_DBG(("MQTTc - Connack code OK.\n\r"));
-                     p_next_msg->Err = MQTTc_ERR_NONE;
-                 }
+            case MQTTc_MSG_TYPE_UNSUBSCRIBE:                    /* Finished sending a UNSUBSCRIBE, wait to rx UNSUBACK. */
+                 p_msg->Type    = MQTTc_MSG_TYPE_UNSUBACK;
+                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                 p_msg->XferLen = 0u;
                  break;
 
 
-            case MQTTc_MSG_TYPE_PUBACK:
-                 if (p_conn->NextMsgRxLen != 0u) {
-                     MQTTc_DBG_TRACE_DBG(("MQTTc - Puback rx'd code not OK.\n\r"));
-                     p_next_msg->Err = MQTTc_ERR_FAIL;
-                 } else {
-                     p_next_msg->Err = MQTTc_ERR_NONE;
-                 }
+            case MQTTc_MSG_TYPE_PINGREQ:                        /* Finished sending a PINGREQ, wait to rx PINGRESP.     */
+                 p_msg->Type    = MQTTc_MSG_TYPE_PINGRESP;
+                 p_msg->State   = MQTTc_MSG_STATE_WAIT_RX;
+                 p_msg->XferLen = 0u;
                  break;
 
 
-            case MQTTc_MSG_TYPE_SUBACK:
-                 p_next_msg->Err = MQTTc_ERR_NONE;
-
-                 p_buf_topic_nbr = ((CPU_INT08U *)p_next_msg->ArgPtr) - 1u;
-                 topic_nbr       =   p_buf_topic_nbr[0u];
+            case MQTTc_MSG_TYPE_DISCONNECT:                     /* Finished sending a DISCONNECT, clear sel descs.      */
+                 MQTTc_MsgCallbackExec(p_msg);
 
-                 for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {
-                     p_buf_topic_nbr--;
-                     if ((*p_buf_topic_nbr) != ((CPU_INT08U *)p_next_msg->ArgPtr)[topic_ix]) {
-                         p_next_msg->Err = MQTTc_ERR_QoS_LEVEL_NOT_GRANTED;
-                         MQTTc_DBG_TRACE_DBG(("!!! ERROR !!! QoS Level not granted by server. Asked %i, got %i\n\r",
-                                               *p_buf_topic_nbr,
-                                                p_next_msg->BufPtr[topic_ix]));
-                         break;
-                     }
-                 }
+                 MQTTc_ConnRemove(p_conn);
 
-                 if (p_conn->NextMsgRxLen == 0u) {
-                     MQTTc_DBG_TRACE_DBG(("MQTTc - Suback rx'd len not OK.\n\r"));
-                     p_next_msg->Err = MQTTc_ERR_FAIL;
-                 }
-                 p_next_msg->ArgPtr = (void *)p_buf_topic_nbr;
+                 MQTTc_ConnMsgListsFlush(p_conn);               /* Exec callbacks for msgs q'd under this conn.         */
                  break;
 
 
-            case MQTTc_MSG_TYPE_UNSUBACK:
-                 if (p_conn->NextMsgRxLen != 0u) {
-                     MQTTc_DBG_TRACE_DBG(("MQTTc - Suback rx'd len not OK.\n\r"));
-                     p_next_msg->Err = MQTTc_ERR_FAIL;
-                 } else {
-                     p_next_msg->Err = MQTTc_ERR_NONE;
-                 }
+            default:
+                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Wait Tx Cmpl switch, in default case.\n\r"));
                  break;
+        }
+
+        if (p_msg->State == MQTTc_MSG_STATE_WAIT_RX) {          /* See Note #1.                                         */
+            MQTTc_WaitRxMsgAdd(p_conn, p_msg);
+        }
+    }
+}
 
 
-            case MQTTc_MSG_TYPE_PINGRESP:
-                 break;
+/*
+*********************************************************************************************************
+*                                     MQTTc_WrSockCoalesceProcess()
+*
+* Description : Copy every message ready to be transmitted on given MQTTc Connection in the connection's tx
+*               buffer and transmit them using a single socket transmit call.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which to process write operation.
+*
+* Return(s)   : DEF_YES, if write operation was processed from the connection's tx buffer,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) The following messages are gathered, in order, as long as they fit in the tx buffer :
+*
+*                   (a) The acks q'd in the connection's ack Q, if any.
+*                   (b) The messages of the connection's tx lanes, in the order given by MQTTc_TxLaneSel().
+*                       Gathering stops after a DISCONNECT, since nothing can be tx'd after it.
+*
+*               (2) If the tx buffer is not set, if a message or an ack is being tx'd without the tx
+*                   buffer or if nothing fits in the tx buffer, DEF_NO is returned and the message or acks
+*                   are tx'd directly by MQTTc_WrSockProcess() or MQTTc_WrSockAckProcess().
+*
+*               (3) Once all the data in the tx buffer has been tx'd, every message gathered is
+*                   processed as if its tx had just cmpl'd. If only part of the data could be tx'd, the
+*                   rest is tx'd on the next write operation, before gathering any other message.
+*
+*               (4) The acks copied in the tx buffer stay q'd in the ack Q until all of them have been tx'd.
+*                   On a tx error, the acks not tx'd are thus left for MQTTc_WrSockAckProcess(), as if
+*                   they had been tx'd without the tx buffer. See MQTTc_WrSockAckProcess() Note #1.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  MQTTc_WrSockCoalesceProcess (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG    *p_msg;
+    MQTTc_MSG    *p_tail_msg;
+    MQTTc_MSG    *p_next_msg;
+    CPU_INT32U    buf_len;
+    CPU_INT16U    msg_nbr;
+    CPU_INT08U    lane;
+    MQTTc_ERR     err_mqttc;
+
+
+    if ((p_conn->TxBufPtr    == DEF_NULL) ||                    /* See Note #2.                                         */
+        (p_conn->TxBufLen    == 0u)       ||
+        (p_conn->TxMsgCurPtr != DEF_NULL) ||
+        (p_conn->AckQ_TxLen  != 0u)) {
+        return (DEF_NO);
+    }
+
+    if (p_conn->TxBufDataLen == 0u) {                           /* ---------- GATHER MSGS READY TO BE TX'D ----------- */
+        buf_len = 0u;
+        if ((p_conn->AckQ_Len != 0u) &&                         /* See Note #1a.                                        */
+            (p_conn->AckQ_Len <= p_conn->TxBufLen)) {
+            Mem_Copy(&p_conn->TxBufPtr[0u],
+                     &p_conn->AckQ_Buf[0u],
+                      p_conn->AckQ_Len);
+            buf_len             = p_conn->AckQ_Len;
+            p_conn->TxBufAckLen = p_conn->AckQ_Len;             /* Acks stay q'd until tx'd. See Note #4.               */
+        }
+
+        p_tail_msg = DEF_NULL;
+        msg_nbr    = 0u;
+        lane       = MQTTc_TxLaneSel(p_conn);                   /* See Note #1b.                                        */
+        while ((lane                                  != MQTTc_TX_LANE_NONE) &&
+               (p_conn->TxLaneHeadPtr[lane]->XferLen  <= (p_conn->TxBufLen - buf_len))) {
+            p_msg = MQTTc_TxMsgGet(p_conn);
+
+            Mem_Copy(&p_conn->TxBufPtr[buf_len],
+                      p_msg->ArgPtr,
+                      p_msg->XferLen);
+            buf_len      += p_msg->XferLen;
+            p_msg->State  = MQTTc_MSG_STATE_WAIT_TX_CMPL;
+            msg_nbr++;
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+            p_msg->LatTxStartTS = CPU_TS_Get32();               /* Buf is tx'd right after being gathered.              */
+#endif
+            MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_TX);
+
+            if (p_tail_msg == DEF_NULL) {                       /* Keep msgs in buf in a list, in tx order.             */
+                p_conn->TxBufMsgHeadPtr = p_msg;
+            } else {
+                p_tail_msg->NextPtr     = p_msg;
+            }
+            p_tail_msg = p_msg;
+
+            if (p_msg->Type == MQTTc_MSG_TYPE_CONNECT) {        /* Set Rd and Err sel desc, to be able to rx CONNACK.   */
+                MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_RD);
+                MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_ERR);
+            } else if (p_msg->Type == MQTTc_MSG_TYPE_DISCONNECT) {
+                break;
+            }
+
+            lane = MQTTc_TxLaneSel(p_conn);
+        }
+
+        if (buf_len == 0u) {                                    /* See Note #2.                                         */
+            return (DEF_NO);
+        }
+
+        MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_TX_COALESCE, buf_len, msg_nbr, 0u, 0u);
+
+        p_conn->TxBufDataLen = buf_len;
+        p_conn->TxBufTxLen   = 0u;
+    }
+
+                                                                /* ------------------ TX BUF CONTENT ------------------ */
+    buf_len               = DEF_MIN((p_conn->TxBufDataLen - p_conn->TxBufTxLen), DEF_INT_16U_MAX_VAL);
+    buf_len               = DEF_MIN(buf_len, p_conn->SchedDeficit);
+    buf_len               = MQTTc_SockTx(    p_conn,
+                                         &p_conn->TxBufPtr[p_conn->TxBufTxLen],
+                                             buf_len,
+                                            &err_mqttc);
+    p_conn->TxBufTxLen   += buf_len;
+    p_conn->SchedDeficit -= buf_len;                            /* See MQTTc_Task() Note #1.                            */
+
+    if ((p_conn->TxBufAckLen != 0u) &&                          /* If all acks in buf were tx'd, remove them from Q.    */
+        (p_conn->TxBufTxLen  >= p_conn->TxBufAckLen)) {
+        p_conn->AckQ_Len -= p_conn->TxBufAckLen;
+        Mem_Move(&p_conn->AckQ_Buf[0u],                         /* Keep acks q'd while buf was being tx'd.              */
+                 &p_conn->AckQ_Buf[p_conn->TxBufAckLen],
+                  p_conn->AckQ_Len);
+        p_conn->TxBufAckLen = 0u;
+                                                                /* Make sure rx is not blocked by a full ack Q.         */
+        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_RD);
+    }
+
+    if ((err_mqttc          == MQTTc_ERR_NONE) &&
+        (p_conn->TxBufTxLen <  p_conn->TxBufDataLen)) {
+        return (DEF_YES);                                       /* See Note #3.                                         */
+    }
+
+    p_msg = p_conn->TxBufMsgHeadPtr;
+
+    if (p_conn->TxBufAckLen != 0u) {                            /* Acks not all tx'd on err. See Note #4.               */
+        p_conn->AckQ_TxLen  = (CPU_INT16U)p_conn->TxBufTxLen;
+        p_conn->TxBufAckLen =  0u;
+    }
+
+    p_conn->TxBufDataLen    = 0u;
+    p_conn->TxBufTxLen      = 0u;
+    p_conn->TxBufMsgHeadPtr = DEF_NULL;
+
+                                                                /* --------------- CMPL MSGS IN TX BUF ---------------- */
+    while (p_msg != DEF_NULL) {
+        p_next_msg     = p_msg->NextPtr;
+        p_msg->NextPtr = DEF_NULL;
+
+        if (err_mqttc != MQTTc_ERR_NONE) {
+            p_msg->Err = err_mqttc;
+            MQTTc_MsgCallbackExec(p_msg);
+        } else {
+            MQTTc_WrSockProcess(p_msg);
+        }
+
+        p_msg = p_next_msg;
+    }
+
+    return (DEF_YES);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_WrSockAckProcess()
+*
+* Description : Transmit the acks q'd in the ack Q of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which to tx acks.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) Every ack q'd is tx'd using a single socket transmit call. If only part of the acks could
+*                   be tx'd, the rest is tx'd on the next write operation. The acks stay q'd on a tx error.
+*
+*               (2) Once the ack Q is empty, reading is re-enabled in case it was blocked by a full Q. See
+*                   MQTTc_RdSockProcess() Note #1.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_WrSockAckProcess (MQTTc_CONN  *p_conn)
+{
+    CPU_INT16U  buf_len;
+    CPU_INT32U  tx_len;
+    MQTTc_ERR   err_mqttc;
+
+
+    buf_len             = p_conn->AckQ_Len - p_conn->AckQ_TxLen;
+    tx_len              = MQTTc_SockTx(    p_conn,              /* See Note #1.                                         */
+                                       &p_conn->AckQ_Buf[p_conn->AckQ_TxLen],
+                                           buf_len,
+                                          &err_mqttc);
+    p_conn->AckQ_TxLen += tx_len;
+    if (err_mqttc != MQTTc_ERR_NONE) {
+        MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Failed to tx acks on sock ID %i: %i.\r\n", p_conn->SockId, err_mqttc));
+        return;
+    }
+
+    MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_TX_ACK, buf_len, tx_len, 0u, 0u);
+
+    if (p_conn->AckQ_TxLen == p_conn->AckQ_Len) {
+        p_conn->AckQ_Len   = 0u;
+        p_conn->AckQ_TxLen = 0u;
+                                                                /* See Note #2.                                         */
+        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_RD);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_RdSockProcess()
+*
+* Description : Process read operations required for given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which to process read operations.
+*
+* Return(s)   : DEF_YES, if a msg has been processed and the next one can be rx'd,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) Every QoS 1 or 2 PUBLISH and every PUBREL rx'd q's an ack in the connection's ack Q. When
+*                   the ack Q is full, no new message is read until the acks are tx'd.
+*
+*               (2) QoS 2 PUBLISH are delivered to the application as soon as they are rx'd. Their message
+*                   ID is kept in the connection's QoS 2 rx table until the matching PUBREL is rx'd, so that:
+*
+*                   (a) A retransmission of a PUBLISH in the table is only replied with a PUBREC and is not
+*                       delivered a second time.
+*
+*                   (b) Any number of QoS 2 flows, up to MQTTc_CFG_QOS2_RX_TBL_SIZE, can be active at the
+*                       same time.
+*
+*                   (c) When the table is full, the PUBLISH is neither delivered nor replied and the connection
+*                       is closed with MQTTc_ERR_QOS2_RX_TBL_FULL, reported to the OnErr callback. Otherwise, the
+*                       message ID would stay in the broker's in-flight window until the next connection. The
+*                       broker re-delivers the PUBLISH once the connection is re-opened.
+*                       MQTTc_CFG_QOS2_RX_TBL_SIZE should be at least the broker's maximum number of in-flight
+*                       messages for this to never happen.
+*
+*               (3) Any other message rx'd is a reply. It is matched against the connection's list of
+*                   messages waiting for a reply using its type and message ID, if any. Replies without a
+*                   message ID (CONNACK and PINGRESP) are matched with the oldest message waiting for them.
+*
+*               (4) Once its PUBREC is rx'd, an outgoing QoS 2 PUBLISH becomes a PUBREL which is q'd in the
+*                   control tx lane, so that it is not delayed by other messages.
+*
+*               (5) When a WAL is set, a QoS 2 PUBLISH is logged before it is delivered, and its PUBREL
+*                   after it is rx'd. See MQTTc_ConnSetParam() Note #8b.
+*
+*               (6) The PUBREL of a stored message is encoded in its slot. See MQTTc_ConnStorePubRecRx().
+*
+*               (7) A PUBLISH is rx'd in the connection's rx msg up to the end of its variable header. It
+*                   is then filtered by MQTTc_RdSockPublishFilter(), and the rest of a PUBLISH that is
+*                   discarded is rx'd in a scratch sink, so that it is never copied in the rx msg :
+*
+*                   (a) A PUBLISH rejected by OnPublishRxFilter is acked, if needed, but is not delivered.
+*                       A QoS 2 PUBLISH rejected is not added to the QoS 2 rx tbl : it is only replied with a
+*                       PUBREC, and is filtered again if it is retransmitted.
+*
+*                   (b) A PUBLISH too large for the rx msg is acked, if needed, and is delivered with an
+*                       empty payload and MQTTc_ERR_BUF_OVERFLOW.
+*
+*                   (c) A PUBLISH whose variable header does not fit in the rx msg is discarded without
+*                       being delivered or acked, since its msg ID cannot be rx'd.
+*
+*               (8) When PUBLISH msgs are delivered in batches, each one is rx'd in the rx msg after the
+*                   ones already in the batch. See MQTTc_PublishRxBatchBufGet().
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  MQTTc_RdSockProcess (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG   *p_next_msg;
+    CPU_INT08U  *p_buf;
+    CPU_INT32U   rx_len;
+    CPU_INT32U   rx_len_max;
+    CPU_BOOLEAN  is_delivered;
+    CPU_INT08U   tbl_ix;
+    MQTTc_ERR    err_mqttc;
+
+
+    if (p_conn->NextMsgPtr == DEF_NULL) {                       /* If next msg is already known, skip this step.        */
+        if (p_conn->NextMsgHeader == DEF_BIT_NONE) {
+                                                                /* If ack Q is full, wait for acks to be tx'd.          */
+            if ((p_conn->AckQ_Len + MQTT_MSG_BASE_LEN) > MQTTc_ACK_Q_BUF_LEN) {
+                MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_ACK_Q_FULL, p_conn->AckQ_Len, 0u, 0u, 0u);
+                MQTTc_SockSelDescClr(p_conn, MQTTc_SEL_DESC_TYPE_RD);
+                MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+                return (DEF_NO);                                /* See Note #1.                                         */
+            }
+
+            (void)MQTTc_SockRx(p_conn,                          /* Read header (type, DUP, QoS and retain) of rx'd msg. */
+                              &p_conn->NextMsgHeader,
+                               1u,
+                              &err_mqttc);
+            if (err_mqttc == MQTTc_ERR_FATAL) {
+                goto err_remove_conn_close_sock;
+            } else if (err_mqttc != MQTTc_ERR_NONE) {           /* Wait for more data to be avail to continue.          */
+                return (DEF_NO);
+            }
+
+            MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_HDR,     /* MQTT pkt type is MQTTc_MSG_TYPE value.               */
+                           (p_conn->NextMsgHeader & MQTT_MSG_TYPE_MSK) >> 4u,
+                            p_conn->NextMsgHeader, 0u, 0u);
+                                                                /* Convert msg type to enum type.                       */
+            switch (p_conn->NextMsgHeader & MQTT_MSG_TYPE_MSK) {
+                case MQTT_MSG_TYPE_CONNACK:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_CONNACK;
+                     break;
+
+                case MQTT_MSG_TYPE_PUBLISH:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBLISH;
+                     break;
+
+                case MQTT_MSG_TYPE_PUBACK:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBACK;
+                     break;
+
+                case MQTT_MSG_TYPE_PUBREC:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBREC;
+                     break;
+
+                case MQTT_MSG_TYPE_PUBREL:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBREL;
+                     break;
+
+                case MQTT_MSG_TYPE_PUBCOMP:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PUBCOMP;
+                     break;
+
+                case MQTT_MSG_TYPE_SUBACK:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_SUBACK;
+                     break;
+
+                case MQTT_MSG_TYPE_UNSUBACK:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_UNSUBACK;
+                     break;
+
+                case MQTT_MSG_TYPE_PINGRESP:
+                     p_conn->NextMsgType = MQTTc_MSG_TYPE_PINGRESP;
+                     break;
+
+
+                case MQTT_MSG_TYPE_CONNECT:
+                case MQTT_MSG_TYPE_SUBSCRIBE:
+                case MQTT_MSG_TYPE_UNSUBSCRIBE:
+                case MQTT_MSG_TYPE_PINGREQ:
+                case MQTT_MSG_TYPE_DISCONNECT:
+                default:
+                     MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Received wrong message type: %i\r\n", p_conn->NextMsgHeader));
+                     p_conn->NextMsgHeader = 0u;
+                     goto err_restart;                          /* These msg types cannot be rx'd. Flush rx buf.        */
+            }
+            p_conn->NextMsgRxLen = 0u;
+        }
+
+        if (p_conn->NextMsgLenIsCmpl == DEF_NO) {
+            CPU_INT08U  rem_len;
+            CPU_INT32U  rx_len;
+            CPU_INT32U  multiplier;
+
+
+            do {                                                /* Read rem len of msg. This can be a multi-byte field. */
+                rx_len = MQTTc_SockRx(p_conn,
+                                     &rem_len,
+                                      1u,
+                                     &err_mqttc);
+                if (err_mqttc == MQTTc_ERR_FATAL) {
+                    goto err_remove_conn_close_sock;
+                } else if (err_mqttc != MQTTc_ERR_NONE) {       /* Wait for more data to be avail to continue.          */
+                    return (DEF_NO);
+                }
+                                                                /* Calculate the multiplier which is a power of 128.    */
+                multiplier            = 1 << (7 * p_conn->NextMsgRxLen);
+                p_conn->NextMsgRxLen += rx_len;
+                                                                /* Use the multiplier to determine msg length           */
+                p_conn->NextMsgLen += (rem_len & MQTT_MSG_FIXED_HDR_REM_LEN_MSK) * multiplier;
+
+                                                                /* Read msg as long as continuation bit is set, max 4x. */
+            }  while ((DEF_BIT_IS_SET(rem_len, MQTT_MSG_FIXED_HDR_REM_LEN_CONTINUATION_BIT) == DEF_YES) &&
+                      (p_conn->NextMsgRxLen                                                 <  MQTT_MSG_FIXED_HDR_REM_LEN_NBR_BYTES_MAX));
+
+            p_conn->NextMsgLenIsCmpl = DEF_YES;
+                                                                /* Count fixed hdr, rem len and rest of msg.            */
+            MQTTc_STAT_INC(p_conn, RxPktCtrTbl[p_conn->NextMsgType]);
+            MQTTc_STAT_ADD(p_conn, RxPktByteCtrTbl[p_conn->NextMsgType], 1u + p_conn->NextMsgRxLen + p_conn->NextMsgLen);
+            p_conn->NextMsgRxLen     = 0u;
+
+            MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_LEN, p_conn->NextMsgType, p_conn->NextMsgLen, 0u, 0u);
+        }
+
+        if ( (p_conn->NextMsgMsgID_IsCmpl == DEF_NO) &&
+            ((p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBACK)  ||
+             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBREC)  ||
+             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBREL)  ||
+             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_PUBCOMP) ||
+             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_SUBACK)  ||
+             (p_conn->NextMsgType         == MQTTc_MSG_TYPE_UNSUBACK))) {
+            CPU_INT08U  msg_id_rx[MQTT_MSG_ID_SIZE];
+
+
+            if (p_conn->NextMsgRxLen == 1u) {                   /* If already rx'd 1 byte of MsgID, re-put in msg_id_rx.*/
+                msg_id_rx[0u] = (p_conn->NextMsgMsgID & 0xFF00u) >> 8u;
+            }
+
+            rx_len = MQTTc_SockRx(p_conn,                       /* Rx msg ID if msg has one.                            */
+                                 &msg_id_rx[p_conn->NextMsgRxLen],
+                                 (MQTT_MSG_ID_SIZE - p_conn->NextMsgRxLen),
+                                &err_mqttc);
+            if (err_mqttc == MQTTc_ERR_NONE) {
+                p_conn->NextMsgRxLen += rx_len;
+            } else if (err_mqttc == MQTTc_ERR_FATAL) {
+                goto err_remove_conn_close_sock;
+            } else {                                            /* Wait to be able to rx data to continue.              */
+                if ((err_mqttc == MQTTc_ERR_RX_BUF_EMPTY) &&
+                    (rx_len    == 1u)) {                        /* Keep first part of msg ID rx'd.                      */
+                    p_conn->NextMsgMsgID = (msg_id_rx[0u] << 8u);
+                    p_conn->NextMsgRxLen += 1u;
+                }
+                return (DEF_NO);
+            }
+
+            p_conn->NextMsgMsgID         = ((msg_id_rx[0u] << 8u) | msg_id_rx[1u]);
+            p_conn->NextMsgLen          -=   MQTT_MSG_ID_SIZE;
+            p_conn->NextMsgMsgID_IsCmpl  =   DEF_YES;
+            p_conn->NextMsgRxLen         =   0u;
+
+            MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_MSG_ID, p_conn->NextMsgType, p_conn->NextMsgMsgID, 0u, 0u);
+        }
+
+        if (p_conn->NextMsgType == MQTTc_MSG_TYPE_PUBREL) {     /* PUBREL only needs to be replied with a PUBCOMP.      */
+            tbl_ix = MQTTc_QoS2_RxTblFind(p_conn, p_conn->NextMsgMsgID);
+            if (tbl_ix != MQTTc_QOS2_RX_TBL_IX_NONE) {          /* Release QoS 2 flow. See Note #2.                     */
+                DEF_BIT_CLR(p_conn->QoS2_RxTblBitmap, (CPU_INT32U)DEF_BIT(tbl_ix));
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+                if (p_conn->WalPtr != DEF_NULL) {               /* See Note #5.                                         */
+                    MQTTc_WalLog(p_conn->WalPtr,
+                                 MQTTc_WAL_STATE_IN_FREE,
+                                 p_conn->NextMsgMsgID,
+                                 DEF_NULL);
+                }
+#endif
+            }
+
+            MQTTc_AckQ_Add(p_conn,
+                           MQTTc_MSG_TYPE_PUBCOMP,
+                           p_conn->NextMsgMsgID);
+
+            MQTTc_ConnNextMsgClr(p_conn);                       /* Clr NextMsg fields.                                  */
+            return (DEF_YES);
+        }
+
+        if (p_conn->NextMsgType == p_conn->PublishRxMsgPtr->Type) {
+            p_conn->NextMsgPtr      = p_conn->PublishRxMsgPtr;
+            p_conn->NextMsgRxLen    = 0u;
+            p_conn->NextMsgPtr->QoS = (p_conn->NextMsgHeader & MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_MSK) >> MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT;
+            p_conn->NextMsgPtr->Err = MQTTc_ERR_NONE;           /* Len is checked once var hdr is rx'd. See Note #7.    */
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+            MQTTc_PublishRxBatchBufGet(p_conn);                 /* See Note #8.                                         */
+#endif
+        } else {                                                /* Make sure msg being rx'd is expected. See Note #3.   */
+            p_conn->NextMsgPtr = MQTTc_WaitRxMsgFind(p_conn,
+                                                     p_conn->NextMsgType,
+                                                     p_conn->NextMsgMsgID);
+            if (p_conn->NextMsgPtr == DEF_NULL) {
+                goto err_restart;
+            }
+
+            if (p_conn->NextMsgLen != p_conn->NextMsgPtr->XferLen) {
+                MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Next msg len (%i) not equal to expected xfer len (%i).\n\r",
+                                       p_conn->NextMsgLen,
+                                       p_conn->NextMsgPtr->XferLen));
+                p_conn->NextMsgPtr->Err = MQTTc_ERR_BUF_OVERFLOW;
+                goto err_callback_restart;
+            }
+            if (p_conn->NextMsgLen > p_conn->NextMsgPtr->BufLen) {
+                MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Next msg len (%i) too big for msg buf (%i).\n\r",
+                                       p_conn->NextMsgLen,
+                                       p_conn->NextMsgPtr->BufLen));
+                p_conn->NextMsgPtr->Err = MQTTc_ERR_BUF_OVERFLOW;
+                goto err_callback_restart;
+            }
+        }
+    }
+
+                                                                /* At this point, p_conn->NextMsgPtr contains the ...   */
+                                                                /* next msg to process and all its infos have been ...  */
+                                                                /* rx'd. Only the payload still needs to be rx'd.       */
+    p_next_msg = p_conn->NextMsgPtr;
+
+    if (p_conn->NextMsgLen != 0u) {                             /* If there is more than the hdr to rx, rx it.          */
+        if (p_conn->NextMsgDiscard == DEF_NO) {
+                                                                /* Rx at most conn's deficit. See MQTTc_Task() Note #1. */
+            rx_len_max = DEF_MIN(p_conn->NextMsgLen, p_conn->SchedDeficit);
+            if ((p_next_msg->Type          == MQTTc_MSG_TYPE_PUBLISH) &&
+                (p_conn->NextMsgIsFiltered == DEF_NO)) {        /* Keep room to null-terminate payload. See Note #7.    */
+                rx_len_max = DEF_MIN(rx_len_max, (p_next_msg->BufLen - 1u) - p_conn->NextMsgRxLen);
+            }
+
+            rx_len = MQTTc_SockRx(    p_conn,
+                                  &(((CPU_INT08U *)p_next_msg->ArgPtr)[p_conn->NextMsgRxLen]),
+                                      rx_len_max,
+                                     &err_mqttc);
+            p_conn->NextMsgLen   -= rx_len;
+            p_conn->NextMsgRxLen += rx_len;
+            p_conn->SchedDeficit -= rx_len;
+            if (err_mqttc == MQTTc_ERR_FATAL) {
+                goto err_remove_conn_close_sock;
+            }
+
+            if ((p_next_msg->Type          == MQTTc_MSG_TYPE_PUBLISH) &&
+                (p_conn->NextMsgIsFiltered == DEF_NO)) {
+                MQTTc_RdSockPublishFilter(p_conn);
+            }
+
+            if (err_mqttc != MQTTc_ERR_NONE) {                  /* Wait for more data to be avail to continue.          */
+                return (DEF_NO);
+            }
+        }
+
+        while ((p_conn->NextMsgDiscard == DEF_YES) &&           /* Skip rest of discarded msg. See Note #7.             */
+               (p_conn->NextMsgLen     != 0u)      &&
+               (p_conn->SchedDeficit   != 0u)) {
+            rx_len_max = DEF_MIN(p_conn->NextMsgLen, p_conn->SchedDeficit);
+            rx_len     = MQTTc_SockRx(p_conn,
+                                     &MQTTc_RxSinkBuf[0u],
+                                      DEF_MIN(rx_len_max, MQTTc_RX_SINK_BUF_LEN),
+                                     &err_mqttc);
+            p_conn->NextMsgLen   -= rx_len;
+            p_conn->SchedDeficit -= rx_len;
+            if (err_mqttc == MQTTc_ERR_FATAL) {
+                goto err_remove_conn_close_sock;
+            } else if (err_mqttc != MQTTc_ERR_NONE) {           /* Wait for more data to be avail to continue.          */
+                return (DEF_NO);
+            }
+        }
+
+        if (p_conn->NextMsgLen != 0u) {                         /* Rest of payload is rx'd on next rd operation.        */
+            return (DEF_NO);
+        }
+    }
+
+    MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_PAYLOAD, p_conn->NextMsgLen, p_conn->NextMsgRxLen, 0u, 0u);
+
+                                                                /* At this point, the payload has been completely rx'd. */
+    if (p_next_msg->Type == MQTTc_MSG_TYPE_PUBLISH) {           /* Rx'd a Publish msg from broker.                      */
+                                                                /* 'p_next_msg' points to p_conn->PublishRxMsgPtr.      */
+        if (p_conn->NextMsgIsFiltered == DEF_NO) {
+            MQTTc_RdSockPublishFilter(p_conn);
+        }
+        if ((p_conn->NextMsgIsFiltered == DEF_NO) ||            /* Var hdr missing or not rx'd. See Note #7c.           */
+            (p_conn->NextMsgRxLen      == 0u)) {
+            MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Publish var hdr could not be rx'd. Discarding Publish.\n\r"));
+            MQTTc_ConnNextMsgClr(p_conn);
+            return (DEF_YES);
+        }
+                                                                /* See Note #7a.                                        */
+        is_delivered = ((p_conn->NextMsgDiscard == DEF_NO) || (p_next_msg->Err == MQTTc_ERR_BUF_OVERFLOW)) ? DEF_YES : DEF_NO;
+
+                                                                /* Null-terminate rx'd msg payload.                     */
+        ((CPU_INT08U*)(p_next_msg->ArgPtr))[p_conn->NextMsgRxLen] = '\0';
+
+        if (p_next_msg->QoS == 0u) {                            /* If QoS is 0, msg is cmpl'd. Exec callback.           */
+            MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_PUBLISH, 0u, 0u, is_delivered, 0u);
+            if (is_delivered == DEF_YES) {
+                MQTTc_MsgCallbackExec(p_next_msg);
+            }
+        } else {
+            MQTTc_MSG_TYPE  type;
+            CPU_INT16U      msg_id;
+            CPU_INT16U      len;
+
+
+            len    = MQTT_MSG_UTF8_LEN_RD((CPU_INT08U *)p_next_msg->ArgPtr) + MQTT_MSG_UTF8_LEN_SIZE;
+            msg_id = MQTT_MSG_UTF8_LEN_RD(&(((CPU_INT08U *)p_next_msg->ArgPtr)[len]));
+
+            if (p_next_msg->QoS == 1u) {
+                type = MQTTc_MSG_TYPE_PUBACK;
+                if (is_delivered == DEF_YES) {
+                    MQTTc_MsgCallbackExec(p_next_msg);
+                }
+            } else {
+                type   = MQTTc_MSG_TYPE_PUBREC;
+                tbl_ix = MQTTc_QoS2_RxTblFind(p_conn, msg_id);
+                if (tbl_ix != MQTTc_QOS2_RX_TBL_IX_NONE) {      /* See Note #2a.                                        */
+                    is_delivered = DEF_NO;                      /* Retransmitted PUBLISH is not delivered again.        */
+                } else if (is_delivered == DEF_YES) {           /* See Note #7a.                                        */
+                    tbl_ix = MQTTc_QoS2_RxTblAdd(p_conn, msg_id);
+                    if (tbl_ix == MQTTc_QOS2_RX_TBL_IX_NONE) {  /* See Note #2c.                                        */
+                        MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! QoS 2 rx tbl full on Publish with Msg ID: %i. Closing conn.\n\r", msg_id));
+                        err_mqttc = MQTTc_ERR_QOS2_RX_TBL_FULL;
+                        goto err_remove_conn_close_sock;
+                    }
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+                    if (p_conn->WalPtr != DEF_NULL) {           /* See Note #5.                                         */
+                        MQTTc_WalLog(p_conn->WalPtr,
+                                     MQTTc_WAL_STATE_IN_REC,
+                                     msg_id,
+                                     DEF_NULL);
+                    }
+#endif
+                    MQTTc_MsgCallbackExec(p_next_msg);
+                }
+            }
+
+            MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_PUBLISH, p_next_msg->QoS, msg_id, is_delivered, 0u);
+
+            MQTTc_AckQ_Add(p_conn,                              /* See Note #1.                                         */
+                           type,
+                           msg_id);
+        }
+
+        MQTTc_ConnNextMsgClr(p_conn);                           /* Clr NextMsg fields.                                  */
+
+        return (DEF_YES);
+    } else {
+        CPU_INT08U  *p_buf_topic_nbr;
+        CPU_INT08U   topic_nbr;
+        CPU_INT08U   topic_ix;
+
+
+        switch (p_next_msg->Type) {
+            case MQTTc_MSG_TYPE_CONNACK:
+                 if ((p_conn->NextMsgRxLen                   != 2u) ||
+                     (((CPU_INT08U *)p_next_msg->ArgPtr)[1u] != MQTT_MSG_VAR_HDR_CONNACK_RET_CODE_ACCEPTED)) {
+                     MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_ACK_ERR, p_next_msg->Type, ((CPU_INT08U *)p_next_msg->ArgPtr)[1u], 0u, 0u);
+                     p_next_msg->Err = MQTTc_ERR_CONNACK_FAIL;
+                 } else {
+                     p_next_msg->Err = MQTTc_ERR_NONE;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PUBACK:
+                 if (p_conn->NextMsgRxLen != 0u) {
+                     MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_ACK_ERR, p_next_msg->Type, p_conn->NextMsgRxLen, 0u, 0u);
+                     p_next_msg->Err = MQTTc_ERR_FAIL;
+                 } else {
+                     p_next_msg->Err = MQTTc_ERR_NONE;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_SUBACK:
+                 p_next_msg->Err = MQTTc_ERR_NONE;
+
+                 p_buf_topic_nbr = ((CPU_INT08U *)p_next_msg->ArgPtr) - 1u;
+                 topic_nbr       =   p_buf_topic_nbr[0u];
+
+                 for (topic_ix = 0u; topic_ix < topic_nbr; topic_ix++) {
+                     p_buf_topic_nbr--;
+                     if ((*p_buf_topic_nbr) != ((CPU_INT08U *)p_next_msg->ArgPtr)[topic_ix]) {
+                         p_next_msg->Err = MQTTc_ERR_QoS_LEVEL_NOT_GRANTED;
+                         MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_ACK_ERR, p_next_msg->Type, ((CPU_INT08U *)p_next_msg->ArgPtr)[topic_ix], 0u, 0u);
+                         break;
+                     }
+                 }
+
+                 if (p_conn->NextMsgRxLen == 0u) {
+                     MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_ACK_ERR, p_next_msg->Type, p_conn->NextMsgRxLen, 0u, 0u);
+                     p_next_msg->Err = MQTTc_ERR_FAIL;
+                 }
+                 p_next_msg->ArgPtr = (void *)p_buf_topic_nbr;
+                 break;
+
+
+            case MQTTc_MSG_TYPE_UNSUBACK:
+                 if (p_conn->NextMsgRxLen != 0u) {
+                     MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_ACK_ERR, p_next_msg->Type, p_conn->NextMsgRxLen, 0u, 0u);
+                     p_next_msg->Err = MQTTc_ERR_FAIL;
+                 } else {
+                     p_next_msg->Err = MQTTc_ERR_NONE;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PINGRESP:
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PUBREC:
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+                 MQTTc_ConnStorePubRecRx(p_conn, p_next_msg);   /* See Note #6.                                         */
+#endif
+                 p_buf = MQTTc_FixedHdrBufCfg((CPU_INT08U *)p_next_msg->ArgPtr,
+                                                            MQTTc_MSG_TYPE_PUBREL,
+                                                            DEF_NO,
+                                                            1u,
+                                                            DEF_NO,
+                                                            MQTT_MSG_ID_SIZE,
+                                                           &p_next_msg->Err);
+
+                 p_buf[0u] = (p_next_msg->MsgID >>    8u);
+                 p_buf[1u] = (p_next_msg->MsgID &  0xFFu);
+
+                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+
+                 MQTTc_ConnMsgRemove(p_conn, p_next_msg);
+
+                 p_next_msg->Type    = MQTTc_MSG_TYPE_PUBREL;
+                 p_next_msg->State   = MQTTc_MSG_STATE_MUST_TX;
+                 p_next_msg->XferLen = MQTT_MSG_BASE_LEN;
+                 p_next_msg->Err     = MQTTc_ERR_NONE;
+                                                                /* See Note #4.                                         */
+                 MQTTc_TxLaneAdd(p_conn, p_next_msg, MQTTc_MSG_PRIO_CTRL);
+
+                 MQTTc_ConnNextMsgClr(p_conn);                  /* Clr NextMsg fields.                                  */
+                 return (DEF_YES);
+
+
+            case MQTTc_MSG_TYPE_PUBCOMP:
+                 if (p_conn->NextMsgRxLen != 0u) {
+                     MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_ACK_ERR, p_next_msg->Type, p_conn->NextMsgRxLen, 0u, 0u);
+                     p_next_msg->Err = MQTTc_ERR_FAIL;
+                 } else {
+                     p_next_msg->Err = MQTTc_ERR_NONE;
+                 }
+                 break;
+
+
+            default:
+                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In Rx switch default case.\n\r"));
+                 break;
+        }
+
+        MQTTc_ConnNextMsgClr(p_conn);                           /* Clr NextMsg fields.                                  */
+
+        MQTTc_MsgCallbackExec(p_next_msg);
+    }
+
+    return (DEF_YES);
+
+err_callback_restart:
+    MQTTc_MsgCallbackExec(p_conn->NextMsgPtr);
+    MQTTc_ConnNextMsgClr(p_conn);                               /* Clr NextMsg fields.                                  */
+
+    return (DEF_YES);
+
+err_restart:
+    MQTTc_ConnNextMsgClr(p_conn);                               /* Clr NextMsg fields.                                  */
+    err_mqttc = MQTTc_ERR_UNEXPECTED_MSG;
+
+err_remove_conn_close_sock:
+    {
+        MQTTc_ERR_CALLBACK   on_err_callback;
+        void                *p_arg;
+        MQTTc_ERR            close_err;
+
+
+        on_err_callback = p_conn->OnErrCallback;
+        p_arg           = p_conn->ArgPtr;
+
+        MQTTc_STAT_ERR_INC(p_conn, err_mqttc);
+
+        MQTTc_ConnCloseProc(p_conn,
+                           &close_err);
+        (void)close_err;
+
+        if (on_err_callback != DEF_NULL) {
+            MQTTc_PROF_CALLBACK_START();
+            on_err_callback(p_conn,
+                            p_arg,
+                            err_mqttc);
+            MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_ERR);
+        }
+    }
+
+    return (DEF_NO);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      MQTTc_RdSockPublishFilter()
+*
+* Description : Filter the PUBLISH being rx'd on a connection, once its variable header is rx'd.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object rx'ing the PUBLISH.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_RdSockProcess().
+*
+* Note(s)     : (1) The PUBLISH is filtered once its whole variable header is in the rx msg. Until then,
+*                   this function returns without setting NextMsgIsFiltered.
+*
+*               (2) OnPublishRxFilter sees the topic, which is not null-terminated, and the len of the
+*                   payload, which is not rx'd yet. It returns DEF_YES to deliver the PUBLISH, DEF_NO to
+*                   discard it. See MQTTc_RdSockProcess() Note #7a.
+*
+*               (3) The bytes of the payload already rx'd are dropped from the rx msg, so that a PUBLISH
+*                   too large is delivered with an empty payload. See MQTTc_RdSockProcess() Note #7b.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_RdSockPublishFilter (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG    *p_msg     = p_conn->NextMsgPtr;
+    CPU_INT08U   *p_buf     = (CPU_INT08U *)p_msg->ArgPtr;
+    CPU_INT32U    topic_len = 0u;
+    CPU_INT32U    var_hdr_len;
+    CPU_INT32U    payload_len;
+    CPU_BOOLEAN   is_accepted;
+
+
+    if (p_conn->NextMsgRxLen < MQTT_MSG_UTF8_LEN_SIZE) {        /* Topic len not rx'd yet.                              */
+        var_hdr_len = MQTT_MSG_UTF8_LEN_SIZE;
+    } else {
+        topic_len   = MQTT_MSG_UTF8_LEN_RD(p_buf);
+        var_hdr_len = topic_len + MQTT_MSG_UTF8_LEN_SIZE;
+        if (p_msg->QoS != 0u) {
+            var_hdr_len += MQTT_MSG_ID_SIZE;
+        }
+    }
+
+    if (var_hdr_len >= p_msg->BufLen) {                         /* See MQTTc_RdSockProcess() Note #7c.                  */
+        MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Publish var hdr (%i) too big for msg buf (%i).\n\r",
+                               var_hdr_len,
+                               p_msg->BufLen));
+        p_msg->Err                = MQTTc_ERR_BUF_OVERFLOW;
+        p_conn->NextMsgRxLen      = 0u;
+        p_conn->NextMsgIsFiltered = DEF_YES;
+        p_conn->NextMsgDiscard    = DEF_YES;
+        return;
+    }
+
+    if (p_conn->NextMsgRxLen < var_hdr_len) {                   /* See Note #1.                                         */
+        return;
+    }
+
+    p_conn->NextMsgIsFiltered = DEF_YES;
+    payload_len               = (p_conn->NextMsgRxLen - var_hdr_len) + p_conn->NextMsgLen;
+
+    if (p_conn->OnPublishRxFilter != DEF_NULL) {                /* See Note #2.                                         */
+        MQTTc_PROF_CALLBACK_START();
+        is_accepted = p_conn->OnPublishRxFilter(                  p_conn,
+                                                (const CPU_CHAR *)&p_buf[MQTT_MSG_UTF8_LEN_SIZE],
+                                                                  topic_len,
+                                                                  payload_len,
+                                                                  p_conn->ArgPtr);
+        MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_PUBLISH_RX_FILTER);
+        if (is_accepted == DEF_NO) {
+            MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_RX_FILTERED, payload_len, 0u, 0u, 0u);
+            p_conn->NextMsgRxLen   = var_hdr_len;               /* See Note #3.                                         */
+            p_conn->NextMsgDiscard = DEF_YES;
+            return;
+        }
+    }
+                                                                /* Keep room to null-terminate payload.                 */
+    if ((var_hdr_len + payload_len) >= p_msg->BufLen) {
+        MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Publish len (%i (+1 for null char)) too big for msg buf (%i).\n\r",
+                               var_hdr_len + payload_len,
+                               p_msg->BufLen));
+        p_msg->Err             = MQTTc_ERR_BUF_OVERFLOW;
+        p_conn->NextMsgRxLen   = var_hdr_len;                   /* See Note #3.                                         */
+        p_conn->NextMsgDiscard = DEF_YES;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_MsgProcess()
+*
+* Description : Process message pending and enqueuing for MQTTc task.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) CONNECT, PINGREQ and PUBREL are q'd in the control tx lane. Other messages are q'd in the
+*                   tx lane matching their prio. See MQTTc_MsgSetParam() Note #1.
+*
+*               (2) OnTxQ_High is called from the task, once the msg that made the tx q reach its high
+*                   watermark is processed. See MQTTc_ConnSetParam() Note #4.
+*
+*               (3) A PUBLISH with conflation enabled takes the place of the msg it replaces in its tx lane,
+*                   if any. See MQTTc_MsgSetParam() Note #2.
+*
+*               (4) The msgs with a deadline are counted, so that the tx lanes are only checked for expired
+*                   msgs when needed. See MQTTc_TxLaneExpire() Note #1.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_MsgProcess (void)
+{
+    MQTTc_MSG  *p_msg;
+
+
+    p_msg = MQTTc_MsgCheck();
+    if (p_msg != DEF_NULL) {
+        MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_MSG_PROCESS, p_msg->ConnPtr->SockId);
+        MQTTc_PROF_PHASE_START(MQTTc_PROF_PHASE_MSG_PROCESS);
+
+        if (p_msg->Type != MQTTc_MSG_TYPE_REQ_CLOSE) {
+            MQTTc_CONN      *p_conn = p_msg->ConnPtr;
+            MQTTc_MSG_TYPE   type   = p_msg->Type;
+            MQTTc_MSG       *p_old_msg;
+
+
+            switch (type) {
+                case MQTTc_MSG_TYPE_CONNECT:
+                     if (MQTTc_Ptr->ConnHeadPtr == DEF_NULL) {       /* Enqueue conn in MQTTc conn list.                     */
+                         MQTTc_Ptr->ConnHeadPtr = p_conn;
+                     } else {
+                         MQTTc_CONN  *p_iter_conn = MQTTc_Ptr->ConnHeadPtr;
+
+
+                         while (p_iter_conn->NextPtr != DEF_NULL) {
+                             p_iter_conn = p_iter_conn->NextPtr;
+                         }
+                         p_iter_conn->NextPtr = p_conn;
+                     }
+                     MQTTc_MEM_CONN_ADD(p_conn);
+                                                                    /* break intentionally omitted.                         */
+                case MQTTc_MSG_TYPE_PUBREL:
+                case MQTTc_MSG_TYPE_PINGREQ:                        /* Enqueue msg in conn's ctrl tx lane. See Note #1.     */
+                     MQTTc_TxLaneAdd(p_conn, p_msg, MQTTc_MSG_PRIO_CTRL);
+                     MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+                     break;
+
+
+                case MQTTc_MSG_TYPE_PUBLISH:
+                case MQTTc_MSG_TYPE_SUBSCRIBE:
+                case MQTTc_MSG_TYPE_UNSUBSCRIBE:
+                case MQTTc_MSG_TYPE_DISCONNECT:                     /* Enqueue msg in conn's tx lane matching its prio.     */
+                     if ((p_msg->Prio == MQTTc_MSG_PRIO_CTRL) ||
+                         (p_msg->Prio >= MQTTc_MSG_PRIO_NBR)) {
+                         p_msg->Prio = MQTTc_MSG_PRIO_NORMAL;
+                     }
+
+                     p_old_msg = DEF_NULL;
+                     if (p_msg->ConflateEn == DEF_YES) {            /* See Note #3.                                         */
+                         p_old_msg = MQTTc_TxLaneConflate(p_conn, p_msg, p_msg->Prio);
+                     }
+                     if (MQTTc_MSG_DEADLINE_IS_SET(p_msg) == DEF_YES) {
+                         p_conn->TxDeadlineMsgNbr++;                /* See Note #4.                                         */
+                     }
+                     if (p_old_msg == DEF_NULL) {
+                         MQTTc_TxLaneAdd(p_conn, p_msg, p_msg->Prio);
+                     } else {
+                         if (MQTTc_MSG_DEADLINE_IS_SET(p_old_msg) == DEF_YES) {
+                             p_conn->TxDeadlineMsgNbr--;
+                         }
+                         MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_Q);
+                         p_old_msg->Err = MQTTc_ERR_SUPERSEDED;
+                         MQTTc_MsgCallbackExec(p_old_msg);
+                     }
+                     MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+
+                     MQTTc_TxQ_HighCallbackExec(p_conn);            /* See Note #2.                                         */
+                     break;
+
+
+                case MQTTc_MSG_TYPE_PUBACK:
+                case MQTTc_MSG_TYPE_PUBREC:
+                case MQTTc_MSG_TYPE_PUBCOMP:
+                case MQTTc_MSG_TYPE_CONNACK:
+                case MQTTc_MSG_TYPE_SUBACK:
+                case MQTTc_MSG_TYPE_UNSUBACK:
+                case MQTTc_MSG_TYPE_PINGRESP:
+                default:
+                     MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In default case for event type:%i\n\r", type));
+                     break;
+            }
+        } else {                                                /* Handle special close req msg.                        */
+            KAL_ERR  err_kal;
+
+
+            MQTTc_ConnCloseProc(p_msg->ConnPtr,
+                               &p_msg->Err);
+
+            KAL_SemPost((*(KAL_SEM_HANDLE *)p_msg->ArgPtr),
+                        KAL_OPT_POST_NONE,
+                       &err_kal);
+            (void)&err_kal;
+        }
+
+        MQTTc_PROF_PHASE_END(MQTTc_PROF_PHASE_MSG_PROCESS);
+        MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_MSG_PROCESS);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_MsgCallbackExec()
+*
+* Description : Frees msg if provided by user and execute application callback(s).
+*
+* Argument(s) : p_msg           Pointer to message for which the callback must be called.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgProcess(),
+*               MQTTc_TxLaneExpire(),
+*               MQTTc_RdSockProcess(),
+*               MQTTc_WrSockProcess(),
+*               MQTTc_WrSockCoalesceProcess().
+*
+* Note(s)     : (1) Stored messages are tx'd once the CONNECT has cmpl'd successfully. Their completion is
+*                   processed by the store, which frees their msg ID, without calling the application
+*                   callbacks. See MQTTc_ConnStoreMsgCmpl().
+*
+*               (2) The initial sync of the connection's cache starts once a SUBSCRIBE cmpl's, and lasts
+*                   while retained messages are rx'd. See MQTTc_ConnSetParam() Note #9a.
+*
+*               (3) The cache could be full. The topic is then left out of it, and the message is still
+*                   delivered to the application.
+*
+*               (4) PUBLISH msgs batched so far are delivered before any other callback is called. See
+*                   MQTTc_ConnSetParam() Note #11b.
+*
+*               (5) The msg is added to the batch of cmpl'd msgs instead of being delivered right away. See
+*                   MQTTc_ConnSetParam() Note #12.
+*
+*               (6) The callbacks may re-post or free the msg. The end of its timeline span is thus recorded
+*                   with the timeline ID it had before they were called. See mqtt-c_timeline.c Note #1a.
+*
+*               (7) The msg stops being accounted in the memory usage before the callbacks are called, since
+*                   they may re-post it.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_MsgCallbackExec (MQTTc_MSG  *p_msg)
+{
+    MQTTc_CMPL_CALLBACK   callback_fnct = DEF_NULL;
+    MQTTc_CONN           *p_conn        = p_msg->ConnPtr;
+    MQTTc_ERR             err           = MQTTc_ERR_NONE;
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+    CPU_INT32U            timeline_id;
+#endif
+
+
+    if (p_msg != p_conn->PublishRxMsgPtr) {
+        MQTTc_MEM_MSG_REMOVE(p_msg);                            /* Msg is given back to the app. See Note #7.           */
+
+        switch (p_msg->Type) {                                  /* Find type of msg and if ok to call callback for it.  */
+            case MQTTc_MSG_TYPE_CONNECT:
+                 err = MQTTc_ERR_FAIL;
+                                                                /* break intentionally omitted.                         */
+            case MQTTc_MSG_TYPE_CONNACK:
+                 p_msg->Type   = MQTTc_MSG_TYPE_CONNECT;
+                 callback_fnct = p_conn->OnConnectCmpl;
+                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PUBLISH:
+                 callback_fnct = p_conn->OnPublishCmpl;
+                 if ((p_msg->QoS   != 0u) ||
+                     (p_msg->State != MQTTc_MSG_STATE_WAIT_TX_CMPL)) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PUBACK:
+            case MQTTc_MSG_TYPE_PUBCOMP:
+                 p_msg->Type   = MQTTc_MSG_TYPE_PUBLISH;
+                 callback_fnct = p_conn->OnPublishCmpl;
+                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+                 if ((p_conn->LatPtr != DEF_NULL)       &&      /* Record latencies of acked msg.                       */
+                     (err            == MQTTc_ERR_NONE) &&
+                     (p_msg->Err     == MQTTc_ERR_NONE)) {
+                     MQTTc_LatRecord(p_conn->LatPtr, p_msg, CPU_TS_Get32());
+                 }
+#endif
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PUBREC:
+            case MQTTc_MSG_TYPE_PUBREL:
+                 p_msg->Type   = MQTTc_MSG_TYPE_PUBLISH;
+                 callback_fnct = p_conn->OnPublishCmpl;
+                 err = MQTTc_ERR_FAIL;
+                 break;
+
+
+            case MQTTc_MSG_TYPE_SUBSCRIBE:
+                 err = MQTTc_ERR_FAIL;
+                                                                /* break intentionally omitted.                         */
+            case MQTTc_MSG_TYPE_SUBACK:
+                 p_msg->Type   = MQTTc_MSG_TYPE_SUBSCRIBE;
+                 callback_fnct = p_conn->OnSubscribeCmpl;
+                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_UNSUBSCRIBE:
+                 err = MQTTc_ERR_FAIL;
+                                                                /* break intentionally omitted.                         */
+            case MQTTc_MSG_TYPE_UNSUBACK:
+                 p_msg->Type   = MQTTc_MSG_TYPE_UNSUBSCRIBE;
+                 callback_fnct = p_conn->OnUnsubscribeCmpl;
+                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_PINGREQ:
+                 err = MQTTc_ERR_FAIL;
+            case MQTTc_MSG_TYPE_PINGRESP:
+                 p_msg->Type   = MQTTc_MSG_TYPE_PINGREQ;
+                 callback_fnct = p_conn->OnPingReqCmpl;
+                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+                 break;
+
+
+            case MQTTc_MSG_TYPE_DISCONNECT:
+                 p_msg->Type   = MQTTc_MSG_TYPE_DISCONNECT;
+                 callback_fnct = p_conn->OnDisconnectCmpl;
+                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_TX_CMPL) {
+                     err = MQTTc_ERR_FAIL;
+                 }
+                 break;
+
+
+            default:
+                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In default case for p_event->Type when executing callback:%i\n\r", p_msg->Type));
+                 return;
+        }
+
+        if (p_msg->Err == MQTTc_ERR_NONE) {
+            p_msg->Err = err;
+        }
+
+        p_msg->State = MQTTc_MSG_STATE_CMPL;
+        MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_MSG_CMPL, p_msg->Type, p_msg->MsgID, p_msg->Err, 0u);
+
+        if (p_msg->Err != MQTTc_ERR_NONE) {
+            MQTTc_STAT_ERR_INC(p_conn, p_msg->Err);
+        }
+
+        MQTTc_ConnMsgRemove(p_conn, p_msg);                     /* Remove msg from conn's msg lists.                    */
+
+        if (p_msg->TxQ_Len != 0u) {                             /* Remove msg from conn's tx q, if it was accounted.    */
+            MQTTc_TxQ_Release(p_conn, p_msg);
+        }
+
+        if (p_msg->Type == MQTTc_MSG_TYPE_CONNECT) {            /* Other msgs can be tx'd once CONNECT has cmpl'd.      */
+            p_conn->TxWaitConnAck = DEF_NO;
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+            if (p_msg->Err == MQTTc_ERR_NONE) {                 /* See Note #1.                                         */
+                p_conn->StoreTxEn = DEF_YES;
+            }
+        } else if (MQTTc_ConnStoreMsgCmpl(p_conn, p_msg) == DEF_YES) {
+            MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_NONE);
+            return;
+#endif
+        }
+
+        MQTTc_MsgID_Free(p_msg->MsgID);                         /* Free msg ID, if any.                                 */
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+        if ((p_msg->Type      == MQTTc_MSG_TYPE_SUBSCRIBE) &&   /* See Note #2.                                         */
+            (p_msg->Err       == MQTTc_ERR_NONE)           &&
+            (p_conn->CachePtr != DEF_NULL)) {
+            p_conn->CacheSyncPend  = DEF_YES;
+            p_conn->CacheSyncTS_ms = NetUtil_TS_Get_ms();
+        }
+#endif
+
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+        if (p_conn->OnCmplBatch != DEF_NULL) {                  /* See Note #5.                                         */
+            MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_NONE);
+            MQTTc_CmplBatchAdd(p_conn, p_msg);
+            return;
+        }
+#endif
+
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+        MQTTc_PublishRxBatchFlush(p_conn);                      /* See Note #4.                                         */
+#endif
+
+        MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_CALLBACK);
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+        timeline_id = p_msg->TimelineID;                        /* See Note #6.                                         */
+#endif
+        MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_CALLBACK, p_conn->SockId);
+
+        if (p_conn->OnCmpl != DEF_NULL) {                       /* Call generic callback, if not NULL.                  */
+            MQTTc_PROF_CALLBACK_START();
+            p_conn->OnCmpl(p_conn,
+                           p_msg,
+                           p_conn->ArgPtr,
+                           p_msg->Err);
+            MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_CMPL);
+        }
+
+        if (callback_fnct != DEF_NULL) {                        /* Call action-specific callback, if not NULL.          */
+            MQTTc_PROF_CALLBACK_START();
+            callback_fnct(p_conn,
+                          p_msg,
+                          p_conn->ArgPtr,
+                          p_msg->Err);
+            MQTTc_PROF_MSG_CALLBACK_END(p_conn, p_msg->Type);
+        }
+
+        MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_CALLBACK);
+        MQTTc_TIMELINE_MSG_CALLBACK_END(timeline_id);
+    } else {
+        CPU_INT08U  *p_buf_start   =  (CPU_INT08U *)p_msg->ArgPtr;
+        CPU_INT08U  *p_buf_topic   = &p_buf_start[MQTT_MSG_UTF8_LEN_SIZE];
+        CPU_INT08U  *p_buf_payload;
+        CPU_INT32U   topic_len;
+        CPU_INT32U   payload_len;
+        CPU_INT32U   len;
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+        MQTTc_ERR    err_cache;
+#endif
+
+
+        if (p_msg->Err != MQTTc_ERR_NONE) {
+            MQTTc_STAT_ERR_INC(p_conn, p_msg->Err);
+        }
+
+        topic_len = MQTT_MSG_UTF8_LEN_RD(p_buf_start);
+        len       = topic_len + MQTT_MSG_UTF8_LEN_SIZE;         /* Account for length.                                  */
+
+        if (p_msg->QoS != 0u) {                                 /* Account for msg ID size if needed.                   */
+            len += MQTT_MSG_ID_SIZE;
+        }
+
+        payload_len   =  p_msg->ConnPtr->NextMsgRxLen - len;
+        p_buf_payload = &p_buf_start[len];
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+        if ((p_conn->CachePtr != DEF_NULL) &&                   /* Payload of a msg too large was not rx'd.             */
+            (p_msg->Err       == MQTTc_ERR_NONE)) {
+            MQTTc_CacheUpdate(p_conn->CachePtr,
+                              p_buf_topic,
+                              (CPU_INT16U)topic_len,
+                              p_buf_payload,
+                              payload_len,
+                             &err_cache);
+            if (err_cache != MQTTc_ERR_NONE) {                  /* See Note #3.                                         */
+                MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Unable to cache rx'd Publish. Err: %i\n\r", err_cache));
+            }
+                                                                /* Retained msg rx'd during initial sync. See Note #2.  */
+            if ((p_conn->CacheSyncPend == DEF_YES) &&
+                (DEF_BIT_IS_SET(p_conn->NextMsgHeader, MQTT_MSG_FIXED_HDR_FLAGS_RETAIN_MSK) == DEF_YES)) {
+                p_conn->CacheSyncTS_ms = NetUtil_TS_Get_ms();
+            }
+        }
+#endif
+
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+        if (p_conn->OnPublishRxBatch != DEF_NULL) {             /* Add msg to batch. See MQTTc_ConnSetParam() Note #11. */
+            MQTTc_PublishRxBatchAdd(p_conn,
+                                    p_buf_topic,
+                                    topic_len,
+                                    p_buf_payload,
+                                    payload_len,
+                                    p_msg->Err);
+            return;
+        }
+#endif
+
+        if (p_conn->OnPublishRx != DEF_NULL) {                  /* Call OnPublishRx callback, if not NULL.              */
+            MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_CALLBACK, p_conn->SockId);
+            MQTTc_PROF_CALLBACK_START();
+            p_conn->OnPublishRx(                  p_conn,
+                                (const CPU_CHAR *)p_buf_topic,
+                                                  topic_len,
+                                (const CPU_CHAR *)p_buf_payload,
+                                                  payload_len,
+                                                  p_conn->ArgPtr,
+                                                  p_msg->Err);
+            MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_PUBLISH_RX);
+            MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_CALLBACK);
+        }
+    }
+
+    return;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_MsgCheck()
+*
+* Description : See if a message is available in the message queue.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Pointer to obtained message, if any,
+*               DEF_NULL,                    otherwise.
+*
+* Caller(s)   : MQTTc_MsgProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_MSG  *MQTTc_MsgCheck (void)
+{
+    MQTTc_MSG  *p_msg = DEF_NULL;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    if (MQTTc_Ptr->MsgListHeadPtr != DEF_NULL) {
+        p_msg                     = MQTTc_Ptr->MsgListHeadPtr;
+        MQTTc_Ptr->MsgListHeadPtr = p_msg->NextPtr;
+        p_msg->NextPtr            = DEF_NULL;
+    }
+    CPU_CRITICAL_EXIT();
+
+    return (p_msg);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_MsgPost()
+*
+* Description : Add a message in the MQTT message queue for the task to process.
+*
+* Argument(s) : p_conn          Pointer to MQTT Connection object associated with message.
+*
+*               p_msg           Pointer to MQTT Message object to add to queue.
+*
+*               type            Type of MQTT message.
+*
+*               xfer_len        Required len to xfer.
+*
+*               qos_lvl         QoS level of the message, if any.
+*
+*               msg_id          Message ID of the message, if any.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*                                   MQTTc_ERR_CONN_IS_CLOSED    Conn is closed.
+*                                   MQTTc_ERR_TX_Q_FULL         Conn's tx q is full.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Various MQTTc functions.
+*
+* Note(s)     : (1) Only PUBLISH messages are accounted for in the tx q, so that protocol messages are never
+*                   held back by the app's traffic. See MQTTc_ConnSetParam() Note #4.
+*
+*               (2) A message is always accepted in an empty tx q, even if it is larger than the limit in
+*                   bytes. Otherwise, it could never be sent.
+*
+*               (3) A rejected message also marks the tx q as 'high', so that producers waiting for room
+*                   are always woken up once the tx q drains.
+*
+*               (4) The deadline of a PUBLISH message is set when it is posted. See MQTTc_MsgSetParam()
+*                   Note #3.
+*
+*               (5) A close req msg is not accounted in the memory usage : it has no buf, and it is given
+*                   back to the caller without cmpl'ing.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_MsgPost (MQTTc_CONN      *p_conn,
+                             MQTTc_MSG       *p_msg,
+                             MQTTc_MSG_TYPE   type,
+                             CPU_INT32U       xfer_len,
+                             CPU_INT08U       qos_lvl,
+                             CPU_INT16U       msg_id,
+                             MQTTc_ERR       *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+    p_msg->ConnPtr = p_conn;                                    /* Set values in msg fields.                            */
+    p_msg->Type    = type;
+    p_msg->State   = MQTTc_MSG_STATE_MUST_TX;
+    p_msg->MsgID   = msg_id;
+    p_msg->XferLen = xfer_len;
+    p_msg->TxQ_Len = (type == MQTTc_MSG_TYPE_PUBLISH) ? xfer_len : 0u;
+    p_msg->QoS     = qos_lvl;
+    p_msg->Err     = MQTTc_ERR_NONE;
+    p_msg->NextPtr = DEF_NULL;
+
+    if (MQTTc_MSG_DEADLINE_IS_SET(p_msg) == DEF_YES) {          /* See Note #4.                                         */
+        p_msg->DeadlineTS_ms = NetUtil_TS_Get_ms() + p_msg->TTL_ms;
+    }
+
+    MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_MSG_POST, type, msg_id, xfer_len, 0u);
+
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+    p_msg->LatPostTS    = CPU_TS_Get32();                       /* Tx timestamps are set again when msg is tx'd.        */
+    p_msg->LatTxStartTS = p_msg->LatPostTS;
+    p_msg->LatTxEndTS   = p_msg->LatPostTS;
+#endif
+
+    CPU_CRITICAL_ENTER();
+    if (p_conn->SockId != NET_SOCK_ID_NONE) {
+
+        if (p_msg->TxQ_Len != 0u) {                             /* Account for msg in conn's tx q. See Note #1.         */
+            if (((p_conn->TxQ_MaxMsgNbr != 0u) &&
+                 (p_conn->TxQ_MsgNbr    >= p_conn->TxQ_MaxMsgNbr)) ||
+                ((p_conn->TxQ_MaxLen    != 0u) &&
+                 (p_conn->TxQ_MsgNbr    != 0u) &&               /* See Note #2.                                         */
+                 (p_conn->TxQ_Len + xfer_len > p_conn->TxQ_MaxLen))) {
+                if (p_conn->TxQ_IsHigh == DEF_NO) {             /* See Note #3.                                         */
+                    p_conn->TxQ_IsHigh           = DEF_YES;
+                    p_conn->TxQ_HighCallbackPend = DEF_YES;
+                }
+                CPU_CRITICAL_EXIT();
+
+                p_msg->TxQ_Len = 0u;
+               *p_err          = MQTTc_ERR_TX_Q_FULL;
+                return;
+            }
+
+            p_conn->TxQ_MsgNbr++;
+            p_conn->TxQ_Len += xfer_len;
+            MQTTc_MEM_ADD(MQTTc_MEM_TYPE_TX_Q, xfer_len);
+            MQTTc_STAT_MAX(p_conn, TxQ_MsgNbrMax, p_conn->TxQ_MsgNbr);
+            MQTTc_STAT_MAX(p_conn, TxQ_LenMax,    p_conn->TxQ_Len);
+            if ((p_conn->TxQ_IsHigh == DEF_NO) &&               /* See if tx q reached its high watermark.              */
+               (((p_conn->TxQ_MaxMsgNbr != 0u) && (p_conn->TxQ_MsgNbr >= p_conn->TxQ_MaxMsgNbr)) ||
+                ((p_conn->TxQ_MaxLen    != 0u) && (p_conn->TxQ_Len    >= p_conn->TxQ_MaxLen)))) {
+                p_conn->TxQ_IsHigh           = DEF_YES;
+                p_conn->TxQ_HighCallbackPend = DEF_YES;
+            }
+        }
+
+        if (type != MQTTc_MSG_TYPE_REQ_CLOSE) {                 /* Msg is owned by the task until it cmpl's. See ...    */
+            MQTTc_MEM_MSG_ADD(p_msg);                           /* ... Note #5.                                         */
+        }
+
+                                                                /* Msg can be processed by the task once q'd.           */
+        MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_POST);
+
+        if (MQTTc_Ptr->MsgListHeadPtr != DEF_NULL) {
+            MQTTc_Ptr->MsgListTailPtr->NextPtr = p_msg;
+        } else {
+            MQTTc_Ptr->MsgListHeadPtr = p_msg;
+        }
+        MQTTc_Ptr->MsgListTailPtr = p_msg;
+
+        CPU_CRITICAL_EXIT();
+
+        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+
+       *p_err = MQTTc_ERR_NONE;
+    } else {
+        CPU_CRITICAL_EXIT();
+
+       *p_err = MQTTc_ERR_CONN_IS_CLOSED;
+    }
+    return;
+}
+
+
+/*
+*********************************************************************************************************
+*                                   MQTTc_MsgListClosedCallbackExec()
+*
+* Description : Execute callback with error MQTTc_ERR_CONN_IS_CLOSED on every message in linked list.
+*
+* Argument(s) : p_head_msg      Pointer to head of list of messages to execute callback on.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnCloseProc(),
+*               MQTTc_ConnMsgListsFlush().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_MsgListClosedCallbackExec (MQTTc_MSG  *p_head_msg)
+{
+    MQTTc_MSG  *p_iter_msg;
+    MQTTc_MSG  *p_next_iter_msg;
+
+
+    p_iter_msg = p_head_msg;                                    /* Exec callback for every msg in list passed.          */
+    while (p_iter_msg != DEF_NULL) {
+
+        p_next_iter_msg = p_iter_msg->NextPtr;
+        p_iter_msg->Err = MQTTc_ERR_CONN_IS_CLOSED;             /* Indicate conn is closed.                             */
+        MQTTc_MsgCallbackExec(p_iter_msg);
+
+        p_iter_msg = p_next_iter_msg;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_TxLaneAdd()
+*
+* Description : Add a message at the tail of a tx lane of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object on which to q the message.
+*
+*               p_msg           Pointer to MQTTc Message object to q.
+*
+*               lane            Tx lane in which to q the message.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgProcess(),
+*               MQTTc_RdSockProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TxLaneAdd (MQTTc_CONN      *p_conn,
+                               MQTTc_MSG       *p_msg,
+                               MQTTc_MSG_PRIO   lane)
+{
+    p_msg->NextPtr = DEF_NULL;
+
+    if (p_conn->TxLaneHeadPtr[lane] == DEF_NULL) {
+        p_conn->TxLaneHeadPtr[lane]          = p_msg;
+    } else {
+        p_conn->TxLaneTailPtr[lane]->NextPtr = p_msg;
+    }
+    p_conn->TxLaneTailPtr[lane] = p_msg;
+
+    MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_Q);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TxLaneConflate()
+*
+* Description : Replace a q'd PUBLISH message on the same topic as given message, in a tx lane of given
+*               MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object on which to q the message.
+*
+*               p_msg           Pointer to MQTTc Message object to q.
+*
+*               lane            Tx lane in which to q the message.
+*
+* Return(s)   : Pointer to replaced MQTTc Message object, if any,
+*               DEF_NULL,                                 otherwise.
+*
+* Caller(s)   : MQTTc_MsgProcess().
+*
+* Note(s)     : (1) Only the PUBLISH messages q'd with conflation enabled can be replaced. Messages of a tx
+*                   lane have not started to be tx'd. See MQTTc_MsgSetParam() Note #2.
+*
+*               (2) The new message takes the place of the replaced message in the tx lane, so that it is
+*                   not delayed behind messages q'd after the one it replaces.
+*********************************************************************************************************
+*/
+
+static  MQTTc_MSG  *MQTTc_TxLaneConflate (MQTTc_CONN      *p_conn,
+                                          MQTTc_MSG       *p_msg,
+                                          MQTTc_MSG_PRIO   lane)
+{
+    MQTTc_MSG   *p_iter_msg;
+    MQTTc_MSG   *p_prev_iter_msg = DEF_NULL;
+    CPU_INT08U  *p_topic;
+    CPU_INT08U  *p_iter_topic;
+    CPU_INT16U   topic_len;
+    CPU_INT16U   iter_topic_len;
+
+
+    if (p_msg->Type != MQTTc_MSG_TYPE_PUBLISH) {
+        return (DEF_NULL);
+    }
+
+    p_topic = MQTTc_PublishTopicGet(p_msg, &topic_len);
+    if (p_topic == DEF_NULL) {
+        return (DEF_NULL);
+    }
+
+    p_iter_msg = p_conn->TxLaneHeadPtr[lane];
+    while (p_iter_msg != DEF_NULL) {
+                                                                /* See Note #1.                                         */
+        if ((p_iter_msg->Type       == MQTTc_MSG_TYPE_PUBLISH) &&
+            (p_iter_msg->ConflateEn == DEF_YES)) {
+            p_iter_topic = MQTTc_PublishTopicGet(p_iter_msg, &iter_topic_len);
+            if ((p_iter_topic   != DEF_NULL)  &&
+                (iter_topic_len == topic_len) &&
+                (Mem_Cmp(p_iter_topic, p_topic, topic_len) == DEF_YES)) {
+                break;
+            }
+        }
+        p_prev_iter_msg = p_iter_msg;
+        p_iter_msg      = p_iter_msg->NextPtr;
+    }
+
+    if (p_iter_msg == DEF_NULL) {
+        return (DEF_NULL);
+    }
+                                                                /* Put new msg in place of old one. See Note #2.        */
+    p_msg->NextPtr = p_iter_msg->NextPtr;
+    if (p_prev_iter_msg != DEF_NULL) {
+        p_prev_iter_msg->NextPtr    = p_msg;
+    } else {
+        p_conn->TxLaneHeadPtr[lane] = p_msg;
+    }
+    if (p_conn->TxLaneTailPtr[lane] == p_iter_msg) {
+        p_conn->TxLaneTailPtr[lane] = p_msg;
+    }
+    p_iter_msg->NextPtr = DEF_NULL;
+
+    return (p_iter_msg);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_TxLaneExpire()
+*
+* Description : Remove the expired PUBLISH messages from the tx lanes of given MQTTc Connection and execute
+*               their callbacks with error MQTTc_ERR_EXPIRED.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) The tx lanes are only walked if they hold messages with a deadline, so that connections
+*                   that do not use the msgs' TTL pay nothing. See MQTTc_MsgSetParam() Note #3.
+*
+*               (2) The deadline is compared with the current timestamp using signed arithmetic, so that
+*                   the comparison remains valid when the timestamp wraps around.
+*
+*               (3) The callback may re-use the message. The next message is thus retrieved first.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TxLaneExpire (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG   *p_iter_msg;
+    MQTTc_MSG   *p_prev_iter_msg;
+    MQTTc_MSG   *p_next_iter_msg;
+    CPU_INT32U   ts_ms;
+    CPU_INT08U   lane;
+
+
+    if (p_conn->TxDeadlineMsgNbr == 0u) {                       /* See Note #1.                                         */
+        return;
+    }
+
+    ts_ms = NetUtil_TS_Get_ms();
+
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {
+        p_prev_iter_msg = DEF_NULL;
+        p_iter_msg      = p_conn->TxLaneHeadPtr[lane];
+        while (p_iter_msg != DEF_NULL) {
+            p_next_iter_msg = p_iter_msg->NextPtr;              /* See Note #3.                                         */
+
+                                                                /* See Note #2.                                         */
+            if ((MQTTc_MSG_DEADLINE_IS_SET(p_iter_msg)       == DEF_NO) ||
+                ((CPU_INT32S)(ts_ms - p_iter_msg->DeadlineTS_ms) <  0)) {
+                p_prev_iter_msg = p_iter_msg;
+                p_iter_msg      = p_next_iter_msg;
+                continue;
+            }
+                                                                /* Unlink expired msg from its tx lane.                 */
+            if (p_prev_iter_msg != DEF_NULL) {
+                p_prev_iter_msg->NextPtr    = p_next_iter_msg;
+            } else {
+                p_conn->TxLaneHeadPtr[lane] = p_next_iter_msg;
+            }
+            if (p_conn->TxLaneTailPtr[lane] == p_iter_msg) {
+                p_conn->TxLaneTailPtr[lane] = p_prev_iter_msg;
+            }
+            p_iter_msg->NextPtr = DEF_NULL;
+            p_conn->TxDeadlineMsgNbr--;
+
+            p_iter_msg->Err = MQTTc_ERR_EXPIRED;
+            MQTTc_MsgCallbackExec(p_iter_msg);
+
+            p_iter_msg = p_next_iter_msg;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_TxLaneSel()
+*
+* Description : Select the tx lane from which the next message must be transmitted on given MQTTc
+*               Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : Tx lane of the next message to tx, if any,
+*               MQTTc_TX_LANE_NONE,                otherwise.
+*
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_TxMsgGet(),
+*               MQTTc_WrSockCoalesceProcess().
+*
+* Note(s)     : (1) Lanes are only switched at message boundaries : a message that has started to be tx'd
+*                   is always cmpl'd before the next one is selected.
+*
+*               (2) The control lane always has precedence. The high, normal and bulk lanes are then served :
+*
+*                   (a) In strict priority order, by default.
+*
+*                   (b) In weighted round-robin, if MQTTc_CFG_TX_SCHED_WEIGHTED_EN is enabled. Each lane can
+*                       tx up to MQTTc_CFG_TX_SCHED_WEIGHT_xxx messages per round. A new round starts once
+*                       every lane that has a message to tx has used its credit.
+*
+*               (3) Nothing else is tx'd between a CONNECT and the reception of its CONNACK.
+*
+*               (4) A DISCONNECT is only tx'd once every other message of the connection has cmpl'd.
+*
+*               (5) This function does not modify the connection. It can be used to know if a message is
+*                   ready to be tx'd.
+*
+*               (6) A PUBLISH held back by the tx rate limiter blocks its lane, so that messages are never
+*                   reordered within a lane. See MQTTc_ConnSetParam() Note #5.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  MQTTc_TxLaneSel (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG    *p_msg;
+    CPU_INT08U    lane;
+    CPU_INT08U    lane_nbr_used = 0u;
+    CPU_INT08U    lane_sel      = MQTTc_TX_LANE_NONE;
+    CPU_BOOLEAN   is_idle;
+
+
+    if (p_conn->TxWaitConnAck == DEF_YES) {                     /* See Note #3.                                         */
+        return (MQTTc_TX_LANE_NONE);
+    }
+
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {
+        if (p_conn->TxLaneHeadPtr[lane] != DEF_NULL) {
+            lane_nbr_used++;
+        }
+    }
+                                                                /* See Note #4.                                         */
+    is_idle = ((lane_nbr_used            <= 1u)       &&
+               (p_conn->TxMsgCurPtr      == DEF_NULL) &&
+               (p_conn->TxBufMsgHeadPtr  == DEF_NULL) &&
+               (p_conn->WaitRxMsgHeadPtr == DEF_NULL)) ? DEF_YES : DEF_NO;
+
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {
+        p_msg = p_conn->TxLaneHeadPtr[lane];
+        if (p_msg == DEF_NULL) {
+            continue;
+        }
+
+        if ((p_msg->Type == MQTTc_MSG_TYPE_DISCONNECT) &&
+            (is_idle     == DEF_NO)) {
+            continue;
+        }
+
+        if (MQTTc_TxRateWaitGet(p_conn, p_msg) != 0u) {         /* See Note #6.                                         */
+            continue;
+        }
+
+#if (MQTTc_CFG_TX_SCHED_WEIGHTED_EN == DEF_ENABLED)
+        if ((lane                       != MQTTc_MSG_PRIO_CTRL) &&
+            (p_conn->TxLaneCredit[lane] == 0u)) {               /* Lane has used its credit for this round.             */
+            if (lane_sel == MQTTc_TX_LANE_NONE) {               /* Keep first lane, in case a new round must start.     */
+                lane_sel = lane;
+            }
+            continue;
+        }
+#endif
+
+        return (lane);                                          /* See Note #2.                                         */
+    }
+
+    return (lane_sel);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_TxMsgGet()
+*
+* Description : Remove the next message to transmit from the tx lanes of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : Pointer to the next message to tx, if any,
+*               DEF_NULL,                          otherwise.
+*
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_WrSockCoalesceProcess().
+*
+* Note(s)     : (1) The lane is selected by MQTTc_TxLaneSel().
+*********************************************************************************************************
+*/
+
+static  MQTTc_MSG  *MQTTc_TxMsgGet (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG   *p_msg;
+    CPU_INT08U   lane;
+
+
+    lane = MQTTc_TxLaneSel(p_conn);                             /* See Note #1.                                         */
+    if (lane == MQTTc_TX_LANE_NONE) {
+        return (DEF_NULL);
+    }
+
+#if (MQTTc_CFG_TX_SCHED_WEIGHTED_EN == DEF_ENABLED)
+    if (lane != MQTTc_MSG_PRIO_CTRL) {
+        if (p_conn->TxLaneCredit[lane] == 0u) {                 /* Every lane has used its credit, start a new round.   */
+            CPU_INT08U  lane_ix;
+
+
+            for (lane_ix = 0u; lane_ix < MQTTc_MSG_PRIO_NBR; lane_ix++) {
+                p_conn->TxLaneCredit[lane_ix] = MQTTc_TxLaneWeightTbl[lane_ix];
+            }
+        }
+        p_conn->TxLaneCredit[lane]--;
+    }
+#endif
+
+    p_msg                       = p_conn->TxLaneHeadPtr[lane];
+    p_conn->TxLaneHeadPtr[lane] = p_msg->NextPtr;
+    p_msg->NextPtr              = DEF_NULL;
+
+    if (MQTTc_MSG_DEADLINE_IS_SET(p_msg) == DEF_YES) {
+        p_conn->TxDeadlineMsgNbr--;
+    }
+
+    if (p_msg->Type == MQTTc_MSG_TYPE_CONNECT) {                /* See MQTTc_TxLaneSel() Note #3.                       */
+        p_conn->TxWaitConnAck = DEF_YES;
+    }
+
+    MQTTc_TxRateConsume(p_conn, p_msg);                         /* Take msg's tokens from tx rate buckets, if any.      */
+
+    return (p_msg);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_WaitRxMsgAdd()
+*
+* Description : Add a message at the tail of the list of messages waiting for a reply of given MQTTc
+*               Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+*               p_msg           Pointer to MQTTc Message object waiting for a reply.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_WrSockProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_WaitRxMsgAdd (MQTTc_CONN  *p_conn,
+                                  MQTTc_MSG   *p_msg)
+{
+    if (p_conn->TxMsgCurPtr == p_msg) {                         /* Msg is not being tx'd anymore.                       */
+        p_conn->TxMsgCurPtr = DEF_NULL;
+    }
+
+    p_msg->NextPtr = DEF_NULL;
+
+    if (p_conn->WaitRxMsgHeadPtr == DEF_NULL) {
+        p_conn->WaitRxMsgHeadPtr          = p_msg;
+    } else {
+        p_conn->WaitRxMsgTailPtr->NextPtr = p_msg;
+    }
+    p_conn->WaitRxMsgTailPtr = p_msg;
+
+    MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, MQTTc_TIMELINE_MSG_PHASE_WAIT_ACK);
+
+    MQTTc_STAT_INC(p_conn, InFlightNbr);
+    MQTTc_STAT_MAX(p_conn, InFlightNbrMax, p_conn->Stats.InFlightNbr);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_WaitRxMsgFind()
+*
+* Description : Find the message a reply rx'd on given MQTTc Connection is destined to.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+*               type            Type of the reply rx'd.
+*
+*               msg_id          Message ID of the reply rx'd, MQTT_MSG_ID_NONE if it has none.
+*
+* Return(s)   : Pointer to the oldest message waiting for that reply, if any,
+*               DEF_NULL,                                          otherwise.
+*
+* Caller(s)   : MQTTc_RdSockProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_MSG  *MQTTc_WaitRxMsgFind (MQTTc_CONN      *p_conn,
+                                         MQTTc_MSG_TYPE   type,
+                                         CPU_INT16U       msg_id)
+{
+    MQTTc_MSG  *p_iter_msg;
+
+
+    p_iter_msg = p_conn->WaitRxMsgHeadPtr;
+    while (p_iter_msg != DEF_NULL) {
+        if ((p_iter_msg->Type  == type) &&
+            (p_iter_msg->MsgID == msg_id)) {
+            break;
+        }
+        p_iter_msg = p_iter_msg->NextPtr;
+    }
+
+    return (p_iter_msg);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_ConnMsgRemove()
+*
+* Description : Remove a message from the message being transmitted or from the list of messages waiting for
+*               a reply of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+*               p_msg           Pointer to MQTTc Message object to remove.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec(),
+*               MQTTc_RdSockProcess().
+*
+* Note(s)     : (1) Messages in the tx lanes or in the tx buffer are removed from their list before being
+*                   processed. Nothing needs to be done for them.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_ConnMsgRemove (MQTTc_CONN  *p_conn,
+                                   MQTTc_MSG   *p_msg)
+{
+    MQTTc_MSG  *p_iter_msg;
+    MQTTc_MSG  *p_prev_iter_msg = DEF_NULL;
+
+
+    if (p_conn->TxMsgCurPtr == p_msg) {
+        p_conn->TxMsgCurPtr = DEF_NULL;
+    } else {
+        p_iter_msg = p_conn->WaitRxMsgHeadPtr;
+        while ((p_iter_msg != DEF_NULL) &&
+               (p_iter_msg != p_msg)) {
+            p_prev_iter_msg = p_iter_msg;
+            p_iter_msg      = p_iter_msg->NextPtr;
+        }
+
+        if (p_iter_msg != DEF_NULL) {                           /* Msg was found in list of msgs waiting for a reply.   */
+            if (p_prev_iter_msg != DEF_NULL) {
+                p_prev_iter_msg->NextPtr = p_msg->NextPtr;
+            } else {
+                p_conn->WaitRxMsgHeadPtr = p_msg->NextPtr;
+            }
+            if (p_conn->WaitRxMsgTailPtr == p_msg) {
+                p_conn->WaitRxMsgTailPtr = p_prev_iter_msg;
+            }
+            MQTTc_STAT_DEC(p_conn, InFlightNbr);
+        }
+    }
+
+    p_msg->NextPtr = DEF_NULL;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_ConnMsgListsFlush()
+*
+* Description : Execute callback with error MQTTc_ERR_CONN_IS_CLOSED on every message q'd under given MQTTc
+*               Connection and empty its message lists.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnCloseProc(),
+*               MQTTc_WrSockProcess().
+*
+* Note(s)     : (1) Callbacks are exec'd for messages waiting for a reply first, since they were tx'd
+*                   first, then for the message being tx'd and finally for every tx lane, in priority order.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_ConnMsgListsFlush (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG   *p_head_msg;
+    CPU_INT08U   lane;
+
+                                                                /* See Note #1.                                         */
+    p_head_msg               = p_conn->WaitRxMsgHeadPtr;
+    p_conn->WaitRxMsgHeadPtr = DEF_NULL;
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+    p_conn->Stats.InFlightNbr = 0u;
+#endif
+    MQTTc_MsgListClosedCallbackExec(p_head_msg);
+
+    p_head_msg              = p_conn->TxBufMsgHeadPtr;
+    p_conn->TxBufMsgHeadPtr = DEF_NULL;
+    MQTTc_MsgListClosedCallbackExec(p_head_msg);
+
+    p_head_msg          = p_conn->TxMsgCurPtr;
+    p_conn->TxMsgCurPtr = DEF_NULL;
+    MQTTc_MsgListClosedCallbackExec(p_head_msg);
+
+    p_conn->TxDeadlineMsgNbr = 0u;
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {
+        p_head_msg                  = p_conn->TxLaneHeadPtr[lane];
+        p_conn->TxLaneHeadPtr[lane] = DEF_NULL;
+        MQTTc_MsgListClosedCallbackExec(p_head_msg);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_TxQ_Release()
+*
+* Description : Remove a completed message from the tx q accounting of given MQTTc Connection and signal
+*               the tx q's low watermark, if it is reached.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object on which the message was q'd.
+*
+*               p_msg           Pointer to MQTTc Message object that completed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec().
+*
+* Note(s)     : (1) A pending OnTxQ_High callback is exec'd first, so that the app always sees the high and
+*                   low watermark callbacks in order.
+*
+*               (2) The sem is posted once per task waiting in MQTTc_TxQ_Wait(). See MQTTc_TxQ_Wait()
+*                   Note #2.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TxQ_Release (MQTTc_CONN  *p_conn,
+                                 MQTTc_MSG   *p_msg)
+{
+    CPU_BOOLEAN  is_low   = DEF_NO;
+    CPU_INT16U   wait_nbr = 0u;
+    KAL_ERR      err_kal;
+    CPU_SR_ALLOC();
+
+
+    MQTTc_TxQ_HighCallbackExec(p_conn);                         /* See Note #1.                                         */
+
+    CPU_CRITICAL_ENTER();
+    p_conn->TxQ_MsgNbr--;
+    p_conn->TxQ_Len -= p_msg->TxQ_Len;
+    MQTTc_MEM_REMOVE(MQTTc_MEM_TYPE_TX_Q, p_msg->TxQ_Len);
+    if ((p_conn->TxQ_IsHigh      == DEF_YES) &&                 /* See if tx q drained down to its low watermark.       */
+        (MQTTc_TxQ_IsLow(p_conn) == DEF_YES)) {
+        p_conn->TxQ_IsHigh  = DEF_NO;
+        is_low              = DEF_YES;
+        wait_nbr            = p_conn->TxQ_WaitNbr;
+        p_conn->TxQ_WaitNbr = 0u;
+    }
+    CPU_CRITICAL_EXIT();
+
+    p_msg->TxQ_Len = 0u;
+
+    if (is_low == DEF_YES) {
+        if (p_conn->OnTxQ_Low != DEF_NULL) {
+            MQTTc_PROF_CALLBACK_START();
+            p_conn->OnTxQ_Low(p_conn,
+                              p_conn->ArgPtr);
+            MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_TX_Q_LOW);
+        }
+
+        while (wait_nbr > 0u) {                                 /* Wake up tasks waiting for room. See Note #2.         */
+            KAL_SemPost(p_conn->TxQ_SemHandle,
+                        KAL_OPT_POST_NONE,
+                       &err_kal);
+            wait_nbr--;
+        }
+        (void)&err_kal;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_TxQ_IsLow()
+*
+* Description : Check if the tx q of given MQTTc Connection is at or below its low watermarks.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object to check.
+*
+* Return(s)   : DEF_YES, if tx q is at or below its low watermarks,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : MQTTc_TxQ_Release().
+*
+* Note(s)     : (1) MUST be called with a critical section entered.
+*
+*               (2) See MQTTc_ConnSetParam() Note #4b.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  MQTTc_TxQ_IsLow (MQTTc_CONN  *p_conn)
+{
+    CPU_INT16U  low_msg_nbr;
+    CPU_INT32U  low_len;
+
+
+    if (p_conn->TxQ_MaxMsgNbr != 0u) {
+        low_msg_nbr = p_conn->TxQ_LowMsgNbr;
+        if ((low_msg_nbr == 0u) ||                              /* See Note #2.                                         */
+            (low_msg_nbr >= p_conn->TxQ_MaxMsgNbr)) {
+            low_msg_nbr = p_conn->TxQ_MaxMsgNbr / 2u;
+        }
+        if (p_conn->TxQ_MsgNbr > low_msg_nbr) {
+            return (DEF_NO);
+        }
+    }
+
+    if (p_conn->TxQ_MaxLen != 0u) {
+        low_len = p_conn->TxQ_LowLen;
+        if ((low_len == 0u) ||
+            (low_len >= p_conn->TxQ_MaxLen)) {
+            low_len = p_conn->TxQ_MaxLen / 2u;
+        }
+        if (p_conn->TxQ_Len > low_len) {
+            return (DEF_NO);
+        }
+    }
+
+    return (DEF_YES);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     MQTTc_TxQ_HighCallbackExec()
+*
+* Description : Execute the OnTxQ_High callback of given MQTTc Connection, if the tx q reached its high
+*               watermark since the last call.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which to exec the callback.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgProcess(),
+*               MQTTc_TxQ_Release().
+*
+* Note(s)     : (1) The flag is set by MQTTc_MsgPost(), from the producer's context. It is checked without
+*                   a critical section first, since it is not set in the common case.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TxQ_HighCallbackExec (MQTTc_CONN  *p_conn)
+{
+    CPU_BOOLEAN  is_pend;
+    CPU_SR_ALLOC();
+
+
+    if (p_conn->TxQ_HighCallbackPend == DEF_NO) {               /* See Note #1.                                         */
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    is_pend                      = p_conn->TxQ_HighCallbackPend;
+    p_conn->TxQ_HighCallbackPend = DEF_NO;
+    CPU_CRITICAL_EXIT();
+
+    if ((is_pend            == DEF_YES) &&
+        (p_conn->OnTxQ_High != DEF_NULL)) {
+        MQTTc_PROF_CALLBACK_START();
+        p_conn->OnTxQ_High(p_conn,
+                           p_conn->ArgPtr);
+        MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_TX_Q_HIGH);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_TxQ_Wait()
+*
+* Description : Wait for the tx q of given MQTTc Connection to drain down to its low watermarks.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object on which to wait.
+*
+*               timeout_ms      Max time to wait, in milliseconds.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Tx q drained, or was woken up.
+*                                   MQTTc_ERR_TIMEOUT           Tx q did not drain before timeout expired.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_PublishBlocking().
+*
+* Note(s)     : (1) The task may have drained the tx q between the moment the message was rejected and
+*                   this call. The caller is then registered as a waiter only if the tx q is still 'high',
+*                   in the same critical section as the one in which the task clears that state.
+*
+*               (2) A task that times out after the sem was posted for it leaves one extra count in the
+*                   sem. The next waiter is then woken up once too early, retries its publish and pends
+*                   again if the tx q is still full.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TxQ_Wait (MQTTc_CONN  *p_conn,
+                              CPU_INT32U   timeout_ms,
+                              MQTTc_ERR   *p_err)
+{
+    CPU_BOOLEAN  is_high;
+    KAL_ERR      err_kal;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    is_high = p_conn->TxQ_IsHigh;
+    if (is_high == DEF_YES) {
+        p_conn->TxQ_WaitNbr++;
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (is_high == DEF_NO) {
+       *p_err = MQTTc_ERR_NONE;
+        return;
+    }
+
+    KAL_SemPend(p_conn->TxQ_SemHandle,
+                KAL_OPT_PEND_NONE,
+                timeout_ms,
+               &err_kal);
+    switch (err_kal) {
+        case KAL_ERR_NONE:
+            *p_err = MQTTc_ERR_NONE;
+             break;
+
+
+        case KAL_ERR_TIMEOUT:
+             CPU_CRITICAL_ENTER();                              /* See Note #2.                                         */
+             if (p_conn->TxQ_WaitNbr > 0u) {
+                 p_conn->TxQ_WaitNbr--;
+             }
+             CPU_CRITICAL_EXIT();
+            *p_err = MQTTc_ERR_TIMEOUT;
+             break;
+
+
+        default:
+            *p_err = MQTTc_ERR_OS_FAIL;
+             break;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TxRateWaitGet()
+*
+* Description : Get the time to wait before a message can be tx'd without exceeding the tx rates of given
+*               MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+*               p_msg           Pointer to MQTTc Message object to tx.
+*
+* Return(s)   : Time to wait before msg can be tx'd, in milliseconds. 0 if it can be tx'd now.
+*
+* Caller(s)   : MQTTc_TxLaneSel(),
+*               MQTTc_TxRateDlyGet().
+*
+* Note(s)     : (1) Only PUBLISH messages are subject to the tx rate limiter. See MQTTc_ConnSetParam()
+*                   Note #5.
+*
+*               (2) The buckets are not modified : their content is only computed as of now. See
+*                   MQTTc_TxLaneSel() Note #5.
+*
+*               (3) The need of the byte bucket is capped by its burst. See MQTTc_ConnSetParam() Note #5b.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_TxRateWaitGet (MQTTc_CONN  *p_conn,
+                                         MQTTc_MSG   *p_msg)
+{
+    CPU_INT32U  elapsed_ms;
+    CPU_INT32U  wait_ms      = 0u;
+    CPU_INT32U  byte_wait_ms;
+    CPU_INT32U  len;
+    CPU_INT32S  need;
+    CPU_INT32S  tokens;
+
+
+    if ((p_msg->Type              != MQTTc_MSG_TYPE_PUBLISH) || /* See Note #1.                                         */
+       ((p_conn->TxRateMsgPerSec   == 0u)                     &&
+        (p_conn->TxRateBytesPerSec == 0u))) {
+        return (0u);
+    }
+
+    elapsed_ms = NetUtil_TS_Get_ms() - p_conn->TxRateTS_ms;     /* See Note #2.                                         */
+
+    if (p_conn->TxRateMsgPerSec != 0u) {
+        tokens = MQTTc_TxRateTokensCalc(p_conn->TxRateMsgTokens,
+                                        p_conn->TxRateMsgPerSec,
+                                        p_conn->TxRateMsgBurst,
+                                        elapsed_ms);
+        need   = (CPU_INT32S)MQTTc_TX_RATE_TOKEN_SCALE;
+        if (tokens < need) {
+            wait_ms = ((CPU_INT32U)(need - tokens) + p_conn->TxRateMsgPerSec - 1u) / p_conn->TxRateMsgPerSec;
+        }
+    }
+
+    if (p_conn->TxRateBytesPerSec != 0u) {
+        tokens = MQTTc_TxRateTokensCalc(p_conn->TxRateBytesTokens,
+                                        p_conn->TxRateBytesPerSec,
+                                        p_conn->TxRateBytesBurst,
+                                        elapsed_ms);
+        len    = DEF_MIN(p_msg->XferLen, p_conn->TxRateBytesBurst);
+        need   = (CPU_INT32S)(len * MQTTc_TX_RATE_TOKEN_SCALE); /* See Note #3.                                         */
+        if (tokens < need) {
+            byte_wait_ms = ((CPU_INT32U)(need - tokens) + p_conn->TxRateBytesPerSec - 1u) / p_conn->TxRateBytesPerSec;
+            wait_ms      = DEF_MAX(wait_ms, byte_wait_ms);
+        }
+    }
+
+    return (wait_ms);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_TxRateDlyGet()
+*
+* Description : Get the time after which the next message held back by the tx rate limiter of given MQTTc
+*               Connection can be tx'd.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : Time to wait, in milliseconds, if a msg is held back by the tx rate limiter,
+*               0,                               otherwise.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) Only the head of each lane is considered, since a held back message blocks its lane. See
+*                   MQTTc_TxLaneSel() Note #6.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_TxRateDlyGet (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MSG   *p_msg;
+    CPU_INT08U   lane;
+    CPU_INT32U   wait_ms;
+    CPU_INT32U   dly_ms  = 0u;
+
+
+    if ((p_conn->TxRateMsgPerSec   == 0u) &&
+        (p_conn->TxRateBytesPerSec == 0u)) {
+        return (0u);
+    }
+
+    for (lane = 0u; lane < MQTTc_MSG_PRIO_NBR; lane++) {        /* See Note #1.                                         */
+        p_msg = p_conn->TxLaneHeadPtr[lane];
+        if (p_msg == DEF_NULL) {
+            continue;
+        }
+
+        wait_ms = MQTTc_TxRateWaitGet(p_conn, p_msg);
+        if ((wait_ms != 0u) &&
+           ((dly_ms  == 0u) || (wait_ms < dly_ms))) {
+            dly_ms = wait_ms;
+        }
+    }
+
+    return (dly_ms);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TxRateConsume()
+*
+* Description : Refill the tx rate buckets of given MQTTc Connection and take the tokens of a message that
+*               is about to be tx'd.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+*               p_msg           Pointer to MQTTc Message object about to be tx'd.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TxMsgGet().
+*
+* Note(s)     : (1) The byte bucket can go in debt. See MQTTc_ConnSetParam() Note #5b. Its content can never
+*                   go below -(MQTTc_TX_RATE_MAX_VAL * MQTTc_TX_RATE_TOKEN_SCALE), since a message is only
+*                   tx'd once the bucket holds at least the smaller of the message's length and the burst.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TxRateConsume (MQTTc_CONN  *p_conn,
+                                   MQTTc_MSG   *p_msg)
+{
+    CPU_INT32U  ts_ms;
+    CPU_INT32U  elapsed_ms;
+    CPU_INT32U  len;
+
+
+    if ((p_msg->Type              != MQTTc_MSG_TYPE_PUBLISH) ||
+       ((p_conn->TxRateMsgPerSec   == 0u)                     &&
+        (p_conn->TxRateBytesPerSec == 0u))) {
+        return;
+    }
+
+    ts_ms               = NetUtil_TS_Get_ms();
+    elapsed_ms          = ts_ms - p_conn->TxRateTS_ms;
+    p_conn->TxRateTS_ms = ts_ms;
+
+    if (p_conn->TxRateMsgPerSec != 0u) {
+        p_conn->TxRateMsgTokens  = MQTTc_TxRateTokensCalc(p_conn->TxRateMsgTokens,
+                                                          p_conn->TxRateMsgPerSec,
+                                                          p_conn->TxRateMsgBurst,
+                                                          elapsed_ms);
+        p_conn->TxRateMsgTokens -= (CPU_INT32S)MQTTc_TX_RATE_TOKEN_SCALE;
+    }
+
+    if (p_conn->TxRateBytesPerSec != 0u) {
+        len                        = DEF_MIN(p_msg->XferLen, MQTTc_TX_RATE_MAX_VAL);
+        p_conn->TxRateBytesTokens  = MQTTc_TxRateTokensCalc(p_conn->TxRateBytesTokens,
+                                                            p_conn->TxRateBytesPerSec,
+                                                            p_conn->TxRateBytesBurst,
+                                                            elapsed_ms);
+        p_conn->TxRateBytesTokens -= (CPU_INT32S)(len * MQTTc_TX_RATE_TOKEN_SCALE);
+    }                                                           /* See Note #1.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_TxRateTokensCalc()
+*
+* Description : Compute the content of a tx rate bucket after it has been refilled for a given time.
+*
+* Argument(s) : tokens          Content of the bucket, in thousandths of msg or byte.
+*
+*               rate            Refill rate of the bucket, in msgs or bytes per second.
+*
+*               burst           Size of the bucket, in msgs or bytes.
+*
+*               elapsed_ms      Time elapsed since the bucket was last refilled, in milliseconds.
+*
+* Return(s)   : Content of the bucket once refilled, in thousandths of msg or byte.
+*
+* Caller(s)   : MQTTc_TxRateWaitGet(),
+*               MQTTc_TxRateConsume().
+*
+* Note(s)     : (1) Refilling the bucket for one millisecond adds 'rate' thousandths of msg or byte. See
+*                   TX RATE DEFINES Note #1.
+*
+*               (2) The bucket is full before the product of the elapsed time and the rate can overflow.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32S  MQTTc_TxRateTokensCalc (CPU_INT32S  tokens,
+                                            CPU_INT32U  rate,
+                                            CPU_INT32U  burst,
+                                            CPU_INT32U  elapsed_ms)
+{
+    CPU_INT32S  cap;
+    CPU_INT32U  room;
+
+
+    cap = (CPU_INT32S)(burst * MQTTc_TX_RATE_TOKEN_SCALE);
+    if (tokens >= cap) {
+        return (cap);
+    }
+
+    room = (CPU_INT32U)(cap - tokens);
+    if (elapsed_ms >= ((room + rate - 1u) / rate)) {            /* See Note #2.                                         */
+        return (cap);
+    }
+
+    return (tokens + (CPU_INT32S)(elapsed_ms * rate));          /* See Note #1.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_AckQ_Add()
+*
+* Description : Encode an ack in the ack Q of given MQTTc Connection, for the task to tx it.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object on which to q the ack.
+*
+*               type            Type of ack (MQTTc_MSG_TYPE_PUBACK, MQTTc_MSG_TYPE_PUBREC or
+*                               MQTTc_MSG_TYPE_PUBCOMP).
+*
+*               msg_id          Message ID to ack.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_RdSockProcess().
+*
+* Note(s)     : (1) The caller MUST make sure there is room in the ack Q. See MQTTc_RdSockProcess() Note #1.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_AckQ_Add (MQTTc_CONN      *p_conn,
+                              MQTTc_MSG_TYPE   type,
+                              CPU_INT16U       msg_id)
+{
+    CPU_INT08U  *p_buf;
+    MQTTc_ERR    err_mqttc;
+
+
+    p_buf = MQTTc_FixedHdrBufCfg(&p_conn->AckQ_Buf[p_conn->AckQ_Len],
+                                  type,
+                                  DEF_NO,
+                                  0u,
+                                  DEF_NO,
+                                  MQTT_MSG_ID_SIZE,
+                                 &err_mqttc);
+    (void)err_mqttc;
+
+    p_buf[0u] = (CPU_INT08U)(msg_id >>    8u);
+    p_buf[1u] = (CPU_INT08U)(msg_id &  0xFFu);
+
+    p_conn->AckQ_Len += MQTT_MSG_BASE_LEN;
+                                                                /* See MQTTc_CONN_STATS Note #2.                        */
+    MQTTc_STAT_INC(p_conn, TxPktCtrTbl[type]);
+    MQTTc_STAT_ADD(p_conn, TxPktByteCtrTbl[type], MQTT_MSG_BASE_LEN);
+
+    MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_QoS2_RxTblFind()
+*
+* Description : Find the entry of a message ID in the QoS 2 rx table of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object in which to search.
+*
+*               msg_id          Message ID of the QoS 2 PUBLISH to find.
+*
+* Return(s)   : Index of the entry in the table, if found,
+*               MQTTc_QOS2_RX_TBL_IX_NONE,       otherwise.
+*
+* Caller(s)   : MQTTc_RdSockProcess().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  MQTTc_QoS2_RxTblFind (MQTTc_CONN  *p_conn,
+                                          CPU_INT16U   msg_id)
+{
+    CPU_INT08U  ix;
+
+
+    if (p_conn->QoS2_RxTblBitmap == DEF_BIT_NONE) {             /* Most common case: no QoS 2 flow in progress.         */
+        return (MQTTc_QOS2_RX_TBL_IX_NONE);
+    }
+
+    for (ix = 0u; ix < MQTTc_CFG_QOS2_RX_TBL_SIZE; ix++) {
+        if ((DEF_BIT_IS_SET(p_conn->QoS2_RxTblBitmap, (CPU_INT32U)DEF_BIT(ix)) == DEF_YES) &&
+            (p_conn->QoS2_RxTblMsgID[ix]                                        == msg_id)) {
+            return (ix);
+        }
+    }
+
+    return (MQTTc_QOS2_RX_TBL_IX_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_QoS2_RxTblAdd()
+*
+* Description : Add a message ID to the QoS 2 rx table of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object in which to add the entry.
+*
+*               msg_id          Message ID of the QoS 2 PUBLISH rx'd.
+*
+* Return(s)   : Index of the entry used in the table, if NO error(s),
+*               MQTTc_QOS2_RX_TBL_IX_NONE,            if the table is full.
+*
+* Caller(s)   : MQTTc_RdSockProcess().
+*
+* Note(s)     : (1) The caller MUST make sure the message ID is not already in the table.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  MQTTc_QoS2_RxTblAdd (MQTTc_CONN  *p_conn,
+                                         CPU_INT16U   msg_id)
+{
+    CPU_INT08U  ix;
+
+
+    for (ix = 0u; ix < MQTTc_CFG_QOS2_RX_TBL_SIZE; ix++) {
+        if (DEF_BIT_IS_CLR(p_conn->QoS2_RxTblBitmap, (CPU_INT32U)DEF_BIT(ix)) == DEF_YES) {
+            DEF_BIT_SET(p_conn->QoS2_RxTblBitmap, (CPU_INT32U)DEF_BIT(ix));
+            p_conn->QoS2_RxTblMsgID[ix] = msg_id;
+            return (ix);
+        }
+    }
+
+    return (MQTTc_QOS2_RX_TBL_IX_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_QoS2_RxTblClr()
+*
+* Description : Remove every entry of the QoS 2 rx table of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which to clear the table.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnCloseProc().
+*
+* Note(s)     : (1) The flows removed are also removed from the connection's WAL, if any.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_QoS2_RxTblClr (MQTTc_CONN  *p_conn)
+{
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    CPU_INT08U  ix;
+
+
+    if (p_conn->WalPtr != DEF_NULL) {                           /* See Note #1.                                         */
+        for (ix = 0u; ix < MQTTc_CFG_QOS2_RX_TBL_SIZE; ix++) {
+            if (DEF_BIT_IS_SET(p_conn->QoS2_RxTblBitmap, (CPU_INT32U)DEF_BIT(ix)) == DEF_YES) {
+                MQTTc_WalLog(p_conn->WalPtr,
+                             MQTTc_WAL_STATE_IN_FREE,
+                             p_conn->QoS2_RxTblMsgID[ix],
+                             DEF_NULL);
+            }
+        }
+    }
+#endif
+
+    p_conn->QoS2_RxTblBitmap = DEF_BIT_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_FixedHdrBufCfg()
+*
+* Description : Fill buffer with correct fields of fixed header.
+*
+* Argument(s) : p_buf           Pointer to beginning of the buffer to fill.
+*
+*               msg_type        Type of message.
+*
+*               dup_flag        DUP flag.
+*
+*               qos_lvl         QoS level of the message.
+*
+*               retain_flag     Retain flag.
+*
+*               rem_len         Remaining length of the message.
+*
+*               p_err           Pointer to variable that will receive the return error code.
+*               -----           Argument validated by caller.
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*
+* Return(s)   : Pointer to next location in buffer, if NO error(s),
+*               DEF_NULL,                           otherwise.
+*
+* Caller(s)   : Various MQTTc functions.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  *MQTTc_FixedHdrBufCfg (CPU_INT08U      *p_buf,
+                                           MQTTc_MSG_TYPE   msg_type,
+                                           CPU_BOOLEAN      dup_flag,
+                                           CPU_INT08U       qos_lvl,
+                                           CPU_BOOLEAN      retain_flag,
+                                           CPU_INT32U       rem_len,
+                                           MQTTc_ERR       *p_err)
+{
+    CPU_INT08U  *p_cur_buf;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_buf == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return (0u);
+        }
+
+        if (rem_len > MQTT_MSG_FIXED_HDR_REM_LEN_MAX) {         /* Make sure len can be encoded.                        */
+           *p_err = MQTTc_ERR_INVALID_ARG;
+            return (0u);
+        }
+    #endif
+
+    p_cur_buf = p_buf;
+
+    switch (msg_type) {                                         /* Convert msg type.                                    */
+        case MQTTc_MSG_TYPE_CONNECT:
+            *p_cur_buf = MQTT_MSG_TYPE_CONNECT;
+             break;
+
+        case MQTTc_MSG_TYPE_CONNACK:
+            *p_cur_buf = MQTT_MSG_TYPE_CONNACK;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBLISH:
+            *p_cur_buf = MQTT_MSG_TYPE_PUBLISH;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBACK:
+            *p_cur_buf = MQTT_MSG_TYPE_PUBACK;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBREC:
+            *p_cur_buf = MQTT_MSG_TYPE_PUBREC;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBREL:
+            *p_cur_buf = MQTT_MSG_TYPE_PUBREL;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBCOMP:
+            *p_cur_buf = MQTT_MSG_TYPE_PUBCOMP;
+             break;
+
+        case MQTTc_MSG_TYPE_SUBSCRIBE:
+            *p_cur_buf = MQTT_MSG_TYPE_SUBSCRIBE;
+             break;
+
+        case MQTTc_MSG_TYPE_SUBACK:
+            *p_cur_buf = MQTT_MSG_TYPE_SUBACK;
+             break;
+
+        case MQTTc_MSG_TYPE_UNSUBSCRIBE:
+            *p_cur_buf = MQTT_MSG_TYPE_UNSUBSCRIBE;
+             break;
+
+        case MQTTc_MSG_TYPE_UNSUBACK:
+            *p_cur_buf = MQTT_MSG_TYPE_UNSUBACK;
+             break;
+
+        case MQTTc_MSG_TYPE_PINGREQ:
+            *p_cur_buf = MQTT_MSG_TYPE_PINGREQ;
+             break;
+
+        case MQTTc_MSG_TYPE_PINGRESP:
+            *p_cur_buf = MQTT_MSG_TYPE_PINGRESP;
+             break;
+
+        case MQTTc_MSG_TYPE_DISCONNECT:
+            *p_cur_buf = MQTT_MSG_TYPE_DISCONNECT;
+             break;
+
+        default:
+             break;
+    }
+
+
+    switch (msg_type) {
+        case MQTTc_MSG_TYPE_PUBLISH:                            /* Set every val.                                       */
+             if (retain_flag == DEF_YES) {
+                 DEF_BIT_SET(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_RETAIN_MSK);
+             } else {
+                 DEF_BIT_CLR(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_RETAIN_MSK);
+             }
+                                                                /* break intentionnally omitted.                        */
+        case MQTTc_MSG_TYPE_PUBREL:                             /* Set everything except 'retain'.                      */
+        case MQTTc_MSG_TYPE_SUBSCRIBE:
+        case MQTTc_MSG_TYPE_UNSUBSCRIBE:
+             if (dup_flag == DEF_YES) {
+                 DEF_BIT_SET(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK);
+             } else {
+                 DEF_BIT_CLR(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK);
+             }
+             DEF_BIT_SET(*p_cur_buf, (qos_lvl << MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT));
+                                                                /* break intentionnally omitted.                        */
+        case MQTTc_MSG_TYPE_CONNECT:                            /* Set only the msg_type.                               */
+        case MQTTc_MSG_TYPE_PUBACK:
+        case MQTTc_MSG_TYPE_PUBREC:
+        case MQTTc_MSG_TYPE_PUBCOMP:
+        case MQTTc_MSG_TYPE_PINGREQ:
+        case MQTTc_MSG_TYPE_DISCONNECT:
+             break;
+
+
+        case MQTTc_MSG_TYPE_CONNACK:                            /* Err cases.                                           */
+        case MQTTc_MSG_TYPE_SUBACK:
+        case MQTTc_MSG_TYPE_UNSUBACK:
+        case MQTTc_MSG_TYPE_PINGRESP:
+        default:
+             MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In default case for msg_type:%i\n\r", msg_type));
+             break;
+    }
+
+    p_cur_buf++;
+    p_cur_buf = MQTTc_RemLenBufCfg(p_cur_buf, rem_len);
+
+   *p_err = MQTTc_ERR_NONE;
+
+    return (p_cur_buf);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_RemLenBufCfg()
+*
+* Description : Encode the 'remaining length' field of the fixed header in buffer.
+*
+* Argument(s) : p_buf           Pointer to location in buffer where to encode the remaining length.
+*
+*               rem_len         Remaining length of the message.
+*
+* Return(s)   : Pointer to next location in buffer.
+*
+* Caller(s)   : MQTTc_FixedHdrBufCfg(),
+*               MQTTc_PublishByTemplate().
+*
+* Note(s)     : (1) The remaining length MUST have been validated by the caller.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  *MQTTc_RemLenBufCfg (CPU_INT08U  *p_buf,
+                                         CPU_INT32U   rem_len)
+{
+    CPU_INT08U  encoded_byte;
+    CPU_INT32U  len;
+
+
+    len = rem_len;
+    do {
+        encoded_byte = (len) % (MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN);
+
+        len = len / MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN;
+
+        if (len > 0) {
+            encoded_byte = encoded_byte | MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN;
+        }
+       *p_buf = encoded_byte;
+        p_buf++;
+    } while (len > 0);
+
+    return (p_buf);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_PublishTopicGet()
+*
+* Description : Get the topic of an encoded PUBLISH message.
+*
+* Argument(s) : p_msg           Pointer to MQTTc Message object containing the PUBLISH message.
+*
+*               p_topic_len     Pointer to variable that will receive the length of the topic.
+*
+* Return(s)   : Pointer to the topic in the message's buffer, if found,
+*               DEF_NULL,                                     otherwise.
+*
+* Caller(s)   : MQTTc_TxLaneConflate().
+*
+* Note(s)     : (1) The topic follows the fixed header, made of the first byte and of the 'remaining length'
+*                   field, which is encoded on 1 to 4 bytes.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  *MQTTc_PublishTopicGet (MQTTc_MSG   *p_msg,
+                                            CPU_INT16U  *p_topic_len)
+{
+    CPU_INT08U  *p_buf = (CPU_INT08U *)p_msg->ArgPtr;
+    CPU_INT32U   ix    = 1u;                                    /* Skip first byte of fixed hdr. See Note #1.           */
+    CPU_INT16U   topic_len;
+
+
+    while ((ix < p_msg->XferLen) &&
+           (DEF_BIT_IS_SET(p_buf[ix], MQTT_MSG_FIXED_HDR_REM_LEN_CONTINUATION_BIT) == DEF_YES)) {
+        if (ix >= MQTT_MSG_FIXED_HDR_REM_LEN_NBR_BYTES_MAX) {
+            return (DEF_NULL);
+        }
+        ix++;
+    }
+    ix++;                                                       /* Skip last byte of rem len.                           */
+
+    if ((ix + MQTT_MSG_UTF8_LEN_SIZE) > p_msg->XferLen) {
+        return (DEF_NULL);
+    }
+
+    topic_len  = (CPU_INT16U)MQTT_MSG_UTF8_LEN_RD(&p_buf[ix]);
+    ix        += MQTT_MSG_UTF8_LEN_SIZE;
+    if ((ix + topic_len) > p_msg->XferLen) {
+        return (DEF_NULL);
+    }
+
+   *p_topic_len = topic_len;
+
+    return (&p_buf[ix]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_MsgID_Get()
+*
+* Description : Obtain a msg ID to use for a message requiring one.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Message ID,          if NO error(s),
+*               MQTT_MSG_ID_INVALID, otherwise.
+*
+* Caller(s)   : MQTTc_Publish(),
+*               MQTTc_SubscribeMult(),
+*               MQTTc_UnsubscribeMult().
+*
+* Note(s)     : (1) Once the message has been completed, MQTTc_MsgID_Free() must be called to release the
+*                   msg ID so that other messages can use it.
+*********************************************************************************************************
+*/
 
+static  CPU_INT16U   MQTTc_MsgID_Get (void)
+{
+    CPU_INT16U  msg_id    = MQTT_MSG_ID_INVALID;
+    CPU_INT08U  bitmap_ix;
+    CPU_SR_ALLOC();
 
-            case MQTTc_MSG_TYPE_PUBREC:
-                 MQTTc_DBG_TRACE_LOG(("Pubrec event rx'd, removing msg from list."));
 
-                 p_buf = MQTTc_FixedHdrBufCfg((CPU_INT08U *)p_next_msg->ArgPtr,
-                                                            MQTTc_MSG_TYPE_PUBREL,
-                                                            DEF_NO,
-                                                            1u,
-                                                            DEF_NO,
-                                                            MQTT_MSG_ID_SIZE,
-                                                           &p_next_msg->Err);
+    CPU_CRITICAL_ENTER();
+    for (bitmap_ix = 0u; bitmap_ix < MQTTc_Ptr->MsgID_BitmapTblMax; bitmap_ix++) {
+        if (DEF_BIT_IS_CLR_ANY(MQTTc_Ptr->MsgID_BitmapTbl[bitmap_ix], DEF_INT_32_MASK) == DEF_YES) {
 
-                 p_buf[0u] = (p_next_msg->MsgID >>    8u);
-                 p_buf[1u] = (p_next_msg->MsgID &  0xFFu);
+            msg_id = DEF_INT_32_NBR_BITS - 1u - CPU_CntLeadZeros(~MQTTc_Ptr->MsgID_BitmapTbl[bitmap_ix]);
 
-                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+            DEF_BIT_SET(MQTTc_Ptr->MsgID_BitmapTbl[bitmap_ix], DEF_BIT(msg_id));
+            msg_id += (DEF_INT_32_NBR_BITS * bitmap_ix) + 1u;
+            break;
+        }
+    }
+    CPU_CRITICAL_EXIT();
 
-                 p_next_msg->Type    = MQTTc_MSG_TYPE_PUBREL;
-                 p_next_msg->State   = MQTTc_MSG_STATE_MUST_TX;
-                 p_next_msg->XferLen = MQTT_MSG_BASE_LEN;
-                 p_next_msg->Err     = MQTTc_ERR_NONE;
+    return (msg_id);
+}
 
-                 MQTTc_ConnNextMsgClr(p_conn);                  /* Clr NextMsg fields.                                  */
-                 return;
 
+/*
+*********************************************************************************************************
+*                                          MQTTc_MsgID_Free()
+*
+* Description : Free message ID, allowing other messages to use it.
+*
+* Argument(s) : msg_id          Message ID to release.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
 
-            case MQTTc_MSG_TYPE_PUBREL:
-                 MQTTc_DBG_TRACE_LOG(("Pubrel event rx'd, removing msg from list."));
+static  void  MQTTc_MsgID_Free (CPU_INT16U  msg_id)
+{
+    CPU_SR_ALLOC();
 
-                 MQTTc_MsgCallbackExec(p_next_msg);
 
-                 p_buf = MQTTc_FixedHdrBufCfg((CPU_INT08U *)p_next_msg->ArgPtr,
-                                                            MQTTc_MSG_TYPE_PUBCOMP,
-                                                            DEF_NO,
-                                                            1u,
-                                                            DEF_NO,
-                                                            MQTT_MSG_ID_SIZE,
-                                                           &p_next_msg->Err);
+    if (msg_id != MQTT_MSG_ID_NONE) {
+        CPU_CRITICAL_ENTER();
+        DEF_BIT_CLR(MQTTc_Ptr->MsgID_BitmapTbl[(msg_id - 1u) / 32u], DEF_BIT((msg_id - 1u) % DEF_INT_32_NBR_BITS));
+        CPU_CRITICAL_EXIT();
+    }
 
-                 p_buf[0u] = (p_next_msg->MsgID >>    8u);
-                 p_buf[1u] = (p_next_msg->MsgID &  0xFFu);
+    return;
+}
 
-                 MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
 
-                 p_next_msg->Type    = MQTTc_MSG_TYPE_PUBCOMP;
-                 p_next_msg->State   = MQTTc_MSG_STATE_MUST_TX;
-                 p_next_msg->XferLen = MQTT_MSG_BASE_LEN;
-                 p_next_msg->Err     = MQTTc_ERR_NONE;
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                         MQTTc_MsgID_Reserve()
+*
+* Description : Reserve a given message ID, so that no other message uses it.
+*
+* Argument(s) : msg_id          Message ID to reserve.
+*
+* Return(s)   : DEF_YES, if the message ID was reserved,
+*               DEF_NO,  if it is invalid or already in use.
+*
+* Caller(s)   : MQTTc_ConnWalRestore().
+*
+* Note(s)     : (1) The message ID MUST be freed with MQTTc_MsgID_Free().
+*********************************************************************************************************
+*/
 
-                 MQTTc_ConnNextMsgClr(p_conn);                  /* Clr NextMsg fields.                                  */
-                 return;
+static  CPU_BOOLEAN  MQTTc_MsgID_Reserve (CPU_INT16U  msg_id)
+{
+    CPU_INT16U   tbl_ix;
+    CPU_INT32U   bit;
+    CPU_BOOLEAN  is_reserved = DEF_NO;
+    CPU_SR_ALLOC();
 
 
-            case MQTTc_MSG_TYPE_PUBCOMP:
-                 if (p_conn->NextMsgRxLen != 0u) {
-                     MQTTc_DBG_TRACE_DBG(("MQTTc - Pubcomp rx'd len not OK.\n\r"));
-                     p_next_msg->Err = MQTTc_ERR_FAIL;
-                 } else {
-                     p_next_msg->Err = MQTTc_ERR_NONE;
-                 }
-                 break;
+    if ((msg_id == MQTT_MSG_ID_NONE) ||
+        (msg_id >  (CPU_INT32U)MQTTc_Ptr->MsgID_BitmapTblMax * DEF_INT_32_NBR_BITS)) {
+        return (DEF_NO);
+    }
 
+    tbl_ix = (msg_id - 1u) / DEF_INT_32_NBR_BITS;
+    bit    =  DEF_BIT((msg_id - 1u) % DEF_INT_32_NBR_BITS);
 
-            default:
-                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In Rx switch default case.\n\r"));
-                 break;
-        }
+    CPU_CRITICAL_ENTER();
+    if (DEF_BIT_IS_CLR(MQTTc_Ptr->MsgID_BitmapTbl[tbl_ix], bit) == DEF_YES) {
+        DEF_BIT_SET(MQTTc_Ptr->MsgID_BitmapTbl[tbl_ix], bit);
+        is_reserved = DEF_YES;
+    }
+    CPU_CRITICAL_EXIT();
 
-        MQTTc_ConnNextMsgClr(p_conn);                           /* Clr NextMsg fields.                                  */
+    return (is_reserved);
+}
+#endif
 
-        MQTTc_MsgCallbackExec(p_next_msg);
-    }
 
-    return;
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                        MQTTc_ConnStoreFeed()
+*
+* Description : Move the next records of the store of given MQTTc Connection to its tx lanes, as long as
+*               its tx window is not full.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) Records are only tx'd once the CONNECT of the connection has cmpl'd successfully.
+*
+*               (2) Each record in flight uses a slot of the connection's tx window and a msg ID. The
+*                   msg ID is written in place in the record. See mqtt-c_store.c Note #4.
+*
+*               (3) Stored messages are tx'd at the QoS they were stored with, in the NORMAL tx lane.
+*
+*               (4) A record whose flow is in the WAL is resumed with the msg ID of the flow. See
+*                   MQTTc_ConnSetParam() Note #8a.
+*
+*                   (a) If it was acknowledged, it is not tx'd again. Its slot is released in order with
+*                       the others.
+*
+*                   (b) If its PUBREC was rx'd, its PUBREL is tx'd again.
+*
+*                   (c) Otherwise, it is tx'd again with the DUP flag set.
+*
+*               (5) A new flow is logged before the record is tx'd. See MQTTc_Task() Note #5.
+*********************************************************************************************************
+*/
 
-err_callback_restart:
-    MQTTc_MsgCallbackExec(p_conn->NextMsgPtr);
-    MQTTc_ConnNextMsgClr(p_conn);                               /* Clr NextMsg fields.                                  */
+static  void  MQTTc_ConnStoreFeed (MQTTc_CONN  *p_conn)
+{
+    MQTTc_STORE_SLOT  *p_slot;
+    MQTTc_MSG         *p_msg;
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    MQTTc_WAL_ENTRY   *p_entry;
+    CPU_INT08U        *p_buf;
+#endif
+    CPU_INT08U        *p_rec;
+    CPU_INT32U         len;
+    CPU_INT16U         msg_id_ix;
+    CPU_INT16U         msg_id;
+    CPU_BOOLEAN        is_added   = DEF_NO;
 
-    return;
 
-err_restart:
-    MQTTc_ConnNextMsgClr(p_conn);                               /* Clr NextMsg fields.                                  */
-    err_mqttc = MQTTc_ERR_UNEXPECTED_MSG;
+    if ((p_conn->StorePtr  == DEF_NULL) ||                      /* See Note #1.                                         */
+        (p_conn->StoreTxEn == DEF_NO)) {
+        return;
+    }
 
-err_remove_conn_close_sock:
-    {
-        MQTTc_ERR_CALLBACK   on_err_callback;
-        void                *p_arg;
-        MQTTc_ERR            close_err;
+    while (p_conn->StoreWinNbr < MQTTc_CFG_STORE_WIN_SIZE) {    /* See Note #2.                                         */
+        msg_id = MQTTc_MsgID_Get();
+        if (msg_id == MQTT_MSG_ID_INVALID) {
+            break;
+        }
 
+        p_slot = &p_conn->StoreSlotTbl[(p_conn->StoreWinHeadIx + p_conn->StoreWinNbr) % MQTTc_CFG_STORE_WIN_SIZE];
+        p_rec  =  MQTTc_StoreRecNext(p_conn->StorePtr,
+                                    &len,
+                                    &msg_id_ix,
+                                    &p_slot->Pos);
+        if (p_rec == DEF_NULL) {
+            MQTTc_MsgID_Free(msg_id);
+            break;
+        }
+        p_conn->StoreWinNbr++;
+
+        p_msg                =  &p_slot->Msg;
+        p_msg->ConnPtr       =  p_conn;
+        p_msg->Type          =  MQTTc_MSG_TYPE_PUBLISH;
+        p_msg->State         =  MQTTc_MSG_STATE_MUST_TX;
+        p_msg->QoS           = (p_rec[0u] & MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_MSK) >> MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT;
+        p_msg->Prio          =  MQTTc_MSG_PRIO_NORMAL;          /* See Note #3.                                         */
+        p_msg->ConflateEn    =  DEF_NO;
+        p_msg->TTL_ms        =  0u;
+        p_msg->DeadlineTS_ms =  0u;
+        p_msg->MsgID         =  msg_id;
+        p_msg->ArgPtr        = (void *)p_rec;
+        p_msg->BufLen        =  len;
+        p_msg->XferLen       =  len;
+        p_msg->TxQ_Len       =  0u;
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+        p_msg->MemLen        =  0u;                             /* Stored msg is accounted in the store's buf.          */
+#endif
+        p_msg->Err           =  MQTTc_ERR_NONE;
+        p_msg->NextPtr       =  DEF_NULL;
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+        p_msg->LatPostTS     =  CPU_TS_Get32();                 /* Stored msg is posted when fed in the tx window.      */
+        p_msg->LatTxStartTS  =  p_msg->LatPostTS;
+        p_msg->LatTxEndTS    =  p_msg->LatPostTS;
+#endif
 
-        on_err_callback = p_conn->OnErrCallback;
-        p_arg           = p_conn->ArgPtr;
+        DEF_BIT_CLR(p_rec[0u], MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK);
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+        p_entry = DEF_NULL;
+        if (p_conn->WalPtr != DEF_NULL) {
+            p_entry = MQTTc_WalOutFind(p_conn->WalPtr, &p_slot->Pos);
+            if (p_entry != DEF_NULL) {                          /* See Note #4.                                         */
+                MQTTc_MsgID_Free(msg_id);
+                p_msg->MsgID = p_entry->MsgID;
+            } else {                                            /* See Note #5.                                         */
+                MQTTc_WalLog(p_conn->WalPtr,
+                             MQTTc_WAL_STATE_OUT_TX,
+                             msg_id,
+                            &p_slot->Pos);
+            }
+        }
+#endif
 
-        MQTTc_ConnCloseProc(p_conn,
-                           &close_err);
-        (void)close_err;
+        if (msg_id_ix != 0u) {
+            p_rec[msg_id_ix]      = (CPU_INT08U)(p_msg->MsgID >> 8u);
+            p_rec[msg_id_ix + 1u] = (CPU_INT08U)(p_msg->MsgID & 0xFFu);
+        }
 
-        if (on_err_callback != DEF_NULL) {
-            on_err_callback(p_conn,
-                            p_arg,
-                            err_mqttc);
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+        if (p_entry != DEF_NULL) {
+            switch (p_entry->State) {
+                case MQTTc_WAL_STATE_OUT_CMPL:                  /* See Note #4a.                                        */
+                     p_msg->State = MQTTc_MSG_STATE_CMPL;
+                     if (p_conn->StoreWinNbr == 1u) {
+                         (void)MQTTc_ConnStoreMsgCmpl(p_conn, p_msg);
+                     }
+                     continue;
+
+
+                case MQTTc_WAL_STATE_OUT_REL:                   /* See Note #4b.                                        */
+                     p_buf = MQTTc_FixedHdrBufCfg(p_slot->RelBuf,
+                                                  MQTTc_MSG_TYPE_PUBREL,
+                                                  DEF_NO,
+                                                  1u,
+                                                  DEF_NO,
+                                                  MQTT_MSG_ID_SIZE,
+                                                 &p_msg->Err);
+                     p_buf[0u] = (CPU_INT08U)(p_msg->MsgID >>    8u);
+                     p_buf[1u] = (CPU_INT08U)(p_msg->MsgID &  0xFFu);
+
+                     p_msg->Type    =  MQTTc_MSG_TYPE_PUBREL;
+                     p_msg->ArgPtr  = (void *)p_slot->RelBuf;
+                     p_msg->BufLen  =  sizeof(p_slot->RelBuf);
+                     p_msg->XferLen =  MQTT_MSG_BASE_LEN;
+                     MQTTc_TxLaneAdd(p_conn, p_msg, MQTTc_MSG_PRIO_CTRL);
+                     is_added = DEF_YES;
+                     continue;
+
+
+                case MQTTc_WAL_STATE_OUT_TX:                    /* See Note #4c.                                        */
+                default:
+                     DEF_BIT_SET(p_rec[0u], MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK);
+                     break;
+            }
         }
+#endif
+
+        MQTTc_TxLaneAdd(p_conn, p_msg, MQTTc_MSG_PRIO_NORMAL);
+        is_added = DEF_YES;
     }
 
-    return;
+    if (is_added == DEF_YES) {
+        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+    }
 }
 
 
 /*
 *********************************************************************************************************
-*                                          MQTTc_MsgProcess()
+*                                       MQTTc_ConnStoreMsgCmpl()
 *
-* Description : Process message pending and enqueuing for MQTTc task.
+* Description : Process the completion of a message, if it was tx'd from the store of given MQTTc
+*               Connection.
 *
-* Argument(s) : none.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
-* Return(s)   : none.
+*               p_msg           Pointer to MQTTc Message object that cmpl'd.
 *
-* Caller(s)   : MQTTc_Task().
+* Return(s)   : DEF_YES, if the message was tx'd from the store,
+*               DEF_NO,  otherwise.
 *
-* Note(s)     : none.
+* Caller(s)   : MQTTc_ConnStoreFeed(),
+*               MQTTc_MsgCallbackExec().
+*
+* Note(s)     : (1) Records are released in the order they were tx'd, once every record before them has
+*                   been acknowledged. A record acknowledged out of order stays in its slot until then.
+*
+*               (2) A message that failed stops the tx of the store until the connection is re-opened, so
+*                   that no record after it is released. Its record is tx'd again on the next connection.
+*                   See MQTTc_ConnSetParam() Note #6c.
+*
+*               (3) No application callback is called for stored messages.
+*
+*               (4) With a WAL, the msg ID of a stored message is kept until its record is released, so
+*                   that the message can be resumed with it. See MQTTc_ConnStoreFeed() Note #4.
+*
+*               (5) The records are released before their flows are removed from the WAL. A crash in
+*                   between only leaves flows whose record was released, which are discarded when the WAL
+*                   is restored.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_MsgProcess (void)
+static  CPU_BOOLEAN  MQTTc_ConnStoreMsgCmpl (MQTTc_CONN  *p_conn,
+                                             MQTTc_MSG   *p_msg)
 {
-    MQTTc_MSG  *p_msg;
+    MQTTc_STORE_SLOT  *p_slot;
+    MQTTc_STORE_SLOT  *p_head_slot;
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    CPU_INT08U         ix;
+#endif
+    CPU_INT16U         rel_nbr      = 0u;
 
 
-    p_msg = MQTTc_MsgCheck();
-    if (p_msg != DEF_NULL) {
-        if (p_msg->Type != MQTTc_MSG_TYPE_REQ_CLOSE) {
-            MQTTc_CONN      *p_conn = p_msg->ConnPtr;
-            MQTTc_MSG_TYPE   type   = p_msg->Type;
+    p_slot = MQTTc_ConnStoreSlotGet(p_conn, p_msg);
+    if (p_slot == DEF_NULL) {
+        return (DEF_NO);
+    }
 
+    if (MQTTc_CONN_WAL_IS_SET(p_conn) == DEF_NO) {              /* See Note #4.                                         */
+        MQTTc_MsgID_Free(p_msg->MsgID);
+    }
 
-            if (p_conn->TxMsgHeadPtr == DEF_NULL) {                 /* Enqueue msg to appropriate MQTTc conn.               */
-                p_conn->TxMsgHeadPtr = p_msg;
-            } else {
-                MQTTc_MSG  *p_iter_msg = p_conn->TxMsgHeadPtr;
+    if (p_msg->Err != MQTTc_ERR_NONE) {                         /* See Note #2.                                         */
+        p_conn->StoreTxEn = DEF_NO;
+        return (DEF_YES);
+    }
 
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    ix = p_conn->StoreWinHeadIx;
+#endif
+    while (p_conn->StoreWinNbr > 0u) {                          /* See Note #1.                                         */
+        p_head_slot = &p_conn->StoreSlotTbl[p_conn->StoreWinHeadIx];
+        if ((p_head_slot->Msg.State != MQTTc_MSG_STATE_CMPL) ||
+            (p_head_slot->Msg.Err   != MQTTc_ERR_NONE)) {
+            break;
+        }
 
-                while (p_iter_msg->NextPtr != DEF_NULL) {
-                    p_iter_msg = p_iter_msg->NextPtr;
-                }
-                p_iter_msg->NextPtr = p_msg;
-            }
+        p_conn->StoreWinHeadIx = (p_conn->StoreWinHeadIx + 1u) % MQTTc_CFG_STORE_WIN_SIZE;
+        p_conn->StoreWinNbr--;
+        rel_nbr++;
+    }
 
-            switch (type) {
-                case MQTTc_MSG_TYPE_CONNECT:
-                     if (MQTTc_Ptr->ConnHeadPtr == DEF_NULL) {       /* Enqueue conn in MQTTc conn list.                     */
-                         MQTTc_Ptr->ConnHeadPtr = p_conn;
-                     } else {
-                         MQTTc_CONN  *p_iter_conn = MQTTc_Ptr->ConnHeadPtr;
+    if (rel_nbr == 0u) {
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+        if (p_conn->WalPtr != DEF_NULL) {                       /* Msg is not tx'd again once resumed.                  */
+            MQTTc_WalLog(p_conn->WalPtr,
+                         MQTTc_WAL_STATE_OUT_CMPL,
+                         p_msg->MsgID,
+                        &p_slot->Pos);
+        }
+#endif
+        return (DEF_YES);                                       /* See Note #3.                                         */
+    }
 
+    MQTTc_StoreRecRelease(p_conn->StorePtr, rel_nbr);           /* See Note #5.                                         */
 
-                         while (p_iter_conn->NextPtr != DEF_NULL) {
-                             p_iter_conn = p_iter_conn->NextPtr;
-                         }
-                         p_iter_conn->NextPtr = p_conn;
-                     }
-                                                                    /* break intentionally omitted.                         */
-                case MQTTc_MSG_TYPE_PUBLISH:
-                case MQTTc_MSG_TYPE_PUBREL:
-                case MQTTc_MSG_TYPE_SUBSCRIBE:
-                case MQTTc_MSG_TYPE_UNSUBSCRIBE:
-                case MQTTc_MSG_TYPE_PINGREQ:
-                case MQTTc_MSG_TYPE_DISCONNECT:
-                     MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
-                     break;
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    if (p_conn->WalPtr != DEF_NULL) {
+        while (rel_nbr > 0u) {
+            p_head_slot = &p_conn->StoreSlotTbl[ix];
+            MQTTc_WalLog(p_conn->WalPtr,
+                         MQTTc_WAL_STATE_OUT_FREE,
+                         p_head_slot->Msg.MsgID,
+                        &p_head_slot->Pos);
+            MQTTc_MsgID_Free(p_head_slot->Msg.MsgID);
 
+            ix = (ix + 1u) % MQTTc_CFG_STORE_WIN_SIZE;
+            rel_nbr--;
+        }
+    }
+#endif
 
-                case MQTTc_MSG_TYPE_PUBACK:
-                case MQTTc_MSG_TYPE_PUBREC:
-                case MQTTc_MSG_TYPE_PUBCOMP:
-                case MQTTc_MSG_TYPE_CONNACK:
-                case MQTTc_MSG_TYPE_SUBACK:
-                case MQTTc_MSG_TYPE_UNSUBACK:
-                case MQTTc_MSG_TYPE_PINGRESP:
-                default:
-                     MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In default case for event type:%i\n\r", type));
-                     break;
-            }
-        } else {                                                /* Handle special close req msg.                        */
-            KAL_ERR  err_kal;
+    return (DEF_YES);                                           /* See Note #3.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_ConnStorePubRecRx()
+*
+* Description : Process the PUBREC rx'd for a message, if it was tx'd from the store of given MQTTc
+*               Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+*               p_msg           Pointer to MQTTc Message object for which a PUBREC was rx'd.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_RdSockProcess().
+*
+* Note(s)     : (1) The PUBREL is encoded in the slot of the message, so that its record is left untouched.
+*                   See mqtt-c.h MQTTc STORE SLOT Note #2.
+*
+*               (2) The PUBREC is logged before the PUBREL is tx'd, so that the PUBLISH is never tx'd again
+*                   once the MQTT server may have released it. See MQTTc_Task() Note #5.
+*********************************************************************************************************
+*/
 
+static  void  MQTTc_ConnStorePubRecRx (MQTTc_CONN  *p_conn,
+                                       MQTTc_MSG   *p_msg)
+{
+    MQTTc_STORE_SLOT  *p_slot;
 
-            MQTTc_ConnCloseProc(p_msg->ConnPtr,
-                               &p_msg->Err);
 
-            KAL_SemPost((*(KAL_SEM_HANDLE *)p_msg->ArgPtr),
-                        KAL_OPT_POST_NONE,
-                       &err_kal);
-            (void)&err_kal;
-        }
+    p_slot = MQTTc_ConnStoreSlotGet(p_conn, p_msg);
+    if (p_slot == DEF_NULL) {
+        return;
+    }
+
+    p_msg->ArgPtr = (void *)p_slot->RelBuf;                     /* See Note #1.                                         */
+    p_msg->BufLen =  sizeof(p_slot->RelBuf);
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    if (p_conn->WalPtr != DEF_NULL) {                           /* See Note #2.                                         */
+        MQTTc_WalLog(p_conn->WalPtr,
+                     MQTTc_WAL_STATE_OUT_REL,
+                     p_msg->MsgID,
+                    &p_slot->Pos);
     }
+#endif
 }
 
 
 /*
 *********************************************************************************************************
-*                                        MQTTc_MsgCallbackExec()
+*                                       MQTTc_ConnStoreSlotGet()
 *
-* Description : Frees msg if provided by user and execute application callback(s).
+* Description : Get the slot of the tx window of given MQTTc Connection that holds a message.
 *
-* Argument(s) : p_msg           Pointer to message for which the callback must be called.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
-* Return(s)   : none.
+*               p_msg           Pointer to MQTTc Message object.
 *
-* Caller(s)   : MQTTc_RdSockProcess(),
-*               MQTTc_WrSockProcess().
+* Return(s)   : Pointer to the slot, if the message was tx'd from the store,
+*               DEF_NULL,            otherwise.
 *
-* Note(s)     : none.
+* Caller(s)   : MQTTc_ConnStoreMsgCmpl(),
+*               MQTTc_ConnStorePubRecRx().
+*
+* Note(s)     : (1) The msg is the first field of its slot. See mqtt-c.h MQTTc STORE SLOT Note #1.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_MsgCallbackExec (MQTTc_MSG  *p_msg)
+static  MQTTc_STORE_SLOT  *MQTTc_ConnStoreSlotGet (MQTTc_CONN  *p_conn,
+                                                   MQTTc_MSG   *p_msg)
 {
-    MQTTc_CMPL_CALLBACK   callback_fnct = DEF_NULL;
-    MQTTc_CONN           *p_conn        = p_msg->ConnPtr;
-    MQTTc_ERR             err           = MQTTc_ERR_NONE;
+    MQTTc_STORE_SLOT  *p_slot = (MQTTc_STORE_SLOT *)p_msg;      /* See Note #1.                                         */
 
 
-    if (p_msg != p_conn->PublishRxMsgPtr) {
-        switch (p_msg->Type) {                                  /* Find type of msg and if ok to call callback for it.  */
-            case MQTTc_MSG_TYPE_CONNECT:
-                 err = MQTTc_ERR_FAIL;
-                                                                /* break intentionally omitted.                         */
-            case MQTTc_MSG_TYPE_CONNACK:
-                 p_msg->Type   = MQTTc_MSG_TYPE_CONNECT;
-                 callback_fnct = p_conn->OnConnectCmpl;
-                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
-                     err = MQTTc_ERR_FAIL;
-                 }
-                 break;
-
+    if ((p_slot <  &p_conn->StoreSlotTbl[0u]) ||
+        (p_slot >= &p_conn->StoreSlotTbl[MQTTc_CFG_STORE_WIN_SIZE])) {
+        return (DEF_NULL);
+    }
 
-            case MQTTc_MSG_TYPE_PUBLISH:
-                 callback_fnct = p_conn->OnPublishCmpl;
-                 if ((p_msg->QoS   != 0u) ||
-                     (p_msg->State != MQTTc_MSG_STATE_WAIT_TX_CMPL)) {
-                     err = MQTTc_ERR_FAIL;
-                 }
-                 break;
+    return (p_slot);
+}
 
 
-            case MQTTc_MSG_TYPE_PUBACK:
-            case MQTTc_MSG_TYPE_PUBCOMP:
-                 p_msg->Type   = MQTTc_MSG_TYPE_PUBLISH;
-                 callback_fnct = p_conn->OnPublishCmpl;
-                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
-                     err = MQTTc_ERR_FAIL;
-                 }
-                 break;
+/*
+*********************************************************************************************************
+*                                        MQTTc_ConnStoreReset()
+*
+* Description : Empty the tx window of given MQTTc Connection and restart the tx of its store from the
+*               oldest record that has not been released.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnOpen(),
+*               MQTTc_ConnCloseProc().
+*
+* Note(s)     : (1) MUST only be called once every message of the tx window has cmpl'd, or before the
+*                   connection is opened.
+*********************************************************************************************************
+*/
 
+static  void  MQTTc_ConnStoreReset (MQTTc_CONN  *p_conn)
+{
+    p_conn->StoreTxEn      = DEF_NO;
+    p_conn->StoreWinHeadIx = 0u;
+    p_conn->StoreWinNbr    = 0u;
 
-            case MQTTc_MSG_TYPE_PUBREC:
-            case MQTTc_MSG_TYPE_PUBREL:
-                 p_msg->Type   = MQTTc_MSG_TYPE_PUBLISH;
-                 callback_fnct = p_conn->OnPublishCmpl;
-                 err = MQTTc_ERR_FAIL;
-                 break;
+    if (p_conn->StorePtr != DEF_NULL) {
+        MQTTc_StoreTxRewind(p_conn->StorePtr);
+    }
+}
 
 
-            case MQTTc_MSG_TYPE_SUBSCRIBE:
-                 err = MQTTc_ERR_FAIL;
-                                                                /* break intentionally omitted.                         */
-            case MQTTc_MSG_TYPE_SUBACK:
-                 p_msg->Type   = MQTTc_MSG_TYPE_SUBSCRIBE;
-                 callback_fnct = p_conn->OnSubscribeCmpl;
-                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
-                     err = MQTTc_ERR_FAIL;
-                 }
-                 break;
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                        MQTTc_ConnWalRestore()
+*
+* Description : Restore the flows held in the WAL of given MQTTc Connection.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnSetParam().
+*
+* Note(s)     : (1) An inbound QoS 2 flow is put back in the QoS 2 rx tbl, unless the session is clean.
+*
+*               (2) The msg ID of an outbound flow is reserved until its record is released. A flow whose
+*                   record was released, or whose msg ID is already in use, is discarded. In the latter case,
+*                   its record is tx'd again as a new message.
+*********************************************************************************************************
+*/
 
+static  void  MQTTc_ConnWalRestore (MQTTc_CONN  *p_conn)
+{
+    MQTTc_WAL_ENTRY  *p_entry;
+    CPU_BOOLEAN       is_live;
+    CPU_INT08U        ix;
 
-            case MQTTc_MSG_TYPE_UNSUBSCRIBE:
-                 err = MQTTc_ERR_FAIL;
-                                                                /* break intentionally omitted.                         */
-            case MQTTc_MSG_TYPE_UNSUBACK:
-                 p_msg->Type   = MQTTc_MSG_TYPE_UNSUBSCRIBE;
-                 callback_fnct = p_conn->OnUnsubscribeCmpl;
-                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
-                     err = MQTTc_ERR_FAIL;
-                 }
-                 break;
 
+    for (ix = 0u; ix < MQTTc_WAL_TBL_SIZE; ix++) {
+        p_entry = &p_conn->WalPtr->Tbl[ix];
 
-            case MQTTc_MSG_TYPE_PINGREQ:
-                 err = MQTTc_ERR_FAIL;
-            case MQTTc_MSG_TYPE_PINGRESP:
-                 p_msg->Type   = MQTTc_MSG_TYPE_PINGREQ;
-                 callback_fnct = p_conn->OnPingReqCmpl;
-                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_RX) {
-                     err = MQTTc_ERR_FAIL;
+        switch (p_entry->State) {
+            case MQTTc_WAL_STATE_IN_REC:                        /* See Note #1.                                         */
+                 if (MQTTc_QoS2_RxTblFind(p_conn, p_entry->MsgID) != MQTTc_QOS2_RX_TBL_IX_NONE) {
+                     break;
+                 }
+                 if ((p_conn->CleanSession                             == DEF_YES) ||
+                     (MQTTc_QoS2_RxTblAdd(p_conn, p_entry->MsgID) == MQTTc_QOS2_RX_TBL_IX_NONE)) {
+                     MQTTc_WalLog(p_conn->WalPtr,
+                                  MQTTc_WAL_STATE_IN_FREE,
+                                  p_entry->MsgID,
+                                  DEF_NULL);
                  }
                  break;
 
 
-            case MQTTc_MSG_TYPE_DISCONNECT:
-                 p_msg->Type   = MQTTc_MSG_TYPE_DISCONNECT;
-                 callback_fnct = p_conn->OnDisconnectCmpl;
-                 if (p_msg->State != MQTTc_MSG_STATE_WAIT_TX_CMPL) {
-                     err = MQTTc_ERR_FAIL;
+            case MQTTc_WAL_STATE_OUT_TX:                        /* See Note #2.                                         */
+            case MQTTc_WAL_STATE_OUT_REL:
+            case MQTTc_WAL_STATE_OUT_CMPL:
+                 is_live = DEF_NO;
+                 if (p_conn->StorePtr != DEF_NULL) {
+                     is_live = MQTTc_StorePosIsLive(p_conn->StorePtr, &p_entry->Pos);
+                 }
+                 if ((is_live                              == DEF_NO) ||
+                     (MQTTc_MsgID_Reserve(p_entry->MsgID) == DEF_NO)) {
+                     MQTTc_WalLog(p_conn->WalPtr,
+                                  MQTTc_WAL_STATE_OUT_FREE,
+                                  p_entry->MsgID,
+                                 &p_entry->Pos);
                  }
                  break;
 
 
             default:
-                 MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In default case for p_event->Type when executing callback:%i\n\r", p_msg->Type));
-                 return;
-        }
-
-        if (err != MQTTc_ERR_NONE) {
-            MQTTc_DBG_TRACE_DBG(("!!! ERROR !!! Detected error when executing callback: %i\n\r", err));
-        }
-
-        if (p_msg->Err == MQTTc_ERR_NONE) {
-            p_msg->Err = err;
-        } else  {
-            MQTTc_DBG_TRACE_DBG(("MQTTc - Callback executed for Msg with error: %i\n\r", p_msg->Err));
-        }
-
-        p_msg->State = MQTTc_MSG_STATE_CMPL;
-
-        MQTTc_MsgID_Free(p_msg->MsgID);                         /* Free msg ID, if any.                                 */
-
-                                                                /* Remove msg from conn's msg list.                     */
-                                                                /* Msg is necessarily located at head of list.          */
-        p_msg->ConnPtr->TxMsgHeadPtr = p_msg->NextPtr;
-        p_msg->NextPtr               = DEF_NULL;
-
-        if (p_conn->OnCmpl != DEF_NULL) {                       /* Call generic callback, if not NULL.                  */
-            p_conn->OnCmpl(p_conn,
-                           p_msg,
-                           p_conn->ArgPtr,
-                           p_msg->Err);
-        }
-
-        if (callback_fnct != DEF_NULL) {                        /* Call action-specific callback, if not NULL.          */
-            callback_fnct(p_conn,
-                          p_msg,
-                          p_conn->ArgPtr,
-                          p_msg->Err);
-        }
-    } else if (p_conn->OnPublishRx != DEF_NULL) {               /* Call OnPublishRx callback, if not NULL.              */
-        CPU_INT08U  *p_buf_start   = &(((CPU_INT08U *)p_msg->ArgPtr)[MQTTc_PUBLISH_RX_MSG_BUF_OFFSET]);
-        CPU_INT08U  *p_buf_topic   = &p_buf_start[MQTT_MSG_UTF8_LEN_SIZE];
-        CPU_INT08U  *p_buf_payload;
-        CPU_INT32U   topic_len;
-        CPU_INT32U   payload_len;
-        CPU_INT32U   len;
-
-
-        MQTTc_DBG_GLOBAL_BUF_COPY(p_buf_start, 512u);
-
-        topic_len = MQTT_MSG_UTF8_LEN_RD(p_buf_start);
-        len       = topic_len + MQTT_MSG_UTF8_LEN_SIZE;         /* Account for length.                                  */
-
-        if (p_msg->QoS != 0u) {                                 /* Account for msg ID size if needed.                   */
-            len += MQTT_MSG_ID_SIZE;
+                 break;
         }
-
-        payload_len   =  p_msg->ConnPtr->NextMsgRxLen - len;
-        p_buf_payload = &p_buf_start[len];
-
-        p_conn->OnPublishRx(                  p_conn,
-                            (const CPU_CHAR *)p_buf_topic,
-                                              topic_len,
-                            (const CPU_CHAR *)p_buf_payload,
-                                              payload_len,
-                                              p_conn->ArgPtr,
-                                              p_msg->Err);
     }
-
-    return;
 }
+#endif
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                           MQTTc_MsgCheck()
+*                                     MQTTc_PublishRxBatchBufGet()
 *
-* Description : See if a message is available in the message queue.
+* Description : Set the part of the rx msg's buf in which the next PUBLISH is rx'd.
 *
-* Argument(s) : none.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object rx'ing a PUBLISH.
 *
-* Return(s)   : Pointer to obtained message, if any,
-*               DEF_NULL,                    otherwise.
+* Return(s)   : none.
 *
-* Caller(s)   : MQTTc_MsgProcess().
+* Caller(s)   : MQTTc_RdSockProcess().
 *
-* Note(s)     : none.
+* Note(s)     : (1) The buf of the rx msg is kept when the first PUBLISH of the connection is rx'd. The rx
+*                   msg is then pointed past the PUBLISH msgs of the batch, so that the rx path is the same
+*                   as without batching. Its buf is restored when the connection is closed. See
+*                   MQTTc_PublishRxBatchRelease().
+*
+*               (2) When the PUBLISH does not fit after the PUBLISH msgs of the batch, the batch is
+*                   delivered first, so that the PUBLISH is rx'd at the start of the buf.
 *********************************************************************************************************
 */
 
-static  MQTTc_MSG  *MQTTc_MsgCheck (void)
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+static  void  MQTTc_PublishRxBatchBufGet (MQTTc_CONN  *p_conn)
 {
-    MQTTc_MSG  *p_msg = DEF_NULL;
-    CPU_SR_ALLOC();
+    MQTTc_MSG  *p_msg = p_conn->PublishRxMsgPtr;
 
 
-    CPU_CRITICAL_ENTER();
-    if (MQTTc_Ptr->MsgListHeadPtr != DEF_NULL) {
-        p_msg                     = MQTTc_Ptr->MsgListHeadPtr;
-        MQTTc_Ptr->MsgListHeadPtr = p_msg->NextPtr;
-        p_msg->NextPtr            = DEF_NULL;
+    if (p_conn->OnPublishRxBatch == DEF_NULL) {
+        return;
     }
-    CPU_CRITICAL_EXIT();
 
-    return (p_msg);
+    if (p_conn->PublishRxBatchBufPtr == DEF_NULL) {             /* See Note #1.                                         */
+        p_conn->PublishRxBatchBufPtr = (CPU_INT08U *)p_msg->ArgPtr;
+        p_conn->PublishRxBatchBufLen =  p_msg->BufLen;
+        p_conn->PublishRxBatchLen    =  0u;
+    }
+                                                                /* Keep room to null-terminate payload. See Note #2.    */
+    if (p_conn->NextMsgLen >= (p_conn->PublishRxBatchBufLen - p_conn->PublishRxBatchLen)) {
+        MQTTc_PublishRxBatchFlush(p_conn);
+    }
+
+    p_msg->ArgPtr = (void *)&p_conn->PublishRxBatchBufPtr[p_conn->PublishRxBatchLen];
+    p_msg->BufLen =          p_conn->PublishRxBatchBufLen - p_conn->PublishRxBatchLen;
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                            MQTTc_MsgPost()
-*
-* Description : Add a message in the MQTT message queue for the task to process.
+*                                       MQTTc_PublishRxBatchAdd()
 *
-* Argument(s) : p_conn          Pointer to MQTT Connection object associated with message.
+* Description : Add a PUBLISH rx'd to the batch of a connection.
 *
-*               p_msg           Pointer to MQTT Message object to add to queue.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
-*               type            Type of MQTT message.
+*               p_topic         Pointer to topic of PUBLISH, in the rx msg's buf.
 *
-*               xfer_len        Required len to xfer.
+*               topic_len       Len of topic, in bytes.
 *
-*               qos_lvl         QoS level of the message, if any.
+*               p_payload       Pointer to payload of PUBLISH, in the rx msg's buf.
 *
-*               msg_id          Message ID of the message, if any.
+*               payload_len     Len of payload, in bytes.
 *
-*               p_err           Pointer to variable that will receive the return error code from this function :
-*                                   MQTTc_ERR_NONE              Operation successful.
-*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*               err             Err associated to rx of PUBLISH.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : Various MQTTc functions.
+* Caller(s)   : MQTTc_MsgCallbackExec().
 *
-* Note(s)     : none.
+* Note(s)     : (1) The null char that ends the payload is kept in the batch.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_MsgPost (MQTTc_CONN      *p_conn,
-                             MQTTc_MSG       *p_msg,
-                             MQTTc_MSG_TYPE   type,
-                             CPU_INT32U       xfer_len,
-                             CPU_INT08U       qos_lvl,
-                             CPU_INT16U       msg_id,
-                             MQTTc_ERR       *p_err)
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+static  void  MQTTc_PublishRxBatchAdd (MQTTc_CONN  *p_conn,
+                                       CPU_INT08U  *p_topic,
+                                       CPU_INT32U   topic_len,
+                                       CPU_INT08U  *p_payload,
+                                       CPU_INT32U   payload_len,
+                                       MQTTc_ERR    err)
 {
-    CPU_SR_ALLOC();
+    MQTTc_PUBLISH_RX_VIEW  *p_view;
 
 
-    p_msg->ConnPtr = p_conn;                                    /* Set values in msg fields.                            */
-    p_msg->Type    = type;
-    p_msg->State   = MQTTc_MSG_STATE_MUST_TX;
-    p_msg->MsgID   = msg_id;
-    p_msg->XferLen = xfer_len;
-    p_msg->QoS     = qos_lvl;
-    p_msg->Err     = MQTTc_ERR_NONE;
-    p_msg->NextPtr = DEF_NULL;
+    p_view             = &p_conn->PublishRxBatchTbl[p_conn->PublishRxBatchNbr];
+    p_view->TopicPtr   = (const CPU_CHAR *)p_topic;
+    p_view->TopicLen   =  topic_len;
+    p_view->PayloadPtr = (const CPU_CHAR *)p_payload;
+    p_view->PayloadLen =  payload_len;
+    p_view->Err        =  err;
 
-    CPU_CRITICAL_ENTER();
-    if (p_conn->SockId != NET_SOCK_ID_NONE) {
+    p_conn->PublishRxBatchNbr++;
+                                                                /* See Note #1.                                         */
+    p_conn->PublishRxBatchLen = (CPU_INT32U)(&p_payload[payload_len + 1u] - p_conn->PublishRxBatchBufPtr);
 
-        if (MQTTc_Ptr->MsgListHeadPtr != DEF_NULL) {
-            MQTTc_Ptr->MsgListTailPtr->NextPtr = p_msg;
-        } else {
-            MQTTc_Ptr->MsgListHeadPtr = p_msg;
-        }
-        MQTTc_Ptr->MsgListTailPtr = p_msg;
+    if (p_conn->PublishRxBatchNbr >= MQTTc_CFG_PUBLISH_RX_BATCH_SIZE) {
+        MQTTc_PublishRxBatchFlush(p_conn);
+    }
+}
+#endif
 
-        CPU_CRITICAL_EXIT();
 
-        MQTTc_SockSelDescSet(p_conn, MQTTc_SEL_DESC_TYPE_WR);
+/*
+*********************************************************************************************************
+*                                      MQTTc_PublishRxBatchFlush()
+*
+* Description : Deliver the batch of PUBLISH msgs rx'd on a connection, if any.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : (1) A PUBLISH being rx'd is not part of the batch. It keeps its place in the buf, and is
+*                   added to the next batch once rx'd.
+*********************************************************************************************************
+*/
 
-       *p_err = MQTTc_ERR_NONE;
-    } else {
-        CPU_CRITICAL_EXIT();
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+static  void  MQTTc_PublishRxBatchFlush (MQTTc_CONN  *p_conn)
+{
+    CPU_INT32U  view_nbr;
 
-       *p_err = MQTTc_ERR_CONN_IS_CLOSED;
+
+    view_nbr = p_conn->PublishRxBatchNbr;
+    if (view_nbr == 0u) {
+        return;
     }
-    return;
+
+    p_conn->PublishRxBatchNbr = 0u;                             /* See Note #1.                                         */
+    p_conn->PublishRxBatchLen = 0u;
+
+    MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_CALLBACK, p_conn->SockId);
+    MQTTc_PROF_CALLBACK_START();
+    p_conn->OnPublishRxBatch(p_conn,
+                            &p_conn->PublishRxBatchTbl[0u],
+                             view_nbr,
+                             p_conn->ArgPtr);
+    MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_PUBLISH_RX_BATCH);
+    MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_CALLBACK);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                   MQTTc_MsgListClosedCallbackExec()
+*                                     MQTTc_PublishRxBatchRelease()
 *
-* Description : Execute callback with error MQTTc_ERR_CONN_IS_CLOSED on every message in linked list.
+* Description : Restore the buf of the rx msg of a connection.
 *
-* Argument(s) : p_head_msg      Pointer to head of list of messages to execute callback on.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
 * Return(s)   : none.
 *
-* Caller(s)   : MQTTc_ConnCloseProc(),
-*               MQTTc_WrSockProcess().
+* Caller(s)   : MQTTc_ConnCloseProc().
 *
-* Note(s)     : none.
+* Note(s)     : (1) The batch MUST have been delivered.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_MsgListClosedCallbackExec (MQTTc_MSG  *p_head_msg)
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+static  void  MQTTc_PublishRxBatchRelease (MQTTc_CONN  *p_conn)
 {
-    MQTTc_MSG  *p_iter_msg;
-    MQTTc_MSG  *p_next_iter_msg;
-
-
-    p_iter_msg = p_head_msg;                                    /* Exec callback for every msg in list passed.          */
-    while (p_iter_msg != DEF_NULL) {
+    if (p_conn->PublishRxBatchBufPtr == DEF_NULL) {
+        return;
+    }
 
-        p_next_iter_msg = p_iter_msg->NextPtr;
-        p_iter_msg->Err = MQTTc_ERR_CONN_IS_CLOSED;             /* Indicate conn is closed.                             */
-        MQTTc_MsgCallbackExec(p_iter_msg);
+    p_conn->PublishRxMsgPtr->ArgPtr = (void *)p_conn->PublishRxBatchBufPtr;
+    p_conn->PublishRxMsgPtr->BufLen =         p_conn->PublishRxBatchBufLen;
 
-        p_iter_msg = p_next_iter_msg;
-    }
+    p_conn->PublishRxBatchBufPtr    = DEF_NULL;
+    p_conn->PublishRxBatchBufLen    = 0u;
+    p_conn->PublishRxBatchLen       = 0u;
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                        MQTTc_FixedHdrBufCfg()
+*                                        MQTTc_ConnStatsSnap()
 *
-* Description : Fill buffer with correct fields of fixed header.
+* Description : Copy the statistics counters of a connection to its snapshot.
 *
-* Argument(s) : p_buf           Pointer to beginning of the buffer to fill.
+* Argument(s) : p_conn          Pointer to MQTTc_CONN.
 *
-*               msg_type        Type of message.
+* Return(s)   : none.
 *
-*               dup_flag        DUP flag.
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_ConnCloseProc().
 *
-*               qos_lvl         QoS level of the message.
+* Note(s)     : (1) The tx q len is updated by the application tasks, within a critical section. It is
+*                   read within the same critical section as the copy, to be consistent with it.
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+static  void  MQTTc_ConnStatsSnap (MQTTc_CONN  *p_conn)
+{
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_conn->Stats.TxQ_MsgNbr = p_conn->TxQ_MsgNbr;              /* See Note #1.                                         */
+    p_conn->Stats.TxQ_Len    = p_conn->TxQ_Len;
+    Mem_Copy(&p_conn->StatsSnap, &p_conn->Stats, sizeof(MQTTc_CONN_STATS));
+    CPU_CRITICAL_EXIT();
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_CmplBatchAdd()
 *
-*               retain_flag     Retain flag.
+* Description : Add a cmpl'd msg to the batch of a connection.
 *
-*               rem_len         Remaining length of the message.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
-*               p_err           Pointer to variable that will receive the return error code.
-*               -----           Argument validated by caller.
-*                                   MQTTc_ERR_NONE              Operation successful.
-*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
-*                                   MQTTc_ERR_INVALID_ARG       Invalid arg passed to function.
+*               p_msg           Pointer to MQTTc Message object that cmpl'd.
 *
-* Return(s)   : Pointer to next location in buffer, if NO error(s),
-*               DEF_NULL,                           otherwise.
+* Return(s)   : none.
 *
-* Caller(s)   : Various MQTTc functions.
+* Caller(s)   : MQTTc_MsgCallbackExec().
 *
-* Note(s)     : none.
+* Note(s)     : (1) A full batch is delivered before the msg is added, so that the msgs are delivered in
+*                   the order they cmpl'd.
 *********************************************************************************************************
 */
 
-static  CPU_INT08U  *MQTTc_FixedHdrBufCfg (CPU_INT08U      *p_buf,
-                                           MQTTc_MSG_TYPE   msg_type,
-                                           CPU_BOOLEAN      dup_flag,
-                                           CPU_INT08U       qos_lvl,
-                                           CPU_BOOLEAN      retain_flag,
-                                           CPU_INT32U       rem_len,
-                                           MQTTc_ERR       *p_err)
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+static  void  MQTTc_CmplBatchAdd (MQTTc_CONN  *p_conn,
+                                  MQTTc_MSG   *p_msg)
 {
-    CPU_INT08U  *p_cur_buf;
-    CPU_INT08U   encoded_byte;
-    CPU_INT32U   len;
-
-
-    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
-        if (p_buf == DEF_NULL) {
-           *p_err = MQTTc_ERR_NULL_PTR;
-            return (0u);
-        }
-
-        if (rem_len > MQTT_MSG_FIXED_HDR_REM_LEN_MAX) {         /* Make sure len can be encoded.                        */
-           *p_err = MQTTc_ERR_INVALID_ARG;
-            return (0u);
-        }
-    #endif
-
-    p_cur_buf = p_buf;
-    len       = rem_len;
-
-    switch (msg_type) {                                         /* Convert msg type.                                    */
-        case MQTTc_MSG_TYPE_CONNECT:
-            *p_cur_buf = MQTT_MSG_TYPE_CONNECT;
-             break;
-
-        case MQTTc_MSG_TYPE_CONNACK:
-            *p_cur_buf = MQTT_MSG_TYPE_CONNACK;
-             break;
-
-        case MQTTc_MSG_TYPE_PUBLISH:
-            *p_cur_buf = MQTT_MSG_TYPE_PUBLISH;
-             break;
-
-        case MQTTc_MSG_TYPE_PUBACK:
-            *p_cur_buf = MQTT_MSG_TYPE_PUBACK;
-             break;
-
-        case MQTTc_MSG_TYPE_PUBREC:
-            *p_cur_buf = MQTT_MSG_TYPE_PUBREC;
-             break;
-
-        case MQTTc_MSG_TYPE_PUBREL:
-            *p_cur_buf = MQTT_MSG_TYPE_PUBREL;
-             break;
-
-        case MQTTc_MSG_TYPE_PUBCOMP:
-            *p_cur_buf = MQTT_MSG_TYPE_PUBCOMP;
-             break;
-
-        case MQTTc_MSG_TYPE_SUBSCRIBE:
-            *p_cur_buf = MQTT_MSG_TYPE_SUBSCRIBE;
-             break;
-
-        case MQTTc_MSG_TYPE_SUBACK:
-            *p_cur_buf = MQTT_MSG_TYPE_SUBACK;
-             break;
-
-        case MQTTc_MSG_TYPE_UNSUBSCRIBE:
-            *p_cur_buf = MQTT_MSG_TYPE_UNSUBSCRIBE;
-             break;
-
-        case MQTTc_MSG_TYPE_UNSUBACK:
-            *p_cur_buf = MQTT_MSG_TYPE_UNSUBACK;
-             break;
-
-        case MQTTc_MSG_TYPE_PINGREQ:
-            *p_cur_buf = MQTT_MSG_TYPE_PINGREQ;
-             break;
-
-        case MQTTc_MSG_TYPE_PINGRESP:
-            *p_cur_buf = MQTT_MSG_TYPE_PINGRESP;
-             break;
-
-        case MQTTc_MSG_TYPE_DISCONNECT:
-            *p_cur_buf = MQTT_MSG_TYPE_DISCONNECT;
-             break;
-
-        default:
-             break;
-    }
-
-
-    switch (msg_type) {
-        case MQTTc_MSG_TYPE_PUBLISH:                            /* Set every val.                                       */
-             if (retain_flag == DEF_YES) {
-                 DEF_BIT_SET(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_RETAIN_MSK);
-             } else {
-                 DEF_BIT_CLR(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_RETAIN_MSK);
-             }
-                                                                /* break intentionnally omitted.                        */
-        case MQTTc_MSG_TYPE_PUBREL:                             /* Set everything except 'retain'.                      */
-        case MQTTc_MSG_TYPE_SUBSCRIBE:
-        case MQTTc_MSG_TYPE_UNSUBSCRIBE:
-             if (dup_flag == DEF_YES) {
-                 DEF_BIT_SET(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK);
-             } else {
-                 DEF_BIT_CLR(*p_cur_buf, MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK);
-             }
-             DEF_BIT_SET(*p_cur_buf, (qos_lvl << MQTT_MSG_FIXED_HDR_FLAGS_QOS_LVL_BIT_SHIFT));
-                                                                /* break intentionnally omitted.                        */
-        case MQTTc_MSG_TYPE_CONNECT:                            /* Set only the msg_type.                               */
-        case MQTTc_MSG_TYPE_PUBACK:
-        case MQTTc_MSG_TYPE_PUBREC:
-        case MQTTc_MSG_TYPE_PUBCOMP:
-        case MQTTc_MSG_TYPE_PINGREQ:
-        case MQTTc_MSG_TYPE_DISCONNECT:
-             break;
+    MQTTc_CMPL_ENTRY  *p_entry;
 
 
-        case MQTTc_MSG_TYPE_CONNACK:                            /* Err cases.                                           */
-        case MQTTc_MSG_TYPE_SUBACK:
-        case MQTTc_MSG_TYPE_UNSUBACK:
-        case MQTTc_MSG_TYPE_PINGRESP:
-        default:
-             MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! In default case for msg_type:%i\n\r", msg_type));
-             break;
+    if (p_conn->CmplBatchNbr >= MQTTc_CFG_CMPL_BATCH_SIZE) {    /* See Note #1.                                         */
+        MQTTc_CmplBatchFlush(p_conn);
     }
 
-    do {
-        encoded_byte = (len) % (MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN);
-
-        len = len / MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN;
-
-        if (len > 0) {
-            encoded_byte = encoded_byte | MQTT_MSG_FIXED_HDR_REM_LEN_MAX_LEN;
-        }
-        p_cur_buf++;
-       *p_cur_buf = encoded_byte;
-    } while (len > 0);
-
-    p_cur_buf++;
-
-   *p_err = MQTTc_ERR_NONE;
+    p_entry         = &p_conn->CmplBatchTbl[p_conn->CmplBatchNbr];
+    p_entry->MsgPtr =  p_msg;
+    p_entry->Type   =  p_msg->Type;
+    p_entry->Err    =  p_msg->Err;
 
-    return (p_cur_buf);
+    p_conn->CmplBatchNbr++;
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                           MQTTc_MsgID_Get()
+*                                        MQTTc_CmplBatchFlush()
 *
-* Description : Obtain a msg ID to use for a message requiring one.
+* Description : Deliver the batch of cmpl'd msgs of a connection, if any.
 *
-* Argument(s) : none.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
-* Return(s)   : Message ID,          if NO error(s),
-*               MQTT_MSG_ID_INVALID, otherwise.
+* Return(s)   : none.
 *
-* Caller(s)   : MQTTc_Publish(),
-*               MQTTc_SubscribeMult(),
-*               MQTTc_UnsubscribeMult().
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_CmplBatchAdd(),
+*               MQTTc_ConnCloseProc().
 *
-* Note(s)     : (1) Once the message has been completed, MQTTc_MsgID_Free() must be called to release the
-*                   msg ID so that other messages can use it.
+* Note(s)     : none.
 *********************************************************************************************************
 */
 
-static  CPU_INT16U   MQTTc_MsgID_Get (void)
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+static  void  MQTTc_CmplBatchFlush (MQTTc_CONN  *p_conn)
 {
-    CPU_INT16U  msg_id    = MQTT_MSG_ID_INVALID;
-    CPU_INT08U  bitmap_ix;
-    CPU_SR_ALLOC();
-
+    CPU_INT32U  entry_nbr;
 
-    CPU_CRITICAL_ENTER();
-    for (bitmap_ix = 0u; bitmap_ix < MQTTc_Ptr->MsgID_BitmapTblMax; bitmap_ix++) {
-        if (DEF_BIT_IS_CLR_ANY(MQTTc_Ptr->MsgID_BitmapTbl[bitmap_ix], DEF_INT_32_MASK) == DEF_YES) {
-
-            msg_id = DEF_INT_32_NBR_BITS - 1u - CPU_CntLeadZeros(~MQTTc_Ptr->MsgID_BitmapTbl[bitmap_ix]);
 
-            DEF_BIT_SET(MQTTc_Ptr->MsgID_BitmapTbl[bitmap_ix], DEF_BIT(msg_id));
-            msg_id += (DEF_INT_32_NBR_BITS * bitmap_ix) + 1u;
-            break;
-        }
+    entry_nbr = p_conn->CmplBatchNbr;
+    if (entry_nbr == 0u) {
+        return;
     }
-    CPU_CRITICAL_EXIT();
 
-    return (msg_id);
+    p_conn->CmplBatchNbr = 0u;
+
+    MQTTc_TIMELINE_TASK_PHASE_START(MQTTc_TIMELINE_TASK_PHASE_CALLBACK, p_conn->SockId);
+    MQTTc_PROF_CALLBACK_START();
+    p_conn->OnCmplBatch(p_conn,
+                       &p_conn->CmplBatchTbl[0u],
+                        entry_nbr,
+                        p_conn->ArgPtr);
+    MQTTc_PROF_CALLBACK_END(p_conn, MQTTc_PROF_CALLBACK_ON_CMPL_BATCH);
+    MQTTc_TIMELINE_TASK_PHASE_END(MQTTc_TIMELINE_TASK_PHASE_CALLBACK);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                          MQTTc_MsgID_Free()
+*                                       MQTTc_ConnCacheSyncProc()
 *
-* Description : Free message ID, allowing other messages to use it.
+* Description : Detect the completion of the initial sync of a connection's cache.
 *
-* Argument(s) : msg_id          Message ID to release.
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
 *
-* Return(s)   : none.
+* Return(s)   : Nbr of ms until the initial sync can cmpl, if it is in progress,
+*               0,                                          otherwise.
 *
-* Caller(s)   : MQTTc_MsgCallbackExec().
+* Caller(s)   : MQTTc_Task().
 *
-* Note(s)     : none.
+* Note(s)     : (1) The initial sync cmpl's once no retained message has been rx'd for the settle time since
+*                   the SUBACK or the last retained message. See MQTTc_ConnSetParam() Note #9a.
 *********************************************************************************************************
 */
 
-static  void  MQTTc_MsgID_Free (CPU_INT16U  msg_id)
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+static  CPU_INT32U  MQTTc_ConnCacheSyncProc (MQTTc_CONN  *p_conn)
 {
-    CPU_SR_ALLOC();
+    CPU_INT32U  elapsed_ms;
 
 
-    if (msg_id != MQTT_MSG_ID_NONE) {
-        CPU_CRITICAL_ENTER();
-        DEF_BIT_CLR(MQTTc_Ptr->MsgID_BitmapTbl[(msg_id - 1u) / 32u], DEF_BIT((msg_id - 1u) % DEF_INT_32_NBR_BITS));
-        CPU_CRITICAL_EXIT();
+    if (p_conn->CacheSyncPend == DEF_NO) {
+        return (0u);
     }
 
-    return;
+    elapsed_ms = NetUtil_TS_Get_ms() - p_conn->CacheSyncTS_ms;
+    if (elapsed_ms < p_conn->CacheSyncSettle_ms) {              /* See Note #1.                                         */
+        return (p_conn->CacheSyncSettle_ms - elapsed_ms);
+    }
+
+    p_conn->CacheSyncPend = DEF_NO;
+    if (p_conn->OnCacheSync != DEF_NULL) {
+        p_conn->OnCacheSync(p_conn, p_conn->ArgPtr);
+    }
+
+    return (0u);
 }
+#endif
 
 
 /*
@@ -3511,6 +7710,8 @@ static  void  MQTTc_ConnNextMsgClr (MQTTc_CONN  *p_conn)
     p_conn->NextMsgMsgID        = MQTT_MSG_ID_NONE;
     p_conn->NextMsgMsgID_IsCmpl = DEF_NO;
     p_conn->NextMsgPtr          = DEF_NULL;
+    p_conn->NextMsgIsFiltered   = DEF_NO;
+    p_conn->NextMsgDiscard      = DEF_NO;
 
     return;
 }
@@ -3584,11 +7785,43 @@ static  void  MQTTc_ConnCloseProc (MQTTc_CONN  *p_conn,
     }
     CPU_CRITICAL_EXIT();
 
-    MQTTc_MsgListClosedCallbackExec(p_conn->TxMsgHeadPtr);      /* Exec callbacks for msgs q'd under this conn.         */
-    p_conn->TxMsgHeadPtr = DEF_NULL;                            /* Mark list as empty.                                  */
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+    MQTTc_PublishRxBatchFlush(p_conn);                          /* Deliver msgs rx'd before conn closed.                */
+    MQTTc_PublishRxBatchRelease(p_conn);
+#endif
+
+    p_conn->TxBufDataLen         = 0u;                          /* Discard content of tx buf, if any.                   */
+    p_conn->TxBufTxLen           = 0u;
+    p_conn->TxBufAckLen          = 0u;
+    p_conn->NextTxMsgTxLen       = 0u;
+    p_conn->TxWaitConnAck        = DEF_NO;
+
+    p_conn->AckQ_Len             = 0u;                          /* Discard q'd acks, if any.                            */
+    p_conn->AckQ_TxLen           = 0u;
+    if (p_conn->CleanSession == DEF_YES) {                      /* Session is clean on next CONNECT. Forget QoS 2 ...   */
+        MQTTc_QoS2_RxTblClr(p_conn);                            /* flows that were not released.                        */
+    }
+
+    MQTTc_ConnMsgListsFlush(p_conn);                            /* Exec callbacks for msgs q'd under this conn.         */
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+    MQTTc_ConnStoreReset(p_conn);                               /* Re-tx stored msgs not released on next conn.         */
+#endif
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+    p_conn->CacheSyncPend        = DEF_NO;                      /* Cache content is kept for next conn.                 */
+#endif
 
                                                                 /* Exec callback, in order, for each msg that had ...   */
     MQTTc_MsgListClosedCallbackExec(p_head_callback_msg);       /* been posted but not processed, for that conn.        */
+
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+    MQTTc_CmplBatchFlush(p_conn);                               /* Deliver msgs cmpl'd before and by the close.         */
+#endif
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+    MQTTc_ConnStatsSnap(p_conn);                                /* Conn is not processed by the task anymore.           */
+#endif
 }
 
 
@@ -3630,6 +7863,9 @@ static  void  MQTTc_ConnRemove (MQTTc_CONN  *p_conn)
             p_iter_conn->NextPtr = p_conn->NextPtr;
         } else {
             MQTTc_DBG_TRACE_INFO(("!!! ERROR !!! Could not find conn in conn list.\r\n"));
+            return;
         }
     }
+
+    MQTTc_MEM_CONN_REMOVE(p_conn);
 }
@@ -81,6 +81,7 @@
 
 #include  <mqtt-c_cfg.h>
 
+#include  <KAL/kal.h>
 #include  <Source/net_app.h>
 #include  <Source/net_sock.h>
 
@@ -95,6 +96,16 @@
 
 #define  MQTTc_FLAGS_NONE                       DEF_BIT_NONE    /* Reserved for future usage.                           */
 
+                                                                /* Len of ack q buf. Each ack is 4 bytes long.          */
+#define  MQTTc_ACK_Q_BUF_LEN                   (MQTTc_CFG_ACK_Q_SIZE * 4u)
+
+#define  MQTTc_QOS2_RX_TBL_IX_NONE                      0xFFu   /* Ix returned when entry is not found in QoS 2 rx tbl. */
+
+#define  MQTTc_TX_LANE_NONE                             0xFFu   /* Lane returned when no msg is ready to be tx'd.       */
+
+                                                                /* Nbr of MQTT ctrl pkt types, incl. reserved type 0.   */
+#define  MQTTc_STAT_PKT_TYPE_NBR                           15u
+
 
 /*
 *********************************************************************************************************
@@ -146,6 +157,27 @@
 #endif
 
 
+/*
+*********************************************************************************************************
+*                                              STATISTICS
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+    #define  MQTTc_STAT_INC(p_conn, ctr)              { (p_conn)->Stats.ctr++;          }
+    #define  MQTTc_STAT_ADD(p_conn, ctr, val)         { (p_conn)->Stats.ctr += (val);   }
+    #define  MQTTc_STAT_DEC(p_conn, ctr)              { (p_conn)->Stats.ctr--;          }
+    #define  MQTTc_STAT_MAX(p_conn, ctr, val)         { if ((val) > (p_conn)->Stats.ctr) { (p_conn)->Stats.ctr = (val); } }
+    #define  MQTTc_STAT_ERR_INC(p_conn, err)          { if ((err) < MQTTc_ERR_NBR) { (p_conn)->Stats.ErrCtrTbl[(err)]++; } }
+#else
+    #define  MQTTc_STAT_INC(p_conn, ctr)
+    #define  MQTTc_STAT_ADD(p_conn, ctr, val)
+    #define  MQTTc_STAT_DEC(p_conn, ctr)
+    #define  MQTTc_STAT_MAX(p_conn, ctr, val)
+    #define  MQTTc_STAT_ERR_INC(p_conn, err)
+#endif
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -156,6 +188,10 @@
 
 typedef  struct  mqttc_conn  MQTTc_CONN;                        /* Forward declaration of MQTTc_CONN.                   */
 typedef  struct  mqttc_msg   MQTTc_MSG;                         /* Forward declaration of MQTTc_MSG.                    */
+typedef  struct  mqttc_store MQTTc_STORE;                       /* Forward declaration of MQTTc_STORE.                  */
+typedef  struct  mqttc_wal   MQTTc_WAL;                         /* Forward declaration of MQTTc_WAL.                    */
+typedef  struct  mqttc_cache MQTTc_CACHE;                       /* Forward declaration of MQTTc_CACHE.                  */
+typedef  struct  mqttc_lat   MQTTc_LAT;                         /* Forward declaration of MQTTc_LAT.                    */
 
 
 /*
@@ -183,9 +219,15 @@ typedef  enum  mqttc_param_type {
     MQTTc_PARAM_TYPE_CALLBACK_ON_UNSUBSCRIBE_CMPL,              /* Conn's on unsubscribe cmpl callback.                 */
     MQTTc_PARAM_TYPE_CALLBACK_ON_PINGREQ_CMPL,                  /* Conn's on pingreq     cmpl callback.                 */
     MQTTc_PARAM_TYPE_CALLBACK_ON_DISCONNECT_CMPL,               /* Conn's on disconnect  cmpl callback.                 */
+    MQTTc_PARAM_TYPE_CALLBACK_ON_COMPL_BATCH,                   /* Conn's on cmpl batch       callback.                 */
     MQTTc_PARAM_TYPE_CALLBACK_ON_ERR_CALLBACK,                  /* Conn's on err              callback.                 */
 
     MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX,                    /* Conn's on publish rx'd callback.                     */
+    MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_FILTER,             /* Conn's on publish rx'd filter callback.              */
+    MQTTc_PARAM_TYPE_CALLBACK_ON_PUBLISH_RX_BATCH,              /* Conn's on publish rx'd batch callback.               */
+
+    MQTTc_PARAM_TYPE_CALLBACK_ON_TX_Q_HIGH,                     /* Conn's on tx q high watermark callback.              */
+    MQTTc_PARAM_TYPE_CALLBACK_ON_TX_Q_LOW,                      /* Conn's on tx q low  watermark callback.              */
 
     MQTTc_PARAM_TYPE_CALLBACK_ARG_PTR,                          /* Conn's ptr on arg passed to callback.                */
 
@@ -193,8 +235,33 @@ typedef  enum  mqttc_param_type {
 
     MQTTc_PARAM_TYPE_PUBLISH_RX_MSG_PTR,                        /* Conn's ptr on msg that is used to rx publish msg.    */
 
+    MQTTc_PARAM_TYPE_TX_BUF_PTR,                                /* Conn's ptr on buf used to coalesce tx'd msgs.        */
+    MQTTc_PARAM_TYPE_TX_BUF_LEN,                                /* Conn's len of buf used to coalesce tx'd msgs.        */
+
+    MQTTc_PARAM_TYPE_SCHED_WEIGHT,                              /* Conn's weight when sharing the task between conns.   */
+
+    MQTTc_PARAM_TYPE_TX_Q_MAX_MSG_NBR,                          /* Conn's max nbr of PUBLISH msgs q'd at once.          */
+    MQTTc_PARAM_TYPE_TX_Q_MAX_LEN,                              /* Conn's max nbr of bytes of PUBLISH msgs q'd at once. */
+    MQTTc_PARAM_TYPE_TX_Q_LOW_MSG_NBR,                          /* Conn's tx q low watermark, in nbr of msgs.           */
+    MQTTc_PARAM_TYPE_TX_Q_LOW_LEN,                              /* Conn's tx q low watermark, in bytes.                 */
+
+    MQTTc_PARAM_TYPE_TX_RATE_MSG_PER_SEC,                       /* Conn's max nbr of PUBLISH msgs tx'd per sec.         */
+    MQTTc_PARAM_TYPE_TX_RATE_MSG_BURST,                         /* Conn's nbr of PUBLISH msgs tx'd back to back.        */
+    MQTTc_PARAM_TYPE_TX_RATE_BYTES_PER_SEC,                     /* Conn's max nbr of PUBLISH bytes tx'd per sec.        */
+    MQTTc_PARAM_TYPE_TX_RATE_BYTES_BURST,                       /* Conn's nbr of PUBLISH bytes tx'd back to back.       */
+    MQTTc_PARAM_TYPE_STORE_PTR,                                 /* Conn's store of outbound PUBLISH msgs.               */
+    MQTTc_PARAM_TYPE_CLEAN_SESSION,                             /* Conn's clean session flag.                           */
+    MQTTc_PARAM_TYPE_WAL_PTR,                                   /* Conn's write-ahead log of in-flight QoS 1/2 state.   */
+    MQTTc_PARAM_TYPE_CACHE_PTR,                                 /* Conn's cache of last payload rx'd on each topic.     */
+    MQTTc_PARAM_TYPE_CACHE_SYNC_SETTLE_MS,                      /* Conn's quiet time ending the initial sync, in ms.    */
+    MQTTc_PARAM_TYPE_CALLBACK_ON_CACHE_SYNC,                    /* Conn's on cache initial sync cmpl callback.          */
+    MQTTc_PARAM_TYPE_LAT_PTR,                                   /* Conn's publish-to-ack latency histograms.            */
+
     MQTTc_PARAM_TYPE_MSG_BUF_PTR,                               /* Msg's buf ptr.                                       */
-    MQTTc_PARAM_TYPE_MSG_BUF_LEN                                /* Msg's buf len.                                       */
+    MQTTc_PARAM_TYPE_MSG_BUF_LEN,                               /* Msg's buf len.                                       */
+    MQTTc_PARAM_TYPE_MSG_PRIO,                                  /* Msg's tx prio.                                       */
+    MQTTc_PARAM_TYPE_MSG_CONFLATE_EN,                           /* Msg can replace q'd msg on same topic.               */
+    MQTTc_PARAM_TYPE_MSG_TTL_MS                                 /* Msg's time to live, in ms, before being tx'd.        */
 } MQTTc_PARAM_TYPE;
 
 
@@ -226,6 +293,16 @@ typedef  enum  mqttc_err {
     MQTTc_ERR_SEL,                                              /* Generic Sel err.                                     */
     MQTTc_ERR_TIMEOUT,                                          /* Operation timed out.                                 */
     MQTTc_ERR_SOCK_FAIL,                                        /* Operation on sock failed.                            */
+
+    MQTTc_ERR_TX_Q_FULL,                                        /* Conn's tx q is full. Msg was not q'd.                */
+    MQTTc_ERR_SUPERSEDED,                                       /* Msg replaced by newer msg on same topic before tx.   */
+    MQTTc_ERR_EXPIRED,                                          /* Msg's TTL expired before msg could be tx'd.          */
+    MQTTc_ERR_STORE_FULL,                                       /* Conn's store is full. Msg was not stored.            */
+    MQTTc_ERR_CACHE_FULL,                                       /* Cache is full. Topic was not cached.                 */
+    MQTTc_ERR_CACHE_MISS,                                       /* Topic is not in the cache.                           */
+    MQTTc_ERR_QOS2_RX_TBL_FULL,                                 /* Conn's QoS 2 rx tbl is full. Conn was closed.        */
+
+    MQTTc_ERR_NBR                                               /* Nbr of err codes. MUST be last.                      */
 } MQTTc_ERR;
 
 
@@ -273,6 +350,104 @@ typedef  enum  mqttc_msg_state {
 } MQTTc_MSG_STATE;
 
 
+/*
+*********************************************************************************************************
+*                                            MQTTc MSG PRIO
+*
+* Note(s) : (1) Each connection has one tx lane per priority. The control lane is reserved to CONNECT,
+*               PINGREQ and PUBREL, and always has precedence over the other lanes.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_msg_prio {
+    MQTTc_MSG_PRIO_CTRL,                                        /* Protocol ctrl msgs. See Note #1.                     */
+    MQTTc_MSG_PRIO_HIGH,                                        /* Urgent msgs, such as alarms.                         */
+    MQTTc_MSG_PRIO_NORMAL,                                      /* Dflt prio.                                           */
+    MQTTc_MSG_PRIO_BULK,                                        /* Large or non-urgent xfers.                           */
+
+    MQTTc_MSG_PRIO_NBR                                          /* Nbr of tx lanes per conn.                            */
+} MQTTc_MSG_PRIO;
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc PUBLISH RX VIEW
+*
+* Note(s) : (1) A view points in the buf of the connection's rx msg. It is only valid during the call to
+*               OnPublishRxBatch.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_publish_rx_view {
+    const  CPU_CHAR    *TopicPtr;                               /* Ptr to topic. Not null-terminated.                   */
+           CPU_INT32U   TopicLen;                               /* Len of topic, in bytes.                              */
+    const  CPU_CHAR    *PayloadPtr;                             /* Ptr to payload. Null-terminated.                     */
+           CPU_INT32U   PayloadLen;                             /* Len of payload, in bytes.                            */
+           MQTTc_ERR    Err;                                    /* Err associated to rx of msg.                         */
+} MQTTc_PUBLISH_RX_VIEW;
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc CONNECTION STATS
+*
+* Note(s) : (1) Pkt ctrs are indexed by MQTT ctrl pkt type, which is also the value of the matching
+*               MQTTc_MSG_TYPE. Their bytes include the fixed hdr.
+*
+*           (2) Acks (PUBACK, PUBREC and PUBCOMP) are counted as tx'd once q'd in the conn's ack Q.
+*
+*           (3) Only PUBLISH msgs tx'd with the DUP flag set are counted as retransmissions.
+*
+*           (4) A read or write is partial when the sock xfer'd fewer bytes than requested.
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+typedef  struct  mqttc_conn_stats {
+    CPU_INT32U  RxByteCtr;                                      /* Nbr of bytes rx'd on sock.                           */
+    CPU_INT32U  TxByteCtr;                                      /* Nbr of bytes tx'd on sock.                           */
+                                                                /* Nbr of pkts rx'd, per type. See Note #1.             */
+    CPU_INT32U  RxPktCtrTbl[MQTTc_STAT_PKT_TYPE_NBR];
+                                                                /* Nbr of bytes of pkts rx'd, per type.                 */
+    CPU_INT32U  RxPktByteCtrTbl[MQTTc_STAT_PKT_TYPE_NBR];
+                                                                /* Nbr of pkts tx'd, per type. See Note #2.             */
+    CPU_INT32U  TxPktCtrTbl[MQTTc_STAT_PKT_TYPE_NBR];
+                                                                /* Nbr of bytes of pkts tx'd, per type.                 */
+    CPU_INT32U  TxPktByteCtrTbl[MQTTc_STAT_PKT_TYPE_NBR];
+
+    CPU_INT16U  TxQ_MsgNbr;                                     /* Nbr of PUBLISH msgs in tx q.                         */
+    CPU_INT16U  TxQ_MsgNbrMax;                                  /* High-water mark of nbr of PUBLISH msgs in tx q.      */
+    CPU_INT32U  TxQ_Len;                                        /* Nbr of bytes of PUBLISH msgs in tx q.                */
+    CPU_INT32U  TxQ_LenMax;                                     /* High-water mark of nbr of bytes in tx q.             */
+    CPU_INT32U  InFlightNbr;                                    /* Nbr of msgs tx'd, waiting for a reply.               */
+    CPU_INT32U  InFlightNbrMax;                                 /* High-water mark of nbr of msgs in flight.            */
+    CPU_INT32U  RetxCtr;                                        /* Nbr of PUBLISH msgs re-tx'd. See Note #3.            */
+
+    CPU_INT32U  ErrCtrTbl[MQTTc_ERR_NBR];                       /* Nbr of errs, per MQTTc_ERR code.                     */
+
+    CPU_INT32U  SelWakeupCtr;                                   /* Nbr of times sock sel reported the conn ready.       */
+    CPU_INT32U  RxPartialCtr;                                   /* Nbr of partial reads.  See Note #4.                  */
+    CPU_INT32U  TxPartialCtr;                                   /* Nbr of partial writes. See Note #4.                  */
+} MQTTc_CONN_STATS;
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc CMPL ENTRY
+*
+* Note(s) : (1) The type and err are copied from the msg when it cmpl's. They stay valid even if the msg
+*               is re-used before the entry is read.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_cmpl_entry {
+    MQTTc_MSG         *MsgPtr;                                  /* Ptr to msg that cmpl'd.                              */
+    MQTTc_MSG_TYPE     Type;                                    /* Type of oper that cmpl'd. See Note #1.               */
+    MQTTc_ERR          Err;                                     /* Err from processing msg.  See Note #1.               */
+} MQTTc_CMPL_ENTRY;
+
+
 /*
 *********************************************************************************************************
 *                                         MQTTc CALLBACK TYPES
@@ -299,6 +474,33 @@ typedef  void  (*MQTTc_PUBLISH_RX_CALLBACK)     (       MQTTc_CONN   *p_conn,
                                                         void         *p_arg,
                                                         MQTTc_ERR     err);
 
+                                                                /* Type of callback exec'd to filter rx'd publish.      */
+typedef  CPU_BOOLEAN  (*MQTTc_PUBLISH_RX_FILTER_CALLBACK) (       MQTTc_CONN   *p_conn,
+                                                           const  CPU_CHAR     *topic_name_str,
+                                                                  CPU_INT32U    topic_len,
+                                                                  CPU_INT32U    payload_len,
+                                                                  void         *p_arg);
+
+                                                                /* Type of callback exec'd when opers cmpl in batch.    */
+typedef  void  (*MQTTc_CMPL_BATCH_CALLBACK)     (       MQTTc_CONN         *p_conn,
+                                                 const  MQTTc_CMPL_ENTRY   *p_entries,
+                                                        CPU_INT32U          entry_nbr,
+                                                        void               *p_arg);
+
+                                                                /* Type of callback exec'd when publishes are rx'd.     */
+typedef  void  (*MQTTc_PUBLISH_RX_BATCH_CALLBACK)  (       MQTTc_CONN              *p_conn,
+                                                    const  MQTTc_PUBLISH_RX_VIEW   *p_views,
+                                                           CPU_INT32U               view_nbr,
+                                                           void                    *p_arg);
+
+                                                                /* Type of callback exec'd when tx q crosses watermark. */
+typedef  void  (*MQTTc_TX_Q_CALLBACK)           (      MQTTc_CONN    *p_conn,
+                                                       void          *p_arg);
+
+                                                                /* Type of callback exec'd when cache is synced.        */
+typedef  void  (*MQTTc_CACHE_SYNC_CALLBACK)     (      MQTTc_CONN    *p_conn,
+                                                       void          *p_arg);
+
 
 /*
 *********************************************************************************************************
@@ -334,6 +536,10 @@ struct  mqttc_msg {
     MQTTc_MSG_TYPE    Type;                                     /* Msg's type.                                          */
     MQTTc_MSG_STATE   State;                                    /* Msg's state.                                         */
     CPU_INT08U        QoS;                                      /* Msg's QoS.                                           */
+    MQTTc_MSG_PRIO    Prio;                                     /* Msg's tx prio.                                       */
+    CPU_BOOLEAN       ConflateEn;                               /* Flag indicating if msg can replace q'd msg.          */
+    CPU_INT32U        TTL_ms;                                   /* Msg's time to live, in ms. 0 if unlimited.           */
+    CPU_INT32U        DeadlineTS_ms;                            /* Timestamp after which msg is dropped if not tx'd.    */
 
     CPU_INT16U        MsgID;                                    /* Msg ID used by msg.                                  */
 
@@ -341,13 +547,82 @@ struct  mqttc_msg {
     void             *ArgPtr;                                   /* to post, in case of 'close' msg.                     */
     CPU_INT32U        BufLen;                                   /* Avail buf len for msg.                               */
     CPU_INT32U        XferLen;                                  /* Len of xfer.                                         */
+    CPU_INT32U        TxQ_Len;                                  /* Len accounted for msg in conn's tx q, if any.        */
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+    CPU_INT32U        MemLen;                                   /* Len accounted for msg in mem usage, if any.          */
+#endif
 
     MQTTc_ERR         Err;                                      /* Err associated to processing of msg.                 */
 
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+    CPU_TS32          LatPostTS;                                /* Timestamp of post.                                   */
+    CPU_TS32          LatTxStartTS;                             /* Timestamp of tx of first byte.                       */
+    CPU_TS32          LatTxEndTS;                               /* Timestamp of tx of last byte.                        */
+#endif
+
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+    CPU_INT32U        TimelineID;                               /* ID of msg's spans in timeline.                       */
+    CPU_INT08U        TimelinePhase;                            /* Cur phase of msg in timeline.                        */
+#endif
+
     MQTTc_MSG        *NextPtr;                                  /* Ptr to next msg.                                     */
 };
 
 
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                         MQTTc STORE POSITION
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_store_pos {
+    CPU_INT32U  SegSeq;                                         /* Seq nbr of seg. Phy seg is SegSeq % SegNbr.          */
+    CPU_INT32U  Offset;                                         /* Offset of rec in seg.                                */
+} MQTTc_STORE_POS;
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc STORE SLOT
+*
+* Note(s) : (1) A slot of the tx window of a connection, used to tx a stored message. The msg MUST be the
+*               first field, so that a slot can be found from its msg.
+*
+*           (2) The PUBREL of a stored QoS 2 message is encoded in the slot, so that the record is left
+*               untouched. Each PUBREL is 4 bytes long.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_store_slot {
+    MQTTc_MSG         Msg;                                      /* Msg used to tx the stored msg. See Note #1.          */
+    MQTTc_STORE_POS   Pos;                                      /* Pos of the rec in the store.                         */
+    CPU_INT08U        RelBuf[4u];                               /* Buf holding the PUBREL. See Note #2.                 */
+} MQTTc_STORE_SLOT;
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      MQTTc PUBLISH TEMPLATE TYPE
+*
+* Note(s) : (1) A publish template holds everything that does not change between two PUBLISH messages sent
+*               on the same topic with the same QoS and retain flag. It is filled once by
+*               MQTTc_PublishTemplateCreate() and can then be used by MQTTc_PublishByTemplate() as many
+*               times as needed, from any number of connections.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_publish_template {
+    const  CPU_CHAR    *TopicStr;                               /* Topic str. Must stay valid while tmpl is used.       */
+           CPU_INT16U   TopicLen;                               /* Len of topic str, in bytes.                          */
+           CPU_INT08U   TopicLenEncoded[2u];                    /* Topic len, as encoded in the var hdr.                */
+           CPU_INT08U   QoS;                                    /* QoS lvl at which to publish.                         */
+           CPU_INT08U   FixedHdrByte;                           /* First byte of fixed hdr (type, QoS and retain).      */
+           CPU_INT32U   VarHdrLen;                              /* Len of var hdr (topic and msg ID, if any).           */
+} MQTTc_PUBLISH_TEMPLATE;
+
+
 /*
 *********************************************************************************************************
 *                                            MQTTc CONN TYPE
@@ -367,6 +642,7 @@ struct  mqttc_conn {
     CPU_CHAR                   *PasswordStr;                    /* Password str.                                        */
 
     CPU_INT16U                  KeepAliveTimerSec;              /* Keep alive timer duration, in seconds.               */
+    CPU_BOOLEAN                 CleanSession;                   /* Flag indicating if session is clean on each CONNECT. */
     MQTTc_WILL_CFG             *WillCfgPtr;                     /* Ptr to will cfg, if any.                             */
 
     NET_APP_SOCK_SECURE_CFG    *SecureCfgPtr;                   /* Ptr to secure will cfg, if any.                      */
@@ -381,6 +657,9 @@ struct  mqttc_conn {
     MQTTc_CMPL_CALLBACK         OnDisconnectCmpl;               /* On disconnect cmpl callback.                         */
     MQTTc_ERR_CALLBACK          OnErrCallback;                  /* On err or conn lost callback. Conn must be re-opened.*/
     MQTTc_PUBLISH_RX_CALLBACK   OnPublishRx;                    /* On publish rx'd cmpl callback.                       */
+    MQTTc_PUBLISH_RX_FILTER_CALLBACK  OnPublishRxFilter;        /* On publish rx'd filter callback.                     */
+    MQTTc_TX_Q_CALLBACK         OnTxQ_High;                     /* On tx q high watermark reached callback.             */
+    MQTTc_TX_Q_CALLBACK         OnTxQ_Low;                      /* On tx q low  watermark reached callback.             */
     void                       *ArgPtr;                         /* Ptr to arg that will be provided to callbacks.       */
 
     CPU_INT32U                  TimeoutMs;                      /* Timeout for 'Open' operation, in milliseconds.       */
@@ -394,12 +673,136 @@ struct  mqttc_conn {
     CPU_INT16U                  NextMsgMsgID;                   /* ID of next msg, if any.                              */
     CPU_BOOLEAN                 NextMsgMsgID_IsCmpl;            /* Flag indicating if next msg's ID has been rx'd.      */
     MQTTc_MSG                  *NextMsgPtr;                     /* Ptr to next msg, if known.                           */
+    CPU_BOOLEAN                 NextMsgIsFiltered;              /* Flag indicating if next PUBLISH has been filtered.   */
+    CPU_BOOLEAN                 NextMsgDiscard;                 /* Flag indicating if rest of next msg is skipped.      */
 
     MQTTc_MSG                  *PublishRxMsgPtr;                /* Ptr to msg that is used to rx publish from server.   */
 
-    MQTTc_MSG                  *TxMsgHeadPtr;                   /* Ptr to head of msg needing to tx or waiting reply.   */
+                                                                /* --------------------- TX LANES --------------------- */
+                                                                /* Ptrs to head of each lane of msgs needing to tx.     */
+    MQTTc_MSG                  *TxLaneHeadPtr[MQTTc_MSG_PRIO_NBR];
+                                                                /* Ptrs to tail of each lane of msgs needing to tx.     */
+    MQTTc_MSG                  *TxLaneTailPtr[MQTTc_MSG_PRIO_NBR];
+#if (MQTTc_CFG_TX_SCHED_WEIGHTED_EN == DEF_ENABLED)
+                                                                /* Nbr of msgs each lane can still tx in this round.    */
+    CPU_INT08U                  TxLaneCredit[MQTTc_MSG_PRIO_NBR];
+#endif
+    CPU_BOOLEAN                 TxWaitConnAck;                  /* Flag indicating CONNECT tx'd, waiting for CONNACK.   */
+    MQTTc_MSG                  *TxMsgCurPtr;                    /* Ptr to msg being tx'd, if any.                       */
     CPU_INT32U                  NextTxMsgTxLen;                 /* Len of already xfer'd data.                          */
 
+    MQTTc_MSG                  *WaitRxMsgHeadPtr;               /* Ptr to head of list of msgs waiting for a reply.     */
+    MQTTc_MSG                  *WaitRxMsgTailPtr;               /* Ptr to tail of list of msgs waiting for a reply.     */
+
+                                                                /* ------------------ TX COALESCING ------------------- */
+    CPU_INT08U                 *TxBufPtr;                       /* Ptr to buf used to coalesce tx'd msgs, if any.       */
+    CPU_INT32U                  TxBufLen;                       /* Len of coalescing buf. Max nbr of bytes per tx.      */
+    CPU_INT32U                  TxBufDataLen;                   /* Len of data currently in coalescing buf.             */
+    CPU_INT32U                  TxBufTxLen;                     /* Len of data in coalescing buf already tx'd.          */
+    CPU_INT16U                  TxBufAckLen;                    /* Len of q'd acks at start of coalescing buf.          */
+    MQTTc_MSG                  *TxBufMsgHeadPtr;                /* Ptr to head of list of msgs copied in buf.           */
+
+                                                                /* -------------------- ACK QUEUE --------------------- */
+    CPU_INT08U                  AckQ_Buf[MQTTc_ACK_Q_BUF_LEN];  /* Buf containing encoded acks q'd for tx.              */
+    CPU_INT16U                  AckQ_Len;                       /* Len of acks q'd in buf.                              */
+    CPU_INT16U                  AckQ_TxLen;                     /* Len of acks in buf already tx'd.                     */
+
+                                                                /* ----------------- INBOUND QoS 2 TBL ---------------- */
+    CPU_INT32U                  QoS2_RxTblBitmap;               /* Bitmap of entries in use in QoS 2 rx tbl.            */
+                                                                /* Msg ID of each QoS 2 PUBLISH rx'd, until PUBREL rx'd.*/
+    CPU_INT16U                  QoS2_RxTblMsgID[MQTTc_CFG_QOS2_RX_TBL_SIZE];
+
+                                                                /* -------------------- SCHEDULING -------------------- */
+    CPU_INT08U                  SchedWeight;                    /* Nbr of quanta given to conn each time it's processed.*/
+    CPU_INT32U                  SchedDeficit;                   /* Nbr of bytes conn can still rx or tx in this round.  */
+
+                                                                /* -------------------- TX Q LIMITS ------------------- */
+    CPU_INT16U                  TxQ_MsgNbr;                     /* Nbr of PUBLISH msgs q'd on conn, until they cmpl.    */
+    CPU_INT32U                  TxQ_Len;                        /* Nbr of bytes of PUBLISH msgs q'd on conn.            */
+    CPU_INT16U                  TxQ_MaxMsgNbr;                  /* High watermark, in nbr of msgs. 0 if unlimited.      */
+    CPU_INT32U                  TxQ_MaxLen;                     /* High watermark, in bytes.       0 if unlimited.      */
+    CPU_INT16U                  TxQ_LowMsgNbr;                  /* Low  watermark, in nbr of msgs.                      */
+    CPU_INT32U                  TxQ_LowLen;                     /* Low  watermark, in bytes.                            */
+    CPU_BOOLEAN                 TxQ_IsHigh;                     /* Flag indicating tx q reached its high watermark.     */
+    CPU_BOOLEAN                 TxQ_HighCallbackPend;           /* Flag indicating OnTxQ_High callback must be exec'd.  */
+    CPU_INT16U                  TxQ_WaitNbr;                    /* Nbr of tasks waiting for tx q to drain.              */
+    KAL_SEM_HANDLE              TxQ_SemHandle;                  /* Sem posted when tx q drains to its low watermark.    */
+
+                                                                /* ----------------- TX RATE LIMITER ------------------ */
+    CPU_INT32U                  TxRateMsgPerSec;                /* Max nbr of PUBLISH msgs tx'd per sec. 0 if unlimited.*/
+    CPU_INT32U                  TxRateMsgBurst;                 /* Nbr of PUBLISH msgs that can be tx'd back to back.   */
+    CPU_INT32U                  TxRateBytesPerSec;              /* Max nbr of bytes tx'd per sec.        0 if unlimited.*/
+    CPU_INT32U                  TxRateBytesBurst;               /* Nbr of bytes that can be tx'd back to back.          */
+    CPU_INT32S                  TxRateMsgTokens;                /* Tokens in msg  bucket, in thousandths of msg.        */
+    CPU_INT32S                  TxRateBytesTokens;              /* Tokens in byte bucket, in thousandths of byte.       */
+    CPU_INT32U                  TxRateTS_ms;                    /* Timestamp of last buckets refill, in ms.             */
+
+    CPU_INT16U                  TxDeadlineMsgNbr;               /* Nbr of msgs with a deadline in tx lanes.             */
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+                                                                /* ----------------- STORE AND FORWARD ---------------- */
+    MQTTc_STORE                *StorePtr;                       /* Ptr to store of outbound PUBLISH msgs, if any.       */
+    CPU_BOOLEAN                 StoreTxEn;                      /* Flag indicating if stored msgs can be tx'd.          */
+    CPU_INT08U                  StoreWinHeadIx;                 /* Ix of oldest stored msg in flight in tx window.      */
+    CPU_INT08U                  StoreWinNbr;                    /* Nbr of stored msgs in flight.                        */
+                                                                /* Slots used to tx stored msgs, in tx order.           */
+    MQTTc_STORE_SLOT            StoreSlotTbl[MQTTc_CFG_STORE_WIN_SIZE];
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+    MQTTc_WAL                  *WalPtr;                         /* Ptr to write-ahead log of in-flight state, if any.   */
+#endif
+#endif
+
+#if (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+                                                                /* -------------------- BATCHED RX -------------------- */
+    MQTTc_PUBLISH_RX_BATCH_CALLBACK  OnPublishRxBatch;          /* On publish rx'd batch callback.                      */
+    CPU_INT08U                 *PublishRxBatchBufPtr;           /* Ptr to buf of rx msg, holding the batch.             */
+    CPU_INT32U                  PublishRxBatchBufLen;           /* Len of buf of rx msg.                                */
+    CPU_INT32U                  PublishRxBatchLen;              /* Len of buf of rx msg used by the batch.              */
+    CPU_INT08U                  PublishRxBatchNbr;              /* Nbr of msgs in batch.                                */
+                                                                /* Views of msgs in batch.                              */
+    MQTTc_PUBLISH_RX_VIEW       PublishRxBatchTbl[MQTTc_CFG_PUBLISH_RX_BATCH_SIZE];
+#endif
+
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+                                                                /* -------------------- STATISTICS -------------------- */
+    MQTTc_CONN_STATS            Stats;                          /* Stat ctrs, updated by the task.                      */
+    MQTTc_CONN_STATS            StatsSnap;                      /* Snapshot of stat ctrs, read by MQTTc_ConnStatsGet(). */
+#endif
+
+#if (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+                                                                /* ------------------- BATCHED CMPL ------------------- */
+    MQTTc_CMPL_BATCH_CALLBACK   OnCmplBatch;                    /* On cmpl batch callback.                              */
+    CPU_INT08U                  CmplBatchNbr;                   /* Nbr of entries in batch.                             */
+                                                                /* Entries of msgs in batch.                            */
+    MQTTc_CMPL_ENTRY            CmplBatchTbl[MQTTc_CFG_CMPL_BATCH_SIZE];
+#endif
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+                                                                /* ------------------ RETAINED CACHE ------------------ */
+    MQTTc_CACHE                *CachePtr;                       /* Ptr to cache of last payload rx'd per topic, if any. */
+    CPU_INT32U                  CacheSyncSettle_ms;             /* Time without retained msg ending initial sync, in ms.*/
+    CPU_INT32U                  CacheSyncTS_ms;                 /* Timestamp of last SUBACK or retained msg rx'd, in ms.*/
+    CPU_BOOLEAN                 CacheSyncPend;                  /* Flag indicating if an initial sync is in progress.   */
+    MQTTc_CACHE_SYNC_CALLBACK   OnCacheSync;                    /* On cache initial sync cmpl callback.                 */
+#endif
+
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+    MQTTc_LAT                  *LatPtr;                         /* Ptr to publish-to-ack latency histograms, if any.    */
+#endif
+
+#if (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+                                                                /* --------------------- CAPTURE ---------------------- */
+    CPU_INT16U                  CapPort;                        /* Synthetic TCP port of conn in capture.               */
+    CPU_INT32U                  CapTxSeq;                       /* Synthetic TCP seq nbr of next byte tx'd.             */
+    CPU_INT32U                  CapRxSeq;                       /* Synthetic TCP seq nbr of next byte rx'd.             */
+#endif
+
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+                                                                /* ---------------- MEMORY ACCOUNTING ----------------- */
+    CPU_INT32U                  MemRxBufLen;                    /* Len of rx msg accounted in mem usage.                */
+    CPU_INT32U                  MemTxBufLen;                    /* Len of tx buf accounted in mem usage.                */
+#endif
+
     MQTTc_CONN                 *NextPtr;                        /* Ptr to next conn.                                    */
 };
 
@@ -447,6 +850,12 @@ void  MQTTc_ConnClose       (       MQTTc_CONN         *p_conn,
                                     MQTTc_FLAGS         flags,
                                     MQTTc_ERR          *p_err);
 
+#if (MQTTc_CFG_STAT_EN == DEF_ENABLED)
+void  MQTTc_ConnStatsGet    (       MQTTc_CONN         *p_conn,
+                                    MQTTc_CONN_STATS   *p_stats,
+                                    MQTTc_ERR          *p_err);
+#endif
+
 void  MQTTc_MsgClr          (       MQTTc_MSG          *p_msg,
                                     MQTTc_ERR          *p_err);
 
@@ -468,6 +877,39 @@ void  MQTTc_Publish         (       MQTTc_CONN         *p_conn,
                                     CPU_INT32U          payload_len,
                                     MQTTc_ERR          *p_err);
 
+void  MQTTc_PublishBlocking (       MQTTc_CONN         *p_conn,
+                                    MQTTc_MSG          *p_msg,
+                             const  CPU_CHAR           *topic_str,
+                                    CPU_INT08U          qos_lvl,
+                                    CPU_BOOLEAN         retain_flag,
+                             const  CPU_CHAR           *p_payload,
+                                    CPU_INT32U          payload_len,
+                                    CPU_INT32U          timeout_ms,
+                                    MQTTc_ERR          *p_err);
+
+void  MQTTc_PublishTemplateCreate(       MQTTc_PUBLISH_TEMPLATE  *p_template,
+                                  const  CPU_CHAR                *topic_str,
+                                         CPU_INT08U               qos_lvl,
+                                         CPU_BOOLEAN              retain_flag,
+                                         MQTTc_ERR               *p_err);
+
+void  MQTTc_PublishByTemplate    (       MQTTc_CONN              *p_conn,
+                                         MQTTc_MSG               *p_msg,
+                                  const  MQTTc_PUBLISH_TEMPLATE  *p_template,
+                                  const  CPU_CHAR                *p_payload,
+                                         CPU_INT32U               payload_len,
+                                         MQTTc_ERR               *p_err);
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+void  MQTTc_PublishStore    (       MQTTc_CONN         *p_conn,
+                             const  CPU_CHAR           *topic_str,
+                                    CPU_INT08U          qos_lvl,
+                                    CPU_BOOLEAN         retain_flag,
+                             const  CPU_CHAR           *p_payload,
+                                    CPU_INT32U          payload_len,
+                                    MQTTc_ERR          *p_err);
+#endif
+
 void  MQTTc_Subscribe       (       MQTTc_CONN         *p_conn,
                                     MQTTc_MSG          *p_msg,
                              const  CPU_CHAR           *topic_str,
@@ -516,16 +958,188 @@ void  MQTTc_Disconnect      (       MQTTc_CONN         *p_conn,
 #error  "MQTTc_CFG_ARG_CHK_EXT_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
 #endif
 
-#ifndef  MQTTc_CFG_DBG_GLOBAL_BUF_EN
-#error  "MQTTc_CFG_DBG_GLOBAL_BUF_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
-#elif  ((MQTTc_CFG_DBG_GLOBAL_BUF_EN != DEF_DISABLED) && \
-        (MQTTc_CFG_DBG_GLOBAL_BUF_EN != DEF_ENABLED ))
-#error  "MQTTc_CFG_DBG_GLOBAL_BUF_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
-#elif   (MQTTc_CFG_DBG_GLOBAL_BUF_EN == DEF_ENABLED)
-#ifndef MQTTc_CFG_DBG_GLOBAL_BUF_LEN
-#error  "MQTTc_CFG_DBG_GLOBAL_BUF_LEN not #define'd in 'mqtt-c_cfg.h'. Must be >= 0u."
-#elif  (MQTTc_CFG_DBG_GLOBAL_BUF_LEN == 0u)
-#error  "MQTTc_CFG_DBG_GLOBAL_BUF_LEN illegally #define'd in 'mqtt-c_cfg.h'. Must be >= 0u."
+#ifndef  MQTTc_CFG_ACK_Q_SIZE
+#error  "MQTTc_CFG_ACK_Q_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#elif  ((MQTTc_CFG_ACK_Q_SIZE < 1u) || \
+        (MQTTc_CFG_ACK_Q_SIZE > 255u))
+#error  "MQTTc_CFG_ACK_Q_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#endif
+
+#ifndef  MQTTc_CFG_QOS2_RX_TBL_SIZE
+#error  "MQTTc_CFG_QOS2_RX_TBL_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 32u]."
+#elif  ((MQTTc_CFG_QOS2_RX_TBL_SIZE < 1u) || \
+        (MQTTc_CFG_QOS2_RX_TBL_SIZE > 32u))
+#error  "MQTTc_CFG_QOS2_RX_TBL_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 32u]."
+#endif
+
+#ifndef  MQTTc_CFG_TX_SCHED_WEIGHTED_EN
+#error  "MQTTc_CFG_TX_SCHED_WEIGHTED_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_TX_SCHED_WEIGHTED_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_TX_SCHED_WEIGHTED_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_TX_SCHED_WEIGHTED_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_TX_SCHED_WEIGHTED_EN == DEF_ENABLED)
+#if    (!defined(MQTTc_CFG_TX_SCHED_WEIGHT_HIGH)   || \
+        !defined(MQTTc_CFG_TX_SCHED_WEIGHT_NORMAL) || \
+        !defined(MQTTc_CFG_TX_SCHED_WEIGHT_BULK))
+#error  "MQTTc_CFG_TX_SCHED_WEIGHT_xxx not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#elif  ((MQTTc_CFG_TX_SCHED_WEIGHT_HIGH   < 1u) || (MQTTc_CFG_TX_SCHED_WEIGHT_HIGH   > 255u) || \
+        (MQTTc_CFG_TX_SCHED_WEIGHT_NORMAL < 1u) || (MQTTc_CFG_TX_SCHED_WEIGHT_NORMAL > 255u) || \
+        (MQTTc_CFG_TX_SCHED_WEIGHT_BULK   < 1u) || (MQTTc_CFG_TX_SCHED_WEIGHT_BULK   > 255u))
+#error  "MQTTc_CFG_TX_SCHED_WEIGHT_xxx illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_TASK_QUANTUM_BYTES
+#error  "MQTTc_CFG_TASK_QUANTUM_BYTES not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 65535u]."
+#elif  ((MQTTc_CFG_TASK_QUANTUM_BYTES < 1u) || \
+        (MQTTc_CFG_TASK_QUANTUM_BYTES > 65535u))
+#error  "MQTTc_CFG_TASK_QUANTUM_BYTES illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 65535u]."
+#endif
+
+#ifndef  MQTTc_CFG_STORE_EN
+#error  "MQTTc_CFG_STORE_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_STORE_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_STORE_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_STORE_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_STORE_WIN_SIZE
+#error  "MQTTc_CFG_STORE_WIN_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#elif  ((MQTTc_CFG_STORE_WIN_SIZE < 1u) || \
+        (MQTTc_CFG_STORE_WIN_SIZE > 255u))
+#error  "MQTTc_CFG_STORE_WIN_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_WAL_EN
+#error  "MQTTc_CFG_WAL_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_WAL_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_WAL_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_WAL_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_WAL_EN   == DEF_ENABLED) && \
+        (MQTTc_CFG_STORE_EN != DEF_ENABLED))
+#error  "MQTTc_CFG_WAL_EN illegally #define'd in 'mqtt-c_cfg.h'. MQTTc_CFG_STORE_EN MUST be DEF_ENABLED."
+#endif
+
+#ifndef  MQTTc_CFG_PUBLISH_RX_BATCH_EN
+#error  "MQTTc_CFG_PUBLISH_RX_BATCH_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_PUBLISH_RX_BATCH_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_PUBLISH_RX_BATCH_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_PUBLISH_RX_BATCH_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_PUBLISH_RX_BATCH_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_PUBLISH_RX_BATCH_SIZE
+#error  "MQTTc_CFG_PUBLISH_RX_BATCH_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#elif  ((MQTTc_CFG_PUBLISH_RX_BATCH_SIZE < 1u) || \
+        (MQTTc_CFG_PUBLISH_RX_BATCH_SIZE > 255u))
+#error  "MQTTc_CFG_PUBLISH_RX_BATCH_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_STAT_EN
+#error  "MQTTc_CFG_STAT_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_STAT_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_STAT_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_STAT_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#endif
+
+#ifndef  MQTTc_CFG_CMPL_BATCH_EN
+#error  "MQTTc_CFG_CMPL_BATCH_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_CMPL_BATCH_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_CMPL_BATCH_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_CMPL_BATCH_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_CMPL_BATCH_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_CMPL_BATCH_SIZE
+#error  "MQTTc_CFG_CMPL_BATCH_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#elif  ((MQTTc_CFG_CMPL_BATCH_SIZE < 1u) || \
+        (MQTTc_CFG_CMPL_BATCH_SIZE > 255u))
+#error  "MQTTc_CFG_CMPL_BATCH_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 255u]."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_CACHE_EN
+#error  "MQTTc_CFG_CACHE_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_CACHE_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_CACHE_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_CACHE_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#endif
+
+#ifndef  MQTTc_CFG_LAT_EN
+#error  "MQTTc_CFG_LAT_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_LAT_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_LAT_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_LAT_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_LAT_HIST_PRECISION_BITS
+#error  "MQTTc_CFG_LAT_HIST_PRECISION_BITS not #define'd in 'mqtt-c_cfg.h'. Must be [1u; 8u]."
+#elif  ((MQTTc_CFG_LAT_HIST_PRECISION_BITS < 1u) || \
+        (MQTTc_CFG_LAT_HIST_PRECISION_BITS > 8u))
+#error  "MQTTc_CFG_LAT_HIST_PRECISION_BITS illegally #define'd in 'mqtt-c_cfg.h'. Must be [1u; 8u]."
+#endif
+#ifndef MQTTc_CFG_LAT_HIST_RANGE_BITS
+#error  "MQTTc_CFG_LAT_HIST_RANGE_BITS not #define'd in 'mqtt-c_cfg.h'. Must be [PRECISION_BITS + 2u; 32u]."
+#elif  ((MQTTc_CFG_LAT_HIST_RANGE_BITS < (MQTTc_CFG_LAT_HIST_PRECISION_BITS + 2u)) || \
+        (MQTTc_CFG_LAT_HIST_RANGE_BITS > 32u))
+#error  "MQTTc_CFG_LAT_HIST_RANGE_BITS illegally #define'd in 'mqtt-c_cfg.h'. Must be [PRECISION_BITS + 2u; 32u]."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_PROF_EN
+#error  "MQTTc_CFG_PROF_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_PROF_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_PROF_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_PROF_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_PROF_CALLBACK_OVERRUN_US
+#error  "MQTTc_CFG_PROF_CALLBACK_OVERRUN_US not #define'd in 'mqtt-c_cfg.h'. Must be >= 1u."
+#elif  (MQTTc_CFG_PROF_CALLBACK_OVERRUN_US < 1u)
+#error  "MQTTc_CFG_PROF_CALLBACK_OVERRUN_US illegally #define'd in 'mqtt-c_cfg.h'. Must be >= 1u."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_MEM_STATS_EN
+#error  "MQTTc_CFG_MEM_STATS_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_MEM_STATS_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_MEM_STATS_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_MEM_STATS_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#endif
+
+#ifndef  MQTTc_CFG_DBG_TRACE_RING_EN
+#error  "MQTTc_CFG_DBG_TRACE_RING_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_DBG_TRACE_RING_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_DBG_TRACE_RING_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_DBG_TRACE_RING_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_DBG_TRACE_RING_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_DBG_TRACE_RING_SIZE
+#error  "MQTTc_CFG_DBG_TRACE_RING_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be a power of 2, >= 2u."
+#elif  ((MQTTc_CFG_DBG_TRACE_RING_SIZE < 2u) || \
+       ((MQTTc_CFG_DBG_TRACE_RING_SIZE & (MQTTc_CFG_DBG_TRACE_RING_SIZE - 1u)) != 0u))
+#error  "MQTTc_CFG_DBG_TRACE_RING_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be a power of 2, >= 2u."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_DBG_TIMELINE_EN
+#error  "MQTTc_CFG_DBG_TIMELINE_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_DBG_TIMELINE_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_DBG_TIMELINE_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_DBG_TIMELINE_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_DBG_TIMELINE_BUF_SIZE
+#error  "MQTTc_CFG_DBG_TIMELINE_BUF_SIZE not #define'd in 'mqtt-c_cfg.h'. Must be >= 1u."
+#elif  (MQTTc_CFG_DBG_TIMELINE_BUF_SIZE < 1u)
+#error  "MQTTc_CFG_DBG_TIMELINE_BUF_SIZE illegally #define'd in 'mqtt-c_cfg.h'. Must be >= 1u."
+#endif
+#endif
+
+#ifndef  MQTTc_CFG_DBG_CAP_EN
+#error  "MQTTc_CFG_DBG_CAP_EN not #define'd in 'mqtt-c_cfg.h'. Must be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif  ((MQTTc_CFG_DBG_CAP_EN != DEF_DISABLED) && \
+        (MQTTc_CFG_DBG_CAP_EN != DEF_ENABLED ))
+#error  "MQTTc_CFG_DBG_CAP_EN illegally #define'd in 'mqtt-c_cfg.h'. MUST be [DEF_DISABLED] or [DEF_ENABLED]."
+#elif   (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+#ifndef MQTTc_CFG_DBG_CAP_BUF_LEN
+#error  "MQTTc_CFG_DBG_CAP_BUF_LEN not #define'd in 'mqtt-c_cfg.h'. Must be a power of 2, >= 256u."
+#elif  ((MQTTc_CFG_DBG_CAP_BUF_LEN < 256u) || \
+       ((MQTTc_CFG_DBG_CAP_BUF_LEN & (MQTTc_CFG_DBG_CAP_BUF_LEN - 1u)) != 0u))
+#error  "MQTTc_CFG_DBG_CAP_BUF_LEN illegally #define'd in 'mqtt-c_cfg.h'. Must be a power of 2, >= 256u."
 #endif
 #endif
 
@@ -0,0 +1,741 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                       RETAINED-VALUE CACHE
+*
+* Filename : mqtt-c_cache.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The cache holds the last payload rx'd on each topic, so that the application can read the
+*                current value of a topic without keeping its own copy. It is kept in a memory region given
+*                by the application, laid out as follows :
+*
+*                    +-----------+-------------------------------------------+
+*                    | Hash tbl  |                   Arena                   |
+*                    +-----------+-------------------------------------------+
+*
+*                (a) The hash tbl is open-addressed, with linear probing. Its load is bounded to 3/4, so
+*                    that lookups take a constant time on average. Entries are removed by shifting back
+*                    the entries that follow them, so that no tombstone is needed.
+*
+*                (b) The arena holds one blk per entry, made of a hdr followed by the topic and the
+*                    payload. Blks are allocated at the end of the arena. A blk whose entry is removed, or
+*                    whose payload no longer fits in it, is left dead in place. When the end of the arena
+*                    is reached, the live blks are moved to its start, in order.
+*
+*            (2) As per the MQTT specification, a retained PUBLISH with an empty payload removes the
+*                retained value of its topic. Any PUBLISH rx'd with an empty payload thus removes its
+*                topic from the cache.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <lib_str.h>
+#include  <cpu.h>
+#include  <KAL/kal.h>
+
+#include  "mqtt-c_cache.h"
+
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_CACHE_ALIGN                                        4u
+
+#define  MQTTc_CACHE_BLK_OFFSET_NONE                     0xFFFFFFFFu
+#define  MQTTc_CACHE_ENTRY_IX_NONE                       0xFFFFFFFFu
+
+#define  MQTTc_CACHE_HASH_INIT                           0x811C9DC5u
+#define  MQTTc_CACHE_HASH_PRIME                          0x01000193u
+
+#define  MQTTc_CACHE_BLK_LEN(len)               (sizeof(MQTTc_CACHE_BLK_HDR) + \
+                                               (((len) + MQTTc_CACHE_ALIGN - 1u) & ~(MQTTc_CACHE_ALIGN - 1u)))
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_cache_blk_hdr {
+    CPU_INT32U  Len;                                            /* Len of blk, hdr included, in bytes.                  */
+    CPU_INT32U  EntryIx;                                        /* Ix of entry in hash tbl. NONE if blk is dead.        */
+    CPU_INT32U  PayloadLen;                                     /* Len of payload, in bytes.                            */
+    CPU_INT16U  TopicLen;                                       /* Len of topic, in bytes.                              */
+    CPU_INT16U  Rsvd;
+} MQTTc_CACHE_BLK_HDR;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U            MQTTc_CacheHash       (const  CPU_INT08U   *p_topic,
+                                                            CPU_INT16U    topic_len);
+
+static  CPU_INT32U            MQTTc_CacheFind       (       MQTTc_CACHE  *p_cache,
+                                                     const  CPU_INT08U   *p_topic,
+                                                            CPU_INT16U    topic_len,
+                                                            CPU_INT32U    hash);
+
+static  void                  MQTTc_CacheRemove     (       MQTTc_CACHE  *p_cache,
+                                                            CPU_INT32U    ix);
+
+static  CPU_INT32U            MQTTc_CacheBlkAlloc   (       MQTTc_CACHE  *p_cache,
+                                                            CPU_INT32U    blk_len);
+
+static  void                  MQTTc_CacheCompact    (       MQTTc_CACHE  *p_cache);
+
+static  MQTTc_CACHE_BLK_HDR  *MQTTc_CacheBlkGet     (       MQTTc_CACHE  *p_cache,
+                                                            CPU_INT32U    offset);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CacheOpen()
+*
+* Description : Open an empty cache over a memory region.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object to open.
+*
+*               p_mem           Pointer to memory region holding the cache. MUST be aligned on 4 bytes.
+*
+*               mem_len         Len of memory region, in bytes.
+*
+*               tbl_size        Nbr of entries of the hash tbl. MUST be a power of 2. At most 3/4 of them
+*                               can be in use. See mqtt-c_cache.c Note #1a.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid geometry of memory region.
+*                                   MQTTc_ERR_ALLOC             Unable to allocate the cache's lock.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The rest of the memory region, after the hash tbl, is the arena that holds the topics
+*                   and the payloads.
+*
+*               (2) The cache MUST be opened before it is set on a connection. See MQTTc_ConnSetParam()
+*                   Note #9.
+*********************************************************************************************************
+*/
+
+void  MQTTc_CacheOpen (MQTTc_CACHE  *p_cache,
+                       void         *p_mem,
+                       CPU_INT32U    mem_len,
+                       CPU_INT32U    tbl_size,
+                       MQTTc_ERR    *p_err)
+{
+    CPU_INT32U  tbl_len;
+    CPU_INT32U  ix;
+    KAL_ERR     err_kal;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if ((p_cache == DEF_NULL) ||
+            (p_mem   == DEF_NULL)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    if ((((CPU_ADDR)p_mem) % MQTTc_CACHE_ALIGN != 0u) ||
+        (  tbl_size                             <  2u) ||
+        (( tbl_size & (tbl_size - 1u))         != 0u) ||
+        (  tbl_size > (DEF_INT_32U_MAX_VAL / sizeof(MQTTc_CACHE_ENTRY)))) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    tbl_len = tbl_size * sizeof(MQTTc_CACHE_ENTRY);             /* See Note #1.                                         */
+    if (mem_len <= tbl_len + sizeof(MQTTc_CACHE_BLK_HDR)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_cache->TblPtr       = (MQTTc_CACHE_ENTRY *)p_mem;
+    p_cache->TblSize      =  tbl_size;
+    p_cache->EntryNbr     =  0u;
+    p_cache->EntryNbrMax  =  tbl_size - (tbl_size / 4u);
+    p_cache->ArenaPtr     = &((CPU_INT08U *)p_mem)[tbl_len];
+    p_cache->ArenaLen     = (mem_len - tbl_len) & ~(MQTTc_CACHE_ALIGN - 1u);
+    p_cache->ArenaUsedLen =  0u;
+    p_cache->ArenaLiveLen =  0u;
+
+    for (ix = 0u; ix < tbl_size; ix++) {
+        p_cache->TblPtr[ix].Hash      = 0u;
+        p_cache->TblPtr[ix].BlkOffset = MQTTc_CACHE_BLK_OFFSET_NONE;
+    }
+
+    p_cache->LockHandle = KAL_LockCreate("MQTTc Cache Lock",
+                                          DEF_NULL,
+                                         &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_ALLOC;
+        return;
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CacheGet()
+*
+* Description : Copy the last payload rx'd on a topic.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+*               topic_str       String containing the topic to look up.
+*
+*               p_buf           Pointer to buffer that will receive the payload.
+*
+*               buf_len         Len of buffer, in bytes.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_CACHE_MISS        Topic is not in the cache.
+*                                   MQTTc_ERR_BUF_OVERFLOW      Payload does not fit in buffer.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : Len of the payload, in bytes, if found,
+*               0,                            otherwise.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The payload is copied while the cache is locked, since its blk can be moved as soon as
+*                   the cache is unlocked. See mqtt-c_cache.c Note #1b.
+*
+*               (2) When the payload does not fit in the buffer, nothing is copied and its len is returned,
+*                   so that the caller can retry with a buffer large enough.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  MQTTc_CacheGet (       MQTTc_CACHE  *p_cache,
+                            const  CPU_CHAR     *topic_str,
+                                   CPU_INT08U   *p_buf,
+                                   CPU_INT32U    buf_len,
+                                   MQTTc_ERR    *p_err)
+{
+    MQTTc_CACHE_BLK_HDR  *p_blk;
+    CPU_INT32U            topic_len;
+    CPU_INT32U            hash;
+    CPU_INT32U            ix;
+    CPU_INT32U            payload_len = 0u;
+    KAL_ERR               err_kal;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(0u);
+        }
+
+        if ((p_cache   == DEF_NULL) ||
+            (topic_str == DEF_NULL)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return (0u);
+        }
+
+        if ((p_buf   == DEF_NULL) &&
+            (buf_len != 0u)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return (0u);
+        }
+    #endif
+
+    topic_len = Str_Len(topic_str);
+    if (topic_len > DEF_INT_16U_MAX_VAL) {                      /* Topic cannot have been rx'd.                         */
+       *p_err = MQTTc_ERR_CACHE_MISS;
+        return (0u);
+    }
+    hash = MQTTc_CacheHash((const CPU_INT08U *)topic_str, (CPU_INT16U)topic_len);
+
+    KAL_LockAcquire(p_cache->LockHandle,
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return (0u);
+    }
+
+    ix = MQTTc_CacheFind(p_cache, (const CPU_INT08U *)topic_str, (CPU_INT16U)topic_len, hash);
+    if (ix == MQTTc_CACHE_ENTRY_IX_NONE) {
+       *p_err = MQTTc_ERR_CACHE_MISS;
+    } else {
+        p_blk       = MQTTc_CacheBlkGet(p_cache, p_cache->TblPtr[ix].BlkOffset);
+        payload_len = p_blk->PayloadLen;
+        if (payload_len > buf_len) {                            /* See Note #2.                                         */
+           *p_err = MQTTc_ERR_BUF_OVERFLOW;
+        } else {
+            Mem_Copy(p_buf,                                     /* See Note #1.                                         */
+                    &((CPU_INT08U *)p_blk)[sizeof(MQTTc_CACHE_BLK_HDR) + p_blk->TopicLen],
+                     payload_len);
+           *p_err = MQTTc_ERR_NONE;
+        }
+    }
+
+    KAL_LockRelease(p_cache->LockHandle, &err_kal);
+    (void)&err_kal;
+
+    return (payload_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_CacheUpdate()
+*
+* Description : Set the last payload rx'd on a topic.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+*               p_topic         Pointer to the topic, as rx'd. Not null-terminated.
+*
+*               topic_len       Len of the topic, in bytes.
+*
+*               p_payload       Pointer to the payload rx'd.
+*
+*               payload_len     Len of the payload, in bytes.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_CACHE_FULL        No room left for the topic.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec().
+*
+* Note(s)     : (1) An empty payload removes the topic from the cache. See mqtt-c_cache.c Note #2.
+*
+*               (2) The payload is written in place when it fits in the blk of the topic. Otherwise, the
+*                   entry is removed and a new blk is allocated.
+*
+*               (3) When there is no room left for the new payload, the topic is left out of the cache,
+*                   so that the application never reads a stale value.
+*********************************************************************************************************
+*/
+
+void  MQTTc_CacheUpdate (       MQTTc_CACHE  *p_cache,
+                         const  CPU_INT08U   *p_topic,
+                                CPU_INT16U    topic_len,
+                         const  CPU_INT08U   *p_payload,
+                                CPU_INT32U    payload_len,
+                                MQTTc_ERR    *p_err)
+{
+    MQTTc_CACHE_BLK_HDR  *p_blk;
+    CPU_INT08U           *p_data;
+    CPU_INT32U            blk_len;
+    CPU_INT32U            blk_offset;
+    CPU_INT32U            hash;
+    CPU_INT32U            ix;
+    CPU_INT32U            mask;
+    KAL_ERR               err_kal;
+
+
+    hash    = MQTTc_CacheHash(p_topic, topic_len);
+    blk_len = MQTTc_CACHE_BLK_LEN((CPU_INT32U)topic_len + payload_len);
+    mask    = p_cache->TblSize - 1u;
+
+    KAL_LockAcquire(p_cache->LockHandle,
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+
+    ix = MQTTc_CacheFind(p_cache, p_topic, topic_len, hash);
+    if (ix != MQTTc_CACHE_ENTRY_IX_NONE) {
+        p_blk = MQTTc_CacheBlkGet(p_cache, p_cache->TblPtr[ix].BlkOffset);
+        if ((payload_len != 0u) &&                              /* See Note #2.                                         */
+            (blk_len     <= p_blk->Len)) {
+            p_data = &((CPU_INT08U *)p_blk)[sizeof(MQTTc_CACHE_BLK_HDR) + topic_len];
+            Mem_Copy(p_data, p_payload, payload_len);
+            p_blk->PayloadLen = payload_len;
+            goto exit_release;
+        }
+
+        MQTTc_CacheRemove(p_cache, ix);                         /* See Note #1.                                         */
+    }
+
+    if (payload_len == 0u) {
+        goto exit_release;
+    }
+
+    if (p_cache->EntryNbr >= p_cache->EntryNbrMax) {            /* See Note #3.                                         */
+       *p_err = MQTTc_ERR_CACHE_FULL;
+        goto exit_release;
+    }
+
+    blk_offset = MQTTc_CacheBlkAlloc(p_cache, blk_len);
+    if (blk_offset == MQTTc_CACHE_BLK_OFFSET_NONE) {
+       *p_err = MQTTc_ERR_CACHE_FULL;
+        goto exit_release;
+    }
+
+    ix = hash & mask;                                           /* Find first free entry from topic's home.             */
+    while (p_cache->TblPtr[ix].BlkOffset != MQTTc_CACHE_BLK_OFFSET_NONE) {
+        ix = (ix + 1u) & mask;
+    }
+
+    p_blk             = MQTTc_CacheBlkGet(p_cache, blk_offset);
+    p_blk->Len        = blk_len;
+    p_blk->EntryIx    = ix;
+    p_blk->PayloadLen = payload_len;
+    p_blk->TopicLen   = topic_len;
+    p_blk->Rsvd       = 0u;
+
+    p_data = &((CPU_INT08U *)p_blk)[sizeof(MQTTc_CACHE_BLK_HDR)];
+    Mem_Copy( p_data,              p_topic,   topic_len);
+    Mem_Copy(&p_data[topic_len],   p_payload, payload_len);
+
+    p_cache->TblPtr[ix].Hash      = hash;
+    p_cache->TblPtr[ix].BlkOffset = blk_offset;
+    p_cache->EntryNbr++;
+
+
+exit_release:
+    KAL_LockRelease(p_cache->LockHandle, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CacheHash()
+*
+* Description : Hash a topic.
+*
+* Argument(s) : p_topic         Pointer to the topic.
+*
+*               topic_len       Len of the topic, in bytes.
+*
+* Return(s)   : Hash of the topic.
+*
+* Caller(s)   : MQTTc_CacheGet(),
+*               MQTTc_CacheUpdate().
+*
+* Note(s)     : (1) 32-bit FNV-1a.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_CacheHash (const  CPU_INT08U  *p_topic,
+                                            CPU_INT16U   topic_len)
+{
+    CPU_INT32U  hash = MQTTc_CACHE_HASH_INIT;
+    CPU_INT16U  ix;
+
+
+    for (ix = 0u; ix < topic_len; ix++) {
+        hash ^= p_topic[ix];
+        hash *= MQTTc_CACHE_HASH_PRIME;
+    }
+
+    return (hash);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CacheFind()
+*
+* Description : Find the entry of a topic in the hash tbl.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+*               p_topic         Pointer to the topic.
+*
+*               topic_len       Len of the topic, in bytes.
+*
+*               hash            Hash of the topic.
+*
+* Return(s)   : Ix of the entry,          if found,
+*               MQTTc_CACHE_ENTRY_IX_NONE, otherwise.
+*
+* Caller(s)   : MQTTc_CacheGet(),
+*               MQTTc_CacheUpdate().
+*
+* Note(s)     : (1) The cache MUST be locked.
+*
+*               (2) The tbl always has a free entry, which ends the probe. See mqtt-c_cache.c Note #1a.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_CacheFind (       MQTTc_CACHE  *p_cache,
+                                     const  CPU_INT08U   *p_topic,
+                                            CPU_INT16U    topic_len,
+                                            CPU_INT32U    hash)
+{
+    MQTTc_CACHE_ENTRY    *p_entry;
+    MQTTc_CACHE_BLK_HDR  *p_blk;
+    CPU_INT32U            mask    = p_cache->TblSize - 1u;
+    CPU_INT32U            ix      = hash & mask;
+    CPU_BOOLEAN           is_eq;
+
+
+    while (DEF_TRUE) {                                          /* See Note #2.                                         */
+        p_entry = &p_cache->TblPtr[ix];
+        if (p_entry->BlkOffset == MQTTc_CACHE_BLK_OFFSET_NONE) {
+            return (MQTTc_CACHE_ENTRY_IX_NONE);
+        }
+
+        if (p_entry->Hash == hash) {
+            p_blk = MQTTc_CacheBlkGet(p_cache, p_entry->BlkOffset);
+            if (p_blk->TopicLen == topic_len) {
+                is_eq = Mem_Cmp(&((CPU_INT08U *)p_blk)[sizeof(MQTTc_CACHE_BLK_HDR)],
+                                  p_topic,
+                                  topic_len);
+                if (is_eq == DEF_YES) {
+                    return (ix);
+                }
+            }
+        }
+
+        ix = (ix + 1u) & mask;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_CacheRemove()
+*
+* Description : Remove an entry from the hash tbl.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+*               ix              Ix of the entry to remove.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CacheUpdate().
+*
+* Note(s)     : (1) The cache MUST be locked.
+*
+*               (2) An entry that follows can take the free entry if the free entry is between its home and
+*                   itself, so that it can still be found by probing from its home. See mqtt-c_cache.c
+*                   Note #1a.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CacheRemove (MQTTc_CACHE  *p_cache,
+                                 CPU_INT32U    ix)
+{
+    MQTTc_CACHE_BLK_HDR  *p_blk;
+    CPU_INT32U            mask  = p_cache->TblSize - 1u;
+    CPU_INT32U            next_ix;
+    CPU_INT32U            home_ix;
+
+
+    p_blk          = MQTTc_CacheBlkGet(p_cache, p_cache->TblPtr[ix].BlkOffset);
+    p_blk->EntryIx = MQTTc_CACHE_ENTRY_IX_NONE;                 /* Blk is dead.                                         */
+    p_cache->ArenaLiveLen -= p_blk->Len;
+    p_cache->EntryNbr--;
+
+    next_ix = ix;
+    while (DEF_TRUE) {
+        next_ix = (next_ix + 1u) & mask;
+        if (p_cache->TblPtr[next_ix].BlkOffset == MQTTc_CACHE_BLK_OFFSET_NONE) {
+            break;
+        }
+
+        home_ix = p_cache->TblPtr[next_ix].Hash & mask;
+        if (((next_ix - home_ix) & mask) >= ((next_ix - ix) & mask)) {
+            p_cache->TblPtr[ix] = p_cache->TblPtr[next_ix];     /* See Note #2.                                         */
+            p_blk               = MQTTc_CacheBlkGet(p_cache, p_cache->TblPtr[ix].BlkOffset);
+            p_blk->EntryIx      = ix;
+            ix                  = next_ix;
+        }
+    }
+
+    p_cache->TblPtr[ix].Hash      = 0u;
+    p_cache->TblPtr[ix].BlkOffset = MQTTc_CACHE_BLK_OFFSET_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_CacheBlkAlloc()
+*
+* Description : Allocate a blk at the end of the arena.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+*               blk_len         Len of the blk, hdr included, in bytes.
+*
+* Return(s)   : Offset of the blk in the arena, if NO error(s),
+*               MQTTc_CACHE_BLK_OFFSET_NONE,   if there is no room left.
+*
+* Caller(s)   : MQTTc_CacheUpdate().
+*
+* Note(s)     : (1) The cache MUST be locked.
+*
+*               (2) The arena is only compacted when the blk would fit once the dead blks are reclaimed.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_CacheBlkAlloc (MQTTc_CACHE  *p_cache,
+                                         CPU_INT32U    blk_len)
+{
+    CPU_INT32U  blk_offset;
+
+
+    if (blk_len > p_cache->ArenaLen - p_cache->ArenaUsedLen) {
+        if (blk_len > p_cache->ArenaLen - p_cache->ArenaLiveLen) {
+            return (MQTTc_CACHE_BLK_OFFSET_NONE);
+        }
+        MQTTc_CacheCompact(p_cache);                            /* See Note #2.                                         */
+    }
+
+    blk_offset             = p_cache->ArenaUsedLen;
+    p_cache->ArenaUsedLen += blk_len;
+    p_cache->ArenaLiveLen += blk_len;
+
+    return (blk_offset);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_CacheCompact()
+*
+* Description : Move the live blks of the arena to its start.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CacheBlkAlloc().
+*
+* Note(s)     : (1) The cache MUST be locked.
+*
+*               (2) Blks are moved in order, towards the start of the arena, so that a blk never overwrites
+*                   a live blk that has not been moved yet.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CacheCompact (MQTTc_CACHE  *p_cache)
+{
+    MQTTc_CACHE_BLK_HDR  *p_blk;
+    CPU_INT32U            rd_offset = 0u;
+    CPU_INT32U            wr_offset = 0u;
+    CPU_INT32U            blk_len;
+    CPU_INT32U            entry_ix;
+
+
+    while (rd_offset < p_cache->ArenaUsedLen) {
+        p_blk    = MQTTc_CacheBlkGet(p_cache, rd_offset);
+        blk_len  = p_blk->Len;
+        entry_ix = p_blk->EntryIx;
+
+        if (entry_ix != MQTTc_CACHE_ENTRY_IX_NONE) {
+            if (wr_offset != rd_offset) {                       /* See Note #2.                                         */
+                Mem_Move(&p_cache->ArenaPtr[wr_offset],
+                         &p_cache->ArenaPtr[rd_offset],
+                          blk_len);
+                p_cache->TblPtr[entry_ix].BlkOffset = wr_offset;
+            }
+            wr_offset += blk_len;
+        }
+
+        rd_offset += blk_len;
+    }
+
+    p_cache->ArenaUsedLen = wr_offset;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_CacheBlkGet()
+*
+* Description : Get a blk of the arena.
+*
+* Argument(s) : p_cache         Pointer to MQTTc Cache object.
+*
+*               offset          Offset of the blk in the arena.
+*
+* Return(s)   : Pointer to the hdr of the blk.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_CACHE_BLK_HDR  *MQTTc_CacheBlkGet (MQTTc_CACHE  *p_cache,
+                                                 CPU_INT32U    offset)
+{
+    return ((MQTTc_CACHE_BLK_HDR *)&p_cache->ArenaPtr[offset]);
+}
+#endif                                                          /* MQTTc_CFG_CACHE_EN                                   */
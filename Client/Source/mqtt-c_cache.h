@@ -0,0 +1,135 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                       RETAINED-VALUE CACHE
+*
+* Filename : mqtt-c_cache.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc cache module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_CACHE_MODULE_PRESENT
+#define  MQTTc_CACHE_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+#if (MQTTc_CFG_CACHE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc CACHE ENTRY
+*
+* Note(s) : (1) An entry is free when its blk offset is MQTTc_CACHE_BLK_OFFSET_NONE.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_cache_entry {
+    CPU_INT32U  Hash;                                           /* Hash of topic.                                       */
+    CPU_INT32U  BlkOffset;                                      /* Offset of blk holding value in arena. See Note #1.   */
+} MQTTc_CACHE_ENTRY;
+
+
+/*
+*********************************************************************************************************
+*                                             MQTTc CACHE
+*********************************************************************************************************
+*/
+
+struct  mqttc_cache {
+    MQTTc_CACHE_ENTRY  *TblPtr;                                 /* Ptr to hash tbl.                                     */
+    CPU_INT32U          TblSize;                                /* Nbr of entries in hash tbl. Power of 2.              */
+    CPU_INT32U          EntryNbr;                               /* Nbr of entries in use.                               */
+    CPU_INT32U          EntryNbrMax;                            /* Max nbr of entries in use, to bound probe len.       */
+
+    CPU_INT08U         *ArenaPtr;                               /* Ptr to arena holding topics and payloads.            */
+    CPU_INT32U          ArenaLen;                               /* Len of arena, in bytes.                              */
+    CPU_INT32U          ArenaUsedLen;                           /* Len of arena allocated, live or not.                 */
+    CPU_INT32U          ArenaLiveLen;                           /* Len of arena allocated to live blks.                 */
+
+    KAL_LOCK_HANDLE     LockHandle;                             /* Lock serializing updates and lookups.                */
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void        MQTTc_CacheOpen   (       MQTTc_CACHE  *p_cache,
+                                      void         *p_mem,
+                                      CPU_INT32U    mem_len,
+                                      CPU_INT32U    tbl_size,
+                                      MQTTc_ERR    *p_err);
+
+CPU_INT32U  MQTTc_CacheGet    (       MQTTc_CACHE  *p_cache,
+                               const  CPU_CHAR     *topic_str,
+                                      CPU_INT08U   *p_buf,
+                                      CPU_INT32U    buf_len,
+                                      MQTTc_ERR    *p_err);
+
+void        MQTTc_CacheUpdate (       MQTTc_CACHE  *p_cache,
+                               const  CPU_INT08U   *p_topic,
+                                      CPU_INT16U    topic_len,
+                               const  CPU_INT08U   *p_payload,
+                                      CPU_INT32U    payload_len,
+                                      MQTTc_ERR    *p_err);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_CACHE_EN                                   */
+#endif
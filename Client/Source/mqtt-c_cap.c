@@ -0,0 +1,846 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                        PCAPNG CAPTURE OF FRAMES
+*
+* Filename : mqtt-c_cap.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The bytes tx'd and rx'd by each conn are captured at the boundary of the sock layer, i.e.
+*                above TLS, so that the MQTT frames can be inspected even on secure conns.
+*
+*            (2) The bytes are recorded in a ring of MQTTc_CFG_DBG_CAP_BUF_LEN bytes, allocated statically.
+*                Once full, the oldest recs are overwritten.
+*
+*                (a) Recs are only written by the MQTTc task, which is the only caller of the sock layer's
+*                    tx and rx functions. The ring is thus written without lock nor critical section.
+*
+*                (b) The ring is read by MQTTc_CapPcapngGet(), from any task, while it is being written.
+*                    The writer moves the tail of the ring past the recs it is about to overwrite before
+*                    writing, and moves the head once the rec is written. The reader checks the tail
+*                    once it has copied a rec, and starts over from the new tail if the rec was
+*                    overwritten meanwhile. This relies on the accesses to the ring being done in program
+*                    order, which volatile accesses ensure on the single-core CPUs targeted.
+*
+*                (c) Writes longer than MQTTc_CAP_SEG_LEN_MAX are split in several recs, like a TCP
+*                    stream is split in segments, so that no rec uses more than a fraction of the ring.
+*
+*            (3) The capture is turned into a pcapng file that Wireshark opens. Since the bytes are
+*                captured above the TCP/IP stack, each rec is framed in synthetic IPv4 and TCP hdrs :
+*
+*                (a) The client is 10.0.0.1 and the broker 10.0.0.2. The broker port is always 1883, so
+*                    that Wireshark dissects the bytes as MQTT, even for secure conns.
+*
+*                (b) Each conn gets its own client port, and its own seq nbrs starting from 1, so that
+*                    each conn is a distinct TCP stream. Recs lost because they were overwritten show up
+*                    as missing segments.
+*
+*                (c) Timestamps are relative to the oldest rec in the file, and extended to 64 bits. Two
+*                    consecutive recs MUST thus be less than a full period of CPU_TS_Get32() apart.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <cpu.h>
+#include  <cpu_core.h>
+
+#include  "mqtt-c_cap.h"
+
+
+#if (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_CAP_BUF_MASK                          (MQTTc_CFG_DBG_CAP_BUF_LEN - 1u)
+
+                                                                /* Max len of data in a rec. See Note #2c.              */
+#define  MQTTc_CAP_SEG_LEN_MAX                       (((MQTTc_CFG_DBG_CAP_BUF_LEN / 4u) < 1460u) ? \
+                                                        (MQTTc_CFG_DBG_CAP_BUF_LEN / 4u) : 1460u)
+
+#define  MQTTc_CAP_LEN_ALIGN(len)                    (((len) + 3u) & ~3u)
+
+#define  MQTTc_CAP_TS_FREQ_DFLT                     1000000u    /* Timestamps are taken as us if freq is unknown.       */
+
+#define  MQTTc_CAP_PORT_BASE                          49152u    /* Client ports, from the dynamic range.                */
+#define  MQTTc_CAP_PORT_NBR                           16384u
+#define  MQTTc_CAP_BROKER_PORT                         1883u    /* See Note #3a.                                        */
+
+#define  MQTTc_CAP_CLIENT_ADDR                   0x0A000001u    /* 10.0.0.1.                                            */
+#define  MQTTc_CAP_BROKER_ADDR                   0x0A000002u    /* 10.0.0.2.                                            */
+
+#define  MQTTc_CAP_IP_HDR_LEN                            20u
+#define  MQTTc_CAP_TCP_HDR_LEN                           20u
+
+#define  MQTTc_CAP_TCP_FLAG_FIN                        0x01u
+#define  MQTTc_CAP_TCP_FLAG_PSH                        0x08u
+#define  MQTTc_CAP_TCP_FLAG_ACK                        0x10u
+
+                                                                /* ----------------- PCAPNG DEFINES ------------------- */
+#define  MQTTc_CAP_PCAPNG_SHB_TYPE               0x0A0D0D0Au    /* Section hdr blk.                                     */
+#define  MQTTc_CAP_PCAPNG_SHB_LEN                        28u
+#define  MQTTc_CAP_PCAPNG_SHB_MAGIC              0x1A2B3C4Du
+#define  MQTTc_CAP_PCAPNG_IDB_TYPE               0x00000001u    /* Interface description blk.                           */
+#define  MQTTc_CAP_PCAPNG_IDB_LEN                        20u
+#define  MQTTc_CAP_PCAPNG_EPB_TYPE               0x00000006u    /* Enhanced pkt blk.                                    */
+#define  MQTTc_CAP_PCAPNG_EPB_HDR_LEN                    28u
+#define  MQTTc_CAP_PCAPNG_LINKTYPE_RAW                  101u    /* Pkts start with their IP hdr.                        */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL DATA TYPES
+*
+* Note(s) : (1) MQTTc_CAP_PCAPNG_LEN_MAX relies on MQTTc_CAP_REC_HDR being 20 bytes long. See mqtt-c_cap.h
+*               DEFINES Note #1.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_cap_rec_hdr {
+    CPU_TS32    TS;                                             /* Timestamp, in CPU_TS_Get32() ticks.                  */
+    CPU_INT32U  TcpSeq;                                         /* Synthetic TCP seq nbr of rec.                        */
+    CPU_INT32U  TcpAck;                                         /* Synthetic TCP ack nbr of rec.                        */
+    CPU_INT16U  Len;                                            /* Len of data following hdr, in bytes.                 */
+    CPU_INT16U  Port;                                           /* Synthetic TCP port of conn.                          */
+    CPU_INT08U  Type;                                           /* Rec type. See MQTTc_CAP_REC_TYPE.                    */
+    CPU_INT08U  Rsvd[3];
+} MQTTc_CAP_REC_HDR;
+
+
+typedef  struct  mqttc_cap_data {
+    volatile  CPU_INT08U   Buf[MQTTc_CFG_DBG_CAP_BUF_LEN];      /* Ring of recs. See Note #2.                           */
+    volatile  CPU_INT32U   Head;                                /* Pos after newest rec, free-running.                  */
+    volatile  CPU_INT32U   Tail;                                /* Pos of oldest rec,    free-running.                  */
+              CPU_BOOLEAN  En;                                  /* Flag indicating if bytes are captured.               */
+              CPU_INT32U   TS_Freq;                             /* Freq of timestamps, in Hz.                           */
+              CPU_INT32U   ConnCtr;                             /* Nbr of conns opened, to give them a port.            */
+} MQTTc_CAP_DATA;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  MQTTc_CAP_DATA  MQTTc_CapData;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapRecWr        (const  MQTTc_CAP_REC_HDR  *p_hdr,
+                                     const  CPU_INT08U         *p_data);
+
+static  void  MQTTc_CapBufWr        (       CPU_INT32U          pos,
+                                     const  void               *p_src,
+                                            CPU_INT32U          len);
+
+static  void  MQTTc_CapBufRd        (       CPU_INT32U          pos,
+                                            void               *p_dst,
+                                            CPU_INT32U          len);
+
+static  void  MQTTc_CapPcapngPktWr  (       CPU_INT08U         *p_buf,
+                                     const  MQTTc_CAP_REC_HDR  *p_hdr,
+                                            CPU_INT16U          ip_id);
+
+static  void  MQTTc_CapPcapngWr16   (       CPU_INT08U         *p_buf,
+                                            CPU_INT16U          val);
+
+static  void  MQTTc_CapPcapngWr32   (       CPU_INT08U         *p_buf,
+                                            CPU_INT32U          val);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     CONFIGURATION ERROR CHECKING
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (CPU_CFG_TS_32_EN != DEF_ENABLED)
+#error  "CPU_CFG_TS_32_EN illegally #define'd in 'cpu_cfg.h'. MUST be DEF_ENABLED when MQTTc_CFG_DBG_CAP_EN is DEF_ENABLED."
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_CapInit()
+*
+* Description : Initialize the capture.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Init().
+*
+* Note(s)     : (1) Bytes are captured by default. See MQTTc_CapEnSet().
+*********************************************************************************************************
+*/
+
+void  MQTTc_CapInit (void)
+{
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    CPU_TS_TMR_FREQ  freq;
+    CPU_ERR          err_cpu;
+#endif
+
+
+    MQTTc_CapData.Head    = 0u;
+    MQTTc_CapData.Tail    = 0u;
+    MQTTc_CapData.ConnCtr = 0u;
+    MQTTc_CapData.TS_Freq = MQTTc_CAP_TS_FREQ_DFLT;
+    MQTTc_CapData.En      = DEF_ENABLED;                        /* See Note #1.                                         */
+
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    freq = CPU_TS_TmrFreqGet(&err_cpu);
+    if ((err_cpu == CPU_ERR_NONE) &&
+        (freq    != 0u)) {
+        MQTTc_CapData.TS_Freq = (CPU_INT32U)freq;
+    }
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_CapConnOpen()
+*
+* Description : Give a newly opened conn its synthetic TCP port and seq nbrs.
+*
+* Argument(s) : p_conn          Pointer to MQTTc_CONN that was opened.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_SockConnOpen(), via MQTTc_CAP_CONN_OPEN().
+*
+* Note(s)     : (1) Conns are opened from the application tasks : the conn ctr is incremented within a
+*                   critical section. See mqtt-c_cap.c Note #3b.
+*********************************************************************************************************
+*/
+
+void  MQTTc_CapConnOpen (MQTTc_CONN  *p_conn)
+{
+    CPU_INT32U  conn_nbr;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    conn_nbr = MQTTc_CapData.ConnCtr;
+    MQTTc_CapData.ConnCtr++;
+    CPU_CRITICAL_EXIT();
+
+    p_conn->CapPort  = (CPU_INT16U)(MQTTc_CAP_PORT_BASE + (conn_nbr % MQTTc_CAP_PORT_NBR));
+    p_conn->CapTxSeq = 1u;
+    p_conn->CapRxSeq = 1u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_CapRec()
+*
+* Description : Record bytes tx'd or rx'd on a conn, or the close of the conn.
+*
+* Argument(s) : p_conn          Pointer to MQTTc_CONN on which the bytes were tx'd or rx'd.
+*
+*               type            Type of rec :
+*                                   MQTTc_CAP_REC_TYPE_TX       Bytes tx'd.
+*                                   MQTTc_CAP_REC_TYPE_RX       Bytes rx'd.
+*                                   MQTTc_CAP_REC_TYPE_CLOSE    Conn closed.
+*
+*               p_data          Pointer to bytes, if any.
+*
+*               len             Nbr of bytes.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_SockTx(),
+*               MQTTc_SockRx(),
+*               MQTTc_SockConnClose(), via MQTTc_CAP_REC().
+*
+* Note(s)     : (1) MUST only be called from the MQTTc task. See mqtt-c_cap.c Note #2a.
+*
+*               (2) The seq nbrs of the conn are advanced even while the capture is disabled, so that the
+*                   bytes not captured show up as missing segments.
+*
+*               (3) A FIN consumes one seq nbr.
+*********************************************************************************************************
+*/
+
+void  MQTTc_CapRec (       MQTTc_CONN          *p_conn,
+                           MQTTc_CAP_REC_TYPE   type,
+                    const  CPU_INT08U          *p_data,
+                           CPU_INT32U           len)
+{
+    MQTTc_CAP_REC_HDR  hdr;
+    CPU_INT32U         seg_len;
+
+
+    if ((len  == 0u) &&                                         /* Nothing tx'd or rx'd.                                */
+        (type != MQTTc_CAP_REC_TYPE_CLOSE)) {
+        return;
+    }
+
+    hdr.TS      = CPU_TS_Get32();
+    hdr.Port    = p_conn->CapPort;
+    hdr.Type    = (CPU_INT08U)type;
+    hdr.Rsvd[0] = 0u;
+    hdr.Rsvd[1] = 0u;
+    hdr.Rsvd[2] = 0u;
+
+    do {                                                        /* Split data in segs. See mqtt-c_cap.c Note #2c.       */
+        seg_len = DEF_MIN(len, MQTTc_CAP_SEG_LEN_MAX);
+        hdr.Len = (CPU_INT16U)seg_len;
+
+        switch (type) {                                         /* See Note #2.                                         */
+            case MQTTc_CAP_REC_TYPE_RX:
+                 hdr.TcpSeq        = p_conn->CapRxSeq;
+                 hdr.TcpAck        = p_conn->CapTxSeq;
+                 p_conn->CapRxSeq += seg_len;
+                 break;
+
+            case MQTTc_CAP_REC_TYPE_CLOSE:
+                 hdr.TcpSeq        = p_conn->CapTxSeq;
+                 hdr.TcpAck        = p_conn->CapRxSeq;
+                 p_conn->CapTxSeq += 1u;                        /* See Note #3.                                         */
+                 break;
+
+            case MQTTc_CAP_REC_TYPE_TX:
+            default:
+                 hdr.TcpSeq        = p_conn->CapTxSeq;
+                 hdr.TcpAck        = p_conn->CapRxSeq;
+                 p_conn->CapTxSeq += seg_len;
+                 break;
+        }
+
+        if (MQTTc_CapData.En == DEF_ENABLED) {
+            MQTTc_CapRecWr(&hdr, p_data);
+        }
+
+        p_data += seg_len;
+        len    -= seg_len;
+    } while (len > 0u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_CapPcapngGet()
+*
+* Description : Write the capture to a buf, as a pcapng file.
+*
+* Argument(s) : p_buf           Pointer to buf that will receive the pcapng file.
+*
+*               buf_len         Len of buf, in bytes. See Note #1.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Parameter passed was a NULL pointer.
+*                                   MQTTc_ERR_BUF_OVERFLOW      Buf too small to hold the whole capture.
+*
+* Return(s)   : Len of the pcapng file, in bytes.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) A buf of MQTTc_CAP_PCAPNG_LEN_MAX bytes always holds the whole capture. If the buf is
+*                   smaller, the newest recs that do not fit are left out, and the file written is still
+*                   valid.
+*
+*               (2) The capture can be read while the MQTTc task writes it. The recs written after the
+*                   head of the ring is read are left out. See mqtt-c_cap.c Note #2b.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  MQTTc_CapPcapngGet (CPU_INT08U  *p_buf,
+                                CPU_INT32U   buf_len,
+                                MQTTc_ERR   *p_err)
+{
+    MQTTc_CAP_REC_HDR  hdr;
+    CPU_INT08U        *p_blk;
+    CPU_INT32U         head;
+    CPU_INT32U         pos;
+    CPU_INT32U         file_len;
+    CPU_INT32U         pkt_len;
+    CPU_INT32U         blk_len;
+    CPU_INT32U         freq;
+    CPU_TS32           ts_last;
+    CPU_INT64U         ts_ticks;
+    CPU_INT64U         ts_us;
+    CPU_INT16U         ip_id;
+    CPU_BOOLEAN        is_first;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(0u);
+        }
+
+        if (p_buf == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return (0u);
+        }
+    #endif
+
+    if (buf_len < (MQTTc_CAP_PCAPNG_SHB_LEN + MQTTc_CAP_PCAPNG_IDB_LEN)) {
+       *p_err = MQTTc_ERR_BUF_OVERFLOW;
+        return (0u);
+    }
+
+                                                                /* ------------------- WR SHB & IDB ------------------- */
+    MQTTc_CapPcapngWr32(&p_buf[0u],  MQTTc_CAP_PCAPNG_SHB_TYPE);
+    MQTTc_CapPcapngWr32(&p_buf[4u],  MQTTc_CAP_PCAPNG_SHB_LEN);
+    MQTTc_CapPcapngWr32(&p_buf[8u],  MQTTc_CAP_PCAPNG_SHB_MAGIC);
+    MQTTc_CapPcapngWr16(&p_buf[12u], 1u);                       /* Major ver.                                           */
+    MQTTc_CapPcapngWr16(&p_buf[14u], 0u);                       /* Minor ver.                                           */
+    MQTTc_CapPcapngWr32(&p_buf[16u], DEF_INT_32U_MAX_VAL);      /* Section len unknown.                                 */
+    MQTTc_CapPcapngWr32(&p_buf[20u], DEF_INT_32U_MAX_VAL);
+    MQTTc_CapPcapngWr32(&p_buf[24u], MQTTc_CAP_PCAPNG_SHB_LEN);
+
+    p_blk = &p_buf[MQTTc_CAP_PCAPNG_SHB_LEN];
+    MQTTc_CapPcapngWr32(&p_blk[0u],  MQTTc_CAP_PCAPNG_IDB_TYPE);
+    MQTTc_CapPcapngWr32(&p_blk[4u],  MQTTc_CAP_PCAPNG_IDB_LEN);
+    MQTTc_CapPcapngWr16(&p_blk[8u],  MQTTc_CAP_PCAPNG_LINKTYPE_RAW);
+    MQTTc_CapPcapngWr16(&p_blk[10u], 0u);
+    MQTTc_CapPcapngWr32(&p_blk[12u], 0u);                       /* No snap len.                                         */
+    MQTTc_CapPcapngWr32(&p_blk[16u], MQTTc_CAP_PCAPNG_IDB_LEN);
+
+    freq = MQTTc_CapData.TS_Freq;
+    head = MQTTc_CapData.Head;                                  /* Recs written after this are left out. See Note #2.   */
+    pos  = MQTTc_CapData.Tail;
+
+restart:
+    file_len = MQTTc_CAP_PCAPNG_SHB_LEN + MQTTc_CAP_PCAPNG_IDB_LEN;
+    ts_ticks = 0u;
+    ts_last  = 0u;
+    ip_id    = 0u;
+    is_first = DEF_YES;
+
+    while ((CPU_INT32S)(head - pos) > 0) {
+        MQTTc_CapBufRd(pos, &hdr, sizeof(hdr));
+        if ((CPU_INT32S)(MQTTc_CapData.Tail - pos) > 0) {       /* Rec overwritten, start over from oldest rec.         */
+            pos = MQTTc_CapData.Tail;
+            goto restart;
+        }
+
+        pkt_len = MQTTc_CAP_IP_HDR_LEN + MQTTc_CAP_TCP_HDR_LEN + hdr.Len;
+        blk_len = MQTTc_CAP_PCAPNG_EPB_HDR_LEN + MQTTc_CAP_LEN_ALIGN(pkt_len) + 4u;
+        if (blk_len > (buf_len - file_len)) {                   /* See Note #1.                                         */
+           *p_err = MQTTc_ERR_BUF_OVERFLOW;
+            return (file_len);
+        }
+
+        p_blk = &p_buf[file_len];
+        MQTTc_CapBufRd(pos + sizeof(hdr),
+                       &p_blk[MQTTc_CAP_PCAPNG_EPB_HDR_LEN + MQTTc_CAP_IP_HDR_LEN + MQTTc_CAP_TCP_HDR_LEN],
+                        hdr.Len);
+        if ((CPU_INT32S)(MQTTc_CapData.Tail - pos) > 0) {
+            pos = MQTTc_CapData.Tail;
+            goto restart;
+        }
+
+        if (is_first == DEF_YES) {                              /* Extend timestamp to 64 bits. See ...                 */
+            ts_last  = hdr.TS;                                  /* ... mqtt-c_cap.c Note #3c.                           */
+            is_first = DEF_NO;
+        }
+        ts_ticks += (CPU_TS32)(hdr.TS - ts_last);
+        ts_last   =  hdr.TS;
+        ts_us     = ((ts_ticks / freq) * 1000000u) +
+                    ((ts_ticks % freq) * 1000000u / freq);
+
+        MQTTc_CapPcapngWr32(&p_blk[0u],  MQTTc_CAP_PCAPNG_EPB_TYPE);
+        MQTTc_CapPcapngWr32(&p_blk[4u],  blk_len);
+        MQTTc_CapPcapngWr32(&p_blk[8u],  0u);                   /* Interface ID.                                        */
+        MQTTc_CapPcapngWr32(&p_blk[12u], (CPU_INT32U)(ts_us >> 32u));
+        MQTTc_CapPcapngWr32(&p_blk[16u], (CPU_INT32U)(ts_us & DEF_INT_32U_MAX_VAL));
+        MQTTc_CapPcapngWr32(&p_blk[20u], pkt_len);              /* Captured len.                                        */
+        MQTTc_CapPcapngWr32(&p_blk[24u], pkt_len);              /* Original len.                                        */
+        MQTTc_CapPcapngPktWr(&p_blk[MQTTc_CAP_PCAPNG_EPB_HDR_LEN], &hdr, ip_id);
+                                                                /* Pad pkt.                                             */
+        Mem_Clr(&p_blk[MQTTc_CAP_PCAPNG_EPB_HDR_LEN + pkt_len],
+                 MQTTc_CAP_LEN_ALIGN(pkt_len) - pkt_len);
+        MQTTc_CapPcapngWr32(&p_blk[blk_len - 4u], blk_len);
+
+        file_len += blk_len;
+        pos      += sizeof(hdr) + MQTTc_CAP_LEN_ALIGN(hdr.Len);
+        ip_id++;
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+
+    return (file_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CapEnSet()
+*
+* Description : Enable or disable the capture.
+*
+* Argument(s) : en              DEF_ENABLED, to capture bytes,
+*                               DEF_DISABLED, otherwise.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) Disabling the capture freezes its content, e.g. once a fault is detected, until it is
+*                   read with MQTTc_CapPcapngGet().
+*********************************************************************************************************
+*/
+
+void  MQTTc_CapEnSet (CPU_BOOLEAN  en)
+{
+    MQTTc_CapData.En = en;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CapRecWr()
+*
+* Description : Write a rec in the ring, overwriting the oldest recs if needed.
+*
+* Argument(s) : p_hdr           Pointer to hdr of rec.
+*
+*               p_data          Pointer to data of rec.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CapRec().
+*
+* Note(s)     : (1) The tail is moved before the recs it passes are overwritten, and the head once the rec
+*                   is written. See mqtt-c_cap.c Note #2b.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapRecWr (const  MQTTc_CAP_REC_HDR  *p_hdr,
+                              const  CPU_INT08U         *p_data)
+{
+    MQTTc_CAP_REC_HDR  hdr_old;
+    CPU_INT32U         rec_len;
+    CPU_INT32U         head;
+    CPU_INT32U         tail;
+
+
+    rec_len = sizeof(MQTTc_CAP_REC_HDR) + MQTTc_CAP_LEN_ALIGN(p_hdr->Len);
+    head    = MQTTc_CapData.Head;
+    tail    = MQTTc_CapData.Tail;
+
+    while ((head + rec_len - tail) > MQTTc_CFG_DBG_CAP_BUF_LEN) {
+        MQTTc_CapBufRd(tail, &hdr_old, sizeof(hdr_old));        /* Skip oldest rec.                                     */
+        tail += sizeof(MQTTc_CAP_REC_HDR) + MQTTc_CAP_LEN_ALIGN(hdr_old.Len);
+    }
+    MQTTc_CapData.Tail = tail;                                  /* See Note #1.                                         */
+
+    MQTTc_CapBufWr(head,                              p_hdr,  sizeof(MQTTc_CAP_REC_HDR));
+    MQTTc_CapBufWr(head + sizeof(MQTTc_CAP_REC_HDR),  p_data, p_hdr->Len);
+
+    MQTTc_CapData.Head = head + rec_len;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CapBufWr()
+*
+* Description : Copy bytes to the ring, wrapping around its end.
+*
+* Argument(s) : pos             Free-running pos at which to copy.
+*
+*               p_src           Pointer to bytes to copy.
+*
+*               len             Nbr of bytes to copy.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CapRecWr().
+*
+* Note(s)     : (1) The ring is accessed byte per byte, through volatile accesses. See mqtt-c_cap.c Note #2b.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapBufWr (       CPU_INT32U   pos,
+                              const  void        *p_src,
+                                     CPU_INT32U   len)
+{
+    const  CPU_INT08U  *p_byte = (const CPU_INT08U *)p_src;
+
+
+    while (len > 0u) {
+        MQTTc_CapData.Buf[pos & MQTTc_CAP_BUF_MASK] = *p_byte;
+        pos++;
+        p_byte++;
+        len--;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_CapBufRd()
+*
+* Description : Copy bytes from the ring, wrapping around its end.
+*
+* Argument(s) : pos             Free-running pos from which to copy.
+*
+*               p_dst           Pointer to buf that will receive the bytes.
+*
+*               len             Nbr of bytes to copy.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CapPcapngGet(),
+*               MQTTc_CapRecWr().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapBufRd (CPU_INT32U   pos,
+                              void        *p_dst,
+                              CPU_INT32U   len)
+{
+    CPU_INT08U  *p_byte = (CPU_INT08U *)p_dst;
+
+
+    while (len > 0u) {
+       *p_byte = MQTTc_CapData.Buf[pos & MQTTc_CAP_BUF_MASK];
+        pos++;
+        p_byte++;
+        len--;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_CapPcapngPktWr()
+*
+* Description : Write the synthetic IPv4 and TCP hdrs of a rec.
+*
+* Argument(s) : p_buf           Pointer to buf that will receive the hdrs.
+*
+*               p_hdr           Pointer to hdr of rec.
+*
+*               ip_id           ID of IPv4 datagram.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CapPcapngGet().
+*
+* Note(s)     : (1) The hdrs are in network order. See mqtt-c_cap.c Note #3.
+*
+*               (2) The TCP checksum is left to 0, which Wireshark does not check by default.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapPcapngPktWr (       CPU_INT08U         *p_buf,
+                                    const  MQTTc_CAP_REC_HDR  *p_hdr,
+                                           CPU_INT16U          ip_id)
+{
+    CPU_INT08U  *p_tcp;
+    CPU_INT32U   ip_len;
+    CPU_INT32U   src_addr;
+    CPU_INT32U   dst_addr;
+    CPU_INT16U   src_port;
+    CPU_INT16U   dst_port;
+    CPU_INT08U   flags;
+    CPU_INT32U   chk_sum;
+    CPU_INT08U   ix;
+
+
+    ip_len = MQTTc_CAP_IP_HDR_LEN + MQTTc_CAP_TCP_HDR_LEN + p_hdr->Len;
+    if (p_hdr->Type == MQTTc_CAP_REC_TYPE_RX) {
+        src_addr = MQTTc_CAP_BROKER_ADDR;
+        dst_addr = MQTTc_CAP_CLIENT_ADDR;
+        src_port = MQTTc_CAP_BROKER_PORT;
+        dst_port = p_hdr->Port;
+    } else {
+        src_addr = MQTTc_CAP_CLIENT_ADDR;
+        dst_addr = MQTTc_CAP_BROKER_ADDR;
+        src_port = p_hdr->Port;
+        dst_port = MQTTc_CAP_BROKER_PORT;
+    }
+    if (p_hdr->Type == MQTTc_CAP_REC_TYPE_CLOSE) {
+        flags = MQTTc_CAP_TCP_FLAG_FIN | MQTTc_CAP_TCP_FLAG_ACK;
+    } else {
+        flags = MQTTc_CAP_TCP_FLAG_PSH | MQTTc_CAP_TCP_FLAG_ACK;
+    }
+
+                                                                /* ---------------------- IP HDR ---------------------- */
+    p_buf[0u]  = 0x45u;                                         /* IPv4, 20-byte hdr.                                   */
+    p_buf[1u]  = 0x00u;
+    p_buf[2u]  = (CPU_INT08U)(ip_len >> 8u);
+    p_buf[3u]  = (CPU_INT08U) ip_len;
+    p_buf[4u]  = (CPU_INT08U)(ip_id  >> 8u);
+    p_buf[5u]  = (CPU_INT08U) ip_id;
+    p_buf[6u]  = 0x40u;                                         /* Don't fragment.                                      */
+    p_buf[7u]  = 0x00u;
+    p_buf[8u]  = 64u;                                           /* TTL.                                                 */
+    p_buf[9u]  = 6u;                                            /* TCP.                                                 */
+    p_buf[10u] = 0x00u;
+    p_buf[11u] = 0x00u;
+    p_buf[12u] = (CPU_INT08U)(src_addr >> 24u);
+    p_buf[13u] = (CPU_INT08U)(src_addr >> 16u);
+    p_buf[14u] = (CPU_INT08U)(src_addr >>  8u);
+    p_buf[15u] = (CPU_INT08U) src_addr;
+    p_buf[16u] = (CPU_INT08U)(dst_addr >> 24u);
+    p_buf[17u] = (CPU_INT08U)(dst_addr >> 16u);
+    p_buf[18u] = (CPU_INT08U)(dst_addr >>  8u);
+    p_buf[19u] = (CPU_INT08U) dst_addr;
+
+    chk_sum = 0u;                                               /* Compute IP hdr checksum.                             */
+    for (ix = 0u; ix < MQTTc_CAP_IP_HDR_LEN; ix += 2u) {
+        chk_sum += ((CPU_INT32U)p_buf[ix] << 8u) | p_buf[ix + 1u];
+    }
+    while ((chk_sum >> 16u) != 0u) {
+        chk_sum = (chk_sum & 0xFFFFu) + (chk_sum >> 16u);
+    }
+    chk_sum    = ~chk_sum;
+    p_buf[10u] = (CPU_INT08U)(chk_sum >> 8u);
+    p_buf[11u] = (CPU_INT08U) chk_sum;
+
+                                                                /* --------------------- TCP HDR ---------------------- */
+    p_tcp      = &p_buf[MQTTc_CAP_IP_HDR_LEN];
+    p_tcp[0u]  = (CPU_INT08U)(src_port >> 8u);
+    p_tcp[1u]  = (CPU_INT08U) src_port;
+    p_tcp[2u]  = (CPU_INT08U)(dst_port >> 8u);
+    p_tcp[3u]  = (CPU_INT08U) dst_port;
+    p_tcp[4u]  = (CPU_INT08U)(p_hdr->TcpSeq >> 24u);
+    p_tcp[5u]  = (CPU_INT08U)(p_hdr->TcpSeq >> 16u);
+    p_tcp[6u]  = (CPU_INT08U)(p_hdr->TcpSeq >>  8u);
+    p_tcp[7u]  = (CPU_INT08U) p_hdr->TcpSeq;
+    p_tcp[8u]  = (CPU_INT08U)(p_hdr->TcpAck >> 24u);
+    p_tcp[9u]  = (CPU_INT08U)(p_hdr->TcpAck >> 16u);
+    p_tcp[10u] = (CPU_INT08U)(p_hdr->TcpAck >>  8u);
+    p_tcp[11u] = (CPU_INT08U) p_hdr->TcpAck;
+    p_tcp[12u] = 0x50u;                                         /* 20-byte hdr.                                         */
+    p_tcp[13u] = flags;
+    p_tcp[14u] = 0xFFu;                                         /* Window.                                              */
+    p_tcp[15u] = 0xFFu;
+    p_tcp[16u] = 0x00u;                                         /* See Note #2.                                         */
+    p_tcp[17u] = 0x00u;
+    p_tcp[18u] = 0x00u;
+    p_tcp[19u] = 0x00u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_CapPcapngWr16()
+*
+* Description : Write a 16-bit field of a pcapng blk.
+*
+* Argument(s) : p_buf           Pointer to field, not necessarily aligned.
+*
+*               val             Value of field.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CapPcapngGet().
+*
+* Note(s)     : (1) See MQTTc_CapPcapngWr32() Note #1.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapPcapngWr16 (CPU_INT08U  *p_buf,
+                                   CPU_INT16U   val)
+{
+    Mem_Copy(p_buf, &val, sizeof(val));                         /* See Note #1.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_CapPcapngWr32()
+*
+* Description : Write a 32-bit field of a pcapng blk.
+*
+* Argument(s) : p_buf           Pointer to field, not necessarily aligned.
+*
+*               val             Value of field.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_CapPcapngGet().
+*
+* Note(s)     : (1) pcapng blks are in the endianness of the writer, which readers detect from the SHB magic.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_CapPcapngWr32 (CPU_INT08U  *p_buf,
+                                   CPU_INT32U   val)
+{
+    Mem_Copy(p_buf, &val, sizeof(val));                         /* See Note #1.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_DBG_CAP_EN                                 */
@@ -0,0 +1,154 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                        PCAPNG CAPTURE OF FRAMES
+*
+* Filename : mqtt-c_cap.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc capture module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_CAP_MODULE_PRESENT
+#define  MQTTc_CAP_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               DEFINES
+*
+* Note(s) : (1) A rec of N bytes of data takes 20 + ALIGN4(N) bytes in the ring : a 20-byte hdr, followed
+*               by its data. In the pcapng file, it takes 28 + ALIGN4(40 + N) + 4 = 72 + ALIGN4(N) bytes :
+*               the 28-byte EPB hdr, the 40-byte IP and TCP hdrs, the data and the 4-byte trailing len.
+*
+*               (a) Each rec thus grows by 52 bytes, whatever its len. A ring of L bytes holds at most
+*                   L / 20 recs, and at most L bytes of recs, so its recs take at most L + (52 * (L / 20))
+*                   bytes in the file. For recs with no data, this is 3.6 times the len of the ring.
+*
+*               (b) The file also holds the 28-byte SHB and the 20-byte IDB, hence the 48 bytes added.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+                                                                /* Len of a buf that always holds the whole capture.    */
+#define  MQTTc_CAP_PCAPNG_LEN_MAX                     (MQTTc_CFG_DBG_CAP_BUF_LEN + \
+                                                       (52u * (MQTTc_CFG_DBG_CAP_BUF_LEN / 20u)) + 48u)
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                        MQTTc CAPTURE REC TYPE
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_cap_rec_type {
+    MQTTc_CAP_REC_TYPE_TX = 0u,                                 /* Bytes tx'd to the broker.                            */
+    MQTTc_CAP_REC_TYPE_RX,                                      /* Bytes rx'd from the broker.                          */
+    MQTTc_CAP_REC_TYPE_CLOSE                                    /* Conn closed by the client.                           */
+} MQTTc_CAP_REC_TYPE;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MACRO'S
+*
+* Note(s) : (1) When the capture is disabled, the macros expand to nothing and the hot path is unchanged.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+#define  MQTTc_CAP_CONN_OPEN(p_conn)                             MQTTc_CapConnOpen((p_conn))
+
+#define  MQTTc_CAP_REC(p_conn, type, p_data, len)                MQTTc_CapRec((p_conn), (type), (p_data), (len))
+#else
+#define  MQTTc_CAP_CONN_OPEN(p_conn)
+#define  MQTTc_CAP_REC(p_conn, type, p_data, len)
+#endif
+
+
+#if (MQTTc_CFG_DBG_CAP_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void        MQTTc_CapInit      (void);
+
+void        MQTTc_CapConnOpen  (       MQTTc_CONN          *p_conn);
+
+void        MQTTc_CapRec       (       MQTTc_CONN          *p_conn,
+                                       MQTTc_CAP_REC_TYPE   type,
+                                const  CPU_INT08U          *p_data,
+                                       CPU_INT32U           len);
+
+CPU_INT32U  MQTTc_CapPcapngGet (       CPU_INT08U          *p_buf,
+                                       CPU_INT32U           buf_len,
+                                       MQTTc_ERR           *p_err);
+
+void        MQTTc_CapEnSet     (       CPU_BOOLEAN          en);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_DBG_CAP_EN                                 */
+#endif
@@ -0,0 +1,521 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                    PUBLISH-TO-ACK LATENCY HISTOGRAMS
+*
+* Filename : mqtt-c_lat.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) Each histogram is log-linear and uses a fixed amount of memory. With P the nbr of bits of
+*                precision (MQTTc_CFG_LAT_HIST_PRECISION_BITS) :
+*
+*                (a) Latencies below 2^(P + 1) us each have their own bucket.
+*
+*                (b) Each power of 2 above is split in 2^P buckets of equal width, so that a bucket is never
+*                    wider than 1 / 2^P of the latencies it holds (12.5 % for P = 3).
+*
+*                (c) Latencies of 2^MQTTc_CFG_LAT_HIST_RANGE_BITS us or more are counted in the last bucket.
+*                    The max latency is still kept exactly.
+*
+*            (2) The histograms are only updated by the MQTTc task. The application reads them through
+*                MQTTc_LatHistGet(), which copies a histogram within a critical section, so that its
+*                counters are consistent with each other.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <cpu.h>
+#include  <cpu_core.h>
+
+#include  "mqtt-c_lat.h"
+
+
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_LAT_PCT_X100_MAX                       10000u    /* 100.00 %.                                            */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_LatHistIxGet    (       CPU_INT32U       val_us);
+
+static  CPU_INT32U  MQTTc_LatHistIxValGet (       CPU_INT32U       ix);
+
+static  void        MQTTc_LatHistAdd      (       MQTTc_LAT_HIST  *p_hist,
+                                                  CPU_INT32U       val_us);
+
+static  CPU_INT32U  MQTTc_LatElapsedGet   (       CPU_TS32         ts_start,
+                                                  CPU_TS32         ts_end);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     CONFIGURATION ERROR CHECKING
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (CPU_CFG_TS_32_EN != DEF_ENABLED)
+#error  "CPU_CFG_TS_32_EN illegally #define'd in 'cpu_cfg.h'. MUST be DEF_ENABLED when MQTTc_CFG_LAT_EN is DEF_ENABLED."
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_LatClr()
+*
+* Description : Clear every histogram of a MQTTc Latency object.
+*
+* Argument(s) : p_lat           Pointer to MQTTc Latency object to clear.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The object MUST be cleared before it is set on a connection. It can be cleared again at any
+*                   time afterwards, e.g. between two phases of a benchmark.
+*
+*               (2) Each histogram is cleared within its own critical section, to keep them short.
+*********************************************************************************************************
+*/
+
+void  MQTTc_LatClr (MQTTc_LAT  *p_lat,
+                    MQTTc_ERR  *p_err)
+{
+    CPU_INT08U  qos_ix;
+    CPU_INT08U  type;
+    CPU_SR_ALLOC();
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if (p_lat == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    for (qos_ix = 0u; qos_ix < MQTTc_LAT_QOS_NBR; qos_ix++) {
+        for (type = 0u; type < MQTTc_LAT_TYPE_NBR; type++) {
+            CPU_CRITICAL_ENTER();                               /* See Note #2.                                         */
+            Mem_Clr(&p_lat->HistTbl[qos_ix][type], sizeof(MQTTc_LAT_HIST));
+            CPU_CRITICAL_EXIT();
+        }
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_LatHistGet()
+*
+* Description : Copy a histogram of a MQTTc Latency object.
+*
+* Argument(s) : p_lat           Pointer to MQTTc Latency object.
+*
+*               qos             QoS lvl of the msgs of the histogram. MUST be 1 or 2.
+*
+*               type            Type of latency of the histogram :
+*                                   MQTTc_LAT_TYPE_Q            From post to first byte tx'd.
+*                                   MQTTc_LAT_TYPE_TX           From first to last byte tx'd.
+*                                   MQTTc_LAT_TYPE_ACK          From last byte tx'd to ack rx'd.
+*                                   MQTTc_LAT_TYPE_TOTAL        From post to ack rx'd.
+*
+*               p_hist          Pointer to variable that will receive the copy of the histogram.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid QoS lvl or latency type.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) See mqtt-c_lat.c Note #2.
+*********************************************************************************************************
+*/
+
+void  MQTTc_LatHistGet (MQTTc_LAT       *p_lat,
+                        CPU_INT08U       qos,
+                        MQTTc_LAT_TYPE   type,
+                        MQTTc_LAT_HIST  *p_hist,
+                        MQTTc_ERR       *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if ((p_lat  == DEF_NULL) ||
+            (p_hist == DEF_NULL)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    if ((qos  <  1u)                 ||
+        (qos  >  MQTTc_LAT_QOS_NBR)  ||
+        (type >= MQTTc_LAT_TYPE_NBR)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    Mem_Copy(p_hist, &p_lat->HistTbl[qos - 1u][type], sizeof(MQTTc_LAT_HIST));
+    CPU_CRITICAL_EXIT();
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                     MQTTc_LatHistPercentileGet()
+*
+* Description : Get a percentile of the latencies recorded in a histogram.
+*
+* Argument(s) : p_hist          Pointer to histogram, as copied by MQTTc_LatHistGet().
+*
+*               pct_x100        Percentile, in hundredths of percent. E.g. 9990 for the 99.9th percentile.
+*                               MUST be [0; 10000].
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid percentile.
+*
+* Return(s)   : Latency, in us, that is greater than or equal to the given percentage of the samples.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The latency returned is the highest one that shares the bucket of the percentile, so
+*                   that it is never below the exact percentile. It is bounded by the max latency recorded.
+*                   See mqtt-c_lat.c Note #1b.
+*
+*               (2) 0 is returned if the histogram holds no sample.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  MQTTc_LatHistPercentileGet (const  MQTTc_LAT_HIST  *p_hist,
+                                               CPU_INT16U       pct_x100,
+                                               MQTTc_ERR       *p_err)
+{
+    CPU_INT64U  rank;
+    CPU_INT64U  cnt;
+    CPU_INT32U  ix;
+    CPU_INT32U  val_us;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(0u);
+        }
+
+        if (p_hist == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return (0u);
+        }
+    #endif
+
+    if (pct_x100 > MQTTc_LAT_PCT_X100_MAX) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return (0u);
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+
+    if (p_hist->SampleNbr == 0u) {                              /* See Note #2.                                         */
+        return (0u);
+    }
+                                                                /* Rank of the sample at the percentile, from 1.        */
+    rank = (((CPU_INT64U)p_hist->SampleNbr * pct_x100) + MQTTc_LAT_PCT_X100_MAX - 1u) / MQTTc_LAT_PCT_X100_MAX;
+    if (rank == 0u) {
+        return (p_hist->Min_us);
+    }
+
+    cnt = 0u;
+    for (ix = 0u; ix < MQTTc_LAT_HIST_BUCKET_NBR; ix++) {
+        cnt += p_hist->CtrTbl[ix];
+        if (cnt >= rank) {
+            break;
+        }
+    }
+
+    val_us = MQTTc_LatHistIxValGet(ix);                         /* See Note #1.                                         */
+    val_us = DEF_MIN(val_us, p_hist->Max_us);
+
+    return (val_us);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_LatRecord()
+*
+* Description : Record the latencies of a PUBLISH msg whose ack has been rx'd.
+*
+* Argument(s) : p_lat           Pointer to MQTTc Latency object.
+*
+*               p_msg           Pointer to PUBLISH msg, of QoS 1 or 2.
+*
+*               ts_ack          Timestamp at which the ack was rx'd.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec().
+*
+* Note(s)     : (1) See mqtt-c_lat.h 'MQTTc LATENCY TYPE Note #1' for the timestamps used.
+*********************************************************************************************************
+*/
+
+void  MQTTc_LatRecord (MQTTc_LAT  *p_lat,
+                       MQTTc_MSG  *p_msg,
+                       CPU_TS32    ts_ack)
+{
+    MQTTc_LAT_HIST  *p_hist_tbl;
+    CPU_INT32U       q_us;
+    CPU_INT32U       tx_us;
+    CPU_INT32U       ack_us;
+    CPU_INT32U       total_us;
+    CPU_SR_ALLOC();
+
+
+    if ((p_msg->QoS < 1u) ||
+        (p_msg->QoS > MQTTc_LAT_QOS_NBR)) {
+        return;
+    }
+
+    q_us       = MQTTc_LatElapsedGet(p_msg->LatPostTS,    p_msg->LatTxStartTS);
+    tx_us      = MQTTc_LatElapsedGet(p_msg->LatTxStartTS, p_msg->LatTxEndTS);
+    ack_us     = MQTTc_LatElapsedGet(p_msg->LatTxEndTS,   ts_ack);
+    total_us   = MQTTc_LatElapsedGet(p_msg->LatPostTS,    ts_ack);
+    p_hist_tbl = &p_lat->HistTbl[p_msg->QoS - 1u][0u];
+
+    CPU_CRITICAL_ENTER();
+    MQTTc_LatHistAdd(&p_hist_tbl[MQTTc_LAT_TYPE_Q],     q_us);
+    MQTTc_LatHistAdd(&p_hist_tbl[MQTTc_LAT_TYPE_TX],    tx_us);
+    MQTTc_LatHistAdd(&p_hist_tbl[MQTTc_LAT_TYPE_ACK],   ack_us);
+    MQTTc_LatHistAdd(&p_hist_tbl[MQTTc_LAT_TYPE_TOTAL], total_us);
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_LatHistIxGet()
+*
+* Description : Get the ix of the bucket holding a latency.
+*
+* Argument(s) : val_us          Latency, in us.
+*
+* Return(s)   : Ix of bucket.
+*
+* Caller(s)   : MQTTc_LatHistAdd().
+*
+* Note(s)     : (1) With m the ix of the most significant bit of the latency and s = m - P, the latency is
+*                   in the (s + 1)th power of 2 above the linear buckets, and its P + 1 most significant
+*                   bits select the bucket in it. See mqtt-c_lat.c Note #1.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_LatHistIxGet (CPU_INT32U  val_us)
+{
+    CPU_INT32U  msb;
+    CPU_INT32U  shift;
+
+
+    if (val_us < (2u * MQTTc_LAT_HIST_SUB_BUCKET_NBR)) {        /* See mqtt-c_lat.c Note #1a.                           */
+        return (val_us);
+    }
+
+    msb = DEF_INT_32_NBR_BITS - 1u - CPU_CntLeadZeros(val_us);
+    if (msb >= MQTTc_CFG_LAT_HIST_RANGE_BITS) {                 /* See mqtt-c_lat.c Note #1c.                           */
+        return (MQTTc_LAT_HIST_BUCKET_NBR - 1u);
+    }
+
+    shift = msb - MQTTc_CFG_LAT_HIST_PRECISION_BITS;            /* See Note #1.                                         */
+
+    return ((shift << MQTTc_CFG_LAT_HIST_PRECISION_BITS) + (val_us >> shift));
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_LatHistIxValGet()
+*
+* Description : Get the highest latency held by a bucket.
+*
+* Argument(s) : ix              Ix of bucket.
+*
+* Return(s)   : Highest latency held by the bucket, in us.
+*
+* Caller(s)   : MQTTc_LatHistPercentileGet().
+*
+* Note(s)     : (1) Inverse of MQTTc_LatHistIxGet().
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_LatHistIxValGet (CPU_INT32U  ix)
+{
+    CPU_INT32U  shift;
+    CPU_INT64U  top;
+
+
+    if (ix < (2u * MQTTc_LAT_HIST_SUB_BUCKET_NBR)) {
+        return (ix);
+    }
+
+    shift = (ix >> MQTTc_CFG_LAT_HIST_PRECISION_BITS) - 1u;
+    top   =  ix - (shift << MQTTc_CFG_LAT_HIST_PRECISION_BITS);
+
+    return ((CPU_INT32U)(((top + 1u) << shift) - 1u));
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_LatHistAdd()
+*
+* Description : Add a sample to a histogram.
+*
+* Argument(s) : p_hist          Pointer to histogram.
+*
+*               val_us          Latency, in us.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_LatRecord().
+*
+* Note(s)     : (1) This function MUST be called within a critical section.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_LatHistAdd (MQTTc_LAT_HIST  *p_hist,
+                                CPU_INT32U       val_us)
+{
+    if ((p_hist->SampleNbr == 0u) ||
+        (val_us            <  p_hist->Min_us)) {
+        p_hist->Min_us = val_us;
+    }
+    if (val_us > p_hist->Max_us) {
+        p_hist->Max_us = val_us;
+    }
+
+    p_hist->SampleNbr++;
+    p_hist->Sum_us += val_us;
+    p_hist->CtrTbl[MQTTc_LatHistIxGet(val_us)]++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_LatElapsedGet()
+*
+* Description : Get the time elapsed between two timestamps.
+*
+* Argument(s) : ts_start        Timestamp at start.
+*
+*               ts_end          Timestamp at end.
+*
+* Return(s)   : Time elapsed, in us, bounded to DEF_INT_32U_MAX_VAL.
+*
+* Caller(s)   : MQTTc_LatRecord().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_LatElapsedGet (CPU_TS32  ts_start,
+                                         CPU_TS32  ts_end)
+{
+    CPU_INT64U  elapsed_us;
+
+
+    elapsed_us = CPU_TS32_to_uSec((CPU_TS32)(ts_end - ts_start));
+    if (elapsed_us > DEF_INT_32U_MAX_VAL) {
+        elapsed_us = DEF_INT_32U_MAX_VAL;
+    }
+
+    return ((CPU_INT32U)elapsed_us);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_LAT_EN                                     */
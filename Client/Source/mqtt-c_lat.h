@@ -0,0 +1,167 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                    PUBLISH-TO-ACK LATENCY HISTOGRAMS
+*
+* Filename : mqtt-c_lat.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc latency module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_LAT_MODULE_PRESENT
+#define  MQTTc_LAT_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+#if (MQTTc_CFG_LAT_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_LAT_QOS_NBR                                2u    /* Histograms are kept for QoS 1 and 2.                 */
+
+                                                                /* Nbr of buckets per power of 2. See mqtt-c_lat.c ...  */
+                                                                /* Note #1.                                             */
+#define  MQTTc_LAT_HIST_SUB_BUCKET_NBR          (1u << MQTTc_CFG_LAT_HIST_PRECISION_BITS)
+
+#define  MQTTc_LAT_HIST_BUCKET_NBR             ((MQTTc_CFG_LAT_HIST_RANGE_BITS - MQTTc_CFG_LAT_HIST_PRECISION_BITS + 1u) * \
+                                                  MQTTc_LAT_HIST_SUB_BUCKET_NBR)
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc LATENCY TYPE
+*
+* Note(s) : (1) Each latency is measured between two of the timestamps taken for a PUBLISH msg :
+*
+*                   (a) When it is posted, or fed from the store.
+*                   (b) When its first byte is tx'd.
+*                   (c) When its last  byte is tx'd.
+*                   (d) When its PUBACK (QoS 1) or PUBCOMP (QoS 2) is rx'd.
+*
+*               The ACK latency of a QoS 2 msg thus includes the PUBREC/PUBREL round trip.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_lat_type {
+    MQTTc_LAT_TYPE_Q = 0u,                                      /* From (a) to (b) : queueing delay.                    */
+    MQTTc_LAT_TYPE_TX,                                          /* From (b) to (c) : tx delay.                          */
+    MQTTc_LAT_TYPE_ACK,                                         /* From (c) to (d) : network and broker delay.          */
+    MQTTc_LAT_TYPE_TOTAL,                                       /* From (a) to (d) : end-to-end delay.                  */
+    MQTTc_LAT_TYPE_NBR                                          /* Nbr of latency types. MUST be last.                  */
+} MQTTc_LAT_TYPE;
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc LATENCY HISTOGRAM
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_lat_hist {
+    CPU_INT32U  SampleNbr;                                      /* Nbr of samples recorded.                             */
+    CPU_INT32U  Min_us;                                         /* Min sample, in us.                                   */
+    CPU_INT32U  Max_us;                                         /* Max sample, in us.                                   */
+    CPU_INT64U  Sum_us;                                         /* Sum of samples, in us.                               */
+    CPU_INT32U  CtrTbl[MQTTc_LAT_HIST_BUCKET_NBR];              /* Nbr of samples per bucket.                           */
+} MQTTc_LAT_HIST;
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc LATENCY
+*********************************************************************************************************
+*/
+
+struct  mqttc_lat {
+                                                                /* Histograms, per QoS lvl (1 and 2) and latency type.  */
+    MQTTc_LAT_HIST  HistTbl[MQTTc_LAT_QOS_NBR][MQTTc_LAT_TYPE_NBR];
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void        MQTTc_LatClr                (       MQTTc_LAT       *p_lat,
+                                                MQTTc_ERR       *p_err);
+
+void        MQTTc_LatHistGet            (       MQTTc_LAT       *p_lat,
+                                                CPU_INT08U       qos,
+                                                MQTTc_LAT_TYPE   type,
+                                                MQTTc_LAT_HIST  *p_hist,
+                                                MQTTc_ERR       *p_err);
+
+CPU_INT32U  MQTTc_LatHistPercentileGet  (const  MQTTc_LAT_HIST  *p_hist,
+                                                CPU_INT16U       pct_x100,
+                                                MQTTc_ERR       *p_err);
+
+void        MQTTc_LatRecord             (       MQTTc_LAT       *p_lat,
+                                                MQTTc_MSG       *p_msg,
+                                                CPU_TS32         ts_ack);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_LAT_EN                                     */
+#endif
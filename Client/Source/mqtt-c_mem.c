@@ -0,0 +1,462 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                          MEMORY ACCOUNTING
+*
+* Filename : mqtt-c_mem.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The usage is updated by the MQTTc task and by the application tasks that post msgs, within
+*                critical sections. MQTTc_MemStatsGet() copies it within a critical section too, so that
+*                the total is consistent with the usage of each type.
+*
+*            (2) The task's stk is painted with zeros by MQTTc_Init(), before the task is created. Its
+*                high-water mark is the len of the stk minus the nbr of bytes still zero at its far end.
+*                Zero is used since the OS may itself clear the stk when it creates the task. A zero
+*                written by the task at the far end is thus counted as unused, as OS stk checks do.
+*
+*            (3) The memory of the debug modules, and of the objects attached to a conn by the application
+*                (store, write-ahead log, cache and latency histograms), is not accounted.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <cpu.h>
+#include  <cpu_core.h>
+
+#include  "mqtt-c_mem.h"
+
+
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_mem_data {
+    MQTTc_MEM_USAGE   UsageTbl[MQTTc_MEM_TYPE_NBR];             /* Usage, per type. See Note #1.                        */
+    MQTTc_MEM_USAGE   Total;                                    /* Usage of all types.                                  */
+    CPU_INT08U       *TaskStkPtr;                               /* Ptr to the task's stk, painted. See Note #2.         */
+    CPU_INT32U        TaskStkLen;                               /* Size of the task's stk, in bytes.                    */
+} MQTTc_MEM_DATA;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  MQTTc_MEM_DATA  MQTTc_MemData;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_MemTaskStkUsedGet  (void);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_MemStatsGet()
+*
+* Description : Copy the memory usage of the MQTTc module.
+*
+* Argument(s) : p_stats         Pointer to variable that will receive the copy of the usage.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) See mqtt-c_mem.c Note #1.
+*
+*               (2) The task's stk is probed outside of the critical section, since its whole len may be
+*                   read. See mqtt-c_mem.c Note #2.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemStatsGet (MQTTc_MEM_STATS  *p_stats,
+                         MQTTc_ERR        *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if (p_stats == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    Mem_Copy(&p_stats->UsageTbl[0u], &MQTTc_MemData.UsageTbl[0u], sizeof(MQTTc_MemData.UsageTbl));
+    p_stats->Total      = MQTTc_MemData.Total;
+    p_stats->TaskStkLen = MQTTc_MemData.TaskStkLen;
+    CPU_CRITICAL_EXIT();
+
+    p_stats->TaskStkLenMax = MQTTc_MemTaskStkUsedGet();         /* See Note #2.                                         */
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_MemInit()
+*
+* Description : Clear the memory usage.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemInit (void)
+{
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    Mem_Clr(&MQTTc_MemData, sizeof(MQTTc_MEM_DATA));
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_MemTaskStkSet()
+*
+* Description : Paint the stk of the MQTTc task and keep it to probe its high-water mark.
+*
+* Argument(s) : p_stk           Pointer to the task's stk.
+*
+*               len             Size of the task's stk, in bytes.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Init().
+*
+* Note(s)     : (1) MUST be called before the task is created. See mqtt-c_mem.c Note #2.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemTaskStkSet (void        *p_stk,
+                           CPU_INT32U   len)
+{
+    Mem_Clr(p_stk, len);                                        /* See Note #1.                                         */
+
+    MQTTc_MemData.TaskStkPtr = (CPU_INT08U *)p_stk;
+    MQTTc_MemData.TaskStkLen =  len;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_MemAdd()
+*
+* Description : Account for bytes put in use.
+*
+* Argument(s) : type            Type of memory. See MQTTc_MEM_TYPE.
+*
+*               len             Nbr of bytes.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Init(),
+*               MQTTc_MemConnAdd(),
+*               MQTTc_MemMsgAdd(),
+*               MQTTc_MsgPost().
+*
+* Note(s)     : (1) See MQTTc_MEM_TYPE Note #3.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemAdd (MQTTc_MEM_TYPE  type,
+                    CPU_INT32U      len)
+{
+    MQTTc_MEM_USAGE  *p_usage = &MQTTc_MemData.UsageTbl[type];
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_usage->Len += len;
+    if (p_usage->Len > p_usage->LenMax) {
+        p_usage->LenMax = p_usage->Len;
+    }
+
+    if (type != MQTTc_MEM_TYPE_TX_Q) {                          /* See Note #1.                                         */
+        MQTTc_MemData.Total.Len += len;
+        if (MQTTc_MemData.Total.Len > MQTTc_MemData.Total.LenMax) {
+            MQTTc_MemData.Total.LenMax = MQTTc_MemData.Total.Len;
+        }
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_MemRemove()
+*
+* Description : Account for bytes no longer in use.
+*
+* Argument(s) : type            Type of memory. See MQTTc_MEM_TYPE.
+*
+*               len             Nbr of bytes. MUST have been added with MQTTc_MemAdd() before.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MemConnRemove(),
+*               MQTTc_MemMsgRemove(),
+*               MQTTc_TxQ_Release().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemRemove (MQTTc_MEM_TYPE  type,
+                       CPU_INT32U      len)
+{
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    MQTTc_MemData.UsageTbl[type].Len -= len;
+    if (type != MQTTc_MEM_TYPE_TX_Q) {
+        MQTTc_MemData.Total.Len -= len;
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_MemConnAdd()
+*
+* Description : Account for a conn that is opened, and for the bufs it borrows from the application.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgProcess().
+*
+* Note(s)     : (1) The lens accounted are kept in the conn, since the application could change its bufs
+*                   while it is open.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemConnAdd (MQTTc_CONN  *p_conn)
+{
+    p_conn->MemRxBufLen = 0u;                                   /* See Note #1.                                         */
+    if (p_conn->PublishRxMsgPtr != DEF_NULL) {
+        p_conn->MemRxBufLen = sizeof(MQTTc_MSG) + p_conn->PublishRxMsgPtr->BufLen;
+    }
+
+    p_conn->MemTxBufLen = 0u;
+    if (p_conn->TxBufPtr != DEF_NULL) {
+        p_conn->MemTxBufLen = p_conn->TxBufLen;
+    }
+
+    MQTTc_MemAdd(MQTTc_MEM_TYPE_CONN,   sizeof(MQTTc_CONN));
+    MQTTc_MemAdd(MQTTc_MEM_TYPE_RX_BUF, p_conn->MemRxBufLen);
+    MQTTc_MemAdd(MQTTc_MEM_TYPE_TX_BUF, p_conn->MemTxBufLen);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_MemConnRemove()
+*
+* Description : Account for a conn that is closed.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnRemove().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemConnRemove (MQTTc_CONN  *p_conn)
+{
+    MQTTc_MemRemove(MQTTc_MEM_TYPE_CONN,   sizeof(MQTTc_CONN));
+    MQTTc_MemRemove(MQTTc_MEM_TYPE_RX_BUF, p_conn->MemRxBufLen);
+    MQTTc_MemRemove(MQTTc_MEM_TYPE_TX_BUF, p_conn->MemTxBufLen);
+
+    p_conn->MemRxBufLen = 0u;
+    p_conn->MemTxBufLen = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_MemMsgAdd()
+*
+* Description : Account for a msg, and its buf, posted to the MQTTc task.
+*
+* Argument(s) : p_msg           Pointer to MQTTc Message object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgPost().
+*
+* Note(s)     : (1) The len accounted is kept in the msg, the same way as its len in the tx q.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemMsgAdd (MQTTc_MSG  *p_msg)
+{
+    p_msg->MemLen = sizeof(MQTTc_MSG) + p_msg->BufLen;          /* See Note #1.                                         */
+
+    MQTTc_MemAdd(MQTTc_MEM_TYPE_MSG, p_msg->MemLen);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_MemMsgRemove()
+*
+* Description : Account for a msg that cmpl'd, if it was accounted.
+*
+* Argument(s) : p_msg           Pointer to MQTTc Message object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemMsgRemove (MQTTc_MSG  *p_msg)
+{
+    if (p_msg->MemLen != 0u) {
+        MQTTc_MemRemove(MQTTc_MEM_TYPE_MSG, p_msg->MemLen);
+        p_msg->MemLen = 0u;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_MemTaskStkUsedGet()
+*
+* Description : Probe the high-water mark of the MQTTc task's stk.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Max nbr of bytes of the stk used so far, or 0 if the stk was not painted.
+*
+* Caller(s)   : MQTTc_MemStatsGet().
+*
+* Note(s)     : (1) The bytes still zero are counted from the end of the stk the task grows toward. See
+*                   mqtt-c_mem.c Note #2.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_MemTaskStkUsedGet (void)
+{
+    CPU_INT08U  *p_stk = MQTTc_MemData.TaskStkPtr;
+    CPU_INT32U   len   = MQTTc_MemData.TaskStkLen;
+    CPU_INT32U   free_len;
+
+
+    if (p_stk == DEF_NULL) {
+        return (0u);
+    }
+
+    free_len = 0u;                                              /* See Note #1.                                         */
+#if (CPU_CFG_STK_GROWTH == CPU_STK_GROWTH_HI_TO_LO)
+    while ((free_len         < len) &&
+           (p_stk[free_len] == 0u)) {
+        free_len++;
+    }
+#else
+    while ((free_len                   < len) &&
+           (p_stk[len - 1u - free_len] == 0u)) {
+        free_len++;
+    }
+#endif
+
+    return (len - free_len);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_MEM_STATS_EN                               */
@@ -0,0 +1,191 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                          MEMORY ACCOUNTING
+*
+* Filename : mqtt-c_mem.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc memory accounting module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_MEM_MODULE_PRESENT
+#define  MQTTc_MEM_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           MQTTc MEM TYPE
+*
+* Note(s) : (1) Memory owned by the MQTTc module, allocated from the memory segment passed to MQTTc_Init(),
+*               or part of the module's static data.
+*
+*           (2) Memory borrowed from the application, while the MQTTc module uses it.
+*
+*           (3) The bytes of the PUBLISH msgs in the tx q are also part of the msgs in use. They are not
+*               added again to the total.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_mem_type {
+    MQTTc_MEM_TYPE_DATA = 0u,                                   /* Data of the module. See Note #1.                     */
+    MQTTc_MEM_TYPE_MSG_ID_BITMAP,                               /* Msg ID bitmap tbl.  See Note #1.                     */
+    MQTTc_MEM_TYPE_CONN,                                        /* Conns open.         See Note #2.                     */
+    MQTTc_MEM_TYPE_RX_BUF,                                      /* Rx msgs of conns open, with their buf. See Note #2.  */
+    MQTTc_MEM_TYPE_TX_BUF,                                      /* Tx coalescing bufs of conns open.      See Note #2.  */
+    MQTTc_MEM_TYPE_MSG,                                         /* Msgs posted until they cmpl, with their buf.         */
+    MQTTc_MEM_TYPE_TX_Q,                                        /* Bytes of PUBLISH msgs in tx q's. See Note #3.        */
+    MQTTc_MEM_TYPE_NBR                                          /* Nbr of types. MUST be last.                          */
+} MQTTc_MEM_TYPE;
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc MEM USAGE
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_mem_usage {
+    CPU_INT32U  Len;                                            /* Nbr of bytes in use.                                 */
+    CPU_INT32U  LenMax;                                         /* High-water mark of nbr of bytes in use.              */
+} MQTTc_MEM_USAGE;
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc MEM STATS
+*
+* Note(s) : (1) The high-water mark of the task's stk is probed by MQTTc_MemStatsGet(). See mqtt-c_mem.c
+*               Note #2.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_mem_stats {
+    MQTTc_MEM_USAGE  UsageTbl[MQTTc_MEM_TYPE_NBR];              /* Usage, per type.                                     */
+    MQTTc_MEM_USAGE  Total;                                     /* Usage of all types. See MQTTc_MEM_TYPE Note #3.      */
+    CPU_INT32U       TaskStkLen;                                /* Size of the task's stk, in bytes.                    */
+    CPU_INT32U       TaskStkLenMax;                             /* High-water mark of task's stk usage. See Note #1.    */
+} MQTTc_MEM_STATS;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MACRO'S
+*
+* Note(s) : (1) When the memory accounting is disabled, the macros expand to nothing and the hot path is
+*               unchanged.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+#define  MQTTc_MEM_ADD(type, len)                                MQTTc_MemAdd((type), (len))
+
+#define  MQTTc_MEM_REMOVE(type, len)                             MQTTc_MemRemove((type), (len))
+
+#define  MQTTc_MEM_CONN_ADD(p_conn)                              MQTTc_MemConnAdd((p_conn))
+
+#define  MQTTc_MEM_CONN_REMOVE(p_conn)                           MQTTc_MemConnRemove((p_conn))
+
+#define  MQTTc_MEM_MSG_ADD(p_msg)                                MQTTc_MemMsgAdd((p_msg))
+
+#define  MQTTc_MEM_MSG_REMOVE(p_msg)                             MQTTc_MemMsgRemove((p_msg))
+#else
+#define  MQTTc_MEM_ADD(type, len)
+#define  MQTTc_MEM_REMOVE(type, len)
+#define  MQTTc_MEM_CONN_ADD(p_conn)
+#define  MQTTc_MEM_CONN_REMOVE(p_conn)
+#define  MQTTc_MEM_MSG_ADD(p_msg)
+#define  MQTTc_MEM_MSG_REMOVE(p_msg)
+#endif
+
+
+#if (MQTTc_CFG_MEM_STATS_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void  MQTTc_MemStatsGet    (MQTTc_MEM_STATS  *p_stats,
+                            MQTTc_ERR        *p_err);
+
+void  MQTTc_MemInit        (void);
+
+void  MQTTc_MemTaskStkSet  (void             *p_stk,
+                            CPU_INT32U        len);
+
+void  MQTTc_MemAdd         (MQTTc_MEM_TYPE    type,
+                            CPU_INT32U        len);
+
+void  MQTTc_MemRemove      (MQTTc_MEM_TYPE    type,
+                            CPU_INT32U        len);
+
+void  MQTTc_MemConnAdd     (MQTTc_CONN       *p_conn);
+
+void  MQTTc_MemConnRemove  (MQTTc_CONN       *p_conn);
+
+void  MQTTc_MemMsgAdd      (MQTTc_MSG        *p_msg);
+
+void  MQTTc_MemMsgRemove   (MQTTc_MSG        *p_msg);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_MEM_STATS_EN                               */
+#endif
@@ -0,0 +1,748 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                         TASK LOOP PROFILER
+*
+* Filename : mqtt-c_prof.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The profiler splits the time of each iteration of the MQTTc task between its phases, and
+*                measures each call of an application callback. Time is measured with CPU_TS_Get32(),
+*                which is usually based on the CPU's cycle counter.
+*
+*            (2) Only the MQTTc task records time. The application reads the stats through
+*                MQTTc_ProfPhaseGet() and MQTTc_ProfCallbackGet(), which copy them within a critical
+*                section, so that their counters are consistent with each other.
+*
+*            (3) Each histogram holds one bucket per power of 2 : bucket 0 counts the samples below 1 us,
+*                and bucket N the samples in [2^(N - 1); 2^N[ us. The last bucket also counts all the
+*                samples above it. The max sample is still kept exactly.
+*
+*            (4) A callback call that lasts more than MQTTc_CFG_PROF_CALLBACK_OVERRUN_US overruns : it is
+*                counted, its conn and duration are kept, and a MQTTc_TRACE_EVT_CALLBACK_OVERRUN evt is
+*                recorded in the trace ring, if enabled.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <cpu.h>
+#include  <cpu_core.h>
+
+#include  "mqtt-c_prof.h"
+#include  "mqtt-c_trace.h"
+
+
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_PROF_PHASE_STK_SIZE                        4u    /* Max nesting of phases. See MQTTc_ProfPhaseStart().   */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_prof_data {
+                                                                /* Stats, per phase and per callback. See Note #2.      */
+    MQTTc_PROF_PHASE_STATS     PhaseStatsTbl[MQTTc_PROF_PHASE_NBR];
+    MQTTc_PROF_CALLBACK_STATS  CallbackStatsTbl[MQTTc_PROF_CALLBACK_NBR];
+
+    CPU_BOOLEAN                IsStarted;                       /* Flag indicating if an iteration was started.         */
+    CPU_TS32                   IterStartTS;                     /* Timestamp of start of iteration.                     */
+    CPU_TS32                   TS_Last;                         /* Timestamp of last change of phase.                   */
+                                                                /* Ticks spent in each phase during iteration.          */
+    CPU_INT32U                 IterTicksTbl[MQTTc_PROF_PHASE_NBR];
+    CPU_INT08U                 PhaseStkLvl;                     /* Nbr of phases in progress.                           */
+                                                                /* Phases in progress, innermost last.                  */
+    CPU_INT08U                 PhaseStk[MQTTc_PROF_PHASE_STK_SIZE];
+                                                                /* Timestamp of start of each phase in progress.        */
+    CPU_TS32                   PhaseStartTS_Tbl[MQTTc_PROF_PHASE_STK_SIZE];
+} MQTTc_PROF_DATA;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  MQTTc_PROF_DATA  MQTTc_ProfData;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U        MQTTc_ProfPhaseEndGet  (MQTTc_PROF_PHASE   phase);
+
+static  MQTTc_PROF_PHASE  MQTTc_ProfPhaseCurGet  (void);
+
+static  void              MQTTc_ProfHistAdd      (MQTTc_PROF_HIST   *p_hist,
+                                                  CPU_INT32U         val_us);
+
+static  CPU_INT32U        MQTTc_ProfTicksToUsec  (CPU_INT32U         ticks);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     CONFIGURATION ERROR CHECKING
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (CPU_CFG_TS_32_EN != DEF_ENABLED)
+#error  "CPU_CFG_TS_32_EN illegally #define'd in 'cpu_cfg.h'. MUST be DEF_ENABLED when MQTTc_CFG_PROF_EN is DEF_ENABLED."
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_ProfClr()
+*
+* Description : Clear the stats of every phase and callback.
+*
+* Argument(s) : p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) Each stats is cleared within its own critical section, to keep them short.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfClr (MQTTc_ERR  *p_err)
+{
+    CPU_INT08U  ix;
+    CPU_SR_ALLOC();
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+    #endif
+
+    for (ix = 0u; ix < MQTTc_PROF_PHASE_NBR; ix++) {
+        CPU_CRITICAL_ENTER();                                   /* See Note #1.                                         */
+        Mem_Clr(&MQTTc_ProfData.PhaseStatsTbl[ix], sizeof(MQTTc_PROF_PHASE_STATS));
+        CPU_CRITICAL_EXIT();
+    }
+
+    for (ix = 0u; ix < MQTTc_PROF_CALLBACK_NBR; ix++) {
+        CPU_CRITICAL_ENTER();
+        Mem_Clr(&MQTTc_ProfData.CallbackStatsTbl[ix], sizeof(MQTTc_PROF_CALLBACK_STATS));
+        MQTTc_ProfData.CallbackStatsTbl[ix].OverrunSockId = NET_SOCK_ID_NONE;
+        CPU_CRITICAL_EXIT();
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_ProfPhaseGet()
+*
+* Description : Copy the stats of a phase of the MQTTc task.
+*
+* Argument(s) : phase           Phase of the task. See MQTTc_PROF_PHASE.
+*
+*               p_stats         Pointer to variable that will receive the copy of the stats.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid phase.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) See mqtt-c_prof.c Note #2.
+*
+*               (2) The time spent in a phase during iterations that did not enter it is recorded as 0, so
+*                   that all the histograms of the phases hold the same nbr of samples.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfPhaseGet (MQTTc_PROF_PHASE         phase,
+                          MQTTc_PROF_PHASE_STATS  *p_stats,
+                          MQTTc_ERR               *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if (p_stats == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    if (phase >= MQTTc_PROF_PHASE_NBR) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    Mem_Copy(p_stats, &MQTTc_ProfData.PhaseStatsTbl[phase], sizeof(MQTTc_PROF_PHASE_STATS));
+    CPU_CRITICAL_EXIT();
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_ProfCallbackGet()
+*
+* Description : Copy the stats of an application callback.
+*
+* Argument(s) : callback        Callback. See MQTTc_PROF_CALLBACK.
+*
+*               p_stats         Pointer to variable that will receive the copy of the stats.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid callback.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The stats of a callback cover all the conns. The conn of its last overrun is kept, to find
+*                   which application callback is slow. See mqtt-c_prof.c Note #4.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfCallbackGet (MQTTc_PROF_CALLBACK         callback,
+                             MQTTc_PROF_CALLBACK_STATS  *p_stats,
+                             MQTTc_ERR                  *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if (p_stats == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    if (callback >= MQTTc_PROF_CALLBACK_NBR) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    Mem_Copy(p_stats, &MQTTc_ProfData.CallbackStatsTbl[callback], sizeof(MQTTc_PROF_CALLBACK_STATS));
+    CPU_CRITICAL_EXIT();
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_ProfIterStart()
+*
+* Description : Start an iteration of the MQTTc task.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task(), via MQTTc_PROF_ITER_START().
+*
+* Note(s)     : (1) The time elapsed since the end of the previous iteration is the task dly.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfIterStart (void)
+{
+    CPU_TS32    ts;
+    CPU_INT32U  ticks;
+    CPU_INT32U  dly_us;
+    CPU_INT08U  ix;
+    CPU_SR_ALLOC();
+
+
+    ts = CPU_TS_Get32();
+
+    if (MQTTc_ProfData.IsStarted == DEF_YES) {                  /* See Note #1.                                         */
+        ticks  = (CPU_INT32U)(CPU_TS32)(ts - MQTTc_ProfData.TS_Last);
+        dly_us = MQTTc_ProfTicksToUsec(ticks);
+
+        CPU_CRITICAL_ENTER();
+        MQTTc_ProfData.PhaseStatsTbl[MQTTc_PROF_PHASE_DLY].TotalTicks += ticks;
+        MQTTc_ProfHistAdd(&MQTTc_ProfData.PhaseStatsTbl[MQTTc_PROF_PHASE_DLY].Hist, dly_us);
+        CPU_CRITICAL_EXIT();
+    }
+
+    for (ix = 0u; ix < MQTTc_PROF_PHASE_NBR; ix++) {
+        MQTTc_ProfData.IterTicksTbl[ix] = 0u;
+    }
+    MQTTc_ProfData.PhaseStkLvl = 0u;
+    MQTTc_ProfData.IterStartTS = ts;
+    MQTTc_ProfData.TS_Last     = ts;
+    MQTTc_ProfData.IsStarted   = DEF_YES;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_ProfIterEnd()
+*
+* Description : End an iteration of the MQTTc task, and record the time spent in each of its phases.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task(), via MQTTc_PROF_ITER_END().
+*
+* Note(s)     : (1) The times are converted before entering the critical section, to keep it short.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfIterEnd (void)
+{
+    MQTTc_PROF_PHASE  phase;
+    CPU_TS32          ts;
+    CPU_INT32U        us_tbl[MQTTc_PROF_PHASE_NBR];
+    CPU_INT08U        ix;
+    CPU_SR_ALLOC();
+
+
+    if (MQTTc_ProfData.IsStarted != DEF_YES) {
+        return;
+    }
+
+    ts    = CPU_TS_Get32();
+    phase = MQTTc_ProfPhaseCurGet();
+    MQTTc_ProfData.IterTicksTbl[phase]                 += (CPU_INT32U)(CPU_TS32)(ts - MQTTc_ProfData.TS_Last);
+    MQTTc_ProfData.IterTicksTbl[MQTTc_PROF_PHASE_ITER]  = (CPU_INT32U)(CPU_TS32)(ts - MQTTc_ProfData.IterStartTS);
+    MQTTc_ProfData.TS_Last                              =  ts;
+    MQTTc_ProfData.PhaseStkLvl                          =  0u;
+
+    for (ix = 0u; ix < MQTTc_PROF_PHASE_NBR; ix++) {            /* See Note #1.                                         */
+        us_tbl[ix] = MQTTc_ProfTicksToUsec(MQTTc_ProfData.IterTicksTbl[ix]);
+    }
+
+    CPU_CRITICAL_ENTER();
+    for (ix = 0u; ix < MQTTc_PROF_PHASE_NBR; ix++) {
+        if (ix != MQTTc_PROF_PHASE_DLY) {
+            MQTTc_ProfData.PhaseStatsTbl[ix].TotalTicks += MQTTc_ProfData.IterTicksTbl[ix];
+            MQTTc_ProfHistAdd(&MQTTc_ProfData.PhaseStatsTbl[ix].Hist, us_tbl[ix]);
+        }
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_ProfPhaseStart()
+*
+* Description : Start a phase of the MQTTc task.
+*
+* Argument(s) : phase           Phase started.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_MsgProcess(), via MQTTc_PROF_PHASE_START(),
+*               callers of application callbacks, via MQTTc_PROF_CALLBACK_START().
+*
+* Note(s)     : (1) The phase in progress, if any, is paused until the new phase ends. See mqtt-c_prof.h
+*                   'MQTTc PROF PHASE Note #1'.
+*
+*               (2) Phases nested deeper than MQTTc_PROF_PHASE_STK_SIZE are accounted to their parent.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfPhaseStart (MQTTc_PROF_PHASE  phase)
+{
+    MQTTc_PROF_PHASE  phase_cur;
+    CPU_TS32          ts;
+    CPU_INT08U        lvl;
+
+
+    if (MQTTc_ProfData.IsStarted != DEF_YES) {
+        return;
+    }
+
+    ts        = CPU_TS_Get32();
+    phase_cur = MQTTc_ProfPhaseCurGet();                        /* See Note #1.                                         */
+    MQTTc_ProfData.IterTicksTbl[phase_cur] += (CPU_INT32U)(CPU_TS32)(ts - MQTTc_ProfData.TS_Last);
+    MQTTc_ProfData.TS_Last                  =  ts;
+
+    lvl = MQTTc_ProfData.PhaseStkLvl;
+    if (lvl >= MQTTc_PROF_PHASE_STK_SIZE) {                     /* See Note #2.                                         */
+        return;
+    }
+    MQTTc_ProfData.PhaseStk[lvl]         = (CPU_INT08U)phase;
+    MQTTc_ProfData.PhaseStartTS_Tbl[lvl] =  ts;
+    MQTTc_ProfData.PhaseStkLvl++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_ProfPhaseEnd()
+*
+* Description : End a phase of the MQTTc task.
+*
+* Argument(s) : phase           Phase ended.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_MsgProcess(), via MQTTc_PROF_PHASE_END().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfPhaseEnd (MQTTc_PROF_PHASE  phase)
+{
+    (void)MQTTc_ProfPhaseEndGet(phase);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_ProfCallbackEnd()
+*
+* Description : End the call of an application callback, and record its duration.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which the callback was called.
+*
+*               callback        Callback called.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Callers of application callbacks, via MQTTc_PROF_CALLBACK_END(),
+*               MQTTc_ProfMsgCallbackEnd().
+*
+* Note(s)     : (1) See mqtt-c_prof.c Note #4.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfCallbackEnd (MQTTc_CONN           *p_conn,
+                             MQTTc_PROF_CALLBACK   callback)
+{
+    MQTTc_PROF_CALLBACK_STATS  *p_stats;
+    CPU_INT32U                  ticks;
+    CPU_INT32U                  dur_us;
+    CPU_BOOLEAN                 is_overrun;
+    CPU_SR_ALLOC();
+
+
+    ticks      = MQTTc_ProfPhaseEndGet(MQTTc_PROF_PHASE_CALLBACK);
+    dur_us     = MQTTc_ProfTicksToUsec(ticks);
+    is_overrun = (dur_us > MQTTc_CFG_PROF_CALLBACK_OVERRUN_US) ? DEF_YES : DEF_NO;
+    p_stats    = &MQTTc_ProfData.CallbackStatsTbl[callback];
+
+    CPU_CRITICAL_ENTER();
+    p_stats->TotalTicks += ticks;
+    MQTTc_ProfHistAdd(&p_stats->Hist, dur_us);
+    if (is_overrun == DEF_YES) {                                /* See Note #1.                                         */
+        p_stats->OverrunCtr++;
+        p_stats->OverrunSockId = p_conn->SockId;
+        p_stats->Overrun_us    = dur_us;
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (is_overrun == DEF_YES) {
+        MQTTc_TRACE_EVT(p_conn, MQTTc_TRACE_EVT_CALLBACK_OVERRUN, callback, dur_us, MQTTc_CFG_PROF_CALLBACK_OVERRUN_US, 0u);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                      MQTTc_ProfMsgCallbackEnd()
+*
+* Description : End the call of the completion callback specific to a type of msg, and record its duration.
+*
+* Argument(s) : p_conn          Pointer to MQTTc Connection object for which the callback was called.
+*
+*               type            Type of the msg that completed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec(), via MQTTc_PROF_MSG_CALLBACK_END().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfMsgCallbackEnd (MQTTc_CONN      *p_conn,
+                                MQTTc_MSG_TYPE   type)
+{
+    MQTTc_PROF_CALLBACK  callback;
+
+
+    switch (type) {
+        case MQTTc_MSG_TYPE_CONNECT:
+             callback = MQTTc_PROF_CALLBACK_ON_CONNECT_CMPL;
+             break;
+
+        case MQTTc_MSG_TYPE_PUBLISH:
+             callback = MQTTc_PROF_CALLBACK_ON_PUBLISH_CMPL;
+             break;
+
+        case MQTTc_MSG_TYPE_SUBSCRIBE:
+             callback = MQTTc_PROF_CALLBACK_ON_SUBSCRIBE_CMPL;
+             break;
+
+        case MQTTc_MSG_TYPE_UNSUBSCRIBE:
+             callback = MQTTc_PROF_CALLBACK_ON_UNSUBSCRIBE_CMPL;
+             break;
+
+        case MQTTc_MSG_TYPE_PINGREQ:
+             callback = MQTTc_PROF_CALLBACK_ON_PING_REQ_CMPL;
+             break;
+
+        case MQTTc_MSG_TYPE_DISCONNECT:
+        default:
+             callback = MQTTc_PROF_CALLBACK_ON_DISCONNECT_CMPL;
+             break;
+    }
+
+    MQTTc_ProfCallbackEnd(p_conn, callback);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_ProfPhaseEndGet()
+*
+* Description : End a phase of the MQTTc task, and get its duration.
+*
+* Argument(s) : phase           Phase ended.
+*
+* Return(s)   : Duration of the phase, in ticks, including the phases nested in it, if the phase was in
+*                   progress,
+*               0,  otherwise.
+*
+* Caller(s)   : MQTTc_ProfPhaseEnd(),
+*               MQTTc_ProfCallbackEnd().
+*
+* Note(s)     : (1) A phase that is not the innermost one in progress is not ended, e.g. if it was nested too
+*                   deep to be recorded. See MQTTc_ProfPhaseStart() Note #2.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_ProfPhaseEndGet (MQTTc_PROF_PHASE  phase)
+{
+    CPU_TS32    ts;
+    CPU_INT08U  lvl;
+
+
+    if (MQTTc_ProfData.IsStarted != DEF_YES) {
+        return (0u);
+    }
+
+    lvl = MQTTc_ProfData.PhaseStkLvl;
+    if ((lvl                               == 0u) ||            /* See Note #1.                                         */
+        (MQTTc_ProfData.PhaseStk[lvl - 1u] != (CPU_INT08U)phase)) {
+        return (0u);
+    }
+
+    ts = CPU_TS_Get32();
+    MQTTc_ProfData.IterTicksTbl[phase] += (CPU_INT32U)(CPU_TS32)(ts - MQTTc_ProfData.TS_Last);
+    MQTTc_ProfData.TS_Last              =  ts;
+    MQTTc_ProfData.PhaseStkLvl--;
+
+    return ((CPU_INT32U)(CPU_TS32)(ts - MQTTc_ProfData.PhaseStartTS_Tbl[lvl - 1u]));
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_ProfPhaseCurGet()
+*
+* Description : Get the phase in progress.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Innermost phase in progress, if any,
+*               MQTTc_PROF_PHASE_OTHER,      otherwise.
+*
+* Caller(s)   : MQTTc_ProfIterEnd(),
+*               MQTTc_ProfPhaseStart().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_PROF_PHASE  MQTTc_ProfPhaseCurGet (void)
+{
+    CPU_INT08U  lvl;
+
+
+    lvl = MQTTc_ProfData.PhaseStkLvl;
+    if (lvl == 0u) {
+        return (MQTTc_PROF_PHASE_OTHER);
+    }
+
+    return ((MQTTc_PROF_PHASE)MQTTc_ProfData.PhaseStk[lvl - 1u]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_ProfHistAdd()
+*
+* Description : Add a sample to a histogram.
+*
+* Argument(s) : p_hist          Pointer to histogram.
+*
+*               val_us          Sample, in us.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ProfCallbackEnd(),
+*               MQTTc_ProfIterEnd(),
+*               MQTTc_ProfIterStart().
+*
+* Note(s)     : (1) This function MUST be called within a critical section.
+*
+*               (2) See mqtt-c_prof.c Note #3.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_ProfHistAdd (MQTTc_PROF_HIST  *p_hist,
+                                 CPU_INT32U        val_us)
+{
+    CPU_INT32U  ix;
+
+
+    ix = 0u;
+    if (val_us != 0u) {                                         /* See Note #2.                                         */
+        ix = DEF_INT_32_NBR_BITS - CPU_CntLeadZeros(val_us);
+        ix = DEF_MIN(ix, MQTTc_PROF_HIST_BUCKET_NBR - 1u);
+    }
+
+    if (val_us > p_hist->Max_us) {
+        p_hist->Max_us = val_us;
+    }
+    p_hist->SampleNbr++;
+    p_hist->CtrTbl[ix]++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_ProfTicksToUsec()
+*
+* Description : Convert a duration in timestamp ticks to us.
+*
+* Argument(s) : ticks           Duration, in CPU_TS_Get32() ticks.
+*
+* Return(s)   : Duration, in us, bounded to DEF_INT_32U_MAX_VAL.
+*
+* Caller(s)   : MQTTc_ProfCallbackEnd(),
+*               MQTTc_ProfIterEnd(),
+*               MQTTc_ProfIterStart().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_ProfTicksToUsec (CPU_INT32U  ticks)
+{
+    CPU_INT64U  val_us;
+
+
+    val_us = CPU_TS32_to_uSec((CPU_TS32)ticks);
+    if (val_us > DEF_INT_32U_MAX_VAL) {
+        val_us = DEF_INT_32U_MAX_VAL;
+    }
+
+    return ((CPU_INT32U)val_us);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_PROF_EN                                    */
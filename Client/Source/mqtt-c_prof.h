@@ -0,0 +1,243 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                         TASK LOOP PROFILER
+*
+* Filename : mqtt-c_prof.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc profiler module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_PROF_MODULE_PRESENT
+#define  MQTTc_PROF_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+                                                                /* Nbr of buckets of a histogram. See mqtt-c_prof.c ... */
+#define  MQTTc_PROF_HIST_BUCKET_NBR                      24u    /* ... Note #3.                                         */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc PROF PHASE
+*
+* Note(s) : (1) The time of an iteration of the MQTTc task is split between the phases below. Time spent in
+*               a phase nested in another, e.g. a callback called while rx'ing, is only accounted to the
+*               nested phase.
+*
+*           (2) MQTTc_PROF_PHASE_ITER is not a phase : it accounts for whole iterations, excluding the task
+*               dly.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_prof_phase {
+    MQTTc_PROF_PHASE_SEL = 0u,                                  /* Task waits on sock sel.                              */
+    MQTTc_PROF_PHASE_RD,                                        /* Task rx's on a conn.                                 */
+    MQTTc_PROF_PHASE_WR,                                        /* Task tx's on a conn.                                 */
+    MQTTc_PROF_PHASE_MSG_PROCESS,                               /* Task q's a posted msg on its conn.                   */
+    MQTTc_PROF_PHASE_CALLBACK,                                  /* Task calls application callbacks.                    */
+    MQTTc_PROF_PHASE_OTHER,                                     /* Task does anything else in the iteration.            */
+    MQTTc_PROF_PHASE_DLY,                                       /* Task dlys between two iterations.                    */
+    MQTTc_PROF_PHASE_ITER,                                      /* Whole iteration. See Note #2.                        */
+    MQTTc_PROF_PHASE_NBR                                        /* Nbr of phases. MUST be last.                         */
+} MQTTc_PROF_PHASE;
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc PROF CALLBACK
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_prof_callback {
+    MQTTc_PROF_CALLBACK_ON_CMPL = 0u,                           /* Generic completion callback.                         */
+    MQTTc_PROF_CALLBACK_ON_CONNECT_CMPL,
+    MQTTc_PROF_CALLBACK_ON_PUBLISH_CMPL,
+    MQTTc_PROF_CALLBACK_ON_SUBSCRIBE_CMPL,
+    MQTTc_PROF_CALLBACK_ON_UNSUBSCRIBE_CMPL,
+    MQTTc_PROF_CALLBACK_ON_PING_REQ_CMPL,
+    MQTTc_PROF_CALLBACK_ON_DISCONNECT_CMPL,
+    MQTTc_PROF_CALLBACK_ON_CMPL_BATCH,
+    MQTTc_PROF_CALLBACK_ON_PUBLISH_RX,
+    MQTTc_PROF_CALLBACK_ON_PUBLISH_RX_FILTER,
+    MQTTc_PROF_CALLBACK_ON_PUBLISH_RX_BATCH,
+    MQTTc_PROF_CALLBACK_ON_TX_Q_HIGH,
+    MQTTc_PROF_CALLBACK_ON_TX_Q_LOW,
+    MQTTc_PROF_CALLBACK_ON_ERR,
+    MQTTc_PROF_CALLBACK_NBR                                     /* Nbr of callbacks. MUST be last.                      */
+} MQTTc_PROF_CALLBACK;
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc PROF HISTOGRAM
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_prof_hist {
+    CPU_INT32U  SampleNbr;                                      /* Nbr of samples recorded.                             */
+    CPU_INT32U  Max_us;                                         /* Max sample, in us.                                   */
+    CPU_INT32U  CtrTbl[MQTTc_PROF_HIST_BUCKET_NBR];             /* Nbr of samples per bucket.                           */
+} MQTTc_PROF_HIST;
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc PROF PHASE STATS
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_prof_phase_stats {
+    CPU_INT64U       TotalTicks;                                /* Time spent in phase, in CPU_TS_Get32() ticks.        */
+    MQTTc_PROF_HIST  Hist;                                      /* Time spent in phase per iteration.                   */
+} MQTTc_PROF_PHASE_STATS;
+
+
+/*
+*********************************************************************************************************
+*                                     MQTTc PROF CALLBACK STATS
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_prof_callback_stats {
+    CPU_INT64U       TotalTicks;                                /* Time spent in callback, in CPU_TS_Get32() ticks.     */
+    MQTTc_PROF_HIST  Hist;                                      /* Duration of each call.                               */
+    CPU_INT32U       OverrunCtr;                                /* Nbr of calls that overran the threshold.             */
+    NET_SOCK_ID      OverrunSockId;                             /* Sock ID of conn of last call that overran.           */
+    CPU_INT32U       Overrun_us;                                /* Duration of last call that overran, in us.           */
+} MQTTc_PROF_CALLBACK_STATS;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MACRO'S
+*
+* Note(s) : (1) When the profiler is disabled, the macros expand to nothing and the hot path is unchanged.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+#define  MQTTc_PROF_ITER_START()                                 MQTTc_ProfIterStart()
+
+#define  MQTTc_PROF_ITER_END()                                   MQTTc_ProfIterEnd()
+
+#define  MQTTc_PROF_PHASE_START(phase)                           MQTTc_ProfPhaseStart((phase))
+
+#define  MQTTc_PROF_PHASE_END(phase)                             MQTTc_ProfPhaseEnd((phase))
+
+#define  MQTTc_PROF_CALLBACK_START()                             MQTTc_ProfPhaseStart(MQTTc_PROF_PHASE_CALLBACK)
+
+#define  MQTTc_PROF_CALLBACK_END(p_conn, callback)               MQTTc_ProfCallbackEnd((p_conn), (callback))
+
+#define  MQTTc_PROF_MSG_CALLBACK_END(p_conn, type)               MQTTc_ProfMsgCallbackEnd((p_conn), (type))
+#else
+#define  MQTTc_PROF_ITER_START()
+#define  MQTTc_PROF_ITER_END()
+#define  MQTTc_PROF_PHASE_START(phase)
+#define  MQTTc_PROF_PHASE_END(phase)
+#define  MQTTc_PROF_CALLBACK_START()
+#define  MQTTc_PROF_CALLBACK_END(p_conn, callback)
+#define  MQTTc_PROF_MSG_CALLBACK_END(p_conn, type)
+#endif
+
+
+#if (MQTTc_CFG_PROF_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void  MQTTc_ProfClr             (MQTTc_ERR                   *p_err);
+
+void  MQTTc_ProfPhaseGet        (MQTTc_PROF_PHASE             phase,
+                                 MQTTc_PROF_PHASE_STATS      *p_stats,
+                                 MQTTc_ERR                   *p_err);
+
+void  MQTTc_ProfCallbackGet     (MQTTc_PROF_CALLBACK          callback,
+                                 MQTTc_PROF_CALLBACK_STATS   *p_stats,
+                                 MQTTc_ERR                   *p_err);
+
+void  MQTTc_ProfIterStart       (void);
+
+void  MQTTc_ProfIterEnd         (void);
+
+void  MQTTc_ProfPhaseStart      (MQTTc_PROF_PHASE             phase);
+
+void  MQTTc_ProfPhaseEnd        (MQTTc_PROF_PHASE             phase);
+
+void  MQTTc_ProfCallbackEnd     (MQTTc_CONN                  *p_conn,
+                                 MQTTc_PROF_CALLBACK          callback);
+
+void  MQTTc_ProfMsgCallbackEnd  (MQTTc_CONN                  *p_conn,
+                                 MQTTc_MSG_TYPE               type);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_PROF_EN                                    */
+#endif
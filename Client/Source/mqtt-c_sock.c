@@ -37,6 +37,7 @@
 #include  <Source/net_sock.h>
 #include  <Source/net_app.h>
 #include  "mqtt-c_sock.h"
+#include  "mqtt-c_cap.h"
 
 
 /*
@@ -168,6 +169,8 @@ void  MQTTc_SockConnOpen (MQTTc_CONN  *p_conn,
         goto end_err;
     }
 
+    MQTTc_CAP_CONN_OPEN(p_conn);
+
    *p_err = MQTTc_ERR_NONE;
 
     return;
@@ -222,6 +225,8 @@ void  MQTTc_SockConnClose (MQTTc_CONN  *p_conn,
         }
     #endif
 
+    MQTTc_CAP_REC(p_conn, MQTTc_CAP_REC_TYPE_CLOSE, DEF_NULL, 0u);
+
     NetSock_Close(p_conn->SockId, &err_net);
     if (err_net == NET_SOCK_ERR_NONE) {
        *p_err = MQTTc_ERR_NONE;
@@ -252,7 +257,8 @@ void  MQTTc_SockConnClose (MQTTc_CONN  *p_conn,
 *
 * Caller(s)   : MQTTc_WrSockProcess().
 *
-* Note(s)     : none.
+* Note(s)     : (1) A write is partial when fewer bytes than requested could be tx'd. The rest is tx'd on a
+*                   later write operation.
 *********************************************************************************************************
 */
 
@@ -288,6 +294,11 @@ CPU_INT32U  MQTTc_SockTx (MQTTc_CONN  *p_conn,
                                     &err_net);
     if (err_net == NET_SOCK_ERR_NONE) {
        *p_err = MQTTc_ERR_NONE;
+        MQTTc_STAT_ADD(p_conn, TxByteCtr, (CPU_INT32U)ret_val);
+        MQTTc_CAP_REC(p_conn, MQTTc_CAP_REC_TYPE_TX, p_buf, (CPU_INT32U)ret_val);
+        if ((CPU_INT32U)ret_val < buf_len) {                    /* See Note #1.                                         */
+            MQTTc_STAT_INC(p_conn, TxPartialCtr);
+        }
     } else {
        *p_err   = MQTTc_ERR_TX;
         ret_val = 0u;
@@ -321,7 +332,8 @@ CPU_INT32U  MQTTc_SockTx (MQTTc_CONN  *p_conn,
 *
 * Caller(s)   : MQTTc_RdSockProcess().
 *
-* Note(s)     : none.
+* Note(s)     : (1) A read is partial when fewer bytes than requested were avail. The rest is rx'd on a
+*                   later read operation.
 *********************************************************************************************************
 */
 
@@ -358,6 +370,11 @@ CPU_INT32U  MQTTc_SockRx (MQTTc_CONN  *p_conn,
     switch (err_net) {
         case NET_SOCK_ERR_NONE:
             *p_err = MQTTc_ERR_NONE;
+             MQTTc_STAT_ADD(p_conn, RxByteCtr, (CPU_INT32U)ret_val);
+             MQTTc_CAP_REC(p_conn, MQTTc_CAP_REC_TYPE_RX, p_buf, (CPU_INT32U)ret_val);
+             if ((CPU_INT32U)ret_val < buf_len) {               /* See Note #1.                                         */
+                 MQTTc_STAT_INC(p_conn, RxPartialCtr);
+             }
              break;
 
         case NET_SOCK_ERR_RX_Q_EMPTY:
@@ -0,0 +1,1134 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                     STORE-AND-FORWARD OUTBOUND LOG
+*
+* Filename : mqtt-c_store.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The store is an append-only log of encoded PUBLISH messages, kept in a memory region given
+*                by the application. The region can be a memory-mapped file, a FRAM, a battery-backed RAM
+*                or any other byte-writable memory that survives a restart of the application.
+*
+*            (2) The region is laid out as follows :
+*
+*                    +--------+---------+---------+-------+-------+-----+-----------+
+*                    |  Hdr   | Ckpt #0 | Ckpt #1 | Seg 0 | Seg 1 | ... | Seg N - 1 |
+*                    +--------+---------+---------+-------+-------+-----+-----------+
+*
+*                (a) The hdr holds the geometry of the log. A region whose hdr does not match the geometry
+*                    given to MQTTc_StoreOpen() is formatted.
+*
+*                (b) The checkpoints hold the position of the oldest record that has not been released.
+*                    They are written alternately, so that a torn checkpoint leaves the previous one
+*                    valid.
+*
+*                (c) Each seg holds records, each made of a hdr followed by the encoded message. A record
+*                    never spans two segs. The rest of a seg that cannot hold the next record is marked
+*                    with a padding record.
+*
+*            (3) The log is crash-consistent. Each record is protected by a CRC that also covers the
+*                sequence number of its seg, so that a torn record or a record left by a previous pass
+*                over the seg is never taken as valid. When the store is opened, the records are scanned
+*                from the last checkpoint up to the first invalid one.
+*
+*            (4) The msg ID and the DUP flag of a stored PUBLISH are set each time the message is tx'd. They
+*                are written in place in the record and are thus excluded from the record's CRC.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <cpu.h>
+#include  <KAL/kal.h>
+
+#include  "mqtt-c_store.h"
+#include  "../../Common/mqtt.h"
+
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_STORE_MAGIC                               0x4C53514Du
+#define  MQTTc_STORE_VER                                          1u
+#define  MQTTc_STORE_CKPT_NBR                                     2u
+#define  MQTTc_STORE_SEG_NBR_MIN                                  2u
+
+#define  MQTTc_STORE_REC_TYPE_DATA                                1u
+#define  MQTTc_STORE_REC_TYPE_PAD                                 2u
+
+#define  MQTTc_STORE_ALIGN                                        4u
+
+#define  MQTTc_STORE_META_LEN                   (sizeof(MQTTc_STORE_HDR) + \
+                                                (sizeof(MQTTc_STORE_CKPT) * MQTTc_STORE_CKPT_NBR))
+
+#define  MQTTc_STORE_REC_LEN(len)               (sizeof(MQTTc_STORE_REC_HDR) + \
+                                               (((len) + MQTTc_STORE_ALIGN - 1u) & ~(MQTTc_STORE_ALIGN - 1u)))
+
+#define  MQTTc_STORE_POS_IS_EQ(p_a, p_b)      ((((p_a)->SegSeq == (p_b)->SegSeq) && \
+                                                ((p_a)->Offset == (p_b)->Offset)) ? DEF_YES : DEF_NO)
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*
+* Note(s) : (1) Every structure is made of 32-bit words, so that it is aligned wherever it is in the region.
+*               The CRC is always the last field, so that it covers every field that precedes it.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_store_hdr {
+    CPU_INT32U  Magic;                                          /* Identifies an MQTTc store.                           */
+    CPU_INT32U  Ver;                                            /* Version of the layout.                               */
+    CPU_INT32U  SegLen;                                         /* Len of each seg, in bytes.                           */
+    CPU_INT32U  SegNbr;                                         /* Nbr of segs.                                         */
+    CPU_INT32U  CRC;                                            /* CRC of the fields above.                             */
+} MQTTc_STORE_HDR;
+
+typedef  struct  mqttc_store_ckpt {
+    CPU_INT32U  Seq;                                            /* Seq nbr of checkpoint. The highest valid one wins.   */
+    CPU_INT32U  RdSegSeq;                                       /* Pos of oldest rec not released.                      */
+    CPU_INT32U  RdOffset;
+    CPU_INT32U  CRC;                                            /* CRC of the fields above.                             */
+} MQTTc_STORE_CKPT;
+
+typedef  struct  mqttc_store_rec_hdr {
+    CPU_INT32U  Len;                                            /* Len of encoded msg, in bytes.                        */
+    CPU_INT32U  SegSeq;                                         /* Seq nbr of seg in which rec was written.             */
+    CPU_INT16U  MsgID_Ix;                                       /* Ix of msg ID in encoded msg. 0 if none.              */
+    CPU_INT16U  Type;                                           /* Data or padding rec.                                 */
+    CPU_INT32U  CRC;                                            /* CRC of the fields above and of the encoded msg.      */
+} MQTTc_STORE_REC_HDR;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  const  CPU_INT32U  MQTTc_StoreCRC_Tbl[16u] = {          /* CRC-32 (IEEE 802.3), reflected, 4 bits at a time.    */
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu,
+    0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+    0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+
+static  const  CPU_INT08U  MQTTc_StoreMsgID_Zero[2u] = { 0u, 0u };
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  void                  MQTTc_StoreFormat     (MQTTc_STORE            *p_store);
+
+static  CPU_BOOLEAN           MQTTc_StoreRecover    (MQTTc_STORE            *p_store);
+
+static  void                  MQTTc_StoreCkptWr     (MQTTc_STORE            *p_store);
+
+static  MQTTc_STORE_REC_HDR  *MQTTc_StoreRecFind    (MQTTc_STORE            *p_store,
+                                                     MQTTc_STORE_POS        *p_pos,
+                                                     MQTTc_STORE_POS        *p_end_pos);
+
+static  MQTTc_STORE_REC_HDR  *MQTTc_StoreRecHdrGet  (MQTTc_STORE            *p_store,
+                                                     MQTTc_STORE_POS        *p_pos);
+
+static  CPU_BOOLEAN           MQTTc_StoreRecIsValid (MQTTc_STORE            *p_store,
+                                                     MQTTc_STORE_REC_HDR    *p_rec,
+                                                     MQTTc_STORE_POS        *p_pos);
+
+static  CPU_INT32U            MQTTc_StoreRecCRC_Calc(MQTTc_STORE_REC_HDR    *p_rec);
+
+static  void                  MQTTc_StoreSync       (MQTTc_STORE            *p_store,
+                                                     void                   *p_addr,
+                                                     CPU_INT32U              len);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_StoreOpen()
+*
+* Description : Open a store over a memory region, recovering the records it already holds, if any.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object to open.
+*
+*               p_mem           Pointer to memory region holding the log. MUST be aligned on 4 bytes.
+*
+*               mem_len         Len of memory region, in bytes.
+*
+*               seg_len         Len of each seg of the log, in bytes. MUST be a multiple of 4. Limits the
+*                               len of a stored message.
+*
+*               sync_fnct       Function called to sync the memory region, DEF_NULL if none.
+*
+*               p_sync_arg      Argument passed to sync function.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid geometry of memory region.
+*                                   MQTTc_ERR_ALLOC             Unable to allocate the store's lock.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) A region that does not hold a valid log with the same geometry is formatted, which
+*                   discards its content. See mqtt-c_store.c Note #2a.
+*
+*               (2) The store MUST be opened before it is set on a connection. See MQTTc_ConnSetParam()
+*                   Note #6.
+*
+*               (3) A store that was opened MUST be closed with MQTTc_StoreClose() before it is opened
+*                   again, so that its lock is freed.
+*********************************************************************************************************
+*/
+
+void  MQTTc_StoreOpen (MQTTc_STORE            *p_store,
+                       void                   *p_mem,
+                       CPU_INT32U              mem_len,
+                       CPU_INT32U              seg_len,
+                       MQTTc_STORE_SYNC_FNCT   sync_fnct,
+                       void                   *p_sync_arg,
+                       MQTTc_ERR              *p_err)
+{
+    MQTTc_STORE_HDR  *p_hdr;
+    CPU_INT32U        seg_nbr;
+    KAL_ERR           err_kal;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if ((p_store == DEF_NULL) ||
+            (p_mem   == DEF_NULL)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    if ((((CPU_ADDR)p_mem) % MQTTc_STORE_ALIGN != 0u)                  ||
+        (  seg_len         % MQTTc_STORE_ALIGN != 0u)                  ||
+        (  seg_len         < MQTTc_STORE_REC_LEN(MQTTc_STORE_ALIGN))   ||
+        (  mem_len         < MQTTc_STORE_META_LEN)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    seg_nbr = (mem_len - MQTTc_STORE_META_LEN) / seg_len;
+    if (seg_nbr < MQTTc_STORE_SEG_NBR_MIN) {
+       *p_err = MQTTc_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_store->MemPtr     = (CPU_INT08U *)p_mem;
+    p_store->SegBasePtr = &p_store->MemPtr[MQTTc_STORE_META_LEN];
+    p_store->SegLen     =  seg_len;
+    p_store->SegNbr     =  seg_nbr;
+    p_store->SyncFnct   =  sync_fnct;
+    p_store->SyncArgPtr =  p_sync_arg;
+    p_store->AllocLen   =  0u;
+
+    p_store->LockHandle = KAL_LockCreate("MQTTc Store Lock",
+                                          DEF_NULL,
+                                         &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_ALLOC;
+        return;
+    }
+
+    p_hdr = (MQTTc_STORE_HDR *)p_store->MemPtr;                 /* See Note #1.                                         */
+    if ((p_hdr->Magic  != MQTTc_STORE_MAGIC)                                                        ||
+        (p_hdr->Ver    != MQTTc_STORE_VER)                                                          ||
+        (p_hdr->SegLen != seg_len)                                                                  ||
+        (p_hdr->SegNbr != seg_nbr)                                                                  ||
+        (p_hdr->CRC    != MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_hdr, sizeof(MQTTc_STORE_HDR) - sizeof(CPU_INT32U))) ||
+        (MQTTc_StoreRecover(p_store) == DEF_NO)) {
+        MQTTc_StoreFormat(p_store);
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_StoreClose()
+*
+* Description : Close a store, freeing its lock. The records it holds are kept in the memory region.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object to close.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The store MUST NOT be set on a connection that is open.
+*********************************************************************************************************
+*/
+
+void  MQTTc_StoreClose (MQTTc_STORE  *p_store,
+                        MQTTc_ERR    *p_err)
+{
+    KAL_ERR  err_kal;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if (p_store == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    KAL_LockDel(p_store->LockHandle,
+               &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return;
+    }
+
+    p_store->LockHandle = KAL_LockHandleNull;
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreRecAlloc()
+*
+* Description : Reserve room at the end of the log for a new record.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               len             Len of the encoded message to store, in bytes.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_INVALID_BUF_SIZE  Msg does not fit in a seg.
+*                                   MQTTc_ERR_STORE_FULL        Log is full.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : Pointer to the location where the message must be encoded, if NO error(s),
+*               DEF_NULL,                                                  otherwise.
+*
+* Caller(s)   : MQTTc_PublishStore().
+*
+* Note(s)     : (1) On success, the store is locked until MQTTc_StoreRecCommit() or MQTTc_StoreRecAbort()
+*                   is called.
+*
+*               (2) A seg can only be written if it does not hold records that have not been released.
+*
+*               (3) The rest of the current seg is marked with a padding record, so that the log can be
+*                   scanned without knowing where it ends. See mqtt-c_store.c Note #2c.
+*********************************************************************************************************
+*/
+
+CPU_INT08U  *MQTTc_StoreRecAlloc (MQTTc_STORE  *p_store,
+                                  CPU_INT32U    len,
+                                  MQTTc_ERR    *p_err)
+{
+    MQTTc_STORE_REC_HDR  *p_rec;
+    MQTTc_STORE_POS       pos;
+    CPU_INT32U            rd_seg_seq;
+    CPU_INT32U            rec_len;
+    KAL_ERR               err_kal;
+    CPU_SR_ALLOC();
+
+
+    if (len > (p_store->SegLen - sizeof(MQTTc_STORE_REC_HDR))) {
+       *p_err = MQTTc_ERR_INVALID_BUF_SIZE;
+        return (DEF_NULL);
+    }
+    rec_len = MQTTc_STORE_REC_LEN(len);
+
+    KAL_LockAcquire(p_store->LockHandle,                        /* See Note #1.                                         */
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return (DEF_NULL);
+    }
+
+    CPU_CRITICAL_ENTER();
+    rd_seg_seq = p_store->RdPos.SegSeq;
+    CPU_CRITICAL_EXIT();
+
+    pos = p_store->WrPos;
+    if ((p_store->SegLen - pos.Offset) < rec_len) {             /* Rec does not fit in cur seg, go to next seg.         */
+        if ((pos.SegSeq + 1u - rd_seg_seq) >= p_store->SegNbr) {
+            goto exit_full;                                     /* See Note #2.                                         */
+        }
+
+        if ((p_store->SegLen - pos.Offset) >= sizeof(MQTTc_STORE_REC_HDR)) {
+            p_rec           = MQTTc_StoreRecHdrGet(p_store, &pos);
+            p_rec->Len      = 0u;                               /* See Note #3.                                         */
+            p_rec->SegSeq   = pos.SegSeq;
+            p_rec->MsgID_Ix = 0u;
+            p_rec->Type     = MQTTc_STORE_REC_TYPE_PAD;
+            p_rec->CRC      = MQTTc_StoreRecCRC_Calc(p_rec);
+            MQTTc_StoreSync(p_store, p_rec, sizeof(MQTTc_STORE_REC_HDR));
+        }
+
+        pos.SegSeq++;
+        pos.Offset = 0u;
+
+        CPU_CRITICAL_ENTER();
+        p_store->WrPos = pos;
+        CPU_CRITICAL_EXIT();
+
+    } else if ((pos.SegSeq - rd_seg_seq) >= p_store->SegNbr) {
+        goto exit_full;
+    }
+
+    p_store->AllocPos = pos;
+    p_store->AllocLen = len;
+
+    p_rec = MQTTc_StoreRecHdrGet(p_store, &pos);
+
+   *p_err = MQTTc_ERR_NONE;
+
+    return ((CPU_INT08U *)(p_rec + 1u));
+
+
+exit_full:
+    KAL_LockRelease(p_store->LockHandle, &err_kal);
+    (void)&err_kal;
+
+   *p_err = MQTTc_ERR_STORE_FULL;
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_StoreRecCommit()
+*
+* Description : Append the record reserved by MQTTc_StoreRecAlloc() to the log and unlock the store.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               msg_id_ix       Ix of the msg ID in the encoded message, 0 if none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_PublishStore().
+*
+* Note(s)     : (1) The record is synced before it is made visible to the task, so that a message is never
+*                   tx'd before it is durable.
+*********************************************************************************************************
+*/
+
+void  MQTTc_StoreRecCommit (MQTTc_STORE  *p_store,
+                            CPU_INT16U    msg_id_ix)
+{
+    MQTTc_STORE_REC_HDR  *p_rec;
+    CPU_INT32U            rec_len;
+    KAL_ERR               err_kal;
+    CPU_SR_ALLOC();
+
+
+    rec_len = MQTTc_STORE_REC_LEN(p_store->AllocLen);
+
+    p_rec           = MQTTc_StoreRecHdrGet(p_store, &p_store->AllocPos);
+    p_rec->Len      = p_store->AllocLen;
+    p_rec->SegSeq   = p_store->AllocPos.SegSeq;
+    p_rec->MsgID_Ix = msg_id_ix;
+    p_rec->Type     = MQTTc_STORE_REC_TYPE_DATA;
+    p_rec->CRC      = MQTTc_StoreRecCRC_Calc(p_rec);
+
+    MQTTc_StoreSync(p_store, p_rec, rec_len);                   /* See Note #1.                                         */
+
+    CPU_CRITICAL_ENTER();
+    p_store->WrPos.SegSeq = p_store->AllocPos.SegSeq;
+    p_store->WrPos.Offset = p_store->AllocPos.Offset + rec_len;
+    CPU_CRITICAL_EXIT();
+
+    KAL_LockRelease(p_store->LockHandle, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreRecAbort()
+*
+* Description : Discard the record reserved by MQTTc_StoreRecAlloc() and unlock the store.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_PublishStore().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_StoreRecAbort (MQTTc_STORE  *p_store)
+{
+    KAL_ERR  err_kal;
+
+
+    p_store->AllocLen = 0u;
+
+    KAL_LockRelease(p_store->LockHandle, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreRecNext()
+*
+* Description : Get the next record to tx from the log.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               p_len           Pointer to variable that will receive the len of the encoded message.
+*
+*               p_msg_id_ix     Pointer to variable that will receive the ix of the msg ID in the message.
+*
+*               p_pos           Pointer to variable that will receive the position of the record.
+*
+* Return(s)   : Pointer to the encoded message, if any,
+*               DEF_NULL,                       otherwise.
+*
+* Caller(s)   : MQTTc_ConnStoreFeed().
+*
+* Note(s)     : (1) MUST only be called from the MQTTc task. The records between the tx position and the
+*                   write position have been committed and are not checked again.
+*********************************************************************************************************
+*/
+
+CPU_INT08U  *MQTTc_StoreRecNext (MQTTc_STORE      *p_store,
+                                 CPU_INT32U       *p_len,
+                                 CPU_INT16U       *p_msg_id_ix,
+                                 MQTTc_STORE_POS  *p_pos)
+{
+    MQTTc_STORE_REC_HDR  *p_rec;
+    MQTTc_STORE_POS       pos;
+    MQTTc_STORE_POS       wr_pos;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    wr_pos = p_store->WrPos;
+    CPU_CRITICAL_EXIT();
+
+    pos   = p_store->TxPos;
+    p_rec = MQTTc_StoreRecFind(p_store, &pos, &wr_pos);         /* See Note #1.                                         */
+    if (p_rec == DEF_NULL) {
+        p_store->TxPos = pos;
+        return (DEF_NULL);
+    }
+
+    p_store->TxPos.SegSeq = pos.SegSeq;
+    p_store->TxPos.Offset = pos.Offset + MQTTc_STORE_REC_LEN(p_rec->Len);
+
+   *p_len       = p_rec->Len;
+   *p_msg_id_ix = p_rec->MsgID_Ix;
+   *p_pos       = pos;
+
+    return ((CPU_INT08U *)(p_rec + 1u));
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_StoreRecRelease()
+*
+* Description : Release the oldest records of the log and checkpoint the new read position.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               rec_nbr         Nbr of records to release.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnStoreMsgCmpl().
+*
+* Note(s)     : (1) MUST only be called from the MQTTc task. Only records that have been tx'd can be
+*                   released.
+*
+*               (2) A crash before the checkpoint is synced only causes the released records to be tx'd
+*                   again after the restart.
+*********************************************************************************************************
+*/
+
+void  MQTTc_StoreRecRelease (MQTTc_STORE  *p_store,
+                             CPU_INT16U    rec_nbr)
+{
+    MQTTc_STORE_REC_HDR  *p_rec;
+    MQTTc_STORE_POS       pos;
+    CPU_SR_ALLOC();
+
+
+    pos = p_store->RdPos;
+    while (rec_nbr > 0u) {                                      /* See Note #1.                                         */
+        p_rec = MQTTc_StoreRecFind(p_store, &pos, &p_store->TxPos);
+        if (p_rec == DEF_NULL) {
+            break;
+        }
+        pos.Offset += MQTTc_STORE_REC_LEN(p_rec->Len);
+        rec_nbr--;
+    }
+
+    CPU_CRITICAL_ENTER();
+    p_store->RdPos = pos;
+    CPU_CRITICAL_EXIT();
+
+    MQTTc_StoreCkptWr(p_store);                                 /* See Note #2.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreTxRewind()
+*
+* Description : Restart the tx of the log from its oldest record that has not been released.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnOpen(),
+*               MQTTc_ConnCloseProc().
+*
+* Note(s)     : (1) The records that were tx'd but not acknowledged are tx'd again on the next connection.
+*********************************************************************************************************
+*/
+
+void  MQTTc_StoreTxRewind (MQTTc_STORE  *p_store)
+{
+    p_store->TxPos = p_store->RdPos;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StorePosIsLive()
+*
+* Description : Check if a position of the log holds a record that has not been released.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               p_pos           Pointer to position to check.
+*
+* Return(s)   : DEF_YES, if the position is between the read and the write positions of the log,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : MQTTc_ConnWalRestore().
+*
+* Note(s)     : (1) The comparison of seg seq nbrs remains valid when they wrap around.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  MQTTc_StorePosIsLive (MQTTc_STORE      *p_store,
+                                   MQTTc_STORE_POS  *p_pos)
+{
+    CPU_INT32U  seg_ix;
+    CPU_INT32U  wr_seg_ix;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    wr_seg_ix = p_store->WrPos.SegSeq - p_store->RdPos.SegSeq;  /* See Note #1.                                         */
+    seg_ix    = p_pos->SegSeq         - p_store->RdPos.SegSeq;
+    if (( seg_ix >  wr_seg_ix)                                                          ||
+        ((seg_ix == 0u)        && (p_pos->Offset <  p_store->RdPos.Offset))             ||
+        ((seg_ix == wr_seg_ix) && (p_pos->Offset >= p_store->WrPos.Offset))) {
+        CPU_CRITICAL_EXIT();
+        return (DEF_NO);
+    }
+    CPU_CRITICAL_EXIT();
+
+    return (DEF_YES);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreCRC_Calc()
+*
+* Description : Update a CRC-32 with a block of data.
+*
+* Argument(s) : crc             Current CRC. MQTTc_STORE_CRC_INIT to start a new CRC.
+*
+*               p_data          Pointer to data.
+*
+*               len             Len of data, in bytes.
+*
+* Return(s)   : Updated CRC.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : (1) A 16 entries tbl is used, to keep the code size small.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  MQTTc_StoreCRC_Calc (       CPU_INT32U   crc,
+                                 const  void        *p_data,
+                                        CPU_INT32U   len)
+{
+    const  CPU_INT08U  *p_byte = (const CPU_INT08U *)p_data;
+
+
+    while (len > 0u) {                                          /* See Note #1.                                         */
+        crc = MQTTc_StoreCRC_Tbl[(crc ^  *p_byte)        & 0x0Fu] ^ (crc >> 4u);
+        crc = MQTTc_StoreCRC_Tbl[(crc ^ (*p_byte >> 4u)) & 0x0Fu] ^ (crc >> 4u);
+        p_byte++;
+        len--;
+    }
+
+    return (crc);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_StoreFormat()
+*
+* Description : Initialize an empty log in the memory region of given MQTTc Store.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_StoreOpen().
+*
+* Note(s)     : (1) The segs are cleared, so that no record of a previous log can be taken as valid.
+*
+*               (2) The hdr is synced before the checkpoint is written. A crash in between leaves no valid
+*                   checkpoint and the region is formatted again on the next open.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_StoreFormat (MQTTc_STORE  *p_store)
+{
+    MQTTc_STORE_HDR  *p_hdr;
+    CPU_INT32U        mem_len;
+
+
+    mem_len = MQTTc_STORE_META_LEN + (p_store->SegLen * p_store->SegNbr);
+    Mem_Clr(p_store->MemPtr, mem_len);                          /* See Note #1.                                         */
+
+    p_hdr         = (MQTTc_STORE_HDR *)p_store->MemPtr;
+    p_hdr->Magic  =  MQTTc_STORE_MAGIC;
+    p_hdr->Ver    =  MQTTc_STORE_VER;
+    p_hdr->SegLen =  p_store->SegLen;
+    p_hdr->SegNbr =  p_store->SegNbr;
+    p_hdr->CRC    =  MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_hdr, sizeof(MQTTc_STORE_HDR) - sizeof(CPU_INT32U));
+
+    MQTTc_StoreSync(p_store, p_store->MemPtr, mem_len);         /* See Note #2.                                         */
+
+    p_store->RdPos.SegSeq = 0u;
+    p_store->RdPos.Offset = 0u;
+    p_store->TxPos        = p_store->RdPos;
+    p_store->WrPos        = p_store->RdPos;
+    p_store->CkptSeq      = 0u;
+
+    MQTTc_StoreCkptWr(p_store);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreRecover()
+*
+* Description : Restore the positions of the log held in the memory region of given MQTTc Store.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+* Return(s)   : DEF_YES, if the log was recovered,
+*               DEF_NO,  if no valid checkpoint was found.
+*
+* Caller(s)   : MQTTc_StoreOpen().
+*
+* Note(s)     : (1) The valid checkpoint with the highest seq nbr is used. The comparison remains valid
+*                   when the seq nbr wraps around.
+*
+*               (2) The write position is the end of the last valid record. See mqtt-c_store.c Note #3.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  MQTTc_StoreRecover (MQTTc_STORE  *p_store)
+{
+    MQTTc_STORE_CKPT     *p_ckpt_tbl;
+    MQTTc_STORE_CKPT     *p_ckpt     = DEF_NULL;
+    MQTTc_STORE_REC_HDR  *p_rec;
+    MQTTc_STORE_POS       pos;
+    CPU_INT08U            ix;
+
+
+    p_ckpt_tbl = (MQTTc_STORE_CKPT *)&p_store->MemPtr[sizeof(MQTTc_STORE_HDR)];
+    for (ix = 0u; ix < MQTTc_STORE_CKPT_NBR; ix++) {            /* See Note #1.                                         */
+        if ((p_ckpt_tbl[ix].CRC      != MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, &p_ckpt_tbl[ix], sizeof(MQTTc_STORE_CKPT) - sizeof(CPU_INT32U))) ||
+            (p_ckpt_tbl[ix].RdOffset >  p_store->SegLen)) {
+            continue;
+        }
+        if ((p_ckpt == DEF_NULL) ||
+            ((CPU_INT32S)(p_ckpt_tbl[ix].Seq - p_ckpt->Seq) > 0)) {
+            p_ckpt = &p_ckpt_tbl[ix];
+        }
+    }
+
+    if (p_ckpt == DEF_NULL) {
+        return (DEF_NO);
+    }
+
+    p_store->CkptSeq      = p_ckpt->Seq;
+    p_store->RdPos.SegSeq = p_ckpt->RdSegSeq;
+    p_store->RdPos.Offset = p_ckpt->RdOffset;
+
+    pos = p_store->RdPos;                                       /* See Note #2.                                         */
+    do {
+        p_rec = MQTTc_StoreRecFind(p_store, &pos, DEF_NULL);
+        if (p_rec != DEF_NULL) {
+            pos.Offset += MQTTc_STORE_REC_LEN(p_rec->Len);
+        }
+    } while (p_rec != DEF_NULL);
+
+    p_store->WrPos = pos;
+    p_store->TxPos = p_store->RdPos;
+
+    return (DEF_YES);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_StoreCkptWr()
+*
+* Description : Write the read position of given MQTTc Store in its next checkpoint.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_StoreFormat(),
+*               MQTTc_StoreRecRelease().
+*
+* Note(s)     : (1) See mqtt-c_store.c Note #2b.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_StoreCkptWr (MQTTc_STORE  *p_store)
+{
+    MQTTc_STORE_CKPT  *p_ckpt;
+    CPU_INT32U         seq;
+
+
+    seq    =  p_store->CkptSeq + 1u;                            /* See Note #1.                                         */
+    p_ckpt = (MQTTc_STORE_CKPT *)&p_store->MemPtr[sizeof(MQTTc_STORE_HDR) + ((seq % MQTTc_STORE_CKPT_NBR) * sizeof(MQTTc_STORE_CKPT))];
+
+    p_ckpt->Seq      = seq;
+    p_ckpt->RdSegSeq = p_store->RdPos.SegSeq;
+    p_ckpt->RdOffset = p_store->RdPos.Offset;
+    p_ckpt->CRC      = MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_ckpt, sizeof(MQTTc_STORE_CKPT) - sizeof(CPU_INT32U));
+
+    MQTTc_StoreSync(p_store, p_ckpt, sizeof(MQTTc_STORE_CKPT));
+
+    p_store->CkptSeq = seq;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_StoreRecFind()
+*
+* Description : Find the next data record of the log, starting at given position.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               p_pos           Pointer to position from which to search. Receives the position of the
+*                               record found, or the position at which the search stopped.
+*
+*               p_end_pos       Pointer to position at which to stop, or DEF_NULL to stop at the first
+*                               invalid record.
+*
+* Return(s)   : Pointer to hdr of the record found, if any,
+*               DEF_NULL,                             otherwise.
+*
+* Caller(s)   : MQTTc_StoreRecNext(),
+*               MQTTc_StoreRecRelease(),
+*               MQTTc_StoreRecover().
+*
+* Note(s)     : (1) Padding records and the rest of a seg too short to hold a record hdr are skipped.
+*
+*               (2) The search never goes further than the last seg that can hold records that have not
+*                   been released.
+*********************************************************************************************************
+*/
+
+static  MQTTc_STORE_REC_HDR  *MQTTc_StoreRecFind (MQTTc_STORE      *p_store,
+                                                  MQTTc_STORE_POS  *p_pos,
+                                                  MQTTc_STORE_POS  *p_end_pos)
+{
+    MQTTc_STORE_REC_HDR  *p_rec;
+
+
+    while (DEF_TRUE) {
+        if ((p_end_pos                                    != DEF_NULL) &&
+            (MQTTc_STORE_POS_IS_EQ(p_pos, p_end_pos)      == DEF_YES)) {
+            return (DEF_NULL);
+        }
+
+        if ((p_pos->SegSeq - p_store->RdPos.SegSeq) >= p_store->SegNbr) {
+            return (DEF_NULL);                                  /* See Note #2.                                         */
+        }
+
+        if ((p_store->SegLen - p_pos->Offset) < sizeof(MQTTc_STORE_REC_HDR)) {
+            p_pos->SegSeq++;                                    /* See Note #1.                                         */
+            p_pos->Offset = 0u;
+            continue;
+        }
+
+        p_rec = MQTTc_StoreRecHdrGet(p_store, p_pos);
+        if ((p_end_pos                                    == DEF_NULL) &&
+            (MQTTc_StoreRecIsValid(p_store, p_rec, p_pos) == DEF_NO)) {
+            return (DEF_NULL);
+        }
+
+        if (p_rec->Type == MQTTc_STORE_REC_TYPE_PAD) {
+            p_pos->SegSeq++;
+            p_pos->Offset = 0u;
+            continue;
+        }
+
+        return (p_rec);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_StoreRecHdrGet()
+*
+* Description : Get the address of the record at given position of the log.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               p_pos           Pointer to position of the record.
+*
+* Return(s)   : Pointer to hdr of the record.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_STORE_REC_HDR  *MQTTc_StoreRecHdrGet (MQTTc_STORE      *p_store,
+                                                    MQTTc_STORE_POS  *p_pos)
+{
+    CPU_INT32U  seg_ix;
+
+
+    seg_ix = p_pos->SegSeq % p_store->SegNbr;
+
+    return ((MQTTc_STORE_REC_HDR *)&p_store->SegBasePtr[(seg_ix * p_store->SegLen) + p_pos->Offset]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_StoreRecIsValid()
+*
+* Description : Check if the record at given position of the log is valid.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               p_rec           Pointer to hdr of the record.
+*
+*               p_pos           Pointer to position of the record.
+*
+* Return(s)   : DEF_YES, if the record is valid,
+*               DEF_NO,  otherwise.
+*
+* Caller(s)   : MQTTc_StoreRecFind().
+*
+* Note(s)     : (1) See mqtt-c_store.c Note #3.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  MQTTc_StoreRecIsValid (MQTTc_STORE          *p_store,
+                                            MQTTc_STORE_REC_HDR  *p_rec,
+                                            MQTTc_STORE_POS      *p_pos)
+{
+    if ((p_rec->SegSeq != p_pos->SegSeq) ||                     /* See Note #1.                                         */
+       ((p_rec->Type   != MQTTc_STORE_REC_TYPE_DATA) &&
+        (p_rec->Type   != MQTTc_STORE_REC_TYPE_PAD))) {
+        return (DEF_NO);
+    }
+
+    if ((p_rec->Len                     >  p_store->SegLen) ||
+        (MQTTc_STORE_REC_LEN(p_rec->Len) > (p_store->SegLen - p_pos->Offset))) {
+        return (DEF_NO);
+    }
+
+    if ((p_rec->MsgID_Ix                                 != 0u) &&
+        (((CPU_INT32U)p_rec->MsgID_Ix + MQTT_MSG_ID_SIZE) > p_rec->Len)) {
+        return (DEF_NO);
+    }
+
+    if (p_rec->CRC != MQTTc_StoreRecCRC_Calc(p_rec)) {
+        return (DEF_NO);
+    }
+
+    return (DEF_YES);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       MQTTc_StoreRecCRC_Calc()
+*
+* Description : Compute the CRC of a record.
+*
+* Argument(s) : p_rec           Pointer to hdr of the record, followed by the encoded message.
+*
+* Return(s)   : CRC of the record.
+*
+* Caller(s)   : MQTTc_StoreRecAlloc(),
+*               MQTTc_StoreRecCommit(),
+*               MQTTc_StoreRecIsValid().
+*
+* Note(s)     : (1) The DUP flag and the msg ID are taken as 0. See mqtt-c_store.c Note #4.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  MQTTc_StoreRecCRC_Calc (MQTTc_STORE_REC_HDR  *p_rec)
+{
+    CPU_INT08U  *p_data = (CPU_INT08U *)(p_rec + 1u);
+    CPU_INT32U   ix     =  p_rec->MsgID_Ix;
+    CPU_INT32U   crc;
+    CPU_INT08U   hdr;
+
+
+    crc = MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT,
+                              p_rec,
+                              sizeof(MQTTc_STORE_REC_HDR) - sizeof(CPU_INT32U));
+    if (p_rec->Len == 0u) {
+        return (crc);
+    }
+
+    hdr = p_data[0u] & (CPU_INT08U)~MQTT_MSG_FIXED_HDR_FLAGS_DUP_MSK;
+    crc = MQTTc_StoreCRC_Calc(crc, &hdr, 1u);                   /* See Note #1.                                         */
+
+    if (ix == 0u) {
+        crc = MQTTc_StoreCRC_Calc(crc, &p_data[1u], p_rec->Len - 1u);
+    } else {
+        crc = MQTTc_StoreCRC_Calc(crc, &p_data[1u],                     ix - 1u);
+        crc = MQTTc_StoreCRC_Calc(crc,  MQTTc_StoreMsgID_Zero,          MQTT_MSG_ID_SIZE);
+        crc = MQTTc_StoreCRC_Calc(crc, &p_data[ix + MQTT_MSG_ID_SIZE], p_rec->Len - ix - MQTT_MSG_ID_SIZE);
+    }
+
+    return (crc);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_StoreSync()
+*
+* Description : Sync a range of the memory region of given MQTTc Store, if a sync function was given.
+*
+* Argument(s) : p_store         Pointer to MQTTc Store object.
+*
+*               p_addr          Pointer to start of range.
+*
+*               len             Len of range, in bytes.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_StoreSync (MQTTc_STORE  *p_store,
+                               void         *p_addr,
+                               CPU_INT32U    len)
+{
+    if (p_store->SyncFnct != DEF_NULL) {
+        p_store->SyncFnct(p_addr,
+                          len,
+                          p_store->SyncArgPtr);
+    }
+}
+
+
+#endif                                                          /* MQTTc_CFG_STORE_EN                                   */
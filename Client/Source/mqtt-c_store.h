@@ -0,0 +1,172 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                     STORE-AND-FORWARD OUTBOUND LOG
+*
+* Filename : mqtt-c_store.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc store module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_STORE_MODULE_PRESENT
+#define  MQTTc_STORE_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+#if (MQTTc_CFG_STORE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_STORE_CRC_INIT                            0xFFFFFFFFu
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                       MQTTc STORE SYNC FUNCTION
+*
+* Note(s) : (1) Called after the store has written to its memory region, so that the given range reaches
+*               non-volatile storage before the store goes on. For example, a port backing the store with
+*               a memory-mapped file calls msync(), a port backing it with a FRAM or a battery-backed RAM
+*               flushes the data cache.
+*********************************************************************************************************
+*/
+
+typedef  void  (*MQTTc_STORE_SYNC_FNCT)(void        *p_addr,
+                                        CPU_INT32U   len,
+                                        void        *p_arg);
+
+
+/*
+*********************************************************************************************************
+*                                               MQTTc STORE
+*********************************************************************************************************
+*/
+
+struct  mqttc_store {
+    CPU_INT08U             *MemPtr;                             /* Ptr to mem region holding the log.                   */
+    CPU_INT08U             *SegBasePtr;                         /* Ptr to first seg of the log.                         */
+    CPU_INT32U              SegLen;                             /* Len of each seg, in bytes.                           */
+    CPU_INT32U              SegNbr;                             /* Nbr of segs in mem region.                           */
+
+    MQTTc_STORE_POS         RdPos;                              /* Pos of oldest rec not released. Checkpointed.        */
+    MQTTc_STORE_POS         TxPos;                              /* Pos of next rec to tx.                               */
+    MQTTc_STORE_POS         WrPos;                              /* Pos at which next rec is appended.                   */
+    CPU_INT32U              CkptSeq;                            /* Seq nbr of last checkpoint written.                  */
+
+    MQTTc_STORE_POS         AllocPos;                           /* Pos of rec being appended.                           */
+    CPU_INT32U              AllocLen;                           /* Len of rec being appended.                           */
+
+    MQTTc_STORE_SYNC_FNCT   SyncFnct;                           /* Fnct called to sync mem region, if any.              */
+    void                   *SyncArgPtr;                         /* Arg passed to sync fnct.                             */
+
+    KAL_LOCK_HANDLE         LockHandle;                         /* Lock serializing appends.                            */
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void          MQTTc_StoreOpen       (MQTTc_STORE            *p_store,
+                                     void                   *p_mem,
+                                     CPU_INT32U              mem_len,
+                                     CPU_INT32U              seg_len,
+                                     MQTTc_STORE_SYNC_FNCT   sync_fnct,
+                                     void                   *p_sync_arg,
+                                     MQTTc_ERR              *p_err);
+
+void          MQTTc_StoreClose      (MQTTc_STORE            *p_store,
+                                     MQTTc_ERR              *p_err);
+
+CPU_INT08U   *MQTTc_StoreRecAlloc   (MQTTc_STORE            *p_store,
+                                     CPU_INT32U              len,
+                                     MQTTc_ERR              *p_err);
+
+void          MQTTc_StoreRecCommit  (MQTTc_STORE            *p_store,
+                                     CPU_INT16U              msg_id_ix);
+
+void          MQTTc_StoreRecAbort   (MQTTc_STORE            *p_store);
+
+CPU_INT08U   *MQTTc_StoreRecNext    (MQTTc_STORE            *p_store,
+                                     CPU_INT32U             *p_len,
+                                     CPU_INT16U             *p_msg_id_ix,
+                                     MQTTc_STORE_POS        *p_pos);
+
+void          MQTTc_StoreRecRelease (MQTTc_STORE            *p_store,
+                                     CPU_INT16U              rec_nbr);
+
+void          MQTTc_StoreTxRewind   (MQTTc_STORE            *p_store);
+
+CPU_BOOLEAN   MQTTc_StorePosIsLive  (MQTTc_STORE            *p_store,
+                                     MQTTc_STORE_POS        *p_pos);
+
+CPU_INT32U    MQTTc_StoreCRC_Calc   (CPU_INT32U              crc,
+                                     const  void            *p_data,
+                                     CPU_INT32U              len);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_STORE_EN                                   */
+#endif
@@ -0,0 +1,889 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                      MESSAGE AND TASK TIMELINES
+*
+* Filename : mqtt-c_timeline.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The timelines are written to a file in the Chrome trace event format (JSON array format),
+*                which chrome://tracing and the Perfetto UI can open. They are meant for hosts on which
+*                the C library's stdio is available, e.g. Linux :
+*
+*                (a) Each msg is shown as an async span, from its post to the end of its callbacks, in
+*                    which each of its phases is a nested span. See 'MQTTc TIMELINE MESSAGE PHASE'.
+*
+*                (b) The phases of the MQTTc task (sock sel, rd, wr, callbacks and msg processing) are
+*                    shown as nested spans on the task's thread.
+*
+*            (2) Phases are recorded in a RAM buf, without formatting, so that recording does not disturb
+*                the timings measured. The MQTTc task writes the records to the file once per iteration,
+*                while the records of its next iteration go to a second buf.
+*
+*                (a) If a buf fills up before it is written, the records that do not fit are dropped and
+*                    their nbr is reported in the file. MQTTc_CFG_DBG_TIMELINE_BUF_SIZE SHOULD then be
+*                    increased.
+*
+*                (b) The file is valid once closed, but can also be opened while still being written or
+*                    after a crash, since the closing bracket of the JSON array format is optional.
+*
+*            (3) Timestamps are taken with CPU_TS_Get32() and extended to 64 bits as records are written.
+*                Two consecutive records MUST thus be less than a full period of the timestamp apart,
+*                which the MQTTc task dly ensures as long as CPU_TS_Get32() does not wrap faster than
+*                every few seconds.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <cpu.h>
+#include  <cpu_core.h>
+#include  <KAL/kal.h>
+
+#include  <stdio.h>
+
+#include  "mqtt-c_timeline.h"
+#include  "../../Common/mqtt.h"
+
+
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_TIMELINE_BUF_NBR                           2u    /* See mqtt-c_timeline.c Note #2.                       */
+
+#define  MQTTc_TIMELINE_ID_NONE                           0u
+
+#define  MQTTc_TIMELINE_PID                               1u    /* Process and thread IDs used in the file.             */
+#define  MQTTc_TIMELINE_TID                               1u
+
+#define  MQTTc_TIMELINE_TS_FREQ_DFLT                1000000u    /* Timestamps are taken as us if freq is unknown.       */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_timeline_rec_type {
+    MQTTc_TIMELINE_REC_TYPE_MSG = 0u,                           /* Msg changed phase.                                   */
+    MQTTc_TIMELINE_REC_TYPE_MSG_CALLBACK_END,                   /* Callbacks of msg returned.                           */
+    MQTTc_TIMELINE_REC_TYPE_TASK_START,                         /* Task started a phase.                                */
+    MQTTc_TIMELINE_REC_TYPE_TASK_END                            /* Task ended a phase.                                  */
+} MQTTc_TIMELINE_REC_TYPE;
+
+
+typedef  struct  mqttc_timeline_rec {
+    CPU_TS32    TS;                                             /* Timestamp, in CPU_TS_Get32() ticks.                  */
+    CPU_INT32U  ID;                                             /* Timeline ID of msg, if any.                          */
+    CPU_INT16U  MsgID;                                          /* MQTT msg ID of msg, if any.                          */
+    CPU_INT16S  SockId;                                         /* Sock ID of conn, -1 if none.                         */
+    CPU_INT08U  Type;                                           /* Rec type. See MQTTc_TIMELINE_REC_TYPE.               */
+    CPU_INT08U  Phase;                                          /* Phase started by rec.                                */
+    CPU_INT08U  PhasePrev;                                      /* Phase ended by rec, for msgs.                        */
+    CPU_INT08U  MsgType;                                        /* Type of msg, for msgs.                               */
+    CPU_INT08U  QoS;                                            /* QoS of msg, for msgs.                                */
+} MQTTc_TIMELINE_REC;
+
+
+typedef  struct  mqttc_timeline_data {
+    CPU_BOOLEAN          En;                                    /* Flag indicating if phases are recorded.              */
+    CPU_INT08U           BufIx;                                 /* Ix of buf in which phases are recorded.              */
+    CPU_INT32U           RecNbr;                                /* Nbr of recs in that buf.                             */
+    CPU_INT32U           DropCtr;                               /* Nbr of recs dropped since last wr. See Note #2a.     */
+    CPU_INT32U           NextID;                                /* Next timeline ID given to a msg.                     */
+                                                                /* Bufs of recs. See mqtt-c_timeline.c Note #2.         */
+    MQTTc_TIMELINE_REC   BufTbl[MQTTc_TIMELINE_BUF_NBR][MQTTc_CFG_DBG_TIMELINE_BUF_SIZE];
+
+    KAL_LOCK_HANDLE      LockHandle;                            /* Lock protecting the file.                            */
+    FILE                *FilePtr;                               /* File being written, DEF_NULL if none.                */
+    CPU_BOOLEAN          IsFirstEvt;                            /* Flag indicating if next evt is the first of file.    */
+    CPU_INT32U           TS_Freq;                               /* Freq of timestamps, in Hz.                           */
+    CPU_TS32             TS_Last;                               /* Timestamp of last rec written.                       */
+    CPU_INT64U           TS_Ticks;                              /* Ticks since file was opened. See Note #3.            */
+    CPU_INT64U           TS_ns;                                 /* Time of last rec written, in ns since file opened.   */
+} MQTTc_TIMELINE_DATA;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          LOCAL CONSTANTS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  const  CPU_CHAR  *const  MQTTc_TimelineMsgPhaseNameTbl[MQTTc_TIMELINE_MSG_PHASE_NBR] = {
+    "none",
+    "post",
+    "queued",
+    "tx",
+    "wait_ack",
+    "callback"
+};
+
+static  const  CPU_CHAR  *const  MQTTc_TimelineTaskPhaseNameTbl[MQTTc_TIMELINE_TASK_PHASE_NBR] = {
+    "sel",
+    "rd",
+    "wr",
+    "callback",
+    "msg_process"
+};
+
+static  const  CPU_CHAR  *const  MQTTc_TimelineMsgTypeNameTbl[] = {
+    "NONE",
+    "CONNECT",
+    "CONNACK",
+    "PUBLISH",
+    "PUBACK",
+    "PUBREC",
+    "PUBREL",
+    "PUBCOMP",
+    "SUBSCRIBE",
+    "SUBACK",
+    "UNSUBSCRIBE",
+    "UNSUBACK",
+    "PINGREQ",
+    "PINGRESP",
+    "DISCONNECT"
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  MQTTc_TIMELINE_DATA  MQTTc_TimelineData;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  MQTTc_TIMELINE_REC  *MQTTc_TimelineRecGet (void);
+
+static  void                 MQTTc_TimelineBufWr  (void);
+
+static  void                 MQTTc_TimelineRecWr  (const  MQTTc_TIMELINE_REC  *p_rec);
+
+static  void                 MQTTc_TimelineEvtWr  (const  CPU_CHAR            *p_name,
+                                                   const  CPU_CHAR            *p_cat,
+                                                          CPU_CHAR             ph,
+                                                          CPU_INT64U           ts_ns);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     CONFIGURATION ERROR CHECKING
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (CPU_CFG_TS_32_EN != DEF_ENABLED)
+#error  "CPU_CFG_TS_32_EN illegally #define'd in 'cpu_cfg.h'. MUST be DEF_ENABLED when MQTTc_CFG_DBG_TIMELINE_EN is DEF_ENABLED."
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_TimelineInit()
+*
+* Description : Initialize the timelines.
+*
+* Argument(s) : p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Init().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineInit (MQTTc_ERR  *p_err)
+{
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    CPU_TS_TMR_FREQ  freq;
+    CPU_ERR          err_cpu;
+#endif
+    KAL_ERR          err_kal;
+
+
+    MQTTc_TimelineData.En      = DEF_NO;
+    MQTTc_TimelineData.BufIx   = 0u;
+    MQTTc_TimelineData.RecNbr  = 0u;
+    MQTTc_TimelineData.DropCtr = 0u;
+    MQTTc_TimelineData.NextID  = MQTTc_TIMELINE_ID_NONE + 1u;
+    MQTTc_TimelineData.FilePtr = DEF_NULL;
+    MQTTc_TimelineData.TS_Freq = MQTTc_TIMELINE_TS_FREQ_DFLT;
+
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    freq = CPU_TS_TmrFreqGet(&err_cpu);
+    if ((err_cpu == CPU_ERR_NONE) &&
+        (freq    != 0u)) {
+        MQTTc_TimelineData.TS_Freq = (CPU_INT32U)freq;
+    }
+#endif
+
+    MQTTc_TimelineData.LockHandle = KAL_LockCreate("MQTTc Timeline Lock",
+                                                    DEF_NULL,
+                                                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_TimelineOpen()
+*
+* Description : Open the file to which the timelines are written, and start recording them.
+*
+* Argument(s) : p_file_name     Name of the file. It is created, or truncated if it exists.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_FAIL              A file is already open, or file could not be
+*                                                                   opened.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) Msgs already posted when the file is opened appear in the timelines from their next
+*                   phase on.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineOpen (const  CPU_CHAR   *p_file_name,
+                                 MQTTc_ERR  *p_err)
+{
+    FILE     *p_file;
+    KAL_ERR   err_kal;
+    CPU_SR_ALLOC();
+
+
+                                                                /* --------------- ARGUMENTS VALIDATION --------------- */
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if (p_file_name == DEF_NULL) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    KAL_LockAcquire(MQTTc_TimelineData.LockHandle,
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return;
+    }
+
+    if (MQTTc_TimelineData.FilePtr != DEF_NULL) {
+       *p_err = MQTTc_ERR_FAIL;
+        goto exit_release;
+    }
+
+    p_file = fopen((const char *)p_file_name, "w");
+    if (p_file == DEF_NULL) {
+       *p_err = MQTTc_ERR_FAIL;
+        goto exit_release;
+    }
+
+    MQTTc_TimelineData.FilePtr    = p_file;
+    MQTTc_TimelineData.IsFirstEvt = DEF_YES;
+    MQTTc_TimelineData.TS_Ticks   = 0u;
+    MQTTc_TimelineData.TS_ns      = 0u;
+    MQTTc_TimelineData.TS_Last    = CPU_TS_Get32();
+
+    (void)fprintf(p_file, "[\n");
+    MQTTc_TimelineEvtWr("process_name", "__metadata", 'M', 0u);
+    (void)fprintf(p_file, ",\"args\":{\"name\":\"MQTTc\"}}");
+    MQTTc_TimelineEvtWr("thread_name",  "__metadata", 'M', 0u);
+    (void)fprintf(p_file, ",\"args\":{\"name\":\"MQTTc Task\"}}");
+
+    CPU_CRITICAL_ENTER();
+    MQTTc_TimelineData.BufIx   = 0u;
+    MQTTc_TimelineData.RecNbr  = 0u;
+    MQTTc_TimelineData.DropCtr = 0u;
+    MQTTc_TimelineData.En      = DEF_YES;
+    CPU_CRITICAL_EXIT();
+
+   *p_err = MQTTc_ERR_NONE;
+
+exit_release:
+    KAL_LockRelease(MQTTc_TimelineData.LockHandle, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TimelineClose()
+*
+* Description : Stop recording the timelines, write the records left and close the file.
+*
+* Argument(s) : p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_FAIL              No file is open.
+*                                   MQTTc_ERR_OS_FAIL           OS operation failed.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The spans of the msgs and of the task phases that are in progress are left open.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineClose (MQTTc_ERR  *p_err)
+{
+    KAL_ERR  err_kal;
+    CPU_SR_ALLOC();
+
+
+                                                                /* --------------- ARGUMENTS VALIDATION --------------- */
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+    #endif
+
+    KAL_LockAcquire(MQTTc_TimelineData.LockHandle,
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+       *p_err = MQTTc_ERR_OS_FAIL;
+        return;
+    }
+
+    if (MQTTc_TimelineData.FilePtr == DEF_NULL) {
+       *p_err = MQTTc_ERR_FAIL;
+        goto exit_release;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* No rec can be added once disabled.                   */
+    MQTTc_TimelineData.En = DEF_NO;
+    CPU_CRITICAL_EXIT();
+
+    MQTTc_TimelineBufWr();
+
+    (void)fprintf(MQTTc_TimelineData.FilePtr, "\n]\n");
+    (void)fclose(MQTTc_TimelineData.FilePtr);
+    MQTTc_TimelineData.FilePtr = DEF_NULL;
+
+   *p_err = MQTTc_ERR_NONE;
+
+exit_release:
+    KAL_LockRelease(MQTTc_TimelineData.LockHandle, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TimelineFlush()
+*
+* Description : Write the phases recorded so far to the file.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task().
+*
+* Note(s)     : (1) Returns right away if no file is open, so that the MQTTc task does not take the lock on
+*                   each iteration.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineFlush (void)
+{
+    KAL_ERR  err_kal;
+
+
+    if (MQTTc_TimelineData.En != DEF_YES) {                     /* See Note #1.                                         */
+        return;
+    }
+
+    KAL_LockAcquire(MQTTc_TimelineData.LockHandle,
+                    KAL_OPT_PEND_NONE,
+                    KAL_TIMEOUT_INFINITE,
+                   &err_kal);
+    if (err_kal != KAL_ERR_NONE) {
+        return;
+    }
+
+    if (MQTTc_TimelineData.FilePtr != DEF_NULL) {
+        MQTTc_TimelineBufWr();
+    }
+
+    KAL_LockRelease(MQTTc_TimelineData.LockHandle, &err_kal);
+    (void)&err_kal;
+}
+
+
+/*
+*********************************************************************************************************
+*                                     MQTTc_TimelineMsgPhaseSet()
+*
+* Description : Record the start of a new phase of a msg.
+*
+* Argument(s) : p_msg           Pointer to MQTTc Message object.
+*
+*               phase           Phase the msg enters. MQTTc_TIMELINE_MSG_PHASE_NONE ends the msg's span.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TIMELINE_MSG_PHASE_SET().
+*
+* Note(s)     : (1) A msg gets a new timeline ID each time it is posted, or when it enters a phase while it
+*                   was not in the timeline, e.g. when it is fed from the connection's store. Its previous
+*                   span, if any, was ended by MQTTc_TimelineMsgCallbackEnd().
+*
+*               (2) A msg's phase is reset while no file is open, so that it starts a new span once one
+*                   is opened. See MQTTc_TimelineOpen() Note #1.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineMsgPhaseSet (MQTTc_MSG                 *p_msg,
+                                 MQTTc_TIMELINE_MSG_PHASE   phase)
+{
+    MQTTc_TIMELINE_REC  *p_rec;
+    CPU_INT08U           phase_prev;
+    CPU_SR_ALLOC();
+
+
+    if (MQTTc_TimelineData.En != DEF_YES) {                     /* See Note #2.                                         */
+        p_msg->TimelinePhase = MQTTc_TIMELINE_MSG_PHASE_NONE;
+        p_msg->TimelineID    = MQTTc_TIMELINE_ID_NONE;
+        return;
+    }
+                                                                /* See Note #1.                                         */
+    phase_prev = (phase == MQTTc_TIMELINE_MSG_PHASE_POST) ? MQTTc_TIMELINE_MSG_PHASE_NONE : p_msg->TimelinePhase;
+    if (phase_prev == (CPU_INT08U)phase) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (phase_prev == MQTTc_TIMELINE_MSG_PHASE_NONE) {
+        p_msg->TimelineID = MQTTc_TimelineData.NextID;
+        MQTTc_TimelineData.NextID++;
+        if (MQTTc_TimelineData.NextID == MQTTc_TIMELINE_ID_NONE) {
+            MQTTc_TimelineData.NextID++;
+        }
+    }
+
+    p_rec = MQTTc_TimelineRecGet();
+    if (p_rec != DEF_NULL) {
+        p_rec->ID        =  p_msg->TimelineID;
+        p_rec->MsgID     =  p_msg->MsgID;
+        p_rec->SockId    = (p_msg->ConnPtr != DEF_NULL) ? (CPU_INT16S)p_msg->ConnPtr->SockId : (CPU_INT16S)NET_SOCK_ID_NONE;
+        p_rec->Type      =  MQTTc_TIMELINE_REC_TYPE_MSG;
+        p_rec->Phase     = (CPU_INT08U)phase;
+        p_rec->PhasePrev =  phase_prev;
+        p_rec->MsgType   = (CPU_INT08U)p_msg->Type;
+        p_rec->QoS       =  p_msg->QoS;
+    }
+    CPU_CRITICAL_EXIT();
+
+    p_msg->TimelinePhase = (CPU_INT08U)phase;
+    if (phase == MQTTc_TIMELINE_MSG_PHASE_NONE) {
+        p_msg->TimelineID = MQTTc_TIMELINE_ID_NONE;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                    MQTTc_TimelineMsgCallbackEnd()
+*
+* Description : Record the end of the callbacks of a msg, which ends the msg's span.
+*
+* Argument(s) : id              Timeline ID the msg had when its callbacks were called.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_MsgCallbackExec().
+*
+* Note(s)     : (1) The msg itself is not accessed, since its callbacks may have re-posted or freed it.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineMsgCallbackEnd (CPU_INT32U  id)
+{
+    MQTTc_TIMELINE_REC  *p_rec;
+    CPU_SR_ALLOC();
+
+
+    if ((MQTTc_TimelineData.En != DEF_YES) ||
+        (id                    == MQTTc_TIMELINE_ID_NONE)) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    p_rec = MQTTc_TimelineRecGet();
+    if (p_rec != DEF_NULL) {
+        p_rec->ID        = id;
+        p_rec->MsgID     = MQTT_MSG_ID_NONE;
+        p_rec->SockId    = (CPU_INT16S)NET_SOCK_ID_NONE;
+        p_rec->Type      = MQTTc_TIMELINE_REC_TYPE_MSG_CALLBACK_END;
+        p_rec->Phase     = MQTTc_TIMELINE_MSG_PHASE_NONE;
+        p_rec->PhasePrev = MQTTc_TIMELINE_MSG_PHASE_CALLBACK;
+        p_rec->MsgType   = MQTTc_MSG_TYPE_NONE;
+        p_rec->QoS       = 0u;
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*                                      MQTTc_TimelineTaskPhase()
+*
+* Description : Record the start or the end of a phase of the MQTTc task.
+*
+* Argument(s) : phase           Phase of the task.
+*
+*               is_start        DEF_YES, if the phase starts,
+*                               DEF_NO,  if it ends.
+*
+*               sock_id         Sock ID of the conn processed in the phase, if any.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TIMELINE_TASK_PHASE_START(),
+*               MQTTc_TIMELINE_TASK_PHASE_END().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineTaskPhase (MQTTc_TIMELINE_TASK_PHASE  phase,
+                               CPU_BOOLEAN                is_start,
+                               NET_SOCK_ID                sock_id)
+{
+    MQTTc_TIMELINE_REC  *p_rec;
+    CPU_SR_ALLOC();
+
+
+    if (MQTTc_TimelineData.En != DEF_YES) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    p_rec = MQTTc_TimelineRecGet();
+    if (p_rec != DEF_NULL) {
+        p_rec->ID        =  MQTTc_TIMELINE_ID_NONE;
+        p_rec->MsgID     =  MQTT_MSG_ID_NONE;
+        p_rec->SockId    = (CPU_INT16S)sock_id;
+        p_rec->Type      = (is_start == DEF_YES) ? MQTTc_TIMELINE_REC_TYPE_TASK_START : MQTTc_TIMELINE_REC_TYPE_TASK_END;
+        p_rec->Phase     = (CPU_INT08U)phase;
+        p_rec->PhasePrev =  0u;
+        p_rec->MsgType   =  MQTTc_MSG_TYPE_NONE;
+        p_rec->QoS       =  0u;
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TimelineRecGet()
+*
+* Description : Get a free rec in the buf in which phases are recorded, and timestamp it.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Pointer to rec, if any,
+*               DEF_NULL,       if the buf is full. See mqtt-c_timeline.c Note #2a.
+*
+* Caller(s)   : MQTTc_TimelineMsgPhaseSet(),
+*               MQTTc_TimelineMsgCallbackEnd(),
+*               MQTTc_TimelineTaskPhase().
+*
+* Note(s)     : (1) MUST be called within a critical section, so that the recs of a buf are in the order of
+*                   their timestamps.
+*********************************************************************************************************
+*/
+
+static  MQTTc_TIMELINE_REC  *MQTTc_TimelineRecGet (void)
+{
+    MQTTc_TIMELINE_REC  *p_rec;
+
+
+    if (MQTTc_TimelineData.RecNbr >= MQTTc_CFG_DBG_TIMELINE_BUF_SIZE) {
+        MQTTc_TimelineData.DropCtr++;
+        return (DEF_NULL);
+    }
+
+    p_rec     = &MQTTc_TimelineData.BufTbl[MQTTc_TimelineData.BufIx][MQTTc_TimelineData.RecNbr];
+    p_rec->TS =  CPU_TS_Get32();
+    MQTTc_TimelineData.RecNbr++;
+
+    return (p_rec);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TimelineBufWr()
+*
+* Description : Swap the bufs of recs, and write the recs of the one that was in use to the file.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TimelineClose(),
+*               MQTTc_TimelineFlush().
+*
+* Note(s)     : (1) MUST be called with the lock acquired and a file open. Since only one buf is written at
+*                   a time, the buf written cannot be in use by the tasks recording phases.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TimelineBufWr (void)
+{
+    MQTTc_TIMELINE_REC  *p_buf;
+    CPU_INT32U           rec_nbr;
+    CPU_INT32U           drop_ctr;
+    CPU_INT32U           ix;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_buf    = &MQTTc_TimelineData.BufTbl[MQTTc_TimelineData.BufIx][0u];
+    rec_nbr  =  MQTTc_TimelineData.RecNbr;
+    drop_ctr =  MQTTc_TimelineData.DropCtr;
+    MQTTc_TimelineData.BufIx   = (MQTTc_TimelineData.BufIx + 1u) % MQTTc_TIMELINE_BUF_NBR;
+    MQTTc_TimelineData.RecNbr  =  0u;
+    MQTTc_TimelineData.DropCtr =  0u;
+    CPU_CRITICAL_EXIT();
+
+    for (ix = 0u; ix < rec_nbr; ix++) {
+        MQTTc_TimelineRecWr(&p_buf[ix]);
+    }
+
+    if (drop_ctr != 0u) {                                       /* See mqtt-c_timeline.c Note #2a.                      */
+        MQTTc_TimelineEvtWr("recs dropped", "timeline", 'i', MQTTc_TimelineData.TS_ns);
+        (void)fprintf(MQTTc_TimelineData.FilePtr, ",\"s\":\"g\",\"args\":{\"nbr\":%u}}", (unsigned int)drop_ctr);
+    }
+
+    if (rec_nbr != 0u) {
+        (void)fflush(MQTTc_TimelineData.FilePtr);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TimelineRecWr()
+*
+* Description : Write the trace evts of a rec to the file.
+*
+* Argument(s) : p_rec           Pointer to rec.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TimelineBufWr().
+*
+* Note(s)     : (1) The span of a msg is a nestable async evt ('b'/'e') identified by the msg's timeline ID.
+*                   Its phases are nested async evts with the same ID, ended before the next one starts.
+*
+*               (2) The phases of the task are duration evts ('B'/'E') on the task's thread, which nest
+*                   e.g. the callbacks called while rx'ing.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TimelineRecWr (const  MQTTc_TIMELINE_REC  *p_rec)
+{
+    FILE        *p_file = MQTTc_TimelineData.FilePtr;
+    CPU_INT64U   ts_ns;
+    CPU_INT32U   freq   = MQTTc_TimelineData.TS_Freq;
+
+
+                                                                /* Extend timestamp to 64 bits. See ...                 */
+                                                                /* mqtt-c_timeline.c Note #3.                           */
+    MQTTc_TimelineData.TS_Ticks += (CPU_TS32)(p_rec->TS - MQTTc_TimelineData.TS_Last);
+    MQTTc_TimelineData.TS_Last   =  p_rec->TS;
+    ts_ns = ((MQTTc_TimelineData.TS_Ticks / freq) * 1000000000u) +
+            ((MQTTc_TimelineData.TS_Ticks % freq) * 1000000000u / freq);
+    MQTTc_TimelineData.TS_ns     =  ts_ns;
+
+    switch (p_rec->Type) {
+        case MQTTc_TIMELINE_REC_TYPE_MSG:                       /* See Note #1.                                         */
+        case MQTTc_TIMELINE_REC_TYPE_MSG_CALLBACK_END:
+             if (p_rec->PhasePrev != MQTTc_TIMELINE_MSG_PHASE_NONE) {
+                 MQTTc_TimelineEvtWr(MQTTc_TimelineMsgPhaseNameTbl[p_rec->PhasePrev], "msg", 'e', ts_ns);
+                 (void)fprintf(p_file, ",\"id\":\"0x%X\"}", (unsigned int)p_rec->ID);
+             } else {
+                 MQTTc_TimelineEvtWr("msg", "msg", 'b', ts_ns);
+                 (void)fprintf(p_file,
+                               ",\"id\":\"0x%X\",\"args\":{\"type\":\"%s\",\"msg_id\":%u,\"qos\":%u,\"sock_id\":%d}}",
+                               (unsigned int)p_rec->ID,
+                               (p_rec->MsgType < (sizeof(MQTTc_TimelineMsgTypeNameTbl) / sizeof(MQTTc_TimelineMsgTypeNameTbl[0u]))) ?
+                                   MQTTc_TimelineMsgTypeNameTbl[p_rec->MsgType] : "?",
+                               (unsigned int)p_rec->MsgID,
+                               (unsigned int)p_rec->QoS,
+                               (int)p_rec->SockId);
+             }
+
+             if (p_rec->Phase != MQTTc_TIMELINE_MSG_PHASE_NONE) {
+                 MQTTc_TimelineEvtWr(MQTTc_TimelineMsgPhaseNameTbl[p_rec->Phase], "msg", 'b', ts_ns);
+                 (void)fprintf(p_file, ",\"id\":\"0x%X\"}", (unsigned int)p_rec->ID);
+             } else {
+                 MQTTc_TimelineEvtWr("msg", "msg", 'e', ts_ns);
+                 (void)fprintf(p_file, ",\"id\":\"0x%X\"}", (unsigned int)p_rec->ID);
+             }
+             break;
+
+
+        case MQTTc_TIMELINE_REC_TYPE_TASK_START:                /* See Note #2.                                         */
+             MQTTc_TimelineEvtWr(MQTTc_TimelineTaskPhaseNameTbl[p_rec->Phase], "task", 'B', ts_ns);
+             if (p_rec->SockId != (CPU_INT16S)NET_SOCK_ID_NONE) {
+                 (void)fprintf(p_file, ",\"args\":{\"sock_id\":%d}", (int)p_rec->SockId);
+             }
+             (void)fprintf(p_file, "}");
+             break;
+
+
+        case MQTTc_TIMELINE_REC_TYPE_TASK_END:
+             MQTTc_TimelineEvtWr(MQTTc_TimelineTaskPhaseNameTbl[p_rec->Phase], "task", 'E', ts_ns);
+             (void)fprintf(p_file, "}");
+             break;
+
+
+        default:
+             break;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MQTTc_TimelineEvtWr()
+*
+* Description : Write the start of a trace evt to the file, with the fields common to all evts.
+*
+* Argument(s) : p_name          Name of the evt.
+*
+*               p_cat           Category of the evt.
+*
+*               ph              Phase of the evt, as defined by the trace evt format.
+*
+*               ts_ns           Timestamp of the evt, in ns since the file was opened.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TimelineOpen(),
+*               MQTTc_TimelineBufWr(),
+*               MQTTc_TimelineRecWr().
+*
+* Note(s)     : (1) The caller adds the fields specific to the evt, and closes it with '}'.
+*
+*               (2) Timestamps of the trace evt format are in us, with a fractional part.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_TimelineEvtWr (const  CPU_CHAR    *p_name,
+                                   const  CPU_CHAR    *p_cat,
+                                          CPU_CHAR     ph,
+                                          CPU_INT64U   ts_ns)
+{
+    (void)fprintf(MQTTc_TimelineData.FilePtr,
+                  "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%u,\"tid\":%u",
+                  (MQTTc_TimelineData.IsFirstEvt == DEF_YES) ? "" : ",\n",
+                  (const char *)p_name,
+                  (const char *)p_cat,
+                  (char)ph,
+                  (unsigned long long)(ts_ns / 1000u),          /* See Note #2.                                         */
+                  (unsigned int)(ts_ns % 1000u),
+                  (unsigned int)MQTTc_TIMELINE_PID,
+                  (unsigned int)MQTTc_TIMELINE_TID);
+
+    MQTTc_TimelineData.IsFirstEvt = DEF_NO;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_DBG_TIMELINE_EN                            */
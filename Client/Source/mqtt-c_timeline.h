@@ -0,0 +1,162 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                      MESSAGE AND TASK TIMELINES
+*
+* Filename : mqtt-c_timeline.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc timeline module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_TIMELINE_MODULE_PRESENT
+#define  MQTTc_TIMELINE_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                     MQTTc TIMELINE MESSAGE PHASE
+*
+* Note(s) : (1) Each phase of a msg is shown as a span, nested in a span covering the whole life of the msg,
+*               from its post to the end of its callback.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_timeline_msg_phase {
+    MQTTc_TIMELINE_MSG_PHASE_NONE = 0u,                         /* Msg is not in the timeline.                          */
+    MQTTc_TIMELINE_MSG_PHASE_POST,                              /* Msg is posted, not yet q'd on its conn.              */
+    MQTTc_TIMELINE_MSG_PHASE_Q,                                 /* Msg is q'd in a tx lane of its conn.                 */
+    MQTTc_TIMELINE_MSG_PHASE_TX,                                /* Msg is being tx'd.                                   */
+    MQTTc_TIMELINE_MSG_PHASE_WAIT_ACK,                          /* Msg waits for its reply.                             */
+    MQTTc_TIMELINE_MSG_PHASE_CALLBACK,                          /* Callbacks of msg are being called.                   */
+    MQTTc_TIMELINE_MSG_PHASE_NBR                                /* Nbr of phases. MUST be last.                         */
+} MQTTc_TIMELINE_MSG_PHASE;
+
+
+/*
+*********************************************************************************************************
+*                                      MQTTc TIMELINE TASK PHASE
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_timeline_task_phase {
+    MQTTc_TIMELINE_TASK_PHASE_SEL = 0u,                         /* Task waits on sock sel.                              */
+    MQTTc_TIMELINE_TASK_PHASE_RD,                               /* Task rx's on a conn.                                 */
+    MQTTc_TIMELINE_TASK_PHASE_WR,                               /* Task tx's on a conn.                                 */
+    MQTTc_TIMELINE_TASK_PHASE_CALLBACK,                         /* Task calls application callbacks.                    */
+    MQTTc_TIMELINE_TASK_PHASE_MSG_PROCESS,                      /* Task q's a posted msg on its conn.                   */
+    MQTTc_TIMELINE_TASK_PHASE_NBR                               /* Nbr of phases. MUST be last.                         */
+} MQTTc_TIMELINE_TASK_PHASE;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MACRO'S
+*
+* Note(s) : (1) When timelines are disabled, the macros expand to nothing and the hot path is unchanged.
+*               When enabled, but no file is open, each record only costs a test of a flag.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+#define  MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, phase)              MQTTc_TimelineMsgPhaseSet((p_msg), (phase))
+
+#define  MQTTc_TIMELINE_MSG_CALLBACK_END(id)                     MQTTc_TimelineMsgCallbackEnd((id))
+
+#define  MQTTc_TIMELINE_TASK_PHASE_START(phase, sock_id)         MQTTc_TimelineTaskPhase((phase), DEF_YES, (sock_id))
+
+#define  MQTTc_TIMELINE_TASK_PHASE_END(phase)                    MQTTc_TimelineTaskPhase((phase), DEF_NO,  NET_SOCK_ID_NONE)
+#else
+#define  MQTTc_TIMELINE_MSG_PHASE_SET(p_msg, phase)
+#define  MQTTc_TIMELINE_MSG_CALLBACK_END(id)
+#define  MQTTc_TIMELINE_TASK_PHASE_START(phase, sock_id)
+#define  MQTTc_TIMELINE_TASK_PHASE_END(phase)
+#endif
+
+
+#if (MQTTc_CFG_DBG_TIMELINE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void  MQTTc_TimelineInit            (       MQTTc_ERR                  *p_err);
+
+void  MQTTc_TimelineOpen            (const  CPU_CHAR                   *p_file_name,
+                                            MQTTc_ERR                  *p_err);
+
+void  MQTTc_TimelineClose           (       MQTTc_ERR                  *p_err);
+
+void  MQTTc_TimelineFlush           (       void);
+
+void  MQTTc_TimelineMsgPhaseSet     (       MQTTc_MSG                  *p_msg,
+                                            MQTTc_TIMELINE_MSG_PHASE    phase);
+
+void  MQTTc_TimelineMsgCallbackEnd  (       CPU_INT32U                  id);
+
+void  MQTTc_TimelineTaskPhase       (       MQTTc_TIMELINE_TASK_PHASE   phase,
+                                            CPU_BOOLEAN                 is_start,
+                                            NET_SOCK_ID                 sock_id);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_DBG_TIMELINE_EN                            */
+#endif
@@ -0,0 +1,248 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                          BINARY TRACE RING
+*
+* Filename : mqtt-c_trace.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The trace ring records the events of the hot path as fixed-size binary entries, without
+*                formatting them, so that it can be left enabled in the field. Once full, the oldest
+*                entries are overwritten.
+*
+*            (2) The ring is dumped as is, e.g. from a debugger or by the application, and turned into
+*                text offline by Client/Tools/mqtt-c_trace_decode.py.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <cpu.h>
+#include  <cpu_core.h>
+
+#include  "mqtt-c_trace.h"
+
+
+#if (MQTTc_CFG_DBG_TRACE_RING_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  MQTTc_TRACE_RING  MQTTc_TraceRing = {
+    MQTTc_TRACE_RING_MAGIC,
+    MQTTc_TRACE_RING_VER,
+    sizeof(MQTTc_TRACE_ENTRY),
+    MQTTc_CFG_DBG_TRACE_RING_SIZE,
+    0u,
+    0u,
+    DEF_ENABLED,
+    {0u, 0u, 0u},
+    {{0u, 0u, 0u, 0, {0u}}}
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     CONFIGURATION ERROR CHECKING
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (CPU_CFG_TS_32_EN != DEF_ENABLED)
+#error  "CPU_CFG_TS_32_EN illegally #define'd in 'cpu_cfg.h'. MUST be DEF_ENABLED when MQTTc_CFG_DBG_TRACE_RING_EN is DEF_ENABLED."
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_TraceInit()
+*
+* Description : Initialize the trace ring.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Init().
+*
+* Note(s)     : (1) The freq of the timestamps is kept in the ring, so that the decoder can convert them.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TraceInit (void)
+{
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    CPU_TS_TMR_FREQ  freq;
+    CPU_ERR          err_cpu;
+
+
+    freq = CPU_TS_TmrFreqGet(&err_cpu);                         /* See Note #1.                                         */
+    if (err_cpu == CPU_ERR_NONE) {
+        MQTTc_TraceRing.TS_Freq = (CPU_INT32U)freq;
+    }
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_TraceEvt()
+*
+* Description : Record an event in the trace ring.
+*
+* Argument(s) : evt             Event ID.
+*
+*               sock_id         Sock ID of conn on which the event occurred.
+*
+*               arg0            First  arg of event.
+*
+*               arg1            Second arg of event.
+*
+*               arg2            Third  arg of event.
+*
+*               arg3            Fourth arg of event.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_TRACE_EVT().
+*
+* Note(s)     : (1) Only the claim of the entry's seq nbr is done within a critical section, so that events
+*                   can be recorded from the MQTTc task and from the application tasks. The entry is then
+*                   filled outside of it, and published by writing its seq nbr last. See 'MQTTc TRACE RING
+*                   ENTRY Note #1'.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TraceEvt (MQTTc_TRACE_EVT  evt,
+                      NET_SOCK_ID      sock_id,
+                      CPU_INT32U       arg0,
+                      CPU_INT32U       arg1,
+                      CPU_INT32U       arg2,
+                      CPU_INT32U       arg3)
+{
+    MQTTc_TRACE_ENTRY  *p_entry;
+    CPU_INT32U          seq;
+    CPU_SR_ALLOC();
+
+
+    if (MQTTc_TraceRing.En != DEF_ENABLED) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    MQTTc_TraceRing.Seq++;
+    seq = MQTTc_TraceRing.Seq;
+    CPU_CRITICAL_EXIT();
+
+    p_entry = &MQTTc_TraceRing.EntryTbl[seq & (MQTTc_CFG_DBG_TRACE_RING_SIZE - 1u)];
+
+    p_entry->Seq       =  0u;
+    p_entry->TS        =  CPU_TS_Get32();
+    p_entry->EvtID     = (CPU_INT16U)evt;
+    p_entry->SockId    = (CPU_INT16S)sock_id;
+    p_entry->ArgTbl[0] =  arg0;
+    p_entry->ArgTbl[1] =  arg1;
+    p_entry->ArgTbl[2] =  arg2;
+    p_entry->ArgTbl[3] =  arg3;
+    p_entry->Seq       =  seq;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_TraceRingGet()
+*
+* Description : Get the trace ring, to dump it.
+*
+* Argument(s) : p_len           Pointer to variable that will receive the len of the ring, in bytes.
+*
+* Return(s)   : Pointer to the trace ring.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) The ring SHOULD be disabled with MQTTc_TraceEnSet() while it is dumped, so that the
+*                   entries dumped last do not overwrite the ones dumped first.
+*********************************************************************************************************
+*/
+
+MQTTc_TRACE_RING  *MQTTc_TraceRingGet (CPU_INT32U  *p_len)
+{
+    if (p_len != DEF_NULL) {
+       *p_len = sizeof(MQTTc_TraceRing);
+    }
+
+    return (&MQTTc_TraceRing);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_TraceEnSet()
+*
+* Description : Enable or disable the recording of events in the trace ring.
+*
+* Argument(s) : en              DEF_ENABLED, to record events,
+*                               DEF_DISABLED, otherwise.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) Events are recorded by default. Disabling the ring freezes its content, e.g. once a
+*                   fault is detected, until it is dumped.
+*********************************************************************************************************
+*/
+
+void  MQTTc_TraceEnSet (CPU_BOOLEAN  en)
+{
+    MQTTc_TraceRing.En = en;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_DBG_TRACE_RING_EN                          */
@@ -0,0 +1,202 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                          BINARY TRACE RING
+*
+* Filename : mqtt-c_trace.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc trace module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_TRACE_MODULE_PRESENT
+#define  MQTTc_TRACE_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_TRACE_RING_MAGIC                  0x5254514Du    /* 'MQTR', in little-endian.                            */
+#define  MQTTc_TRACE_RING_VER                             1u
+
+#define  MQTTc_TRACE_ARG_NBR                              4u
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc TRACE EVENT
+*
+* Note(s) : (1) The args of each event are listed in its comment. The decoder in Client/Tools reads them from
+*               this file : new events MUST be added before MQTTc_TRACE_EVT_NBR, with such a comment.
+*
+*           (2) 'type' args are MQTTc_MSG_TYPE values and 'err' args are MQTTc_ERR values.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_trace_evt {
+    MQTTc_TRACE_EVT_NONE,                                       /* Args: none.                                          */
+    MQTTc_TRACE_EVT_MSG_POST,                                   /* Args: type, msg ID, len.                             */
+    MQTTc_TRACE_EVT_MSG_CMPL,                                   /* Args: type, msg ID, err.                             */
+    MQTTc_TRACE_EVT_TX,                                         /* Args: type, len, len tx'd.                           */
+    MQTTc_TRACE_EVT_TX_CMPL,                                    /* Args: type, msg ID, QoS.                             */
+    MQTTc_TRACE_EVT_TX_COALESCE,                                /* Args: len, msg nbr.                                  */
+    MQTTc_TRACE_EVT_TX_ACK,                                     /* Args: len, len tx'd.                                 */
+    MQTTc_TRACE_EVT_ACK_Q_FULL,                                 /* Args: ack Q len.                                     */
+    MQTTc_TRACE_EVT_RX_HDR,                                     /* Args: type, hdr.                                     */
+    MQTTc_TRACE_EVT_RX_LEN,                                     /* Args: type, len.                                     */
+    MQTTc_TRACE_EVT_RX_MSG_ID,                                  /* Args: type, msg ID.                                  */
+    MQTTc_TRACE_EVT_RX_PAYLOAD,                                 /* Args: len, len rx'd.                                 */
+    MQTTc_TRACE_EVT_RX_PUBLISH,                                 /* Args: QoS, msg ID, is delivered.                     */
+    MQTTc_TRACE_EVT_RX_FILTERED,                                /* Args: payload len.                                   */
+    MQTTc_TRACE_EVT_RX_ACK_ERR,                                 /* Args: type, code or len.                             */
+    MQTTc_TRACE_EVT_CALLBACK_OVERRUN,                           /* Args: callback, duration us, threshold us.           */
+    MQTTc_TRACE_EVT_NBR                                         /* Nbr of events. MUST be last.                         */
+} MQTTc_TRACE_EVT;
+
+
+#if (MQTTc_CFG_DBG_TRACE_RING_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                        MQTTc TRACE RING ENTRY
+*
+* Note(s) : (1) The seq nbr of an entry is set last, once the rest of the entry has been written. An entry
+*               whose seq nbr does not match its position in the ring is being written, and is skipped by
+*               the decoder.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_trace_entry {
+    CPU_INT32U  Seq;                                            /* Seq nbr of entry, from 1. See Note #1.               */
+    CPU_TS32    TS;                                             /* Timestamp, in CPU_TS_Get32() ticks.                  */
+    CPU_INT16U  EvtID;                                          /* Event ID. See MQTTc_TRACE_EVT.                       */
+    CPU_INT16S  SockId;                                         /* Sock ID of conn, -1 if none.                         */
+    CPU_INT32U  ArgTbl[MQTTc_TRACE_ARG_NBR];                    /* Args of event.                                       */
+} MQTTc_TRACE_ENTRY;
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc TRACE RING
+*
+* Note(s) : (1) The ring is self-describing, so that it can be decoded from a raw memory dump. Its fields are
+*               in the CPU's endianness, which the decoder detects from the magic.
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_trace_ring {
+    CPU_INT32U         Magic;                                   /* MQTTc_TRACE_RING_MAGIC.                              */
+    CPU_INT16U         Ver;                                     /* MQTTc_TRACE_RING_VER.                                */
+    CPU_INT16U         EntryLen;                                /* Len of an entry, in bytes.                           */
+    CPU_INT32U         EntryNbr;                                /* Nbr of entries in ring.                              */
+    CPU_INT32U         TS_Freq;                                 /* Freq of timestamps, in Hz. 0 if unknown.             */
+    CPU_INT32U         Seq;                                     /* Seq nbr of last entry claimed.                       */
+    CPU_BOOLEAN        En;                                      /* Flag indicating if events are recorded.              */
+    CPU_INT08U         Rsvd[3];
+                                                                /* Entries. Entry of seq nbr N is at N % EntryNbr.      */
+    MQTTc_TRACE_ENTRY  EntryTbl[MQTTc_CFG_DBG_TRACE_RING_SIZE];
+} MQTTc_TRACE_RING;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MACRO'S
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_TRACE_EVT(p_conn, evt, a0, a1, a2, a3)   MQTTc_TraceEvt((evt),                  \
+                                                                       (p_conn)->SockId,       \
+                                                                       (CPU_INT32U)(a0),       \
+                                                                       (CPU_INT32U)(a1),       \
+                                                                       (CPU_INT32U)(a2),       \
+                                                                       (CPU_INT32U)(a3))
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void               MQTTc_TraceInit    (void);
+
+void               MQTTc_TraceEvt     (MQTTc_TRACE_EVT   evt,
+                                       NET_SOCK_ID       sock_id,
+                                       CPU_INT32U        arg0,
+                                       CPU_INT32U        arg1,
+                                       CPU_INT32U        arg2,
+                                       CPU_INT32U        arg3);
+
+MQTTc_TRACE_RING  *MQTTc_TraceRingGet (CPU_INT32U       *p_len);
+
+void               MQTTc_TraceEnSet   (CPU_BOOLEAN       en);
+
+
+#else
+#define  MQTTc_TRACE_EVT(p_conn, evt, a0, a1, a2, a3)
+#endif                                                          /* MQTTc_CFG_DBG_TRACE_RING_EN                          */
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif
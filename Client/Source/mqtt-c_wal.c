@@ -0,0 +1,749 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                  WRITE-AHEAD LOG OF IN-FLIGHT STATE
+*
+* Filename : mqtt-c_wal.c
+* Version  : V1.02.00
+*********************************************************************************************************
+* Note(s)  : (1) The write-ahead log (WAL) records each change of state of the QoS 1 and QoS 2 flows in
+*                flight on a connection, so that they can be resumed with the same msg IDs after a restart
+*                of the application. It is kept in a memory region given by the application, like the
+*                store. See mqtt-c_store.c Note #1.
+*
+*            (2) The region is split in two halves, laid out as follows :
+*
+*                    +-----+-------+-------+-----+-----------+
+*                    | Hdr | Rec 0 | Rec 1 | ... | Rec N - 1 |
+*                    +-----+-------+-------+-----+-----------+
+*
+*                (a) Only one half is in use at a time. Its hdr holds the epoch of the half, which is
+*                    incremented each time the other half is put in use.
+*
+*                (b) Each rec holds one change of state and the epoch of the half it was written in.
+*
+*                (c) When the half in use is full, the live entries of the tbl are written at the start of
+*                    the other half, then the hdr of the other half is written. The old half is kept
+*                    until the new hdr is synced.
+*
+*            (3) The log is crash-consistent. When the log is opened, the half with the valid hdr of the
+*                highest epoch is replayed, up to the first rec that is torn or left by a previous epoch.
+*                The tbl is then written to the other half, so that recs left after the end of the replay
+*                can never be replayed later.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include  <lib_def.h>
+#include  <lib_mem.h>
+#include  <cpu.h>
+
+#include  "mqtt-c_wal.h"
+
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_WAL_MAGIC                                 0x4C41574Du
+#define  MQTTc_WAL_VER                                            1u
+#define  MQTTc_WAL_HALF_NBR                                       2u
+#define  MQTTc_WAL_ALIGN                                          4u
+
+#define  MQTTc_WAL_POS_IS_EQ(p_a, p_b)        ((((p_a)->SegSeq == (p_b)->SegSeq) && \
+                                                ((p_a)->Offset == (p_b)->Offset)) ? DEF_YES : DEF_NO)
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*
+* Note(s) : (1) Every structure is a multiple of 32 bits long, with its CRC as last field. See mqtt-c_store.c
+*               LOCAL DATA TYPES Note #1.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_wal_hdr {
+    CPU_INT32U  Magic;                                          /* Identifies an MQTTc WAL.                             */
+    CPU_INT32U  Ver;                                            /* Version of the layout.                               */
+    CPU_INT32U  Epoch;                                          /* Epoch of half. The highest valid one wins.           */
+    CPU_INT32U  CRC;                                            /* CRC of the fields above.                             */
+} MQTTc_WAL_HDR;
+
+typedef  struct  mqttc_wal_rec {
+    CPU_INT32U  Epoch;                                          /* Epoch of half in which rec was written.              */
+    CPU_INT32U  SegSeq;                                         /* Pos of rec in store, for outbound flows.             */
+    CPU_INT32U  Offset;
+    CPU_INT16U  MsgID;                                          /* Msg ID used by flow.                                 */
+    CPU_INT16U  State;                                          /* New state of flow.                                   */
+    CPU_INT32U  CRC;                                            /* CRC of the fields above.                             */
+} MQTTc_WAL_REC;
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN       MQTTc_WalRecover   (MQTTc_WAL        *p_wal);
+
+static  void              MQTTc_WalCompact   (MQTTc_WAL        *p_wal);
+
+static  MQTTc_WAL_ENTRY  *MQTTc_WalApply     (MQTTc_WAL        *p_wal,
+                                              MQTTc_WAL_STATE   state,
+                                              CPU_INT16U        msg_id,
+                                              MQTTc_STORE_POS  *p_pos);
+
+static  MQTTc_WAL_HDR    *MQTTc_WalHdrGet    (MQTTc_WAL        *p_wal,
+                                              CPU_INT08U        half_ix);
+
+static  MQTTc_WAL_REC    *MQTTc_WalRecGet    (MQTTc_WAL        *p_wal,
+                                              CPU_INT08U        half_ix,
+                                              CPU_INT32U        rec_ix);
+
+static  void              MQTTc_WalRecWr     (MQTTc_WAL        *p_wal,
+                                              CPU_INT08U        half_ix,
+                                              CPU_INT32U        rec_ix,
+                                              MQTTc_WAL_ENTRY  *p_entry);
+
+static  void              MQTTc_WalSyncRange (MQTTc_WAL        *p_wal,
+                                              void             *p_addr,
+                                              CPU_INT32U        len);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_WalOpen()
+*
+* Description : Open a WAL over a memory region, rebuilding the state of the flows it holds, if any.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object to open.
+*
+*               p_mem           Pointer to memory region holding the log. MUST be aligned on 4 bytes.
+*
+*               mem_len         Len of memory region, in bytes.
+*
+*               sync_policy     When the records are synced :
+*                                   MQTTc_WAL_SYNC_POLICY_NONE      Never.
+*                                   MQTTc_WAL_SYNC_POLICY_GROUP     In a single batch, before each tx.
+*                                   MQTTc_WAL_SYNC_POLICY_EACH      After each record.
+*
+*               sync_fnct       Function called to sync the memory region, DEF_NULL if none.
+*
+*               p_sync_arg      Argument passed to sync function.
+*
+*               p_err           Pointer to variable that will receive the return error code from this function :
+*                                   MQTTc_ERR_NONE              Operation successful.
+*                                   MQTTc_ERR_NULL_PTR          Null ptr was passed as argument.
+*                                   MQTTc_ERR_INVALID_ARG       Invalid memory region or sync policy.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) Each half MUST be able to hold more records than the tbl has entries. See mqtt-c_wal.c
+*                   Note #2c.
+*
+*               (2) A region that does not hold a valid log is formatted, which discards its content.
+*
+*               (3) The WAL MUST be opened before it is set on a connection. See MQTTc_ConnSetParam()
+*                   Note #8e.
+*********************************************************************************************************
+*/
+
+void  MQTTc_WalOpen (MQTTc_WAL              *p_wal,
+                     void                   *p_mem,
+                     CPU_INT32U              mem_len,
+                     MQTTc_WAL_SYNC_POLICY   sync_policy,
+                     MQTTc_STORE_SYNC_FNCT   sync_fnct,
+                     void                   *p_sync_arg,
+                     MQTTc_ERR              *p_err)
+{
+    CPU_INT32U  half_len;
+    CPU_INT32U  rec_nbr_max;
+
+
+    #if (MQTTc_CFG_ARG_CHK_EXT_EN == DEF_ENABLED)
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        if ((p_wal == DEF_NULL) ||
+            (p_mem == DEF_NULL)) {
+           *p_err = MQTTc_ERR_NULL_PTR;
+            return;
+        }
+    #endif
+
+    half_len    = (mem_len / MQTTc_WAL_HALF_NBR) & ~(MQTTc_WAL_ALIGN - 1u);
+    rec_nbr_max = (half_len < sizeof(MQTTc_WAL_HDR)) ? 0u : ((half_len - sizeof(MQTTc_WAL_HDR)) / sizeof(MQTTc_WAL_REC));
+    if (((((CPU_ADDR)p_mem) % MQTTc_WAL_ALIGN) != 0u)                ||
+        (rec_nbr_max                          <= MQTTc_WAL_TBL_SIZE) ||
+        (sync_policy                          >  MQTTc_WAL_SYNC_POLICY_EACH)) {
+       *p_err = MQTTc_ERR_INVALID_ARG;                          /* See Note #1.                                         */
+        return;
+    }
+
+    p_wal->MemPtr     = (CPU_INT08U *)p_mem;
+    p_wal->HalfLen    =  half_len;
+    p_wal->RecNbrMax  =  rec_nbr_max;
+    p_wal->SyncPolicy =  sync_policy;
+    p_wal->SyncFnct   =  sync_fnct;
+    p_wal->SyncArgPtr =  p_sync_arg;
+
+    Mem_Clr(p_wal->Tbl, sizeof(p_wal->Tbl));
+
+    if (MQTTc_WalRecover(p_wal) == DEF_NO) {                    /* See Note #2.                                         */
+        Mem_Clr(p_wal->MemPtr, half_len * MQTTc_WAL_HALF_NBR);
+        MQTTc_WalSyncRange(p_wal, p_wal->MemPtr, half_len * MQTTc_WAL_HALF_NBR);
+        p_wal->HalfIx = 1u;
+        p_wal->Epoch  = 0u;
+    }
+
+    MQTTc_WalCompact(p_wal);                                    /* See mqtt-c_wal.c Note #3.                            */
+
+   *p_err = MQTTc_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_WalLog()
+*
+* Description : Record a change of state of a flow.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               state           New state of the flow.
+*
+*               msg_id          Msg ID used by the flow.
+*
+*               p_pos           Pointer to pos of the record in the store, for outbound flows,
+*                               DEF_NULL,                                   for inbound  flows.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_ConnStoreFeed(),
+*               MQTTc_ConnStoreMsgCmpl(),
+*               MQTTc_ConnStorePubRecRx(),
+*               MQTTc_ConnWalRestore(),
+*               MQTTc_ConnCloseProc(),
+*               MQTTc_RdSockProcess().
+*
+* Note(s)     : (1) MUST only be called from the MQTTc task, or before the WAL is set on a connection.
+*
+*               (2) The tbl is sized so that it cannot be full. See mqtt-c_wal.h DEFINES Note #1.
+*
+*               (3) The change is applied to the tbl before the half in use is compacted, so that the
+*                   snapshot written to the other half already holds it.
+*********************************************************************************************************
+*/
+
+void  MQTTc_WalLog (MQTTc_WAL         *p_wal,
+                    MQTTc_WAL_STATE    state,
+                    CPU_INT16U         msg_id,
+                    MQTTc_STORE_POS   *p_pos)
+{
+    MQTTc_WAL_ENTRY  *p_entry;
+    MQTTc_WAL_ENTRY   entry;
+
+
+    p_entry = MQTTc_WalApply(p_wal, state, msg_id, p_pos);
+    if ((p_entry == DEF_NULL)                  &&               /* See Note #2.                                         */
+        (state   != MQTTc_WAL_STATE_OUT_FREE)  &&
+        (state   != MQTTc_WAL_STATE_IN_FREE)) {
+        return;
+    }
+
+    if (p_wal->RecIx >= p_wal->RecNbrMax) {                     /* See Note #3.                                         */
+        MQTTc_WalCompact(p_wal);
+        return;
+    }
+
+    entry.State = state;
+    entry.MsgID = msg_id;
+    if (p_pos != DEF_NULL) {
+        entry.Pos = *p_pos;
+    } else {
+        entry.Pos.SegSeq = 0u;
+        entry.Pos.Offset = 0u;
+    }
+
+    MQTTc_WalRecWr(p_wal, p_wal->HalfIx, p_wal->RecIx, &entry);
+    p_wal->RecIx++;
+
+    if (p_wal->SyncPolicy == MQTTc_WAL_SYNC_POLICY_EACH) {
+        MQTTc_WalSync(p_wal);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_WalOutFind()
+*
+* Description : Find the outbound flow of a record of the store.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               p_pos           Pointer to pos of the record in the store.
+*
+* Return(s)   : Pointer to entry of the flow, if any,
+*               DEF_NULL,                     otherwise.
+*
+* Caller(s)   : MQTTc_ConnStoreFeed(),
+*               MQTTc_WalApply().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+MQTTc_WAL_ENTRY  *MQTTc_WalOutFind (MQTTc_WAL        *p_wal,
+                                    MQTTc_STORE_POS  *p_pos)
+{
+    MQTTc_WAL_ENTRY  *p_entry;
+    CPU_INT08U        ix;
+
+
+    for (ix = 0u; ix < MQTTc_WAL_TBL_SIZE; ix++) {
+        p_entry = &p_wal->Tbl[ix];
+        if ((p_entry->State                           >= MQTTc_WAL_STATE_OUT_TX)   &&
+            (p_entry->State                           <= MQTTc_WAL_STATE_OUT_CMPL) &&
+            (MQTTc_WAL_POS_IS_EQ(&p_entry->Pos, p_pos) == DEF_YES)) {
+            return (p_entry);
+        }
+    }
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            MQTTc_WalSync()
+*
+* Description : Sync the records written since the last sync, in a single batch.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_Task(),
+*               MQTTc_WalLog().
+*
+* Note(s)     : (1) Called by the task before anything is tx'd on the connection. See mqtt-c_wal.h MQTTc WAL
+*                   SYNC POLICY Note #1.
+*********************************************************************************************************
+*/
+
+void  MQTTc_WalSync (MQTTc_WAL  *p_wal)
+{
+    if (p_wal->SyncIx == p_wal->RecIx) {
+        return;
+    }
+
+    if (p_wal->SyncPolicy != MQTTc_WAL_SYNC_POLICY_NONE) {
+        MQTTc_WalSyncRange(p_wal,
+                           MQTTc_WalRecGet(p_wal, p_wal->HalfIx, p_wal->SyncIx),
+                          (p_wal->RecIx - p_wal->SyncIx) * sizeof(MQTTc_WAL_REC));
+    }
+
+    p_wal->SyncIx = p_wal->RecIx;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_WalRecover()
+*
+* Description : Rebuild the tbl of given MQTTc WAL from the records held in its memory region.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+* Return(s)   : DEF_YES, if the log was recovered,
+*               DEF_NO,  if no valid hdr was found.
+*
+* Caller(s)   : MQTTc_WalOpen().
+*
+* Note(s)     : (1) The comparison of epochs remains valid when they wrap around.
+*
+*               (2) See mqtt-c_wal.c Note #3.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  MQTTc_WalRecover (MQTTc_WAL  *p_wal)
+{
+    MQTTc_WAL_HDR    *p_hdr;
+    MQTTc_WAL_HDR    *p_hdr_cur  = DEF_NULL;
+    MQTTc_WAL_REC    *p_rec;
+    MQTTc_STORE_POS   pos;
+    CPU_INT32U        rec_ix;
+    CPU_INT08U        half_ix;
+
+
+    for (half_ix = 0u; half_ix < MQTTc_WAL_HALF_NBR; half_ix++) {
+        p_hdr = MQTTc_WalHdrGet(p_wal, half_ix);
+        if ((p_hdr->Magic != MQTTc_WAL_MAGIC) ||
+            (p_hdr->Ver   != MQTTc_WAL_VER)   ||
+            (p_hdr->CRC   != MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_hdr, sizeof(MQTTc_WAL_HDR) - sizeof(CPU_INT32U)))) {
+            continue;
+        }
+        if ((p_hdr_cur == DEF_NULL) ||                          /* See Note #1.                                         */
+            ((CPU_INT32S)(p_hdr->Epoch - p_hdr_cur->Epoch) > 0)) {
+            p_hdr_cur     = p_hdr;
+            p_wal->HalfIx = half_ix;
+        }
+    }
+
+    if (p_hdr_cur == DEF_NULL) {
+        return (DEF_NO);
+    }
+
+    p_wal->Epoch = p_hdr_cur->Epoch;
+
+    for (rec_ix = 0u; rec_ix < p_wal->RecNbrMax; rec_ix++) {    /* See Note #2.                                         */
+        p_rec = MQTTc_WalRecGet(p_wal, p_wal->HalfIx, rec_ix);
+        if ((p_rec->Epoch != p_wal->Epoch) ||
+            (p_rec->CRC   != MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_rec, sizeof(MQTTc_WAL_REC) - sizeof(CPU_INT32U)))) {
+            break;
+        }
+
+        pos.SegSeq = p_rec->SegSeq;
+        pos.Offset = p_rec->Offset;
+        (void)MQTTc_WalApply(p_wal,
+                             (MQTTc_WAL_STATE)p_rec->State,
+                             p_rec->MsgID,
+                            &pos);
+    }
+
+    return (DEF_YES);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_WalCompact()
+*
+* Description : Write the live entries of the tbl of given MQTTc WAL to the other half of its region and
+*               put that half in use.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_WalOpen(),
+*               MQTTc_WalLog().
+*
+* Note(s)     : (1) The recs are synced before the hdr is written, and the hdr is synced before the half is
+*                   used. A crash in between leaves the old half in use. See mqtt-c_wal.c Note #2c.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_WalCompact (MQTTc_WAL  *p_wal)
+{
+    MQTTc_WAL_HDR  *p_hdr;
+    CPU_INT08U      half_ix;
+    CPU_INT32U      epoch;
+    CPU_INT32U      rec_ix  = 0u;
+    CPU_INT08U      ix;
+
+
+    half_ix = (p_wal->HalfIx + 1u) % MQTTc_WAL_HALF_NBR;
+    epoch   =  p_wal->Epoch  + 1u;
+
+    p_wal->HalfIx = half_ix;                                    /* Recs are tagged with the epoch of the half in use.   */
+    p_wal->Epoch  = epoch;
+    for (ix = 0u; ix < MQTTc_WAL_TBL_SIZE; ix++) {
+        if (p_wal->Tbl[ix].State != MQTTc_WAL_STATE_NONE) {
+            MQTTc_WalRecWr(p_wal, half_ix, rec_ix, &p_wal->Tbl[ix]);
+            rec_ix++;
+        }
+    }
+    if (rec_ix != 0u) {                                         /* See Note #1.                                         */
+        MQTTc_WalSyncRange(p_wal,
+                           MQTTc_WalRecGet(p_wal, half_ix, 0u),
+                           rec_ix * sizeof(MQTTc_WAL_REC));
+    }
+
+    p_hdr        = MQTTc_WalHdrGet(p_wal, half_ix);
+    p_hdr->Magic = MQTTc_WAL_MAGIC;
+    p_hdr->Ver   = MQTTc_WAL_VER;
+    p_hdr->Epoch = epoch;
+    p_hdr->CRC   = MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_hdr, sizeof(MQTTc_WAL_HDR) - sizeof(CPU_INT32U));
+    MQTTc_WalSyncRange(p_wal, p_hdr, sizeof(MQTTc_WAL_HDR));
+
+    p_wal->RecIx  = rec_ix;
+    p_wal->SyncIx = rec_ix;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_WalApply()
+*
+* Description : Apply a change of state to the tbl of given MQTTc WAL.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               state           New state of the flow.
+*
+*               msg_id          Msg ID used by the flow.
+*
+*               p_pos           Pointer to pos of the record in the store, for outbound flows.
+*
+* Return(s)   : Pointer to entry of the flow, if it is still in flight,
+*               DEF_NULL,                     otherwise.
+*
+* Caller(s)   : MQTTc_WalLog(),
+*               MQTTc_WalRecover().
+*
+* Note(s)     : (1) See mqtt-c_wal.h MQTTc WAL STATE Note #1.
+*********************************************************************************************************
+*/
+
+static  MQTTc_WAL_ENTRY  *MQTTc_WalApply (MQTTc_WAL        *p_wal,
+                                          MQTTc_WAL_STATE   state,
+                                          CPU_INT16U        msg_id,
+                                          MQTTc_STORE_POS  *p_pos)
+{
+    MQTTc_WAL_ENTRY  *p_entry = DEF_NULL;
+    CPU_INT08U        ix;
+
+
+    switch (state) {                                            /* See Note #1.                                         */
+        case MQTTc_WAL_STATE_OUT_TX:
+        case MQTTc_WAL_STATE_OUT_REL:
+        case MQTTc_WAL_STATE_OUT_CMPL:
+        case MQTTc_WAL_STATE_OUT_FREE:
+             p_entry = MQTTc_WalOutFind(p_wal, p_pos);
+             break;
+
+
+        case MQTTc_WAL_STATE_IN_REC:
+        case MQTTc_WAL_STATE_IN_FREE:
+             for (ix = 0u; ix < MQTTc_WAL_TBL_SIZE; ix++) {
+                 if ((p_wal->Tbl[ix].State == MQTTc_WAL_STATE_IN_REC) &&
+                     (p_wal->Tbl[ix].MsgID == msg_id)) {
+                     p_entry = &p_wal->Tbl[ix];
+                     break;
+                 }
+             }
+             break;
+
+
+        default:
+             return (DEF_NULL);
+    }
+
+    if ((state == MQTTc_WAL_STATE_OUT_FREE) ||
+        (state == MQTTc_WAL_STATE_IN_FREE)) {
+        if (p_entry != DEF_NULL) {
+            p_entry->State = MQTTc_WAL_STATE_NONE;
+        }
+        return (DEF_NULL);
+    }
+
+    if (p_entry == DEF_NULL) {                                  /* New flow. Take a free entry.                         */
+        for (ix = 0u; ix < MQTTc_WAL_TBL_SIZE; ix++) {
+            if (p_wal->Tbl[ix].State == MQTTc_WAL_STATE_NONE) {
+                p_entry = &p_wal->Tbl[ix];
+                break;
+            }
+        }
+        if (p_entry == DEF_NULL) {
+            return (DEF_NULL);
+        }
+        if (p_pos != DEF_NULL) {
+            p_entry->Pos = *p_pos;
+        } else {
+            p_entry->Pos.SegSeq = 0u;
+            p_entry->Pos.Offset = 0u;
+        }
+    }
+
+    p_entry->State = state;
+    p_entry->MsgID = msg_id;
+
+    return (p_entry);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_WalHdrGet()
+*
+* Description : Get the address of the hdr of a half of the region of given MQTTc WAL.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               half_ix         Ix of the half.
+*
+* Return(s)   : Pointer to hdr of the half.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_WAL_HDR  *MQTTc_WalHdrGet (MQTTc_WAL   *p_wal,
+                                         CPU_INT08U   half_ix)
+{
+    return ((MQTTc_WAL_HDR *)&p_wal->MemPtr[half_ix * p_wal->HalfLen]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MQTTc_WalRecGet()
+*
+* Description : Get the address of a record of a half of the region of given MQTTc WAL.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               half_ix         Ix of the half.
+*
+*               rec_ix          Ix of the record in the half.
+*
+* Return(s)   : Pointer to the record.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  MQTTc_WAL_REC  *MQTTc_WalRecGet (MQTTc_WAL   *p_wal,
+                                         CPU_INT08U   half_ix,
+                                         CPU_INT32U   rec_ix)
+{
+    return ((MQTTc_WAL_REC *)&p_wal->MemPtr[(half_ix * p_wal->HalfLen) + sizeof(MQTTc_WAL_HDR) + (rec_ix * sizeof(MQTTc_WAL_REC))]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc_WalRecWr()
+*
+* Description : Write a record in a half of the region of given MQTTc WAL.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               half_ix         Ix of the half.
+*
+*               rec_ix          Ix of the record in the half.
+*
+*               p_entry         Pointer to the state to record.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : MQTTc_WalCompact(),
+*               MQTTc_WalLog().
+*
+* Note(s)     : (1) The record is tagged with the epoch of the half in use. See mqtt-c_wal.c Note #2b.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_WalRecWr (MQTTc_WAL        *p_wal,
+                              CPU_INT08U        half_ix,
+                              CPU_INT32U        rec_ix,
+                              MQTTc_WAL_ENTRY  *p_entry)
+{
+    MQTTc_WAL_REC  *p_rec;
+
+
+    p_rec         =  MQTTc_WalRecGet(p_wal, half_ix, rec_ix);
+    p_rec->Epoch  =  p_wal->Epoch;                              /* See Note #1.                                         */
+    p_rec->SegSeq =  p_entry->Pos.SegSeq;
+    p_rec->Offset =  p_entry->Pos.Offset;
+    p_rec->MsgID  =  p_entry->MsgID;
+    p_rec->State  = (CPU_INT16U)p_entry->State;
+    p_rec->CRC    =  MQTTc_StoreCRC_Calc(MQTTc_STORE_CRC_INIT, p_rec, sizeof(MQTTc_WAL_REC) - sizeof(CPU_INT32U));
+}
+
+
+/*
+*********************************************************************************************************
+*                                         MQTTc_WalSyncRange()
+*
+* Description : Sync a range of the memory region of given MQTTc WAL, if a sync function was given.
+*
+* Argument(s) : p_wal           Pointer to MQTTc WAL object.
+*
+*               p_addr          Pointer to start of range.
+*
+*               len             Len of range, in bytes.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Various.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  MQTTc_WalSyncRange (MQTTc_WAL   *p_wal,
+                                  void        *p_addr,
+                                  CPU_INT32U   len)
+{
+    if ((p_wal->SyncPolicy != MQTTc_WAL_SYNC_POLICY_NONE) &&
+        (p_wal->SyncFnct   != DEF_NULL)) {
+        p_wal->SyncFnct(p_addr,
+                        len,
+                        p_wal->SyncArgPtr);
+    }
+}
+
+
+#endif                                                          /* MQTTc_CFG_WAL_EN                                     */
@@ -0,0 +1,189 @@
+/*
+*********************************************************************************************************
+*                                              uC/MQTTc
+*                                Message Queue Telemetry Transport Client
+*
+*                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                             MQTT CLIENT
+*                                  WRITE-AHEAD LOG OF IN-FLIGHT STATE
+*
+* Filename : mqtt-c_wal.h
+* Version  : V1.02.00
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This header file is protected from multiple pre-processor inclusion through use of the
+*               MQTTc WAL module present pre-processor macro definition.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#ifndef  MQTTc_WAL_MODULE_PRESENT
+#define  MQTTc_WAL_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#include  "mqtt-c.h"
+#include  "mqtt-c_store.h"
+
+
+#if (MQTTc_CFG_WAL_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                               DEFINES
+*
+* Note(s) : (1) A connection has at most one outbound entry per slot of its tx window and one inbound
+*               entry per entry of its QoS 2 rx tbl.
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#define  MQTTc_WAL_TBL_SIZE                     (MQTTc_CFG_STORE_WIN_SIZE + MQTTc_CFG_QOS2_RX_TBL_SIZE)
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                       MQTTc WAL SYNC POLICY
+*
+* Note(s) : (1) With the GROUP policy, the records are synced in a single batch before anything is tx'd
+*               to the server. The server can thus never see a state that the log does not cover.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_wal_sync_policy {
+    MQTTc_WAL_SYNC_POLICY_NONE,                                 /* Never synced. For a battery-backed RAM.              */
+    MQTTc_WAL_SYNC_POLICY_GROUP,                                /* Synced before each tx. See Note #1.                  */
+    MQTTc_WAL_SYNC_POLICY_EACH                                  /* Synced after each rec.                               */
+} MQTTc_WAL_SYNC_POLICY;
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc WAL STATE
+*
+* Note(s) : (1) Outbound entries are keyed by the pos of their rec in the store, inbound entries by their
+*               msg ID.
+*
+*           (2) The FREE states are only logged, to remove an entry. They are never held in the tbl.
+*********************************************************************************************************
+*/
+
+typedef  enum  mqttc_wal_state {
+    MQTTc_WAL_STATE_NONE = 0,                                   /* Entry not in use.                                    */
+    MQTTc_WAL_STATE_OUT_TX,                                     /* PUBLISH tx'd with msg ID.                            */
+    MQTTc_WAL_STATE_OUT_REL,                                    /* PUBREC rx'd. PUBREL tx'd.                            */
+    MQTTc_WAL_STATE_OUT_CMPL,                                   /* PUBACK or PUBCOMP rx'd. Rec not released yet.        */
+    MQTTc_WAL_STATE_OUT_FREE,                                   /* Rec released. See Note #2.                           */
+    MQTTc_WAL_STATE_IN_REC,                                     /* QoS 2 PUBLISH rx'd and delivered. PUBREC tx'd.       */
+    MQTTc_WAL_STATE_IN_FREE                                     /* PUBREL rx'd. See Note #2.                            */
+} MQTTc_WAL_STATE;
+
+
+/*
+*********************************************************************************************************
+*                                           MQTTc WAL ENTRY
+*********************************************************************************************************
+*/
+
+typedef  struct  mqttc_wal_entry {
+    MQTTc_WAL_STATE   State;                                    /* State of the flow.                                   */
+    CPU_INT16U        MsgID;                                    /* Msg ID used by the flow.                             */
+    MQTTc_STORE_POS   Pos;                                      /* Pos of rec in store, for outbound flows.             */
+} MQTTc_WAL_ENTRY;
+
+
+/*
+*********************************************************************************************************
+*                                               MQTTc WAL
+*********************************************************************************************************
+*/
+
+struct  mqttc_wal {
+    CPU_INT08U             *MemPtr;                             /* Ptr to mem region holding the log.                   */
+    CPU_INT32U              HalfLen;                            /* Len of each half of the region, in bytes.            */
+    CPU_INT32U              RecNbrMax;                          /* Nbr of recs each half can hold.                      */
+
+    CPU_INT08U              HalfIx;                             /* Ix of half in use.                                   */
+    CPU_INT32U              Epoch;                              /* Epoch of half in use.                                */
+    CPU_INT32U              RecIx;                              /* Ix of next rec in half in use.                       */
+    CPU_INT32U              SyncIx;                             /* Ix of first rec not synced.                          */
+
+    MQTTc_WAL_SYNC_POLICY   SyncPolicy;                         /* When recs are synced.                                */
+    MQTTc_STORE_SYNC_FNCT   SyncFnct;                           /* Fnct called to sync mem region, if any.              */
+    void                   *SyncArgPtr;                         /* Arg passed to sync fnct.                             */
+
+    MQTTc_WAL_ENTRY         Tbl[MQTTc_WAL_TBL_SIZE];            /* State of each flow in flight.                        */
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+void              MQTTc_WalOpen    (MQTTc_WAL              *p_wal,
+                                    void                   *p_mem,
+                                    CPU_INT32U              mem_len,
+                                    MQTTc_WAL_SYNC_POLICY   sync_policy,
+                                    MQTTc_STORE_SYNC_FNCT   sync_fnct,
+                                    void                   *p_sync_arg,
+                                    MQTTc_ERR              *p_err);
+
+void              MQTTc_WalLog     (MQTTc_WAL              *p_wal,
+                                    MQTTc_WAL_STATE         state,
+                                    CPU_INT16U              msg_id,
+                                    MQTTc_STORE_POS        *p_pos);
+
+MQTTc_WAL_ENTRY  *MQTTc_WalOutFind (MQTTc_WAL              *p_wal,
+                                    MQTTc_STORE_POS        *p_pos);
+
+void              MQTTc_WalSync    (MQTTc_WAL              *p_wal);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#endif                                                          /* MQTTc_CFG_WAL_EN                                     */
+#endif
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+#
+# *********************************************************************************************************
+# *                                              uC/MQTTc
+# *                                Message Queue Telemetry Transport Client
+# *
+# *                    Copyright 2014-2020 Silicon Laboratories Inc. www.silabs.com
+# *
+# *                                 SPDX-License-Identifier: APACHE-2.0
+# *
+# *               This software is subject to an open source license and is distributed by
+# *                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+# *                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+# *
+# *********************************************************************************************************
+#
+# *********************************************************************************************************
+# *
+# *                                             MQTT CLIENT
+# *                                        TRACE RING DECODER
+# *
+# * Filename : mqtt-c_trace_decode.py
+# * Version  : V1.02.00
+# *********************************************************************************************************
+# * Note(s)  : (1) Turns a dump of the MQTTc trace ring (see mqtt-c_trace.c) into text, one event per line,
+# *                oldest first :
+# *
+# *                    <seq> <time> sock=<sock ID> <event> <arg>=<value> ...
+# *
+# *                The time is in us since the first event decoded, if the freq of the timestamps is known,
+# *                or in raw timestamp ticks otherwise.
+# *
+# *            (2) The dump can be the ring alone or any larger memory dump holding it : the ring is found by
+# *                its magic, in either endianness.
+# *
+# *            (3) The names and args of the events are read from mqtt-c_trace.h, and the names of the msg
+# *                types and of the errs from mqtt-c.h, so that the decoder follows the sources it is
+# *                given. By default, the sources next to this tool are used.
+# *********************************************************************************************************
+#
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+
+TRACE_RING_MAGIC = 0x5254514D
+TRACE_RING_VER   = 1
+
+RING_HDR_FMT     = 'IHHIIIB3x'                                  # See MQTTc_TRACE_RING.
+ENTRY_FMT        = 'IIHh4I'                                     # See MQTTc_TRACE_ENTRY.
+
+SRC_DIR_DFLT     = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Source')
+
+
+def enum_parse(path, prefix):
+    """Return the names of an enum's values, in order, with the comment of each (see Note #3)."""
+    names    = []
+    comments = []
+    with open(path, 'r') as f:
+        for line in f:
+            m = re.match(r'\s*' + prefix + r'(\w+)\s*(?:=\s*0u?)?\s*,?\s*(?:/\*\s*(.*?)\s*\*/)?\s*$', line)
+            if m is not None:
+                names.append(m.group(1))
+                comments.append(m.group(2) or '')
+    return names, comments
+
+
+def evt_tbl_get(src_dir):
+    """Return (name, arg names) of each event, indexed by event ID."""
+    names, comments = enum_parse(os.path.join(src_dir, 'mqtt-c_trace.h'), 'MQTTc_TRACE_EVT_')
+    tbl = []
+    for name, comment in zip(names, comments):
+        m    = re.match(r'Args:\s*(.*?)\.?$', comment)
+        args = []
+        if (m is not None) and (m.group(1) != 'none'):
+            args = [re.sub(r'\W+', '_', arg.strip().replace("'", '')).lower() for arg in m.group(1).split(',')]
+        tbl.append((name, args))
+    return tbl
+
+
+def ring_find(data):
+    """Return (offset, endianness prefix) of the ring in the dump. See Note #2."""
+    for endian in ('<', '>'):
+        offset = data.find(struct.pack(endian + 'I', TRACE_RING_MAGIC))
+        while offset >= 0:
+            ver = struct.unpack_from(endian + 'H', data, offset + 4)[0]
+            if ver == TRACE_RING_VER:
+                return offset, endian
+            offset = data.find(struct.pack(endian + 'I', TRACE_RING_MAGIC), offset + 1)
+    return None, None
+
+
+def arg_fmt(name, val, msg_types, errs):
+    if (name == 'type') and (val < len(msg_types)):
+        return msg_types[val]
+    if (name == 'err') and (val < len(errs)):
+        return errs[val]
+    if name == 'hdr':
+        return '0x%02X' % val
+    return str(val)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a dump of the MQTTc trace ring.')
+    parser.add_argument('dump',                            help='binary dump holding the trace ring')
+    parser.add_argument('--src', default=SRC_DIR_DFLT,     help='dir holding mqtt-c.h and mqtt-c_trace.h')
+    args = parser.parse_args()
+
+    with open(args.dump, 'rb') as f:
+        data = f.read()
+
+    offset, endian = ring_find(data)
+    if offset is None:
+        sys.exit('Trace ring not found in %s.' % args.dump)
+
+    evt_tbl      = evt_tbl_get(args.src)
+    msg_types, _ = enum_parse(os.path.join(args.src, 'mqtt-c.h'), 'MQTTc_MSG_TYPE_')
+    errs, _      = enum_parse(os.path.join(args.src, 'mqtt-c.h'), 'MQTTc_ERR_')
+
+    hdr_fmt   = endian + RING_HDR_FMT
+    entry_fmt = endian + ENTRY_FMT
+    _, _, entry_len, entry_nbr, ts_freq, seq_last, _ = struct.unpack_from(hdr_fmt, data, offset)
+    if entry_len != struct.calcsize(entry_fmt):
+        sys.exit('Unsupported entry len: %d.' % entry_len)
+
+    offset += struct.calcsize(hdr_fmt)
+    if offset + (entry_nbr * entry_len) > len(data):
+        sys.exit('Dump is truncated.')
+
+    entries = []
+    for ix in range(entry_nbr):
+        entry = struct.unpack_from(entry_fmt, data, offset + (ix * entry_len))
+        seq   = entry[0]
+        if (seq == 0) or ((seq % entry_nbr) != ix):             # Entry is empty or being written.
+            continue
+        if (seq > seq_last) or (seq + entry_nbr <= seq_last):   # Entry is stale.
+            continue
+        entries.append(entry)
+    entries.sort(key=lambda entry: entry[0])
+
+    ts_first = entries[0][1] if entries else 0
+    for seq, ts, evt_id, sock_id, *arg_vals in entries:
+        ticks = (ts - ts_first) & 0xFFFFFFFF
+        if ts_freq != 0:
+            time_str = '%12.3f us' % (ticks * 1000000.0 / ts_freq)
+        else:
+            time_str = '%12d ticks' % ticks
+
+        if evt_id < len(evt_tbl):
+            name, arg_names = evt_tbl[evt_id]
+        else:
+            name, arg_names = 'EVT_%d' % evt_id, []
+
+        arg_strs = []
+        for ix, val in enumerate(arg_vals):
+            if ix < len(arg_names):
+                arg_strs.append('%s=%s' % (arg_names[ix], arg_fmt(arg_names[ix], val, msg_types, errs)))
+            elif val != 0:
+                arg_strs.append('arg%d=%d' % (ix, val))
+
+        print('%10d %s sock=%-4d %-12s %s' % (seq, time_str, sock_id, name, ' '.join(arg_strs)))
+
+
+if __name__ == '__main__':
+    main()